@@ -3,6 +3,7 @@
 #include "json/document.h"
 #include "json/writer.h"
 #include "json/stringbuffer.h"
+#include <memory>
 
 USING_NS_CC;
 
@@ -94,4 +95,16 @@ LevelConfig LevelConfigLoader::loadFromFile(const std::string& filename) {
     CCLOG("======================================================");
 
     return config;
+}
+
+void LevelConfigLoader::loadFromFileAsync(const std::string& filename, const std::function<void(const LevelConfig&)>& callback) {
+    // 读取和解析在工作线程中进行，结果在主线程中交给回调
+    auto config = std::make_shared<LevelConfig>();
+    JobSystem::getInstance()->schedule([filename, config]() {
+        *config = loadFromFile(filename);
+    }, [config, callback]() {
+        if (callback) {
+            callback(*config);
+        }
+    });
 }
\ No newline at end of file
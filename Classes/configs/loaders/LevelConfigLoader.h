@@ -5,10 +5,12 @@
  * 职责：
  * - 从JSON文件加载关卡配置
  * - 解析配置数据并转换为LevelConfig对象
+ * - 在JobSystem的工作线程中异步加载，主线程回调
  */
 
 #pragma once
 #include "configs/models/LevelConfig.h"
+#include <functional>
 #include <string>
 
  /**
@@ -25,6 +27,13 @@ public:
      */
     static LevelConfig loadFromFile(const std::string& filename);
 
+    /**
+     * @brief 在JobSystem的工作线程中读取并解析关卡配置，完成后在主线程中回调
+     * @param filename JSON文件名（相对于Resources目录）
+     * @param callback 主线程回调，参数为加载的关卡配置对象（失败时为空配置）
+     */
+    static void loadFromFileAsync(const std::string& filename, const std::function<void(const LevelConfig&)>& callback);
+
 private:
     LevelConfigLoader() = delete;  // 禁止实例化
 };
\ No newline at end of file
@@ -48,19 +48,36 @@ bool GameController::startGame(int levelId) {
     CCLOG("========== GameController::startGame ==========");
     CCLOG("Level ID: %d", levelId);
 
-    // 加载关卡配置
+    // 在工作线程中加载关卡配置，视图在加载期间保持存活
     std::string filename = "level1.json"; 
-    LevelConfig config = LevelConfigLoader::loadFromFile(filename);
+    GameView* gameView = _gameView;
+    gameView->retain();
+    LevelConfigLoader::loadFromFileAsync(filename, [this, gameView](const LevelConfig& config) {
+        // 视图已被移除时只剩下这里的引用，不再开始游戏
+        if (gameView->getReferenceCount() > 1) {
+            onLevelConfigLoaded(config);
+        }
+        gameView->release();
+        });
+
+    CCLOG("Level config loading started");
+    CCLOG("==========================================");
+
+    return true;
+}
+
+void GameController::onLevelConfigLoaded(const LevelConfig& config) {
+    CCLOG("========== GameController::onLevelConfigLoaded ==========");
 
     if (config.playfieldCards.empty() && config.stackCards.empty()) {
         CCLOG("ERROR: Failed to load level config");
-        return false;
+        return;
     }
 
     // 生成游戏模型
     if (!GameModelFromLevelGenerator::generateFromConfig(config, *_gameModel)) {
         CCLOG("ERROR: Failed to generate game model");
-        return false;
+        return;
     }
 
     // 清空回退记录
@@ -69,7 +86,7 @@ bool GameController::startGame(int levelId) {
     // 创建视图
     if (!_gameView->createCardsFromModel(*_gameModel)) {
         CCLOG("ERROR: Failed to create cards view");
-        return false;
+        return;
     }
 
     // 更新UI
@@ -77,8 +94,6 @@ bool GameController::startGame(int levelId) {
 
     CCLOG("Game started successfully");
     CCLOG("==========================================");
-
-    return true;
 }
 
 void GameController::onCardClicked(int cardId) {
@@ -13,6 +13,7 @@
 #include "cocos2d.h"
 #include "models/GameModel.h"
 #include "managers/UndoManager.h"
+#include "configs/models/LevelConfig.h"
 #include <functional>
 
 USING_NS_CC;
@@ -39,8 +40,9 @@ public:
 
     /**
      * @brief ʼϷ
+     * ؿJobSystemĹ߳жȡͽɺ߳д
      * @param levelId ؿIDʱδʹãֱӼ level1. json
-     * @return Ƿɹʼ
+     * @return Ƿɹʼ
      */
     bool startGame(int levelId = 1);
 
@@ -62,6 +64,12 @@ public:
     bool checkVictory() const;
 
 private:
+    /**
+     * @brief ؿüɺ߳пʼϷ
+     * @param config صĹؿ
+     */
+    void onLevelConfigLoaded(const LevelConfig& config);
+
     /**
      * @brief ſǷƥ
      * @param card1 1
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #define __ACTIONS_CCACTION_H__
 
 #include "base/CCRef.h"
+#include "base/CCObjectPool.h"
 #include "math/CCGeometry.h"
 #include "base/CCScriptSupport.h"
 
@@ -52,6 +53,8 @@ enum {
 class CC_DLL Action : public Ref, public Clonable
 {
 public:
+    CC_USE_OBJECT_POOL
+
     /** Default tag used for all the actions. */
     static const int INVALID_TAG = -1;
     /**
@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "2d/CCActionEase.h"
 #include "2d/CCTweenFunction.h"
 
+#include <typeinfo>
+
 NS_CC_BEGIN
 
 #ifndef M_PI_X_2
@@ -100,6 +102,11 @@ ActionInterval* ActionEase::getInnerAction()
     return _inner;
 }
 
+bool ActionEase::getEasing(tweenfunc::EaseFunction& /*function*/, float& /*param*/) const
+{
+    return false;
+}
+
 //
 // EaseRateAction
 //
@@ -157,6 +164,14 @@ void CLASSNAME::update(float time) { \
 } \
 ActionEase* CLASSNAME::reverse() const { \
     return REVERSE_CLASSNAME::create(_inner->reverse()); \
+} \
+bool CLASSNAME::getEasing(tweenfunc::EaseFunction& function, float& param) const { \
+    /* only the exact type: subclasses may override update() */ \
+    if (typeid(*this) != typeid(CLASSNAME)) \
+        return false; \
+    function = &tweenfunc::easeWithoutParam<TWEEN_FUNC>; \
+    param = 0; \
+    return true; \
 }
 
 EASE_TEMPLATE_IMPL(EaseExponentialIn, tweenfunc::expoEaseIn, EaseExponentialOut);
@@ -214,6 +229,14 @@ void CLASSNAME::update(float time) { \
 } \
 EaseRateAction* CLASSNAME::reverse() const { \
     return CLASSNAME::create(_inner->reverse(), 1.f / _rate); \
+} \
+bool CLASSNAME::getEasing(tweenfunc::EaseFunction& function, float& param) const { \
+    /* only the exact type: subclasses may override update() */ \
+    if (typeid(*this) != typeid(CLASSNAME)) \
+        return false; \
+    function = &TWEEN_FUNC; \
+    param = _rate; \
+    return true; \
 }
 
 // NOTE: the original code used the same class for the `reverse()` method
@@ -263,6 +286,14 @@ void CLASSNAME::update(float time) { \
 } \
 EaseElastic* CLASSNAME::reverse() const { \
     return REVERSE_CLASSNAME::create(_inner->reverse(), _period); \
+} \
+bool CLASSNAME::getEasing(tweenfunc::EaseFunction& function, float& param) const { \
+    /* only the exact type: subclasses may override update() */ \
+    if (typeid(*this) != typeid(CLASSNAME)) \
+        return false; \
+    function = &TWEEN_FUNC; \
+    param = _period; \
+    return true; \
 }
 
 EASEELASTIC_TEMPLATE_IMPL(EaseElasticIn, tweenfunc::elasticEaseIn, EaseElasticOut);
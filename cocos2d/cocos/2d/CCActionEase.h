@@ -54,6 +54,16 @@ public:
     */
     virtual ActionInterval* getInnerAction();
 
+    /**
+     @brief Gets the easing this action applies to its inner action as a plain function.
+     @details Lets the ActionManager update the inner action in its batched loops instead of stepping the wrapper.
+     @param function Set to the easing function.
+     @param param Set to the rate or period passed to the function.
+     @return Return false when the easing can't be expressed as a tweenfunc::EaseFunction,
+     or when the action is a subclass of the ease action defining it, which may override update().
+    */
+    virtual bool getEasing(tweenfunc::EaseFunction& function, float& param) const;
+
     //
     // Overrides
     //
@@ -134,6 +144,7 @@ public: \
     virtual CLASSNAME* clone() const override; \
     virtual void update(float time) override; \
     virtual ActionEase* reverse() const override; \
+    virtual bool getEasing(tweenfunc::EaseFunction& function, float& param) const override; \
 private: \
     CC_DISALLOW_COPY_AND_ASSIGN(CLASSNAME); \
 };
@@ -383,6 +394,7 @@ public: \
     virtual CLASSNAME* clone() const override; \
     virtual void update(float time) override; \
     virtual EaseRateAction* reverse() const override; \
+    virtual bool getEasing(tweenfunc::EaseFunction& function, float& param) const override; \
 private: \
     CC_DISALLOW_COPY_AND_ASSIGN(CLASSNAME); \
 };
@@ -470,6 +482,7 @@ public: \
     virtual CLASSNAME* clone() const override; \
     virtual void update(float time) override; \
     virtual EaseElastic* reverse() const override; \
+    virtual bool getEasing(tweenfunc::EaseFunction& function, float& param) const override; \
 private: \
     CC_DISALLOW_COPY_AND_ASSIGN(CLASSNAME); \
 };
@@ -86,6 +86,17 @@ void ExtraAction::step(float /*dt*/)
 // IntervalAction
 //
 
+ActionInterval::ActionInterval()
+: _elapsed(0)
+, _firstTick(true)
+, _done(false)
+, _easeFunction(nullptr)
+, _easeParam(0)
+, _tweenKind(-1)
+, _tweenSlot(-1)
+{
+}
+
 bool ActionInterval::initWithDuration(float d)
 {
 
@@ -131,6 +142,11 @@ void ActionInterval::step(float dt)
                               std::min(1.0f, _elapsed / _duration)
                               );
 
+    if (_easeFunction)
+    {
+        updateDt = _easeFunction(updateDt, _easeParam);
+    }
+
     if (sendUpdateEventToScript(updateDt, this)) return;
     
     this->update(updateDt);
@@ -138,6 +154,12 @@ void ActionInterval::step(float dt)
     _done = _elapsed >= _duration;
 }
 
+void ActionInterval::setEaseFunction(tweenfunc::EaseFunction function, float param)
+{
+    _easeFunction = function;
+    _easeParam = param;
+}
+
 void ActionInterval::setAmplitudeRate(float /*amp*/)
 {
     // Abstract class needs implementation
@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include "2d/CCAction.h"
 #include "2d/CCAnimation.h"
+#include "2d/CCTweenFunction.h"
 #include "base/CCProtocols.h"
 #include "base/CCVector.h"
 
@@ -88,6 +89,25 @@ public:
      */
     float getAmplitudeRate();
 
+    /** Eases the progress of the action without wrapping it in an ActionEase.
+     * The function is applied by step(), so it is used when the action runs on its own or inside
+     * RepeatForever and Speed. Sequence, Spawn and Repeat drive their children with update() and ignore it.
+     * It is not copied by clone() and reverse().
+     * @code
+     * move->setEaseFunction(tweenfunc::getEaseFunction(tweenfunc::Elastic_EaseOut), 0.3f);
+     * @endcode
+     *
+     * @param function  The easing function, nullptr for a linear progress.
+     * @param param     The rate or period passed to the function.
+     */
+    void setEaseFunction(tweenfunc::EaseFunction function, float param = 0.0f);
+
+    /** Gets the easing function set by setEaseFunction(). */
+    tweenfunc::EaseFunction getEaseFunction() const { return _easeFunction; }
+
+    /** Gets the parameter of the easing function. */
+    float getEaseParam() const { return _easeParam; }
+
     //
     // Overrides
     //
@@ -110,6 +130,8 @@ public:
     }
 
 CC_CONSTRUCTOR_ACCESS:
+    ActionInterval();
+
     /** initializes the action */
     bool initWithDuration(float d);
 
@@ -117,9 +139,17 @@ protected:
     float _elapsed;
     bool _firstTick;
     bool _done;
+    tweenfunc::EaseFunction _easeFunction;
+    float _easeParam;
     
 protected:
     bool sendUpdateEventToScript(float dt, Action *actionObject);
+
+private:
+    friend class ActionManager;
+    // bucket and slot of the action in the batched updates of the ActionManager, -1 when stepped normally
+    int _tweenKind;
+    int _tweenSlot;
 };
 
 /** @class Sequence
@@ -630,6 +660,8 @@ protected:
     Vec3 _startPosition;
     Vec3 _previousPosition;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MoveBy);
 };
@@ -1125,6 +1157,8 @@ protected:
     float _deltaY;
     float _deltaZ;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ScaleTo);
 };
@@ -1262,6 +1296,7 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     GLubyte _toOpacity;
     GLubyte _fromOpacity;
+    friend class ActionManager;
     friend class FadeOut;
     friend class FadeIn;
 private:
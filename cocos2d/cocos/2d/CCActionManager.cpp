@@ -28,12 +28,19 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCActionManager.h"
+
+#include <algorithm>
+#include <typeinfo>
+
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
+#include "2d/CCActionInterval.h"
+#include "2d/CCActionEase.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
 #include "base/ccCArray.h"
 #include "base/uthash.h"
+#include "base/CCFrameProfiler.h"
 
 NS_CC_BEGIN
 //
@@ -42,6 +49,7 @@ NS_CC_BEGIN
 typedef struct _hashElement
 {
     struct _ccArray     *actions;
+    struct _ccArray     *tweens;    // actions updated by the batched loops, see addTween()
     Node                *target;
     int                 actionIndex;
     Action              *currentAction;
@@ -50,10 +58,20 @@ typedef struct _hashElement
     UT_hash_handle      hh;
 } tHashElement;
 
+// bits of TweenBucket::states
+enum
+{
+    TWEEN_FIRST_TICK = 1 << 0,
+    TWEEN_PAUSED = 1 << 1,
+    TWEEN_REMOVED = 1 << 2,
+};
+
 ActionManager::ActionManager()
 : _targets(nullptr),
   _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _currentTargetSalvaged(false),
+  _tweensLocked(false),
+  _tweensDirty(false)
 {
 
 }
@@ -69,6 +87,14 @@ ActionManager::~ActionManager()
 
 void ActionManager::deleteHashElement(tHashElement *element)
 {
+    if (element->tweens)
+    {
+        for (ssize_t i = 0; i < element->tweens->num; ++i)
+        {
+            detachTween(static_cast<ActionInterval*>(element->tweens->arr[i]));
+        }
+        ccArrayFree(element->tweens);
+    }
     ccArrayFree(element->actions);
     HASH_DEL(_targets, element);
     element->target->release();
@@ -81,6 +107,7 @@ void ActionManager::actionAllocWithHashElement(tHashElement *element)
     if (element->actions == nullptr)
     {
         element->actions = ccArrayNew(4);
+        element->tweens = ccArrayNew(4);
     }else 
     if (element->actions->num == element->actions->max)
     {
@@ -107,7 +134,7 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
         element->actionIndex--;
     }
 
-    if (element->actions->num == 0)
+    if (element->actions->num == 0 && element->tweens->num == 0)
     {
         if (_currentTarget == element)
         {
@@ -120,6 +147,217 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
     }
 }
 
+// tweens
+
+void ActionManager::TweenBucket::resize(size_t size)
+{
+    actions.resize(size);
+    driven.resize(size);
+    targets.resize(size);
+    elapsed.resize(size);
+    durations.resize(size);
+    progress.resize(size);
+    easeFunctions.resize(size);
+    easeParams.resize(size);
+    states.resize(size);
+    from.resize(size);
+    deltas.resize(size);
+    previous.resize(size);
+}
+
+void ActionManager::TweenBucket::erase(size_t slot)
+{
+    size_t last = size() - 1;
+    if (slot != last)
+    {
+        actions[slot] = actions[last];
+        driven[slot] = driven[last];
+        targets[slot] = targets[last];
+        elapsed[slot] = elapsed[last];
+        durations[slot] = durations[last];
+        progress[slot] = progress[last];
+        easeFunctions[slot] = easeFunctions[last];
+        easeParams[slot] = easeParams[last];
+        states[slot] = states[last];
+        from[slot] = from[last];
+        deltas[slot] = deltas[last];
+        previous[slot] = previous[last];
+
+        if (actions[slot])
+        {
+            actions[slot]->_tweenSlot = (int)slot;
+        }
+    }
+    resize(last);
+}
+
+int ActionManager::getTweenKind(Action *action, ActionInterval *&driven, tweenfunc::EaseFunction &easeFunction, float &easeParam) const
+{
+    auto interval = dynamic_cast<ActionInterval*>(action);
+    if (interval == nullptr)
+    {
+        return -1;
+    }
+
+#if CC_ENABLE_SCRIPT_BINDING
+    // javascript actions get an update event for every step
+    if (interval->_scriptType == kScriptTypeJavascript)
+    {
+        return -1;
+    }
+#endif
+
+    driven = interval;
+    easeFunction = interval->_easeFunction;
+    easeParam = interval->_easeParam;
+
+    auto ease = dynamic_cast<ActionEase*>(interval);
+    if (ease)
+    {
+        // getEasing() fails for the subclasses of the ease actions, like the driven action they may override update()
+        if (easeFunction || !ease->getEasing(easeFunction, easeParam))
+        {
+            return -1;
+        }
+        driven = ease->getInnerAction();
+        if (driven == nullptr)
+        {
+            return -1;
+        }
+    }
+
+    // only the exact types: subclasses may override update()
+    const std::type_info& type = typeid(*driven);
+    if (type == typeid(MoveBy) || type == typeid(MoveTo))
+    {
+        return TWEEN_MOVE;
+    }
+    if (type == typeid(ScaleBy) || type == typeid(ScaleTo))
+    {
+        return TWEEN_SCALE;
+    }
+    if (type == typeid(FadeTo) || type == typeid(FadeIn) || type == typeid(FadeOut))
+    {
+        return TWEEN_FADE;
+    }
+    return -1;
+}
+
+void ActionManager::addTween(ActionInterval *action, tHashElement *element)
+{
+    ActionInterval *driven = nullptr;
+    tweenfunc::EaseFunction easeFunction = nullptr;
+    float easeParam = 0;
+    int kind = getTweenKind(action, driven, easeFunction, easeParam);
+    CCASSERT(kind >= 0, "action can't be updated in a batch");
+
+    auto& bucket = _tweens[kind];
+    size_t slot = bucket.size();
+    bucket.resize(slot + 1);
+
+    bucket.actions[slot] = action;
+    bucket.driven[slot] = driven;
+    bucket.targets[slot] = element->target;
+    bucket.elapsed[slot] = action->_elapsed;
+    bucket.durations[slot] = action->getDuration();
+    bucket.progress[slot] = 0;
+    bucket.easeFunctions[slot] = easeFunction;
+    bucket.easeParams[slot] = easeParam;
+    bucket.states[slot] = (action->_firstTick ? TWEEN_FIRST_TICK : 0) | (element->paused ? TWEEN_PAUSED : 0);
+
+    switch (kind)
+    {
+        case TWEEN_MOVE:
+        {
+            auto move = static_cast<MoveBy*>(driven);
+            bucket.from[slot] = move->_startPosition;
+            bucket.deltas[slot] = move->_positionDelta;
+            bucket.previous[slot] = move->_previousPosition;
+            break;
+        }
+        case TWEEN_SCALE:
+        {
+            auto scale = static_cast<ScaleTo*>(driven);
+            bucket.from[slot].set(scale->_startScaleX, scale->_startScaleY, scale->_startScaleZ);
+            bucket.deltas[slot].set(scale->_deltaX, scale->_deltaY, scale->_deltaZ);
+            break;
+        }
+        case TWEEN_FADE:
+        {
+            auto fade = static_cast<FadeTo*>(driven);
+            bucket.from[slot].set(fade->_fromOpacity, 0, 0);
+            bucket.deltas[slot].set((float)(fade->_toOpacity - fade->_fromOpacity), 0, 0);
+            break;
+        }
+        default:
+            break;
+    }
+
+    action->_tweenKind = kind;
+    action->_tweenSlot = (int)slot;
+}
+
+void ActionManager::detachTween(ActionInterval *action)
+{
+    if (action->_tweenKind < 0)
+    {
+        return;
+    }
+
+    auto& bucket = _tweens[action->_tweenKind];
+    size_t slot = action->_tweenSlot;
+
+    // hand the state that only lives in the bucket back to the action
+    if (action->_tweenKind == TWEEN_MOVE)
+    {
+        auto move = static_cast<MoveBy*>(bucket.driven[slot]);
+        move->_startPosition = bucket.from[slot];
+        move->_previousPosition = bucket.previous[slot];
+    }
+
+    action->_tweenKind = -1;
+    action->_tweenSlot = -1;
+
+    if (_tweensLocked)
+    {
+        bucket.actions[slot] = nullptr;
+        bucket.states[slot] |= TWEEN_REMOVED;
+        _tweensDirty = true;
+    }
+    else
+    {
+        bucket.erase(slot);
+    }
+}
+
+void ActionManager::removeTweenAtIndex(ssize_t index, tHashElement *element)
+{
+    detachTween(static_cast<ActionInterval*>(element->tweens->arr[index]));
+    ccArrayRemoveObjectAtIndex(element->tweens, index, true);
+
+    if (element->actions->num == 0 && element->tweens->num == 0)
+    {
+        if (_currentTarget == element)
+        {
+            _currentTargetSalvaged = true;
+        }
+        else
+        {
+            deleteHashElement(element);
+        }
+    }
+}
+
+void ActionManager::setTweensPaused(tHashElement *element, bool paused)
+{
+    for (ssize_t i = 0; i < element->tweens->num; ++i)
+    {
+        auto action = static_cast<ActionInterval*>(element->tweens->arr[i]);
+        auto& state = _tweens[action->_tweenKind].states[action->_tweenSlot];
+        state = paused ? (state | TWEEN_PAUSED) : (state & ~TWEEN_PAUSED);
+    }
+}
+
 // pause / resume
 
 void ActionManager::pauseTarget(Node *target)
@@ -129,6 +367,7 @@ void ActionManager::pauseTarget(Node *target)
     if (element)
     {
         element->paused = true;
+        setTweensPaused(element, true);
     }
 }
 
@@ -139,6 +378,7 @@ void ActionManager::resumeTarget(Node *target)
     if (element)
     {
         element->paused = false;
+        setTweensPaused(element, false);
     }
 }
 
@@ -151,6 +391,7 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
         if (! element->paused) 
         {
             element->paused = true;
+            setTweensPaused(element, true);
             idsWithActions.pushBack(element->target);
         }
     }    
@@ -188,12 +429,25 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
         HASH_ADD_PTR(_targets, target, element);
     }
 
-     actionAllocWithHashElement(element);
- 
-     CCASSERT(! ccArrayContainsObject(element->actions, action), "action already be added!");
-     ccArrayAppendObject(element->actions, action);
- 
-     action->startWithTarget(target);
+    actionAllocWithHashElement(element);
+
+    CCASSERT(! ccArrayContainsObject(element->actions, action) && ! ccArrayContainsObject(element->tweens, action), "action already be added!");
+
+    ActionInterval *driven = nullptr;
+    tweenfunc::EaseFunction easeFunction = nullptr;
+    float easeParam = 0;
+    if (getTweenKind(action, driven, easeFunction, easeParam) >= 0)
+    {
+        ccArrayAppendObjectWithResize(element->tweens, action);
+        action->startWithTarget(target);
+        // startWithTarget() computed the start values the bucket needs
+        addTween(static_cast<ActionInterval*>(action), element);
+        return;
+    }
+
+    ccArrayAppendObject(element->actions, action);
+
+    action->startWithTarget(target);
 }
 
 // remove
@@ -227,6 +481,11 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
         }
 
         ccArrayRemoveAllObjects(element->actions);
+        for (ssize_t i = 0; i < element->tweens->num; ++i)
+        {
+            detachTween(static_cast<ActionInterval*>(element->tweens->arr[i]));
+        }
+        ccArrayRemoveAllObjects(element->tweens);
         if (_currentTarget == element)
         {
             _currentTargetSalvaged = true;
@@ -255,6 +514,13 @@ void ActionManager::removeAction(Action *action)
         if (i != CC_INVALID_INDEX)
         {
             removeActionAtIndex(i, element);
+            return;
+        }
+
+        i = ccArrayGetIndexOfObject(element->tweens, action);
+        if (i != CC_INVALID_INDEX)
+        {
+            removeTweenAtIndex(i, element);
         }
     }
 }
@@ -281,7 +547,19 @@ void ActionManager::removeActionByTag(int tag, Node *target)
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
                 removeActionAtIndex(i, element);
-                break;
+                return;
+            }
+        }
+
+        limit = element->tweens->num;
+        for (int i = 0; i < limit; ++i)
+        {
+            Action *action = static_cast<Action*>(element->tweens->arr[i]);
+
+            if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
+            {
+                removeTweenAtIndex(i, element);
+                return;
             }
         }
     }
@@ -301,6 +579,8 @@ void ActionManager::removeAllActionsByTag(int tag, Node *target)
     
     if (element)
     {
+        // the element is deleted together with its last action
+        auto tweenLimit = element->tweens->num;
         auto limit = element->actions->num;
         for (int i = 0; i < limit;)
         {
@@ -316,6 +596,21 @@ void ActionManager::removeAllActionsByTag(int tag, Node *target)
                 ++i;
             }
         }
+
+        for (int i = 0; i < tweenLimit;)
+        {
+            Action *action = static_cast<Action*>(element->tweens->arr[i]);
+
+            if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
+            {
+                removeTweenAtIndex(i, element);
+                --tweenLimit;
+            }
+            else
+            {
+                ++i;
+            }
+        }
     }
 }
 
@@ -336,6 +631,8 @@ void ActionManager::removeActionsByFlags(unsigned int flags, Node *target)
 
     if (element)
     {
+        // the element is deleted together with its last action
+        auto tweenLimit = element->tweens->num;
         auto limit = element->actions->num;
         for (int i = 0; i < limit;)
         {
@@ -351,6 +648,21 @@ void ActionManager::removeActionsByFlags(unsigned int flags, Node *target)
                 ++i;
             }
         }
+
+        for (int i = 0; i < tweenLimit;)
+        {
+            Action *action = static_cast<Action*>(element->tweens->arr[i]);
+
+            if ((action->getFlags() & flags) != 0 && action->getOriginalTarget() == target)
+            {
+                removeTweenAtIndex(i, element);
+                --tweenLimit;
+            }
+            else
+            {
+                ++i;
+            }
+        }
     }
 }
 
@@ -379,6 +691,17 @@ Action* ActionManager::getActionByTag(int tag, const Node *target) const
                     return action;
                 }
             }
+
+            limit = element->tweens->num;
+            for (int i = 0; i < limit; ++i)
+            {
+                Action *action = static_cast<Action*>(element->tweens->arr[i]);
+
+                if (action->getTag() == (int)tag)
+                {
+                    return action;
+                }
+            }
         }
     }
 
@@ -393,7 +716,7 @@ ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) con
     HASH_FIND_PTR(_targets, &target, element);
     if (element)
     {
-        return element->actions ? element->actions->num : 0;
+        return element->actions ? element->actions->num + element->tweens->num : 0;
     }
 
     return 0;
@@ -420,6 +743,13 @@ size_t ActionManager::getNumberOfRunningActionsInTargetByTag(const Node *target,
         if(action->getTag() == tag)
             ++count;
     }
+    limit = element->tweens->num;
+    for(int i = 0; i < limit; ++i)
+    {
+        auto action = static_cast<Action*>(element->tweens->arr[i]);
+        if(action->getTag() == tag)
+            ++count;
+    }
 
     return count;
 }
@@ -431,7 +761,7 @@ ssize_t ActionManager::getNumberOfRunningActions() const
     struct _hashElement* tmp = nullptr;
     HASH_ITER(hh, _targets, element, tmp)
     {
-        count += (element->actions ? element->actions->num : 0);
+        count += (element->actions ? element->actions->num + element->tweens->num : 0);
     }
     return count;
 }
@@ -439,6 +769,8 @@ ssize_t ActionManager::getNumberOfRunningActions() const
 // main loop
 void ActionManager::update(float dt)
 {
+    CC_PROFILE_ZONE("ActionManager::update");
+
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
@@ -486,7 +818,7 @@ void ActionManager::update(float dt)
         elt = (tHashElement*)(elt->hh.next);
 
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+        if (_currentTargetSalvaged && _currentTarget->actions->num == 0 && _currentTarget->tweens->num == 0)
         {
             deleteHashElement(_currentTarget);
         }
@@ -499,6 +831,148 @@ void ActionManager::update(float dt)
 
     // issue #635
     _currentTarget = nullptr;
+
+    updateTweens(dt);
+}
+
+void ActionManager::updateTweens(float dt)
+{
+    _tweensLocked = true;
+
+    for (int kind = 0; kind < TWEEN_KIND_COUNT; ++kind)
+    {
+        auto& bucket = _tweens[kind];
+        // tweens added while updating start with the next frame
+        const size_t count = bucket.size();
+        if (count == 0)
+        {
+            continue;
+        }
+
+        // same timing as ActionInterval::step(), nothing in here calls out so the loop runs over plain arrays
+        float *elapsed = bucket.elapsed.data();
+        float *progress = bucket.progress.data();
+        unsigned char *states = bucket.states.data();
+        const float *durations = bucket.durations.data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const unsigned char state = states[i];
+            const bool running = (state & (TWEEN_PAUSED | TWEEN_REMOVED)) == 0;
+            const float advanced = (state & TWEEN_FIRST_TICK) ? MATH_EPSILON : elapsed[i] + dt;
+            elapsed[i] = running ? advanced : elapsed[i];
+            states[i] = running ? (unsigned char)(state & ~TWEEN_FIRST_TICK) : state;
+            progress[i] = std::max(0.0f, std::min(1.0f, elapsed[i] / durations[i]));
+        }
+
+        const tweenfunc::EaseFunction *easeFunctions = bucket.easeFunctions.data();
+        const float *easeParams = bucket.easeParams.data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (easeFunctions[i])
+            {
+                progress[i] = easeFunctions[i](progress[i], easeParams[i]);
+            }
+        }
+
+        applyTweens((TweenKind)kind, bucket, count);
+
+        // write the clock back so isDone() and getElapsed() keep working, and retire the finished tweens
+        // like the generic loop does
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (bucket.states[i] & (TWEEN_PAUSED | TWEEN_REMOVED))
+            {
+                continue;
+            }
+
+            auto action = bucket.actions[i];
+            action->_firstTick = false;
+            action->_elapsed = bucket.elapsed[i];
+            action->_done = bucket.elapsed[i] >= bucket.durations[i];
+            if (action->_done)
+            {
+                action->stop();
+                removeAction(action);
+            }
+        }
+    }
+
+    _tweensLocked = false;
+
+    if (_tweensDirty)
+    {
+        _tweensDirty = false;
+        for (auto& bucket : _tweens)
+        {
+            for (size_t i = 0; i < bucket.size();)
+            {
+                if (bucket.actions[i] == nullptr)
+                {
+                    bucket.erase(i);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+    }
+}
+
+void ActionManager::applyTweens(TweenKind kind, TweenBucket &bucket, size_t count)
+{
+    // the node setters may run user code that adds or removes actions: the vectors are indexed again
+    // after every call, and removed tweens are only flagged until updateTweens() is done
+    switch (kind)
+    {
+        case TWEEN_MOVE:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (bucket.states[i] & (TWEEN_PAUSED | TWEEN_REMOVED))
+                {
+                    continue;
+                }
+#if CC_ENABLE_STACKABLE_ACTIONS
+                Node *target = bucket.targets[i];
+                bucket.from[i] += target->getPosition3D() - bucket.previous[i];
+                Vec3 newPos = bucket.from[i] + bucket.deltas[i] * bucket.progress[i];
+                target->setPosition3D(newPos);
+                bucket.previous[i] = newPos;
+#else
+                bucket.targets[i]->setPosition3D(bucket.from[i] + bucket.deltas[i] * bucket.progress[i]);
+#endif // CC_ENABLE_STACKABLE_ACTIONS
+            }
+            break;
+
+        case TWEEN_SCALE:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (bucket.states[i] & (TWEEN_PAUSED | TWEEN_REMOVED))
+                {
+                    continue;
+                }
+                Node *target = bucket.targets[i];
+                Vec3 scale = bucket.from[i] + bucket.deltas[i] * bucket.progress[i];
+                target->setScaleX(scale.x);
+                target->setScaleY(scale.y);
+                target->setScaleZ(scale.z);
+            }
+            break;
+
+        case TWEEN_FADE:
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (bucket.states[i] & (TWEEN_PAUSED | TWEEN_REMOVED))
+                {
+                    continue;
+                }
+                bucket.targets[i]->setOpacity((GLubyte)(bucket.from[i].x + bucket.deltas[i].x * bucket.progress[i]));
+            }
+            break;
+
+        default:
+            break;
+    }
 }
 
 NS_CC_END
@@ -30,13 +30,18 @@ THE SOFTWARE.
 #ifndef __ACTION_CCACTION_MANAGER_H__
 #define __ACTION_CCACTION_MANAGER_H__
 
+#include <vector>
+
 #include "2d/CCAction.h"
+#include "2d/CCTweenFunction.h"
 #include "base/CCVector.h"
 #include "base/CCRef.h"
+#include "math/Vec3.h"
 
 NS_CC_BEGIN
 
 class Action;
+class ActionInterval;
 
 struct _hashElement;
 
@@ -53,6 +58,11 @@ struct _hashElement;
  Examples:
     - When you want to run an action where the target is different from a Node. 
     - When you want to pause / resume the actions.
+
+ MoveBy, MoveTo, ScaleBy, ScaleTo, FadeTo, FadeIn and FadeOut, run on their own or wrapped in one of the
+ easing actions, are not stepped one by one: their state is kept in one structure of arrays per action type
+ and all of them are advanced by a few tight loops after the other actions were stepped.
+ Their elapsed time and done flag are written back every frame, so they behave like any other action.
  
  @since v0.8
  */
@@ -206,10 +216,52 @@ protected:
     void deleteHashElement(struct _hashElement *element);
     void actionAllocWithHashElement(struct _hashElement *element);
 
+    // batched updates of the common interval actions
+    enum TweenKind
+    {
+        TWEEN_MOVE,
+        TWEEN_SCALE,
+        TWEEN_FADE,
+        TWEEN_KIND_COUNT
+    };
+
+    struct TweenBucket
+    {
+        std::vector<ActionInterval*> actions;       // the actions passed to addAction(), nullptr once removed during update()
+        std::vector<ActionInterval*> driven;        // the actions whose update() is replicated, the inner action of an ActionEase
+        std::vector<Node*> targets;
+        std::vector<float> elapsed;
+        std::vector<float> durations;
+        std::vector<float> progress;
+        std::vector<tweenfunc::EaseFunction> easeFunctions;
+        std::vector<float> easeParams;
+        std::vector<unsigned char> states;
+        std::vector<Vec3> from;
+        std::vector<Vec3> deltas;
+        std::vector<Vec3> previous;
+
+        size_t size() const { return actions.size(); }
+        void resize(size_t size);
+        void erase(size_t slot);
+    };
+
+    int getTweenKind(Action *action, ActionInterval *&driven, tweenfunc::EaseFunction &easeFunction, float &easeParam) const;
+    void addTween(ActionInterval *action, struct _hashElement *element);
+    void removeTweenAtIndex(ssize_t index, struct _hashElement *element);
+    void detachTween(ActionInterval *action);
+    void setTweensPaused(struct _hashElement *element, bool paused);
+    void updateTweens(float dt);
+    void applyTweens(TweenKind kind, TweenBucket &bucket, size_t count);
+
 protected:
     struct _hashElement    *_targets;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
+
+    TweenBucket     _tweens[TWEEN_KIND_COUNT];
+    // removed tweens are only compacted once updateTweens() is done with the buckets
+    bool            _tweensLocked;
+    bool            _tweensDirty;
 };
 
 // end of actions group
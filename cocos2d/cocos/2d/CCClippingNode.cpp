@@ -213,7 +213,7 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     renderer->pushGroup(_groupCommand.getRenderQueueID());
 
     _beforeVisitCmd.init(_globalZOrder);
-    _beforeVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
+    _beforeVisitCmd.func = [this]() { _stencilStateManager->onBeforeVisit(); };
     renderer->addCommand(&_beforeVisitCmd);
     
     auto alphaThreshold = this->getAlphaThreshold();
@@ -236,7 +236,7 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     _stencil->visit(renderer, _modelViewTransform, flags);
 
     _afterDrawStencilCmd.init(_globalZOrder);
-    _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
+    _afterDrawStencilCmd.func = [this]() { _stencilStateManager->onAfterDrawStencil(); };
     renderer->addCommand(&_afterDrawStencilCmd);
 
     int i = 0;
@@ -268,7 +268,7 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     }
 
     _afterVisitCmd.init(_globalZOrder);
-    _afterVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+    _afterVisitCmd.func = [this]() { _stencilStateManager->onAfterVisit(); };
     renderer->addCommand(&_afterVisitCmd);
 
     renderer->popGroup();
@@ -95,13 +95,13 @@ void ClippingRectangleNode::onAfterVisitScissor()
 void ClippingRectangleNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags)
 {
     _beforeVisitCmdScissor.init(_globalZOrder);
-    _beforeVisitCmdScissor.func = CC_CALLBACK_0(ClippingRectangleNode::onBeforeVisitScissor, this);
+    _beforeVisitCmdScissor.func = [this]() { onBeforeVisitScissor(); };
     renderer->addCommand(&_beforeVisitCmdScissor);
     
     Node::visit(renderer, parentTransform, parentFlags);
     
     _afterVisitCmdScissor.init(_globalZOrder);
-    _afterVisitCmdScissor.func = CC_CALLBACK_0(ClippingRectangleNode::onAfterVisitScissor, this);
+    _afterVisitCmdScissor.func = [this]() { onAfterVisitScissor(); };
     renderer->addCommand(&_afterVisitCmdScissor);
 }
 
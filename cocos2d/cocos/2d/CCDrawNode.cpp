@@ -281,26 +281,31 @@ bool DrawNode::init()
     return true;
 }
 
+bool DrawNode::getCullingRect(Rect* /*rect*/) const
+{
+    return false;
+}
+
 void DrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     if(_bufferCount)
     {
         _customCommand.init(_globalZOrder, transform, flags);
-        _customCommand.func = CC_CALLBACK_0(DrawNode::onDraw, this, transform, flags);
+        _customCommand.func = [this]() { onDraw(_customCommand.getModelView(), _customCommand.getFlags()); };
         renderer->addCommand(&_customCommand);
     }
     
     if(_bufferCountGLPoint)
     {
         _customCommandGLPoint.init(_globalZOrder, transform, flags);
-        _customCommandGLPoint.func = CC_CALLBACK_0(DrawNode::onDrawGLPoint, this, transform, flags);
+        _customCommandGLPoint.func = [this]() { onDrawGLPoint(_customCommandGLPoint.getModelView(), _customCommandGLPoint.getFlags()); };
         renderer->addCommand(&_customCommandGLPoint);
     }
     
     if(_bufferCountGLLine)
     {
         _customCommandGLLine.init(_globalZOrder, transform, flags);
-        _customCommandGLLine.func = CC_CALLBACK_0(DrawNode::onDrawGLLine, this, transform, flags);
+        _customCommandGLLine.func = [this]() { onDrawGLLine(_customCommandGLLine.getModelView(), _customCommandGLLine.getFlags()); };
         renderer->addCommand(&_customCommandGLLine);
     }
 }
@@ -313,6 +313,8 @@ public:
     
     // Overrides
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    // the primitives may be anywhere, the node is never culled
+    virtual bool getCullingRect(Rect* rect) const override;
 
     virtual void visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t parentFlags) override;
     
@@ -44,7 +44,8 @@ const char* FontFreeType::_glyphNEHE = "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFG
 
 typedef struct _DataRef
 {
-    Data data;
+    // FreeType reads the font tables on demand, keep the mapped file instead of a copy
+    FileView data;
     unsigned int referenceCount;
 }DataRef;
 
@@ -134,7 +135,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
     else
     {
         s_cacheFontData[fontName].referenceCount = 1;
-        s_cacheFontData[fontName].data = FileUtils::getInstance()->getDataFromFile(fontName);    
+        s_cacheFontData[fontName].data = FileUtils::getInstance()->getContentsView(fontName, FileUtils::AccessPattern::RANDOM);    
 
         if (s_cacheFontData[fontName].data.isNull())
         {
@@ -672,11 +672,8 @@ void Label::setString(const std::string& text)
         _utf8Text = text;
         _contentDirty = true;
 
-        std::u32string utf32String;
-        if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
-        {
-            _utf32Text  = utf32String;
-        }
+        // converted in place, _utf32Text is left untouched when the text isn't valid UTF-8
+        StringUtils::UTF8ToUTF32(_utf8Text, _utf32Text);
 
         CCASSERT(_utf32Text.length() <= CC_LABEL_MAX_LENGTH, "Length of text should be less then 16384");
         if (_utf32Text.length() > CC_LABEL_MAX_LENGTH)
@@ -867,14 +864,14 @@ bool Label::alignText()
             float fontSize = this->getRenderingFontSize();
 
             if(fontSize > 0 &&  isVerticalClamp()){
-                this->shrinkLabelToContentSize(CC_CALLBACK_0(Label::isVerticalClamp, this));
+                this->shrinkLabelToContentSize([this]() { return isVerticalClamp(); });
             }
         }
 
         if(!updateQuads()){
             ret = false;
             if(_overflow == Overflow::SHRINK){
-                this->shrinkLabelToContentSize(CC_CALLBACK_0(Label::isHorizontalClamp, this));
+                this->shrinkLabelToContentSize([this]() { return isHorizontalClamp(); });
             }
             break;
         }
@@ -1406,11 +1403,7 @@ void Label::updateContent()
 
     if (_fontAtlas)
     {
-        std::u32string utf32String;
-        if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
-        {
-            _utf32Text = utf32String;
-        }
+        StringUtils::UTF8ToUTF32(_utf8Text, _utf32Text);
 
         computeHorizontalKernings(_utf32Text);
         updateFinished = alignText();
@@ -1635,7 +1628,7 @@ void Label::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
         else
         {
             _customCommand.init(_globalZOrder, transform, flags);
-            _customCommand.func = CC_CALLBACK_0(Label::onDraw, this, transform, transformUpdated);
+            _customCommand.func = [this]() { onDraw(_customCommand.getModelView(), (_customCommand.getFlags() & FLAGS_TRANSFORM_DIRTY) != 0); };
 
             renderer->addCommand(&_customCommand);
         }
@@ -2055,6 +2048,25 @@ Rect Label::getBoundingBox() const
     return Node::getBoundingBox();
 }
 
+bool Label::getCullingRect(Rect* rect) const
+{
+    const Size& contentSize = getContentSize();
+    rect->setRect(0, 0, contentSize.width, contentSize.height);
+    if (rect->size.width <= 0 || rect->size.height <= 0)
+        return true;
+
+    float margin = std::max(_outlineSize, 0.0f);
+    if (_shadowEnabled)
+    {
+        margin += std::max(std::abs(_shadowOffset.width), std::abs(_shadowOffset.height)) + _shadowBlurRadius;
+    }
+    rect->origin.x -= margin;
+    rect->origin.y -= margin;
+    rect->size.width += 2 * margin;
+    rect->size.height += 2 * margin;
+    return true;
+}
+
 void Label::setBlendFunc(const BlendFunc &blendFunc)
 {
     _blendFunc = blendFunc;
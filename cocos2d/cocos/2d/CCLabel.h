@@ -598,6 +598,8 @@ public:
 
     virtual const Size& getContentSize() const override;
     virtual Rect getBoundingBox() const override;
+    // the content size extended by the outline and the shadow
+    virtual bool getCullingRect(Rect* rect) const override;
 
     virtual void visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags) override;
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
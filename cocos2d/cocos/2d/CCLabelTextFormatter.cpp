@@ -314,12 +314,12 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
 
 bool Label::multilineTextWrapByWord()
 {
-    return multilineTextWrap(CC_CALLBACK_3(Label::getFirstWordLen, this));
+    return multilineTextWrap([this](const std::u32string& text, int startIndex, int textLen) { return getFirstWordLen(text, startIndex, textLen); });
 }
 
 bool Label::multilineTextWrapByChar()
 {
-    return multilineTextWrap(CC_CALLBACK_3(Label::getFirstCharLen, this));
+    return multilineTextWrap([this](const std::u32string& text, int startIndex, int textLen) { return getFirstCharLen(text, startIndex, textLen); });
 }
 
 bool Label::isVerticalClamp()
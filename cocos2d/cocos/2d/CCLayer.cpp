@@ -602,7 +602,7 @@ void LayerColor::updateColor()
 void LayerColor::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     _customCommand.init(_globalZOrder, transform, flags);
-    _customCommand.func = CC_CALLBACK_0(LayerColor::onDraw, this, transform, flags);
+    _customCommand.func = [this]() { onDraw(_customCommand.getModelView(), _customCommand.getFlags()); };
     renderer->addCommand(&_customCommand);
     
     for(int i = 0; i < 4; ++i)
@@ -932,7 +932,7 @@ bool LayerRadialGradient::initWithColor(const cocos2d::Color4B &startColor, cons
 void LayerRadialGradient::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     _customCommand.init(_globalZOrder, transform, flags);
-    _customCommand.func = CC_CALLBACK_0(LayerRadialGradient::onDraw, this, transform, flags);
+    _customCommand.func = [this]() { onDraw(_customCommand.getModelView(), _customCommand.getFlags()); };
     renderer->addCommand(&_customCommand);
 }
 
@@ -189,6 +189,11 @@ float MotionStreak::getPositionY() const
     return  _positionR.y;
 }
 
+bool MotionStreak::getCullingRect(Rect* /*rect*/) const
+{
+    return false;
+}
+
 void MotionStreak::setPositionY(float y)
 {
     if (!_startingPositionInitialized) {
@@ -401,7 +406,7 @@ void MotionStreak::draw(Renderer *renderer, const Mat4 &transform, uint32_t flag
     if(_nuPoints <= 1)
         return;
     _customCommand.init(_globalZOrder, transform, flags);
-    _customCommand.func = CC_CALLBACK_0(MotionStreak::onDraw, this, transform, flags);
+    _customCommand.func = [this]() { onDraw(_customCommand.getModelView(), _customCommand.getFlags()); };
     renderer->addCommand(&_customCommand);
 }
 
@@ -121,6 +121,8 @@ public:
     virtual void setPositionY(float y) override;
     virtual float getPositionX(void) const override;
     virtual float getPositionY(void) const override;
+    // the streak follows the positions of the node, it is never culled
+    virtual bool getCullingRect(Rect* rect) const override;
     virtual Vec3 getPosition3D() const override;
     /**
     * @js NA
@@ -36,11 +36,13 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCTouchHitGrid.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
 #include "2d/CCActionManager.h"
 #include "2d/CCScene.h"
 #include "2d/CCComponent.h"
+#include "2d/CCSpatialIndex.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
@@ -92,6 +94,7 @@ Node::Node()
 , _tag(Node::INVALID_TAG)
 , _name("")
 , _hashOfName(0)
+, _childNameIndex(nullptr)
 // userData is always inited as nil
 , _userData(nullptr)
 , _userObject(nullptr)
@@ -100,6 +103,7 @@ Node::Node()
 , _visible(true)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
+, _reorderedChild(nullptr)
 , _isTransitionFinished(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _updateScriptHandler(0)
@@ -116,6 +120,14 @@ Node::Node()
 , _onExitCallback(nullptr)
 , _onEnterTransitionDidFinishCallback(nullptr)
 , _onExitTransitionDidStartCallback(nullptr)
+, _spatialIndex(nullptr)
+, _spatialIndexSlot(-1)
+, _spatialCullingEnabled(false)
+, _spatialBoundsDirty(false)
+, _spatialPendingFlags(0)
+, _spatialChangedSlot(-1)
+, _spatialResolveStamp(0)
+, _touchHitGridIndexed(false)
 #if CC_USE_PHYSICS
 , _physicsBody(nullptr)
 #endif
@@ -176,6 +188,11 @@ Node::~Node()
     removeAllComponents();
     
     CC_SAFE_DELETE(_componentContainer);
+
+    if (_spatialIndex)
+        _spatialIndex->remove(this);
+    if (_spatialChangedSlot >= 0)
+        SpatialIndex::removeChangedNode(this);
     
     stopAllActions();
     unscheduleAllCallbacks();
@@ -192,6 +209,7 @@ Node::~Node()
     CC_SAFE_RELEASE(_eventDispatcher);
 
     delete[] _additionalTransform;
+    delete _childNameIndex;
 }
 
 bool Node::init()
@@ -251,6 +269,7 @@ void Node::setSkewX(float skewX)
     
     _skewX = skewX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 float Node::getSkewY() const
@@ -265,6 +284,7 @@ void Node::setSkewY(float skewY)
     
     _skewY = skewY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 void Node::setLocalZOrder(std::int32_t z)
@@ -317,6 +337,7 @@ void Node::setRotation(float rotation)
     
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
     
     updateRotationQuat();
 }
@@ -334,6 +355,7 @@ void Node::setRotation3D(const Vec3& rotation)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 
     _rotationX = rotation.x;
     _rotationY = rotation.y;
@@ -385,6 +407,7 @@ void Node::setRotationQuat(const Quaternion& quat)
     _rotationQuat = quat;
     updateRotation3D();
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 Quaternion Node::getRotationQuat() const
@@ -399,6 +422,7 @@ void Node::setRotationSkewX(float rotationX)
     
     _rotationZ_X = rotationX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
     
     updateRotationQuat();
 }
@@ -415,6 +439,7 @@ void Node::setRotationSkewY(float rotationY)
     
     _rotationZ_Y = rotationY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
     
     updateRotationQuat();
 }
@@ -434,6 +459,7 @@ void Node::setScale(float scale)
     
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 /// scaleX getter
@@ -451,6 +477,7 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 /// scaleX setter
@@ -461,6 +488,7 @@ void Node::setScaleX(float scaleX)
     
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 /// scaleY getter
@@ -477,6 +505,7 @@ void Node::setScaleZ(float scaleZ)
     
     _scaleZ = scaleZ;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 /// scaleY getter
@@ -493,6 +522,7 @@ void Node::setScaleY(float scaleY)
     
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 
@@ -523,6 +553,7 @@ void Node::setPosition(float x, float y)
     _position.y = y;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
     _usingNormalizedPosition = false;
 }
 
@@ -568,6 +599,7 @@ void Node::setPositionZ(float positionZ)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 
     _positionZ = positionZ;
 }
@@ -588,6 +620,7 @@ void Node::setPositionNormalized(const Vec2& position)
     _usingNormalizedPosition = true;
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 ssize_t Node::getChildrenCount() const
@@ -609,6 +642,7 @@ void Node::setVisible(bool visible)
         _visible = visible;
         if(_visible)
             _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateSpatialBounds();
     }
 }
 
@@ -630,6 +664,7 @@ void Node::setAnchorPoint(const Vec2& point)
         _anchorPoint = point;
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateSpatialBounds();
     }
 }
 
@@ -647,6 +682,7 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = _contentSizeDirty = true;
+        invalidateSpatialBounds();
     }
 }
 
@@ -659,8 +695,17 @@ bool Node::isRunning() const
 /// parent setter
 void Node::setParent(Node * parent)
 {
+    if (_parent != parent)
+    {
+        if (_parent && _parent->_childNameIndex)
+            _parent->removeFromChildNameIndex(this);
+        if (parent && parent->_childNameIndex)
+            parent->addToChildNameIndex(this);
+    }
+
     _parent = parent;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 /// isRelativeAnchorPoint getter
@@ -676,6 +721,7 @@ void Node::setIgnoreAnchorPointForPosition(bool newValue)
     {
         _ignoreAnchorPointForPosition = newValue;
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateSpatialBounds();
     }
 }
 
@@ -698,9 +744,16 @@ const std::string& Node::getName() const
 
 void Node::setName(const std::string& name)
 {
+    bool indexed = _parent && _parent->_childNameIndex;
+    if (indexed)
+        _parent->removeFromChildNameIndex(this);
+
     _name = name;
     std::hash<std::string> h;
     _hashOfName = h(name);
+
+    if (indexed)
+        _parent->addToChildNameIndex(this);
 }
 
 /// userData setter
@@ -802,12 +855,91 @@ Node* Node::getChildByTag(int tag) const
     return nullptr;
 }
 
+void Node::setChildNameIndexEnabled(bool enabled)
+{
+    if (enabled == (_childNameIndex != nullptr))
+        return;
+
+    if (!enabled)
+    {
+        CC_SAFE_DELETE(_childNameIndex);
+        return;
+    }
+
+    _childNameIndex = new (std::nothrow) std::unordered_map<size_t, ChildNameEntry>();
+    if (_childNameIndex)
+    {
+        _childNameIndex->reserve(_children.size());
+        for (const auto& child : _children)
+        {
+            addToChildNameIndex(child);
+        }
+    }
+}
+
+void Node::addToChildNameIndex(Node* child)
+{
+    if (child->_name.empty())
+        return;
+
+    auto& entry = (*_childNameIndex)[child->_hashOfName];
+    // a new entry is value-initialized
+    entry.child = entry.count == 0 ? child : nullptr;
+    ++entry.count;
+}
+
+void Node::removeFromChildNameIndex(Node* child)
+{
+    if (child->_name.empty())
+        return;
+
+    auto iter = _childNameIndex->find(child->_hashOfName);
+    if (iter == _childNameIndex->end())
+        return;
+
+    auto& entry = iter->second;
+    if (--entry.count == 0)
+    {
+        _childNameIndex->erase(iter);
+    }
+    else
+    {
+        // the remaining child is looked up again on the next search
+        entry.child = nullptr;
+    }
+}
+
 Node* Node::getChildByName(const std::string& name) const
 {
     CCASSERT(!name.empty(), "Invalid name");
     
     std::hash<std::string> h;
     size_t hash = h(name);
+
+    if (_childNameIndex)
+    {
+        auto iter = _childNameIndex->find(hash);
+        if (iter == _childNameIndex->end())
+            return nullptr;
+
+        // when several children share the name (or its hash), scan them to return the first one like before
+        auto& entry = iter->second;
+        if (entry.count == 1)
+        {
+            if (!entry.child)
+            {
+                for (const auto& child : _children)
+                {
+                    if (child->_hashOfName == hash && child->_parent == this)
+                    {
+                        entry.child = child;
+                        break;
+                    }
+                }
+            }
+            return entry.child && entry.child->_name.compare(name) == 0 ? entry.child : nullptr;
+        }
+    }
     
     for (const auto& child : _children)
     {
@@ -907,10 +1039,27 @@ bool Node::doEnumerate(std::string name, std::function<bool (Node *)> callback)
         needRecursive = true;
     }
     
+    // names without any special character match themselves only, don't compile a regular expression for them
+    bool isPlainName = searchName.find_first_of("\\^$.|?*+()[]{}") == std::string::npos;
+    size_t searchHash = 0;
+    std::regex searchRegex;
+    if (isPlainName)
+    {
+        std::hash<std::string> h;
+        searchHash = h(searchName);
+    }
+    else
+    {
+        searchRegex.assign(searchName);
+    }
+
     bool ret = false;
     for (const auto& child : getChildren())
     {
-        if (std::regex_match(child->_name, std::regex(searchName)))
+        bool matched = isPlainName
+            ? (child->_hashOfName == searchHash && child->_name == searchName)
+            : std::regex_match(child->_name, searchRegex);
+        if (matched)
         {
             if (!needRecursive)
             {
@@ -1161,7 +1310,8 @@ void Node::insertChild(Node* child, int z)
     }
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
     _transformUpdated = true;
-    _reorderChildDirty = true;
+    invalidateSpatialBounds();
+    setChildReordered(child);
     _children.pushBack(child);
     child->_setLocalZOrder(z);
 }
@@ -1169,18 +1319,69 @@ void Node::insertChild(Node* child, int z)
 void Node::reorderChild(Node *child, int zOrder)
 {
     CCASSERT( child != nullptr, "Child must be non-nil");
-    _reorderChildDirty = true;
+    setChildReordered(child);
     child->updateOrderOfArrival();
     child->_setLocalZOrder(zOrder);
+    _eventDispatcher->setDirtyForNode(child);
+}
+
+void Node::setChildReordered(Node* child)
+{
+    if (!_reorderChildDirty)
+    {
+        _reorderChildDirty = true;
+        _reorderedChild = child;
+    }
+    else if (_reorderedChild != child)
+    {
+        _reorderedChild = nullptr;
+    }
+}
+
+bool Node::moveReorderedChild()
+{
+    ssize_t index = _children.getIndex(_reorderedChild);
+    if (index == CC_INVALID_INDEX)
+        return false;
+
+    auto isBefore = [](const Node* n1, const Node* n2) {
+#if CC_64BITS
+        return n1->_localZOrder$Arrival < n2->_localZOrder$Arrival;
+#else
+        return (n1->_localZOrder == n2->_localZOrder && n1->_orderOfArrival < n2->_orderOfArrival) || n1->_localZOrder < n2->_localZOrder;
+#endif
+    };
+
+    // the other children are still sorted: find the new position with a binary search and shift the ones in between
+    auto first = _children.begin();
+    auto last = _children.end();
+    auto position = first + index;
+    if (position != first && isBefore(*position, *(position - 1)))
+    {
+        auto target = std::upper_bound(first, position, *position, isBefore);
+        std::rotate(target, position, position + 1);
+    }
+    else if (position + 1 != last && isBefore(*(position + 1), *position))
+    {
+        auto target = std::lower_bound(position + 1, last, *position, isBefore);
+        std::rotate(position, position + 1, target);
+    }
+
+    // subclasses may have changed the order of the children behind our back
+    return std::is_sorted(first, last, isBefore);
 }
 
 void Node::sortAllChildren()
 {
     if (_reorderChildDirty)
     {
-        sortNodes(_children);
+        // only one child was added or reordered since the last sort: move it instead of sorting everything
+        if (!_reorderedChild || !moveReorderedChild())
+        {
+            sortNodes(_children);
+        }
         _reorderChildDirty = false;
-        _eventDispatcher->setDirtyForNode(this);
+        _reorderedChild = nullptr;
     }
 }
 
@@ -1218,6 +1419,10 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
         }
     }
 
+    // before the camera check, the grid of any camera may contain this node
+    if (_touchHitGridIndexed && ((parentFlags & FLAGS_DIRTY_MASK) || _transformUpdated || _contentSizeDirty))
+        TouchHitGrid::markNodeChanged();
+
     // Fixes Github issue #16100. Basically when having two cameras, one camera might set as dirty the
     // node that is not visited by it, and might affect certain calculations. Besides, it is faster to do this.
     if (!isVisitableByVisitingCamera())
@@ -1244,6 +1449,71 @@ bool Node::isVisitableByVisitingCamera() const
     return visibleByCamera;
 }
 
+void Node::setSpatialCullingEnabled(bool enabled)
+{
+    if (_spatialCullingEnabled == enabled)
+        return;
+
+    _spatialCullingEnabled = enabled;
+    _spatialBoundsDirty = true;
+    if (!enabled && _spatialIndex)
+        _spatialIndex->remove(this);
+}
+
+bool Node::getCullingRect(Rect* rect) const
+{
+    // a leaf without size may be a custom drawing node
+    if (_children.empty() && (_contentSize.width <= 0 || _contentSize.height <= 0))
+        return false;
+
+    rect->setRect(0, 0, _contentSize.width, _contentSize.height);
+    return true;
+}
+
+void Node::invalidateSpatialBounds()
+{
+    // the parents are walked once per frame by SpatialIndex::resolveChangedNodes(), not by every setter
+    if (SpatialIndex::getInstanceCount() == 0 || _spatialChangedSlot >= 0)
+        return;
+
+    SpatialIndex::addChangedNode(this);
+}
+
+bool Node::isCulledBySpatialIndex(uint32_t& flags)
+{
+    // _modelViewTransform is only up to date for the cameras that see this node
+    if (!isVisitableByVisitingCamera())
+        return false;
+
+    if (_spatialIndex == nullptr)
+    {
+        auto scene = getScene();
+        if (scene == nullptr || scene->getSpatialIndex() == nullptr)
+            return false;
+
+        // registered lazily, so that roots can be added before the index is enabled
+        scene->getSpatialIndex()->update(this, SpatialIndex::computeSubtreeBounds(this, _modelViewTransform));
+        _spatialBoundsDirty = false;
+    }
+    else if (_spatialBoundsDirty || (flags & FLAGS_DIRTY_MASK))
+    {
+        _spatialIndex->update(this, SpatialIndex::computeSubtreeBounds(this, _modelViewTransform));
+        _spatialBoundsDirty = false;
+    }
+
+    // the children missed the dirty flags of the frames in which this root was culled
+    flags |= _spatialPendingFlags;
+
+    if (_spatialIndex->isVisible(this, _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION)))
+    {
+        _spatialPendingFlags = 0;
+        return false;
+    }
+
+    _spatialPendingFlags = flags & FLAGS_DIRTY_MASK;
+    return true;
+}
+
 void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t parentFlags)
 {
     // quick return if not visible. children won't be drawn.
@@ -1254,6 +1524,12 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
 
+    // the whole subtree is outside of the visible area of the camera
+    if (_spatialCullingEnabled && isCulledBySpatialIndex(flags))
+    {
+        return;
+    }
+
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
@@ -1398,6 +1674,9 @@ void Node::onExit()
     {
         --__attachedNodeCount;
     }
+
+    if (_spatialIndex)
+        _spatialIndex->remove(this);
 #if CC_ENABLE_SCRIPT_BINDING
     if (_scriptType == kScriptTypeJavascript)
     {
@@ -1808,6 +2087,7 @@ void Node::setNodeToParentTransform(const Mat4& transform)
     _transform = transform;
     _transformDirty = false;
     _transformUpdated = true;
+    invalidateSpatialBounds();
 
     if (_additionalTransform)
         // _additionalTransform[1] has a copy of lastest transform
@@ -1841,6 +2121,7 @@ void Node::setAdditionalTransform(const Mat4* additionalTransform)
         _additionalTransform[0] = *additionalTransform;
     }
     _transformUpdated = _additionalTransformDirty = _inverseDirty = true;
+    invalidateSpatialBounds();
 }
 
 void Node::setAdditionalTransform(const Mat4& additionalTransform)
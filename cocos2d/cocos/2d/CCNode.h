@@ -31,9 +31,11 @@
 #define __CCNODE_H__
 
 #include <cstdint>
+#include <unordered_map>
 #include "base/ccMacros.h"
 #include "base/CCVector.h"
 #include "base/CCProtocols.h"
+#include "base/CCObjectPool.h"
 #include "base/CCScriptSupport.h"
 #include "math/CCAffineTransform.h"
 #include "math/CCMath.h"
@@ -63,6 +65,7 @@ class GLProgramState;
 class Material;
 class Camera;
 class PhysicsBody;
+class SpatialIndex;
 
 /**
  * @addtogroup _2d
@@ -109,6 +112,8 @@ class EventListener;
 class CC_DLL Node : public Ref
 {
 public:
+    CC_USE_OBJECT_POOL
+
     /** Default tag used for all the nodes */
     static const int INVALID_TAG = -1;
 
@@ -807,9 +812,25 @@ public:
     */
     template <typename T>
     T getChildByName(const std::string& name) const { return static_cast<T>(getChildByName(name)); }
+    /**
+     * Enables an index of the children by name, so `getChildByName()` finds a child without scanning all the children.
+     * Worth it for containers with many named children, the index costs one map entry per named child.
+     * When several children share a name, `getChildByName()` scans the children for that name to keep returning the first one.
+     *
+     * @param enabled True to build the index, false to delete it.
+     * @since v3.17
+     */
+    void setChildNameIndexEnabled(bool enabled);
+    /**
+     * Returns whether the children are indexed by name.
+     *
+     * @since v3.17
+     */
+    bool isChildNameIndexEnabled() const { return _childNameIndex != nullptr; }
     /** Search the children of the receiving node to perform processing for nodes which share a name.
      *
      * @param name The name to search for, supports c++11 regular expression.
+     * Names without any regular expression character are compared directly, without compiling a regular expression.
      * Search syntax options:
      * `//`: Can only be placed at the begin of the search string. This indicates that it will search recursively.
      * `..`: The search should move up to the node's parent. Can only be placed at the end of string.
@@ -1857,6 +1878,33 @@ public:
      */
     virtual void setCameraMask(unsigned short mask, bool applyChildren = true);
 
+    /**
+     * Makes this node a spatial culling root.
+     * When the running scene has a SpatialIndex (see `Scene::setSpatialIndexEnabled()`), the bounds of this node
+     * and all its descendants are indexed as a whole, and the entire subtree is skipped by visit() when it is
+     * outside of the visible area of the camera. Good candidates are containers of many sprites, like a card, a tile
+     * chunk or an off-screen part of a large map.
+     * Culling roots should not be nested into nodes that override visit() without calling Node::visit().
+     * @param enabled Whether or not this node is a culling root. Default is false.
+     */
+    void setSpatialCullingEnabled(bool enabled);
+    /**
+     * Whether or not this node is a spatial culling root.
+     */
+    bool isSpatialCullingEnabled() const { return _spatialCullingEnabled; }
+
+    /**
+     * Gets the rect, in the node's space, covered by what this node draws itself, its children excluded.
+     * The spatial culling merges the rects of a culling root and of its descendants into its bounds.
+     * The default is the content size. A node without content size nor children is assumed to draw anywhere,
+     * since it can only be there to draw something custom. Nodes drawing outside of their content size
+     * override it, e.g. ParticleSystem, DrawNode and Label.
+     * @param rect The rect covered by this node, an empty rect if it draws nothing.
+     * @return false if this node may draw anywhere, then its culling root is never culled.
+     * @since v3.17
+     */
+    virtual bool getCullingRect(Rect* rect) const;
+
 CC_CONSTRUCTOR_ACCESS:
     // Nodes should be created using create();
     Node();
@@ -1874,6 +1922,21 @@ protected:
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
     void detachChild(Node *child, ssize_t index, bool doCleanup);
 
+    /// Marks the children order dirty, remembering the child if it is the only one out of place
+    void setChildReordered(Node* child);
+
+    /// Moves the only child out of place to its sorted position, returns false if the children still need a full sort
+    bool moveReorderedChild();
+
+    struct ChildNameEntry
+    {
+        Node* child;            ///< the child with this name, nullptr if it has to be searched again
+        unsigned int count;     ///< number of children whose name has this hash
+    };
+
+    void addToChildNameIndex(Node* child);
+    void removeFromChildNameIndex(Node* child);
+
     /// Convert cocos2d coordinates to UI windows coordinate.
     Vec2 convertToWindowSpace(const Vec2& nodePoint) const;
 
@@ -1891,6 +1954,11 @@ protected:
     
     //check whether this camera mask is visible by the current visiting camera
     bool isVisitableByVisitingCamera() const;
+
+    // tells the culling roots above this node, before the next cull, that their subtree bounds must be recomputed
+    void invalidateSpatialBounds();
+    // updates the index entry of a culling root, returns true if the whole subtree can be skipped
+    bool isCulledBySpatialIndex(uint32_t& flags);
     
     // update quaternion from Rotation3D
     void updateRotationQuat();
@@ -1962,6 +2030,8 @@ protected:
     float _globalZOrder;            ///< Global order used to sort the node
 
     static std::uint32_t s_globalOrderOfArrival;
+    // orders the scene graph priority listeners like the children are sorted
+    friend class EventDispatcher;
 
     Vector<Node*> _children;        ///< array of children nodes
     Node *_parent;                  ///< weak reference to parent node
@@ -1970,6 +2040,7 @@ protected:
     
     std::string _name;              ///<a string label, an user defined string to identify this node
     size_t _hashOfName;             ///<hash value of _name, used for speed in getChildByName
+    std::unordered_map<size_t, ChildNameEntry>* _childNameIndex; ///< children by hash of name, see setChildNameIndexEnabled()
 
     void *_userData;                ///< A user assigned void pointer, Can be point to any cpp object
     Ref *_userObject;               ///< A user assigned Object
@@ -1990,6 +2061,7 @@ protected:
                                           ///< Used by Layer and Scene.
 
     bool _reorderChildDirty;          ///< children order dirty flag
+    Node* _reorderedChild;            ///< only child reordered or added since the last sort, nullptr if there are several
     bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -2016,6 +2088,20 @@ protected:
     std::function<void()> _onEnterTransitionDidFinishCallback;
     std::function<void()> _onExitTransitionDidStartCallback;
 
+    // spatial culling, see setSpatialCullingEnabled()
+    SpatialIndex* _spatialIndex;      ///< weak ref, index of the scene this culling root is registered in
+    int _spatialIndexSlot;            ///< entry of this node in _spatialIndex, -1 if not indexed
+    bool _spatialCullingEnabled;
+    bool _spatialBoundsDirty;         ///< something inside the subtree changed since the bounds were indexed
+    uint32_t _spatialPendingFlags;    ///< dirty flags received while culled, forwarded to the children once visible
+    int _spatialChangedSlot;          ///< entry of this node in the changed nodes of SpatialIndex, -1 if not changed
+    unsigned int _spatialResolveStamp; ///< set by SpatialIndex::resolveChangedNodes() once the ancestors were told
+
+    friend class SpatialIndex;
+
+    bool _touchHitGridIndexed;        ///< a TouchHitGrid indexed the hit test rect of this node, its changes invalidate the grid
+    friend class TouchHitGrid;
+
 //Physics:remaining backwardly compatible  
 #if CC_USE_PHYSICS
     PhysicsBody* _physicsBody;
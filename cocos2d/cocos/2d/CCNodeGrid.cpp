@@ -133,7 +133,7 @@ void NodeGrid::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t p
     }
 
     _gridBeginCommand.init(_globalZOrder);
-    _gridBeginCommand.func = CC_CALLBACK_0(NodeGrid::onGridBeginDraw, this);
+    _gridBeginCommand.func = [this]() { onGridBeginDraw(); };
     renderer->addCommand(&_gridBeginCommand);
 
 
@@ -182,7 +182,7 @@ void NodeGrid::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t p
     }
 
     _gridEndCommand.init(_globalZOrder);
-    _gridEndCommand.func = CC_CALLBACK_0(NodeGrid::onGridEndDraw, this);
+    _gridEndCommand.func = [this]() { onGridEndDraw(); };
     renderer->addCommand(&_gridEndCommand);
 
     renderer->popGroup();
@@ -1373,6 +1373,11 @@ void ParticleSystem::setScaleY(float newScaleY)
     Node::setScaleY(newScaleY);
 }
 
+bool ParticleSystem::getCullingRect(Rect* /*rect*/) const
+{
+    return false;
+}
+
 void ParticleSystem::start()
 {
     resetSystem();
@@ -439,6 +439,8 @@ public:
     virtual void setRotation(float newRotation) override;
     virtual void setScaleX(float newScaleX) override;
     virtual void setScaleY(float newScaleY) override;
+    // the particles may be anywhere, the system is never culled
+    virtual bool getCullingRect(Rect* rect) const override;
 
     /** Whether or not the particle system is active.
      *
@@ -547,7 +547,7 @@ void ProgressTimer::draw(Renderer *renderer, const Mat4 &transform, uint32_t fla
         return;
 
     _customCommand.init(_globalZOrder, transform, flags);
-    _customCommand.func = CC_CALLBACK_0(ProgressTimer::onDraw, this, transform, flags);
+    _customCommand.func = [this]() { onDraw(_customCommand.getModelView(), _customCommand.getFlags()); };
     renderer->addCommand(&_customCommand);
 }
 
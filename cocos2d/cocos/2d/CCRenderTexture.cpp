@@ -437,7 +437,7 @@ void RenderTexture::beginWithClear(float r, float g, float b, float a, float dep
 
     //clear screen
     _beginWithClearCommand.init(_globalZOrder);
-    _beginWithClearCommand.func = CC_CALLBACK_0(RenderTexture::onClear, this);
+    _beginWithClearCommand.func = [this]() { onClear(); };
     Director::getInstance()->getRenderer()->addCommand(&_beginWithClearCommand);
 }
 
@@ -455,7 +455,7 @@ void RenderTexture::clearDepth(float depthValue)
     this->begin();
 
     _clearDepthCommand.init(_globalZOrder);
-    _clearDepthCommand.func = CC_CALLBACK_0(RenderTexture::onClearDepth, this);
+    _clearDepthCommand.func = [this]() { onClearDepth(); };
 
     Director::getInstance()->getRenderer()->addCommand(&_clearDepthCommand);
 
@@ -779,7 +779,7 @@ void RenderTexture::draw(Renderer *renderer, const Mat4 &transform, uint32_t fla
 
         //clear screen
         _clearCommand.init(_globalZOrder);
-        _clearCommand.func = CC_CALLBACK_0(RenderTexture::onClear, this);
+        _clearCommand.func = [this]() { onClear(); };
         renderer->addCommand(&_clearCommand);
 
         //! make sure all children are drawn
@@ -831,7 +831,7 @@ void RenderTexture::begin()
     renderer->pushGroup(_groupCommand.getRenderQueueID());
 
     _beginCommand.init(_globalZOrder);
-    _beginCommand.func = CC_CALLBACK_0(RenderTexture::onBegin, this);
+    _beginCommand.func = [this]() { onBegin(); };
 
     Director::getInstance()->getRenderer()->addCommand(&_beginCommand);
 }
@@ -839,7 +839,7 @@ void RenderTexture::begin()
 void RenderTexture::end()
 {
     _endCommand.init(_globalZOrder);
-    _endCommand.func = CC_CALLBACK_0(RenderTexture::onEnd, this);
+    _endCommand.func = [this]() { onEnd(); };
 
     Director* director = Director::getInstance();
     CCASSERT(nullptr != director, "Director is null when setting matrix stack");
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "2d/CCScene.h"
 #include "base/CCDirector.h"
 #include "2d/CCCamera.h"
+#include "2d/CCSpatialIndex.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/ccUTF8.h"
@@ -52,6 +53,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 Scene::Scene()
+: _cullingIndex(nullptr)
 {
 #if CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION
     _physics3DWorld = nullptr;
@@ -103,6 +105,8 @@ Scene::~Scene()
 #endif
     Director::getInstance()->getEventDispatcher()->removeEventListener(_event);
     CC_SAFE_RELEASE(_event);
+
+    CC_SAFE_DELETE(_cullingIndex);
     
 #if CC_USE_PHYSICS
     delete _physicsWorld;
@@ -184,6 +188,23 @@ void Scene::onProjectionChanged(EventCustom* /*event*/)
     }
 }
 
+void Scene::setSpatialIndexEnabled(bool enabled, float cellSize)
+{
+    if (enabled)
+    {
+        if (_cullingIndex && _cullingIndex->getCellSize() == cellSize)
+            return;
+
+        // the culling roots register themselves again the next time they are visited
+        CC_SAFE_DELETE(_cullingIndex);
+        _cullingIndex = new (std::nothrow) SpatialIndex(cellSize);
+    }
+    else
+    {
+        CC_SAFE_DELETE(_cullingIndex);
+    }
+}
+
 static bool camera_cmp(const Camera* a, const Camera* b)
 {
     return a->getRenderOrder() < b->getRenderOrder();
@@ -240,6 +261,12 @@ void Scene::render(Renderer* renderer, const Mat4* eyeTransforms, const Mat4* ey
         camera->apply();
         //clear background with max depth
         camera->clearBackground();
+        //cull the indexed subtrees once for this camera
+        if (_cullingIndex)
+        {
+            SpatialIndex::resolveChangedNodes();
+            _cullingIndex->cull(camera);
+        }
         //visit the scene
         visit(renderer, transform, 0);
 #if CC_USE_NAVMESH
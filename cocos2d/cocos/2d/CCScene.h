@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include <string>
 #include "2d/CCNode.h"
+#include "2d/CCSpatialIndex.h"
 
 NS_CC_BEGIN
 
@@ -106,6 +107,20 @@ public:
      */
     const std::vector<BaseLight*>& getLights() const { return _lights; }
 
+    /** Enables or disables the spatial index used to cull the subtrees of culling roots.
+     * Only the nodes flagged with `Node::setSpatialCullingEnabled(true)` are indexed, see SpatialIndex.
+     * @param enabled Whether or not the scene keeps a spatial index. Default is false.
+     * @param cellSize Size in points of one cell of the index grid.
+     * @js NA
+     */
+    void setSpatialIndexEnabled(bool enabled, float cellSize = SpatialIndex::DEFAULT_CELL_SIZE);
+
+    /** Get the spatial index of the scene.
+     * @return The spatial index, or nullptr if it is not enabled.
+     * @js NA
+     */
+    SpatialIndex* getSpatialIndex() const { return _cullingIndex; }
+
     /** Render the scene.
      * @param renderer The renderer use to render the scene.
      * @param eyeTransform The AdditionalTransform of camera.
@@ -160,6 +175,8 @@ protected:
     EventListenerCustom*       _event;
 
     std::vector<BaseLight *> _lights;
+
+    SpatialIndex*        _cullingIndex; // owned, nullptr unless enabled
     
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Scene);
@@ -0,0 +1,397 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "2d/CCNode.h"
+#include "2d/CCCamera.h"
+
+NS_CC_BEGIN
+
+const float SpatialIndex::DEFAULT_CELL_SIZE = 512.0f;
+int SpatialIndex::s_instanceCount = 0;
+std::vector<Node*> SpatialIndex::s_changedNodes;
+unsigned int SpatialIndex::s_resolveStamp = 0;
+
+// entries spanning more cells than this are kept in a separate list
+static const int MAX_CELLS_PER_ENTRY = 64;
+// the bounds of the subtrees drawing anywhere, they are never culled
+static const float UNBOUNDED_EXTENT = 1.0e9f;
+// cell coordinates are clamped to this range, so that huge bounds don't overflow
+static const float MAX_CELL_COORDINATE = 1.0e6f;
+
+// false if a node of the subtree may draw anywhere
+static bool accumulateBounds(const Node* node, const Mat4& transform, Rect& bounds, bool& hasBounds)
+{
+    Rect rect;
+    if (!node->getCullingRect(&rect))
+        return false;
+
+    if (rect.size.width > 0 && rect.size.height > 0)
+    {
+        rect = RectApplyTransform(rect, transform);
+        if (hasBounds)
+        {
+            bounds.merge(rect);
+        }
+        else
+        {
+            bounds = rect;
+            hasBounds = true;
+        }
+    }
+
+    for (const auto& child : node->getChildren())
+    {
+        if (child->isVisible() && !accumulateBounds(child, transform * child->getNodeToParentTransform(), bounds, hasBounds))
+            return false;
+    }
+    return true;
+}
+
+SpatialIndex::SpatialIndex(float cellSize)
+: _cellSize(cellSize > 0 ? cellSize : DEFAULT_CELL_SIZE)
+, _stamp(0)
+, _camera(nullptr)
+, _allVisible(true)
+, _visibleCount(0)
+{
+    ++s_instanceCount;
+}
+
+SpatialIndex::~SpatialIndex()
+{
+    removeAll();
+    --s_instanceCount;
+}
+
+void SpatialIndex::addChangedNode(Node* node)
+{
+    node->_spatialChangedSlot = (int)s_changedNodes.size();
+    s_changedNodes.push_back(node);
+}
+
+void SpatialIndex::removeChangedNode(Node* node)
+{
+    int slot = node->_spatialChangedSlot;
+    s_changedNodes[slot] = s_changedNodes.back();
+    s_changedNodes[slot]->_spatialChangedSlot = slot;
+    s_changedNodes.pop_back();
+    node->_spatialChangedSlot = -1;
+}
+
+void SpatialIndex::resolveChangedNodes()
+{
+    if (s_changedNodes.empty())
+        return;
+
+    // the ancestors shared by several changed nodes are only walked once
+    ++s_resolveStamp;
+    for (auto node : s_changedNodes)
+    {
+        node->_spatialChangedSlot = -1;
+        for (auto ancestor = node; ancestor != nullptr && ancestor->_spatialResolveStamp != s_resolveStamp; ancestor = ancestor->_parent)
+        {
+            ancestor->_spatialResolveStamp = s_resolveStamp;
+            if (ancestor->_spatialCullingEnabled)
+                ancestor->_spatialBoundsDirty = true;
+        }
+    }
+    s_changedNodes.clear();
+}
+
+Rect SpatialIndex::computeSubtreeBounds(const Node* node, const Mat4& worldTransform)
+{
+    Rect bounds;
+    bool hasBounds = false;
+    if (!accumulateBounds(node, worldTransform, bounds, hasBounds))
+    {
+        bounds.setRect(-UNBOUNDED_EXTENT, -UNBOUNDED_EXTENT, 2 * UNBOUNDED_EXTENT, 2 * UNBOUNDED_EXTENT);
+    }
+    else if (!hasBounds)
+    {
+        // nothing to draw yet: keep a point at the node's origin, it will be refreshed when children are added
+        bounds.origin.set(worldTransform.m[12], worldTransform.m[13]);
+    }
+    return bounds;
+}
+
+void SpatialIndex::computeCellRange(const Rect& bounds, int& minX, int& minY, int& maxX, int& maxY) const
+{
+    auto toCell = [this](float coordinate) {
+        return (int)clampf(std::floor(coordinate / _cellSize), -MAX_CELL_COORDINATE, MAX_CELL_COORDINATE);
+    };
+    minX = toCell(bounds.getMinX());
+    minY = toCell(bounds.getMinY());
+    maxX = toCell(bounds.getMaxX());
+    maxY = toCell(bounds.getMaxY());
+}
+
+void SpatialIndex::insertInCells(int slot)
+{
+    auto& entry = _entries[slot];
+    computeCellRange(entry.bounds, entry.minX, entry.minY, entry.maxX, entry.maxY);
+
+    entry.oversized = (long long)(entry.maxX - entry.minX + 1) * (entry.maxY - entry.minY + 1) > MAX_CELLS_PER_ENTRY;
+    if (entry.oversized)
+    {
+        _oversized.push_back(slot);
+        return;
+    }
+
+    for (int x = entry.minX; x <= entry.maxX; ++x)
+    {
+        for (int y = entry.minY; y <= entry.maxY; ++y)
+        {
+            _cells[makeKey(x, y)].push_back(slot);
+        }
+    }
+}
+
+void SpatialIndex::removeFromCells(int slot)
+{
+    const auto& entry = _entries[slot];
+    if (entry.oversized)
+    {
+        auto iter = std::find(_oversized.begin(), _oversized.end(), slot);
+        if (iter != _oversized.end())
+        {
+            *iter = _oversized.back();
+            _oversized.pop_back();
+        }
+        return;
+    }
+
+    for (int x = entry.minX; x <= entry.maxX; ++x)
+    {
+        for (int y = entry.minY; y <= entry.maxY; ++y)
+        {
+            auto cell = _cells.find(makeKey(x, y));
+            if (cell == _cells.end())
+                continue;
+
+            auto& slots = cell->second;
+            auto iter = std::find(slots.begin(), slots.end(), slot);
+            if (iter != slots.end())
+            {
+                *iter = slots.back();
+                slots.pop_back();
+            }
+            if (slots.empty())
+                _cells.erase(cell);
+        }
+    }
+}
+
+void SpatialIndex::update(Node* node, const Rect& worldBounds)
+{
+    CCASSERT(node, "node can't be nullptr");
+
+    int slot = node->_spatialIndexSlot;
+    if (slot < 0)
+    {
+        if (_freeSlots.empty())
+        {
+            slot = (int)_entries.size();
+            _entries.push_back(Entry());
+        }
+        else
+        {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+        }
+
+        auto& entry = _entries[slot];
+        entry.node = node;
+        entry.bounds = worldBounds;
+        // a freshly indexed node is drawn until the next cull had a chance to look at it
+        entry.stamp = _stamp;
+        node->_spatialIndex = this;
+        node->_spatialIndexSlot = slot;
+        insertInCells(slot);
+        return;
+    }
+
+    CCASSERT(node->_spatialIndex == this && _entries[slot].node == node, "node is indexed by another SpatialIndex");
+
+    auto& entry = _entries[slot];
+    int minX, minY, maxX, maxY;
+    computeCellRange(worldBounds, minX, minY, maxX, maxY);
+    entry.bounds = worldBounds;
+    // the bounds changed after this frame's cull, draw it until the next cull decides
+    entry.stamp = _stamp;
+
+    // loose cells: only re-bucket when the node crossed a cell border
+    if (minX != entry.minX || minY != entry.minY || maxX != entry.maxX || maxY != entry.maxY)
+    {
+        removeFromCells(slot);
+        insertInCells(slot);
+    }
+}
+
+void SpatialIndex::remove(Node* node)
+{
+    int slot = node->_spatialIndexSlot;
+    if (slot < 0 || node->_spatialIndex != this)
+        return;
+
+    removeFromCells(slot);
+    _entries[slot].node = nullptr;
+    _freeSlots.push_back(slot);
+
+    node->_spatialIndex = nullptr;
+    node->_spatialIndexSlot = -1;
+}
+
+void SpatialIndex::removeAll()
+{
+    for (auto& entry : _entries)
+    {
+        if (entry.node)
+        {
+            entry.node->_spatialIndex = nullptr;
+            entry.node->_spatialIndexSlot = -1;
+        }
+    }
+    _entries.clear();
+    _freeSlots.clear();
+    _cells.clear();
+    _oversized.clear();
+    _visibleCount = 0;
+}
+
+bool SpatialIndex::computeVisibleRect(const Camera* camera, Rect& visibleRect) const
+{
+    // intersect the edges of the camera's frustum with the z = 0 plane, whatever the viewport the camera draws to
+    const Mat4 inverseViewProjection = camera->getViewProjectionMatrix().getInversed();
+    const Vec2 corners[4] = { Vec2(-1.0f, -1.0f), Vec2(1.0f, -1.0f), Vec2(-1.0f, 1.0f), Vec2(1.0f, 1.0f) };
+
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        Vec4 nearClip = inverseViewProjection * Vec4(corners[i].x, corners[i].y, -1.0f, 1.0f);
+        Vec4 farClip = inverseViewProjection * Vec4(corners[i].x, corners[i].y, 1.0f, 1.0f);
+        if (std::abs(nearClip.w) < FLT_EPSILON || std::abs(farClip.w) < FLT_EPSILON)
+            return false;
+        Vec3 nearPoint(nearClip.x / nearClip.w, nearClip.y / nearClip.w, nearClip.z / nearClip.w);
+        Vec3 farPoint(farClip.x / farClip.w, farClip.y / farClip.w, farClip.z / farClip.w);
+
+        float dz = nearPoint.z - farPoint.z;
+        if (std::abs(dz) < FLT_EPSILON)
+            return false;
+
+        float t = nearPoint.z / dz;
+        if (t < 0.0f || t > 1.0f)
+            return false;
+
+        float x = nearPoint.x + (farPoint.x - nearPoint.x) * t;
+        float y = nearPoint.y + (farPoint.y - nearPoint.y) * t;
+        if (i == 0)
+        {
+            minX = maxX = x;
+            minY = maxY = y;
+        }
+        else
+        {
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+    }
+
+    visibleRect.setRect(minX, minY, maxX - minX, maxY - minY);
+    return true;
+}
+
+void SpatialIndex::cull(const Camera* camera)
+{
+    ++_stamp;
+    _camera = camera;
+    _viewProjection = camera->getViewProjectionMatrix();
+    _visibleCount = 0;
+
+    Rect visibleRect;
+    _allVisible = !computeVisibleRect(camera, visibleRect);
+    if (_allVisible)
+        return;
+
+    auto stampIfVisible = [this, &visibleRect](int slot) {
+        auto& entry = _entries[slot];
+        if (entry.stamp != _stamp && entry.bounds.intersectsRect(visibleRect))
+        {
+            entry.stamp = _stamp;
+            ++_visibleCount;
+        }
+    };
+
+    for (const auto& slot : _oversized)
+        stampIfVisible(slot);
+
+    int minX, minY, maxX, maxY;
+    computeCellRange(visibleRect, minX, minY, maxX, maxY);
+
+    // a far away camera may see more cells than there are occupied ones
+    if ((double)(maxX - minX + 1) * (maxY - minY + 1) > (double)_cells.size())
+    {
+        for (const auto& cell : _cells)
+        {
+            for (const auto& slot : cell.second)
+                stampIfVisible(slot);
+        }
+        return;
+    }
+
+    for (int x = minX; x <= maxX; ++x)
+    {
+        for (int y = minY; y <= maxY; ++y)
+        {
+            auto cell = _cells.find(makeKey(x, y));
+            if (cell == _cells.end())
+                continue;
+
+            for (const auto& slot : cell->second)
+                stampIfVisible(slot);
+        }
+    }
+}
+
+bool SpatialIndex::isVisible(const Node* node, const Mat4& projection) const
+{
+    int slot = node->_spatialIndexSlot;
+    if (_allVisible || slot < 0 || node->_spatialIndex != this)
+        return true;
+
+    // render textures and custom passes visit the scene graph with another projection
+    if (Camera::getVisitingCamera() != _camera || std::memcmp(projection.m, _viewProjection.m, sizeof(projection.m)) != 0)
+        return true;
+
+    return _entries[slot].stamp == _stamp;
+}
+
+NS_CC_END
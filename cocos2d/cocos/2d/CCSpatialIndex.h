@@ -0,0 +1,157 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCSPATIALINDEX_H__
+#define __CCSPATIALINDEX_H__
+
+#include <vector>
+#include <unordered_map>
+
+#include "math/CCGeometry.h"
+#include "math/Mat4.h"
+
+NS_CC_BEGIN
+
+class Node;
+class Camera;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class SpatialIndex
+ * @brief A loose uniform grid of world space bounds used to cull whole subtrees of a Scene.
+ *
+ * Only nodes flagged with `Node::setSpatialCullingEnabled(true)` (culling roots) are indexed.
+ * The bounds of a culling root cover the culling rects (see `Node::getCullingRect()`) of itself and of all its
+ * visible descendants, and are only recomputed when something inside the subtree changed.
+ * Once per camera and frame, `cull()` walks the cells overlapping the camera's visible rect and stamps
+ * the entries it finds. A culling root whose entry was not stamped is skipped by `Node::visit` together
+ * with all its children.
+ *
+ * The index is created and owned by the Scene, see `Scene::setSpatialIndexEnabled()`.
+ */
+class CC_DLL SpatialIndex
+{
+public:
+    /** Default size in points of one grid cell. */
+    static const float DEFAULT_CELL_SIZE;
+
+    /**
+     * @param cellSize Size in points of one grid cell. Should be a few times larger than a typical culling root.
+     */
+    explicit SpatialIndex(float cellSize = DEFAULT_CELL_SIZE);
+    ~SpatialIndex();
+
+    /** Inserts the node or moves it to the given world bounds. */
+    void update(Node* node, const Rect& worldBounds);
+
+    /** Removes the node from the index. Does nothing if the node is not indexed. */
+    void remove(Node* node);
+
+    /** Removes all the nodes from the index. */
+    void removeAll();
+
+    /** Computes the visible rect of the camera on the z = 0 plane and stamps all the entries overlapping it.
+     * Called by the Scene once per camera and frame, before the scene graph is visited.
+     */
+    void cull(const Camera* camera);
+
+    /** Returns whether the node should be visited for the camera that is currently being rendered.
+     * Nodes that are not indexed and nodes rendered with another camera or projection are always visible.
+     */
+    bool isVisible(const Node* node, const Mat4& projection) const;
+
+    /** Returns the number of indexed nodes. */
+    ssize_t getNodeCount() const { return _entries.size() - _freeSlots.size(); }
+
+    /** Returns the number of indexed nodes that were found visible by the last cull. */
+    ssize_t getVisibleNodeCount() const { return _visibleCount; }
+
+    /** Returns the size of one grid cell. */
+    float getCellSize() const { return _cellSize; }
+
+    /** Returns the world space bounds of a node and all its visible descendants, given the node's world transform. */
+    static Rect computeSubtreeBounds(const Node* node, const Mat4& worldTransform);
+
+    /** Returns the number of live SpatialIndex objects. Nodes only track dirty bounds when it's not 0. */
+    static int getInstanceCount() { return s_instanceCount; }
+
+    /** Records a node whose transform, size or children changed. Its ancestors are only walked by resolveChangedNodes(),
+     * so moving many nodes in a frame walks every parent once.
+     */
+    static void addChangedNode(Node* node);
+
+    /** Forgets a changed node, called when it is destroyed. */
+    static void removeChangedNode(Node* node);
+
+    /** Marks dirty the bounds of the culling roots above the nodes changed since the last call.
+     * Called by the Scene once per frame, before the scene graph is visited.
+     */
+    static void resolveChangedNodes();
+
+protected:
+    struct Entry
+    {
+        Node* node;
+        Rect bounds;
+        int minX, minY, maxX, maxY; // covered cells, inclusive
+        unsigned int stamp;
+        bool oversized;
+    };
+
+    typedef long long CellKey;
+
+    CellKey makeKey(int x, int y) const { return ((CellKey)x << 32) | (unsigned int)y; }
+    void insertInCells(int slot);
+    void removeFromCells(int slot);
+    void computeCellRange(const Rect& bounds, int& minX, int& minY, int& maxX, int& maxY) const;
+    bool computeVisibleRect(const Camera* camera, Rect& visibleRect) const;
+
+    float _cellSize;
+    std::vector<Entry> _entries;
+    std::vector<int> _freeSlots;
+    std::unordered_map<CellKey, std::vector<int>> _cells;
+    // entries covering more than MAX_CELLS_PER_ENTRY cells are tested on every cull instead of being bucketed
+    std::vector<int> _oversized;
+
+    // state of the last cull
+    unsigned int _stamp;
+    const Camera* _camera;
+    Mat4 _viewProjection;
+    bool _allVisible; // the visible rect of the last camera could not be computed
+    ssize_t _visibleCount;
+
+    static int s_instanceCount;
+    static std::vector<Node*> s_changedNodes;
+    static unsigned int s_resolveStamp;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCSPATIALINDEX_H__
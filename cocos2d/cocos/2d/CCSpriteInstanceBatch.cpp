@@ -0,0 +1,595 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCSpriteInstanceBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "2d/CCSpriteFrame.h"
+#include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventType.h"
+#include "base/ccUTF8.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCTextureCache.h"
+#include "renderer/ccGLStateCache.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+#define CC_GL_VERTEX_ATTRIB_DIVISOR     glVertexAttribDivisorEXT
+#define CC_GL_DRAW_ELEMENTS_INSTANCED   glDrawElementsInstancedEXT
+#else
+#define CC_GL_VERTEX_ATTRIB_DIVISOR     glVertexAttribDivisorARB
+#define CC_GL_DRAW_ELEMENTS_INSTANCED   glDrawElementsInstancedARB
+#endif
+
+NS_CC_BEGIN
+
+// QuadCommand uses GLushort indices, keep every command well below 65536 / 6 quads
+static const ssize_t MAX_QUADS_PER_COMMAND = 8192;
+
+static const GLuint INSTANCE_ATTRIBS[] = {
+    GLProgram::VERTEX_ATTRIB_COLOR,
+    GLProgram::VERTEX_ATTRIB_TEX_COORD,
+    GLProgram::VERTEX_ATTRIB_TEX_COORD1,
+    GLProgram::VERTEX_ATTRIB_TEX_COORD2,
+};
+
+SpriteInstanceBatch* SpriteInstanceBatch::create(const std::string& fileImage, ssize_t capacity)
+{
+    SpriteInstanceBatch* batch = new (std::nothrow) SpriteInstanceBatch();
+    if (batch && batch->initWithFile(fileImage, capacity))
+    {
+        batch->autorelease();
+        return batch;
+    }
+    CC_SAFE_DELETE(batch);
+    return nullptr;
+}
+
+SpriteInstanceBatch* SpriteInstanceBatch::createWithTexture(Texture2D* texture, ssize_t capacity)
+{
+    SpriteInstanceBatch* batch = new (std::nothrow) SpriteInstanceBatch();
+    if (batch && batch->initWithTexture(texture, capacity))
+    {
+        batch->autorelease();
+        return batch;
+    }
+    CC_SAFE_DELETE(batch);
+    return nullptr;
+}
+
+SpriteInstanceBatch::SpriteInstanceBatch()
+: _texture(nullptr)
+, _blendFunc(BlendFunc::ALPHA_PREMULTIPLIED)
+, _instanceAnchorPoint(Vec2::ANCHOR_MIDDLE)
+, _instancingEnabled(true)
+, _drawingInstanced(false)
+, _dirtyBegin(0)
+, _dirtyEnd(0)
+, _uploadBegin(0)
+, _uploadEnd(0)
+, _bufferCapacity(0)
+, _quadsDirtyBegin(0)
+, _quadsDirtyEnd(0)
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+, _rendererRecreatedListener(nullptr)
+#endif
+{
+    memset(_buffersVBO, 0, sizeof(_buffersVBO));
+}
+
+SpriteInstanceBatch::~SpriteInstanceBatch()
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    if (_rendererRecreatedListener)
+        Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+#endif
+    releaseBuffers();
+    CC_SAFE_RELEASE(_texture);
+}
+
+bool SpriteInstanceBatch::initWithTexture(Texture2D* texture, ssize_t capacity)
+{
+    if (!texture || !Node::init())
+        return false;
+
+    capacity = std::max(capacity, (ssize_t)1);
+    _instances.reserve(capacity);
+    _instanceVertices.reserve(capacity);
+    _indexToId.reserve(capacity);
+    _idToIndex.reserve(capacity);
+
+    setTexture(texture);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // the VBOs are wild handles once the context is lost, forget them and upload everything again on the next draw
+    _rendererRecreatedListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom* /*event*/) {
+        memset(_buffersVBO, 0, sizeof(_buffersVBO));
+        _bufferCapacity = 0;
+        _uploadBegin = 0;
+        _uploadEnd = _instances.size();
+    });
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, -1);
+#endif
+
+    return true;
+}
+
+bool SpriteInstanceBatch::initWithFile(const std::string& fileImage, ssize_t capacity)
+{
+    Texture2D* texture = Director::getInstance()->getTextureCache()->addImage(fileImage);
+    return initWithTexture(texture, capacity);
+}
+
+void SpriteInstanceBatch::setTexture(Texture2D* texture)
+{
+    CCASSERT(texture, "texture can't be nullptr");
+    if (_texture == texture)
+        return;
+
+    CC_SAFE_RETAIN(texture);
+    CC_SAFE_RELEASE(_texture);
+    _texture = texture;
+
+    // used by the quad path, the instanced path has its own program
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, texture));
+    updateBlendFunc();
+    markAllDirty();
+}
+
+void SpriteInstanceBatch::updateBlendFunc()
+{
+    if (!_texture->hasPremultipliedAlpha())
+    {
+        _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    }
+    else
+    {
+        _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    }
+}
+
+int SpriteInstanceBatch::addInstance(const Rect& textureRect, const Vec2& position, float rotation, const Vec2& scale, const Color4B& color)
+{
+    int instanceId;
+    if (_freeIds.empty())
+    {
+        instanceId = (int)_idToIndex.size();
+        _idToIndex.push_back(0);
+    }
+    else
+    {
+        instanceId = _freeIds.back();
+        _freeIds.pop_back();
+    }
+
+    ssize_t index = _instances.size();
+    _idToIndex[instanceId] = (int)index;
+    _indexToId.push_back(instanceId);
+
+    Instance instance;
+    instance.position = position;
+    instance.scale = scale;
+    instance.rotation = rotation;
+    instance.color = color;
+    instance.textureRect = textureRect;
+    _instances.push_back(instance);
+    _instanceVertices.push_back(InstanceVertex());
+
+    markDirty(index);
+    return instanceId;
+}
+
+int SpriteInstanceBatch::addInstance(SpriteFrame* spriteFrame, const Vec2& position, float rotation, const Vec2& scale, const Color4B& color)
+{
+    CCASSERT(spriteFrame, "spriteFrame can't be nullptr");
+    CCASSERT(spriteFrame->getTexture() == _texture, "the sprite frame must use the texture of the batch");
+    CCASSERT(!spriteFrame->isRotated(), "rotated sprite frames are not supported");
+    return addInstance(spriteFrame->getRect(), position, rotation, scale, color);
+}
+
+void SpriteInstanceBatch::removeInstance(int instanceId)
+{
+    CCASSERT(instanceId >= 0 && instanceId < (int)_idToIndex.size() && _idToIndex[instanceId] >= 0, "invalid instance id");
+
+    // move the last instance into the hole
+    ssize_t index = _idToIndex[instanceId];
+    ssize_t last = _instances.size() - 1;
+    if (index != last)
+    {
+        _instances[index] = _instances[last];
+        _instanceVertices[index] = _instanceVertices[last];
+        int movedId = _indexToId[last];
+        _indexToId[index] = movedId;
+        _idToIndex[movedId] = (int)index;
+        markDirty(index);
+    }
+
+    _instances.pop_back();
+    _instanceVertices.pop_back();
+    _indexToId.pop_back();
+    _idToIndex[instanceId] = -1;
+    _freeIds.push_back(instanceId);
+}
+
+void SpriteInstanceBatch::removeAllInstances()
+{
+    _instances.clear();
+    _instanceVertices.clear();
+    _indexToId.clear();
+    _idToIndex.clear();
+    _freeIds.clear();
+    _dirtyBegin = _dirtyEnd = 0;
+    _uploadBegin = _uploadEnd = 0;
+    _quadsDirtyBegin = _quadsDirtyEnd = 0;
+}
+
+SpriteInstanceBatch::Instance& SpriteInstanceBatch::getInstance(int instanceId)
+{
+    CCASSERT(instanceId >= 0 && instanceId < (int)_idToIndex.size() && _idToIndex[instanceId] >= 0, "invalid instance id");
+    return _instances[_idToIndex[instanceId]];
+}
+
+const SpriteInstanceBatch::Instance& SpriteInstanceBatch::getInstance(int instanceId) const
+{
+    CCASSERT(instanceId >= 0 && instanceId < (int)_idToIndex.size() && _idToIndex[instanceId] >= 0, "invalid instance id");
+    return _instances[_idToIndex[instanceId]];
+}
+
+void SpriteInstanceBatch::setInstancePosition(int instanceId, const Vec2& position)
+{
+    getInstance(instanceId).position = position;
+    markDirty(_idToIndex[instanceId]);
+}
+
+const Vec2& SpriteInstanceBatch::getInstancePosition(int instanceId) const
+{
+    return getInstance(instanceId).position;
+}
+
+void SpriteInstanceBatch::setInstanceRotation(int instanceId, float rotation)
+{
+    getInstance(instanceId).rotation = rotation;
+    markDirty(_idToIndex[instanceId]);
+}
+
+float SpriteInstanceBatch::getInstanceRotation(int instanceId) const
+{
+    return getInstance(instanceId).rotation;
+}
+
+void SpriteInstanceBatch::setInstanceScale(int instanceId, const Vec2& scale)
+{
+    getInstance(instanceId).scale = scale;
+    markDirty(_idToIndex[instanceId]);
+}
+
+const Vec2& SpriteInstanceBatch::getInstanceScale(int instanceId) const
+{
+    return getInstance(instanceId).scale;
+}
+
+void SpriteInstanceBatch::setInstanceColor(int instanceId, const Color4B& color)
+{
+    getInstance(instanceId).color = color;
+    markDirty(_idToIndex[instanceId]);
+}
+
+const Color4B& SpriteInstanceBatch::getInstanceColor(int instanceId) const
+{
+    return getInstance(instanceId).color;
+}
+
+void SpriteInstanceBatch::setInstanceTextureRect(int instanceId, const Rect& textureRect)
+{
+    getInstance(instanceId).textureRect = textureRect;
+    markDirty(_idToIndex[instanceId]);
+}
+
+const Rect& SpriteInstanceBatch::getInstanceTextureRect(int instanceId) const
+{
+    return getInstance(instanceId).textureRect;
+}
+
+void SpriteInstanceBatch::setInstanceAnchorPoint(const Vec2& anchorPoint)
+{
+    if (!anchorPoint.equals(_instanceAnchorPoint))
+    {
+        _instanceAnchorPoint = anchorPoint;
+        markAllDirty();
+    }
+}
+
+void SpriteInstanceBatch::updateColor()
+{
+    markAllDirty();
+}
+
+void SpriteInstanceBatch::markDirty(ssize_t index)
+{
+    if (_dirtyBegin == _dirtyEnd)
+    {
+        _dirtyBegin = index;
+        _dirtyEnd = index + 1;
+    }
+    else
+    {
+        _dirtyBegin = std::min(_dirtyBegin, index);
+        _dirtyEnd = std::max(_dirtyEnd, index + 1);
+    }
+}
+
+void SpriteInstanceBatch::markAllDirty()
+{
+    _dirtyBegin = 0;
+    _dirtyEnd = _instances.size();
+}
+
+void SpriteInstanceBatch::updateInstanceVertices()
+{
+    const ssize_t count = _instances.size();
+    ssize_t begin = std::min(_dirtyBegin, count);
+    ssize_t end = std::min(_dirtyEnd, count);
+    _dirtyBegin = _dirtyEnd = 0;
+    if (begin >= end)
+        return;
+
+    const float atlasWidth = (float)_texture->getPixelsWide();
+    const float atlasHeight = (float)_texture->getPixelsHigh();
+    const bool premultiplied = _texture->hasPremultipliedAlpha();
+
+    for (ssize_t i = begin; i < end; ++i)
+    {
+        const Instance& instance = _instances[i];
+        InstanceVertex& vertex = _instanceVertices[i];
+
+        // same conventions as Node: clockwise rotation in degrees, scale applied before the rotation
+        float width = instance.textureRect.size.width * instance.scale.x;
+        float height = instance.textureRect.size.height * instance.scale.y;
+        if (instance.rotation == 0.0f)
+        {
+            vertex.axisX.set(width, 0.0f);
+            vertex.axisY.set(0.0f, height);
+        }
+        else
+        {
+            float radians = -CC_DEGREES_TO_RADIANS(instance.rotation);
+            float c = cosf(radians);
+            float s = sinf(radians);
+            vertex.axisX.set(c * width, s * width);
+            vertex.axisY.set(-s * height, c * height);
+        }
+        vertex.origin.set(instance.position.x - vertex.axisX.x * _instanceAnchorPoint.x - vertex.axisY.x * _instanceAnchorPoint.y,
+                          instance.position.y - vertex.axisX.y * _instanceAnchorPoint.x - vertex.axisY.y * _instanceAnchorPoint.y,
+                          0.0f);
+
+        GLubyte opacity = (GLubyte)(instance.color.a * _displayedOpacity / 255);
+        vertex.color.r = (GLubyte)(instance.color.r * _displayedColor.r / 255);
+        vertex.color.g = (GLubyte)(instance.color.g * _displayedColor.g / 255);
+        vertex.color.b = (GLubyte)(instance.color.b * _displayedColor.b / 255);
+        vertex.color.a = opacity;
+        if (premultiplied)
+        {
+            vertex.color.r = (GLubyte)(vertex.color.r * opacity / 255);
+            vertex.color.g = (GLubyte)(vertex.color.g * opacity / 255);
+            vertex.color.b = (GLubyte)(vertex.color.b * opacity / 255);
+        }
+
+        Rect rect = CC_RECT_POINTS_TO_PIXELS(instance.textureRect);
+        vertex.texCoordsMin.u = rect.origin.x / atlasWidth;
+        vertex.texCoordsMin.v = (rect.origin.y + rect.size.height) / atlasHeight;
+        vertex.texCoordsMax.u = (rect.origin.x + rect.size.width) / atlasWidth;
+        vertex.texCoordsMax.v = rect.origin.y / atlasHeight;
+    }
+
+    // each path consumes its own range, the other one may be picked again in a later frame
+    if (_uploadBegin == _uploadEnd)
+    {
+        _uploadBegin = begin;
+        _uploadEnd = end;
+    }
+    else
+    {
+        _uploadBegin = std::min(_uploadBegin, begin);
+        _uploadEnd = std::max(_uploadEnd, end);
+    }
+
+    if (_quadsDirtyBegin == _quadsDirtyEnd)
+    {
+        _quadsDirtyBegin = begin;
+        _quadsDirtyEnd = end;
+    }
+    else
+    {
+        _quadsDirtyBegin = std::min(_quadsDirtyBegin, begin);
+        _quadsDirtyEnd = std::max(_quadsDirtyEnd, end);
+    }
+}
+
+bool SpriteInstanceBatch::canDrawInstanced() const
+{
+    // ETC1 alpha textures need the ETC1 fragment shader, only the quad path has it
+    return _instancingEnabled
+        && Configuration::getInstance()->supportsInstancedArrays()
+        && _texture->getAlphaTextureName() == 0;
+}
+
+void SpriteInstanceBatch::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    if (_instances.empty())
+        return;
+
+    updateInstanceVertices();
+
+    _drawingInstanced = canDrawInstanced();
+    if (_drawingInstanced)
+    {
+        _customCommand.init(_globalZOrder, transform, flags);
+        _customCommand.func = [this]() { onDrawInstanced(_customCommand.getModelView(), _customCommand.getFlags()); };
+        renderer->addCommand(&_customCommand);
+    }
+    else
+    {
+        drawQuads(renderer, transform, flags);
+    }
+}
+
+void SpriteInstanceBatch::drawQuads(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    // added and moved instances are already part of the dirty range
+    const ssize_t count = _instances.size();
+    _quads.resize(count);
+
+    ssize_t end = std::min(_quadsDirtyEnd, count);
+    for (ssize_t i = _quadsDirtyBegin; i < end; ++i)
+    {
+        const InstanceVertex& vertex = _instanceVertices[i];
+        V3F_C4B_T2F_Quad& quad = _quads[i];
+
+        quad.bl.vertices = vertex.origin;
+        quad.br.vertices.set(vertex.origin.x + vertex.axisX.x, vertex.origin.y + vertex.axisX.y, vertex.origin.z);
+        quad.tl.vertices.set(vertex.origin.x + vertex.axisY.x, vertex.origin.y + vertex.axisY.y, vertex.origin.z);
+        quad.tr.vertices.set(quad.br.vertices.x + vertex.axisY.x, quad.br.vertices.y + vertex.axisY.y, vertex.origin.z);
+
+        quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = vertex.color;
+
+        quad.bl.texCoords = vertex.texCoordsMin;
+        quad.tr.texCoords = vertex.texCoordsMax;
+        quad.tl.texCoords.u = vertex.texCoordsMin.u;
+        quad.tl.texCoords.v = vertex.texCoordsMax.v;
+        quad.br.texCoords.u = vertex.texCoordsMax.u;
+        quad.br.texCoords.v = vertex.texCoordsMin.v;
+    }
+    _quadsDirtyBegin = _quadsDirtyEnd = 0;
+
+    ssize_t commandCount = (count + MAX_QUADS_PER_COMMAND - 1) / MAX_QUADS_PER_COMMAND;
+    if ((ssize_t)_quadCommands.size() < commandCount)
+        _quadCommands.resize(commandCount);
+
+    for (ssize_t i = 0; i < commandCount; ++i)
+    {
+        ssize_t start = i * MAX_QUADS_PER_COMMAND;
+        ssize_t quadCount = std::min(MAX_QUADS_PER_COMMAND, count - start);
+        _quadCommands[i].init(_globalZOrder, _texture, getGLProgramState(), _blendFunc, &_quads[start], quadCount, transform, flags);
+        renderer->addCommand(&_quadCommands[i]);
+    }
+}
+
+void SpriteInstanceBatch::setupBuffers()
+{
+    static const GLfloat corners[] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+    static const GLushort indices[] = { 0, 1, 2, 3, 2, 1 };
+
+    glGenBuffers(3, &_buffersVBO[0]);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    _bufferCapacity = 0;
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void SpriteInstanceBatch::releaseBuffers()
+{
+    if (_buffersVBO[0])
+    {
+        glDeleteBuffers(3, &_buffersVBO[0]);
+        memset(_buffersVBO, 0, sizeof(_buffersVBO));
+    }
+    _bufferCapacity = 0;
+}
+
+void SpriteInstanceBatch::onDrawInstanced(const Mat4& transform, uint32_t /*flags*/)
+{
+    const ssize_t count = _instances.size();
+    if (!_buffersVBO[0])
+        setupBuffers();
+
+    auto glProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED);
+    glProgramState->apply(transform);
+    GL::bindTexture2D(_texture->getName());
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX
+                            | (1 << GLProgram::VERTEX_ATTRIB_TEX_COORD1)
+                            | (1 << GLProgram::VERTEX_ATTRIB_TEX_COORD2));
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[2]);
+    if (count > _bufferCapacity)
+    {
+        // grow like a vector and upload everything
+        _bufferCapacity = std::max(count, std::max(_bufferCapacity * 2, (ssize_t)_instanceVertices.capacity()));
+        glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceVertex) * _bufferCapacity, nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(InstanceVertex) * count, _instanceVertices.data());
+    }
+    else if (_uploadBegin < _uploadEnd)
+    {
+        ssize_t end = std::min(_uploadEnd, count);
+        if (_uploadBegin < end)
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(InstanceVertex) * _uploadBegin, sizeof(InstanceVertex) * (end - _uploadBegin), &_instanceVertices[_uploadBegin]);
+    }
+    _uploadBegin = _uploadEnd = 0;
+
+#define kInstanceSize sizeof(InstanceVertex)
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD1, 4, GL_FLOAT, GL_FALSE, kInstanceSize, (GLvoid*)offsetof(InstanceVertex, axisX));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD2, 3, GL_FLOAT, GL_FALSE, kInstanceSize, (GLvoid*)offsetof(InstanceVertex, origin));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kInstanceSize, (GLvoid*)offsetof(InstanceVertex, color));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 4, GL_FLOAT, GL_FALSE, kInstanceSize, (GLvoid*)offsetof(InstanceVertex, texCoordsMin));
+#undef kInstanceSize
+
+    for (const auto& attrib : INSTANCE_ATTRIBS)
+        CC_GL_VERTEX_ATTRIB_DIVISOR(attrib, 1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    CC_GL_DRAW_ELEMENTS_INSTANCED(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (GLvoid*)0, (GLsizei)count);
+
+    // the divisors are not part of the GL state cache, every other draw expects 0
+    for (const auto& attrib : INSTANCE_ATTRIBS)
+        CC_GL_VERTEX_ATTRIB_DIVISOR(attrib, 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, count * 4);
+    CHECK_GL_ERROR_DEBUG();
+}
+
+std::string SpriteInstanceBatch::getDescription() const
+{
+    return StringUtils::format("<SpriteInstanceBatch | Tag = %d, Instances = %d>", _tag, (int)_instances.size());
+}
+
+NS_CC_END
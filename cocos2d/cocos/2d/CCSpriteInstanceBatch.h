@@ -0,0 +1,231 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCSPRITEINSTANCEBATCH_H__
+#define __CCSPRITEINSTANCEBATCH_H__
+
+#include <vector>
+
+#include "2d/CCNode.h"
+#include "base/CCProtocols.h"
+#include "renderer/CCCustomCommand.h"
+#include "renderer/CCQuadCommand.h"
+
+NS_CC_BEGIN
+
+class Texture2D;
+class SpriteFrame;
+class EventListenerCustom;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class SpriteInstanceBatch
+ * @brief Draws a large number of textured quads sharing one texture, one blend function and one shader.
+ *
+ * An instance is not a Node: it only has a position, a rotation, a scale, a color and a texture rect, and is
+ * addressed by the id returned by `addInstance()`. The instances are drawn in insertion order, in the space of
+ * the batch node.
+ *
+ * When instanced arrays are supported (`Configuration::supportsInstancedArrays()`), the per instance data is kept
+ * in a VBO and only the instances that changed are uploaded again. All the instances are drawn with one
+ * glDrawElementsInstanced() call, so the CPU cost of a frame doesn't depend on the number of static instances.
+ * Otherwise the instances are expanded to quads and drawn with QuadCommands, like SpriteBatchNode does.
+ *
+ * Limitations:
+ * - Rotated sprite frames and ETC1 alpha textures are not supported by the instanced path and fall back to quads.
+ * - The instanced path always uses `GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED`, a custom
+ *   GLProgramState only applies to the quad path.
+ * @since v3.17
+ */
+class CC_DLL SpriteInstanceBatch : public Node, public TextureProtocol
+{
+public:
+    /** Default number of instances allocated up front. */
+    static const int DEFAULT_CAPACITY = 128;
+
+    /** Creates a batch drawing instances of the given image file. */
+    static SpriteInstanceBatch* create(const std::string& fileImage, ssize_t capacity = DEFAULT_CAPACITY);
+
+    /** Creates a batch drawing instances of the given texture. */
+    static SpriteInstanceBatch* createWithTexture(Texture2D* texture, ssize_t capacity = DEFAULT_CAPACITY);
+
+    /** Adds an instance showing the given rect of the texture, in points.
+     *
+     * @return The id of the instance, valid until it is removed.
+     */
+    int addInstance(const Rect& textureRect, const Vec2& position, float rotation = 0.0f, const Vec2& scale = Vec2::ONE, const Color4B& color = Color4B::WHITE);
+
+    /** Adds an instance showing a sprite frame. The frame must use the texture of the batch and must not be rotated. */
+    int addInstance(SpriteFrame* spriteFrame, const Vec2& position, float rotation = 0.0f, const Vec2& scale = Vec2::ONE, const Color4B& color = Color4B::WHITE);
+
+    /** Removes an instance. The last instance takes its place in the draw order. */
+    void removeInstance(int instanceId);
+
+    /** Removes all the instances. */
+    void removeAllInstances();
+
+    /** Returns the number of instances. */
+    ssize_t getInstanceCount() const { return _instances.size(); }
+
+    void setInstancePosition(int instanceId, const Vec2& position);
+    const Vec2& getInstancePosition(int instanceId) const;
+
+    /** Sets the rotation of an instance in degrees, clockwise like `Node::setRotation()`. */
+    void setInstanceRotation(int instanceId, float rotation);
+    float getInstanceRotation(int instanceId) const;
+
+    void setInstanceScale(int instanceId, const Vec2& scale);
+    const Vec2& getInstanceScale(int instanceId) const;
+
+    /** Sets the color of an instance. It is multiplied by the displayed color and opacity of the batch. */
+    void setInstanceColor(int instanceId, const Color4B& color);
+    const Color4B& getInstanceColor(int instanceId) const;
+
+    /** Sets the rect of the texture shown by an instance, in points. */
+    void setInstanceTextureRect(int instanceId, const Rect& textureRect);
+    const Rect& getInstanceTextureRect(int instanceId) const;
+
+    /** Sets the anchor point shared by all the instances, (0.5, 0.5) by default. */
+    void setInstanceAnchorPoint(const Vec2& anchorPoint);
+    const Vec2& getInstanceAnchorPoint() const { return _instanceAnchorPoint; }
+
+    /** Allows or forbids the instanced path. When forbidden or not supported, the instances are drawn as quads. */
+    void setInstancingEnabled(bool enabled) { _instancingEnabled = enabled; }
+    bool isInstancingEnabled() const { return _instancingEnabled; }
+
+    /** Returns whether the last frame was drawn with instancing. */
+    bool isDrawingInstanced() const { return _drawingInstanced; }
+
+    // Overrides
+    virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags) override;
+    virtual Texture2D* getTexture() const override { return _texture; }
+    virtual void setTexture(Texture2D* texture) override;
+    /**
+    * @code
+    * When this function bound into js or lua,the parameter will be changed
+    * In js: var setBlendFunc(var src, var dst)
+    * @endcode
+    * @lua NA
+    */
+    virtual void setBlendFunc(const BlendFunc& blendFunc) override { _blendFunc = blendFunc; }
+    /**
+    * @js NA
+    * @lua NA
+    */
+    virtual const BlendFunc& getBlendFunc() const override { return _blendFunc; }
+    virtual std::string getDescription() const override;
+
+CC_CONSTRUCTOR_ACCESS:
+    SpriteInstanceBatch();
+    virtual ~SpriteInstanceBatch();
+
+    bool initWithTexture(Texture2D* texture, ssize_t capacity);
+    bool initWithFile(const std::string& fileImage, ssize_t capacity);
+
+protected:
+    /** What the user sets on an instance. */
+    struct Instance
+    {
+        Vec2 position;
+        Vec2 scale;
+        float rotation;
+        Color4B color;
+        Rect textureRect;
+    };
+
+    /** What the GPU reads for an instance, matches the attributes of the instanced shader. */
+    struct InstanceVertex
+    {
+        Vec2 axisX;             // a_texCoord1.xy
+        Vec2 axisY;             // a_texCoord1.zw
+        Vec3 origin;            // a_texCoord2
+        Color4B color;          // a_color
+        Tex2F texCoordsMin;     // a_texCoord.xy, bottom left
+        Tex2F texCoordsMax;     // a_texCoord.zw, top right
+    };
+
+    virtual void updateColor() override;
+
+    Instance& getInstance(int instanceId);
+    const Instance& getInstance(int instanceId) const;
+    void markDirty(ssize_t index);
+    void markAllDirty();
+    void updateInstanceVertices();
+    void updateBlendFunc();
+
+    bool canDrawInstanced() const;
+    void drawQuads(Renderer* renderer, const Mat4& transform, uint32_t flags);
+    void onDrawInstanced(const Mat4& transform, uint32_t flags);
+    void setupBuffers();
+    void releaseBuffers();
+
+    Texture2D* _texture;
+    BlendFunc _blendFunc;
+    Vec2 _instanceAnchorPoint;
+    bool _instancingEnabled;
+    bool _drawingInstanced;
+
+    // instances are packed, ids are mapped to their index
+    std::vector<Instance> _instances;
+    std::vector<InstanceVertex> _instanceVertices;
+    std::vector<int> _indexToId;
+    std::vector<int> _idToIndex;
+    std::vector<int> _freeIds;
+
+    // range of _instanceVertices that needs to be computed again, [begin, end)
+    ssize_t _dirtyBegin;
+    ssize_t _dirtyEnd;
+    // range of the instance VBO that needs to be uploaded again, [begin, end)
+    ssize_t _uploadBegin;
+    ssize_t _uploadEnd;
+
+    // instanced path
+    GLuint _buffersVBO[3]; // 0: quad corners, 1: quad indices, 2: instances
+    ssize_t _bufferCapacity;
+    CustomCommand _customCommand;
+
+    // quad path
+    std::vector<V3F_C4B_T2F_Quad> _quads;
+    // range of _quads that needs to be computed again, [begin, end)
+    ssize_t _quadsDirtyBegin;
+    ssize_t _quadsDirtyEnd;
+    std::vector<QuadCommand> _quadCommands;
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(SpriteInstanceBatch);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCSPRITEINSTANCEBATCH_H__
@@ -182,6 +182,57 @@ float tweenTo(float time, TweenType type, float *easingParam)
     return delta;
 }
 
+EaseFunction getEaseFunction(TweenType type)
+{
+    switch (type)
+    {
+        case CUSTOM_EASING: return nullptr;
+        case Linear: return &easeWithoutParam<linear>;
+
+        case Sine_EaseIn: return &easeWithoutParam<sineEaseIn>;
+        case Sine_EaseOut: return &easeWithoutParam<sineEaseOut>;
+        case Sine_EaseInOut: return &easeWithoutParam<sineEaseInOut>;
+
+        case Quad_EaseIn: return &easeWithoutParam<quadEaseIn>;
+        case Quad_EaseOut: return &easeWithoutParam<quadEaseOut>;
+        case Quad_EaseInOut: return &easeWithoutParam<quadEaseInOut>;
+
+        case Cubic_EaseIn: return &easeWithoutParam<cubicEaseIn>;
+        case Cubic_EaseOut: return &easeWithoutParam<cubicEaseOut>;
+        case Cubic_EaseInOut: return &easeWithoutParam<cubicEaseInOut>;
+
+        case Quart_EaseIn: return &easeWithoutParam<quartEaseIn>;
+        case Quart_EaseOut: return &easeWithoutParam<quartEaseOut>;
+        case Quart_EaseInOut: return &easeWithoutParam<quartEaseInOut>;
+
+        case Quint_EaseIn: return &easeWithoutParam<quintEaseIn>;
+        case Quint_EaseOut: return &easeWithoutParam<quintEaseOut>;
+        case Quint_EaseInOut: return &easeWithoutParam<quintEaseInOut>;
+
+        case Expo_EaseIn: return &easeWithoutParam<expoEaseIn>;
+        case Expo_EaseOut: return &easeWithoutParam<expoEaseOut>;
+        case Expo_EaseInOut: return &easeWithoutParam<expoEaseInOut>;
+
+        case Circ_EaseIn: return &easeWithoutParam<circEaseIn>;
+        case Circ_EaseOut: return &easeWithoutParam<circEaseOut>;
+        case Circ_EaseInOut: return &easeWithoutParam<circEaseInOut>;
+
+        case Elastic_EaseIn: return &elasticEaseIn;
+        case Elastic_EaseOut: return &elasticEaseOut;
+        case Elastic_EaseInOut: return &elasticEaseInOut;
+
+        case Back_EaseIn: return &easeWithoutParam<backEaseIn>;
+        case Back_EaseOut: return &easeWithoutParam<backEaseOut>;
+        case Back_EaseInOut: return &easeWithoutParam<backEaseInOut>;
+
+        case Bounce_EaseIn: return &easeWithoutParam<bounceEaseIn>;
+        case Bounce_EaseOut: return &easeWithoutParam<bounceEaseOut>;
+        case Bounce_EaseInOut: return &easeWithoutParam<bounceEaseInOut>;
+
+        default: return &easeWithoutParam<sineEaseInOut>;
+    }
+}
+
 // Linear
 float linear(float time)
 {
@@ -292,6 +292,22 @@ namespace tweenfunc {
      * @param time in seconds.
      */
     float CC_DLL customEase(float time, float *easingParam);
+
+    /** An easing function with one parameter, maps the linear progress of an action to the eased progress.
+     * The parameter is the rate of easeIn/easeOut/easeInOut and the period of the elastic easings,
+     * it is ignored by the other easings.
+     */
+    typedef float (*EaseFunction)(float time, float param);
+
+    /** Adapts an easing function without parameter to the EaseFunction signature. */
+    template <float (*TWEEN_FUNC)(float)>
+    float easeWithoutParam(float time, float /*param*/)
+    {
+        return TWEEN_FUNC(time);
+    }
+
+    /** Returns the EaseFunction of a tween type, or nullptr for CUSTOM_EASING. */
+    EaseFunction CC_DLL getEaseFunction(TweenType type);
 }
 
 NS_CC_END
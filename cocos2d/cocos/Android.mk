@@ -72,8 +72,10 @@ cocos2d.cpp \
 2d/CCProtectedNode.cpp \
 2d/CCRenderTexture.cpp \
 2d/CCScene.cpp \
+2d/CCSpatialIndex.cpp \
 2d/CCSprite.cpp \
 2d/CCSpriteBatchNode.cpp \
+2d/CCSpriteInstanceBatch.cpp \
 2d/CCSpriteFrame.cpp \
 2d/CCSpriteFrameCache.cpp \
 2d/CCTMXLayer.cpp \
@@ -89,8 +91,10 @@ cocos2d.cpp \
 2d/CCAutoPolygon.cpp \
 3d/CCFrustum.cpp \
 3d/CCPlane.cpp \
+platform/CCAssetPack.cpp \
 platform/CCDataManager.cpp \
 platform/CCFileUtils.cpp \
+platform/CCFullPathCache.cpp \
 platform/CCGLView.cpp \
 platform/CCImage.cpp \
 platform/CCSAXParser.cpp \
@@ -108,6 +112,7 @@ math/Vec4.cpp \
 base/CCNinePatchImageParser.cpp \
 base/CCStencilStateManager.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCJobSystem.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
@@ -135,12 +140,17 @@ base/CCEventMouse.cpp \
 base/CCEventTouch.cpp \
 base/CCIMEDispatcher.cpp \
 base/CCNS.cpp \
+base/CCObjectPool.cpp \
+base/CCFrameArena.cpp \
+base/CCFrameProfiler.cpp \
+base/CCFunctionQueue.cpp \
 base/CCProfiling.cpp \
 base/CCProperties.cpp \
 base/CCRef.cpp \
 base/CCScheduler.cpp \
 base/CCScriptSupport.cpp \
 base/CCTouch.cpp \
+base/CCTouchHitGrid.cpp \
 base/CCUserDefault-android.cpp \
 base/CCUserDefault.cpp \
 base/CCValue.cpp \
@@ -187,6 +197,7 @@ renderer/CCVertexAttribBinding.cpp \
 renderer/CCVertexIndexBuffer.cpp \
 renderer/CCVertexIndexData.cpp \
 renderer/ccGLStateCache.cpp \
+renderer/ccPixelConversion.cpp \
 renderer/CCFrameBuffer.cpp \
 renderer/ccShaders.cpp \
 vr/CCVRDistortion.cpp \
@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 
 NS_CC_BEGIN
 
@@ -47,10 +48,45 @@ void AsyncTaskPool::destroyInstance()
 
 AsyncTaskPool::AsyncTaskPool()
 {
+    for (auto& generation : _generations)
+    {
+        generation = std::make_shared<std::atomic<unsigned int>>(0);
+    }
 }
 
 AsyncTaskPool::~AsyncTaskPool()
 {
+    // like the dedicated threads used to, drop the tasks that did not start yet
+    for (auto& generation : _generations)
+    {
+        ++*generation;
+    }
+}
+
+void AsyncTaskPool::stopTasks(TaskType type)
+{
+    ++*_generations[(int)type];
+}
+
+void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, TaskCallBack callback, void* callbackParam, std::function<void()> task)
+{
+    auto generation = _generations[(int)type];
+    unsigned int enqueuedGeneration = generation->load();
+    auto started = std::make_shared<bool>(false);
+
+    JobSystem::getInstance()->schedule([generation, enqueuedGeneration, started, task]() {
+        if (generation->load() == enqueuedGeneration)
+        {
+            *started = true;
+            task();
+        }
+    }, [started, callback, callbackParam]() {
+        // the callback of a task that started is called even if the type was stopped meanwhile
+        if (*started && callback)
+        {
+            callback(callbackParam);
+        }
+    });
 }
 
 NS_CC_END
@@ -38,6 +38,7 @@ THE SOFTWARE.
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <atomic>
 
 /**
 * @addtogroup base
@@ -49,6 +50,8 @@ NS_CC_BEGIN
 /**
  * @class AsyncTaskPool
  * @brief This class allows to perform background operations without having to manipulate threads.
+ * The tasks are run by the JobSystem, tasks of the same type may run in parallel.
+ * New code should use JobSystem directly.
  * @js NA
  */
 class CC_DLL AsyncTaskPool
@@ -78,7 +81,7 @@ public:
     CC_DEPRECATED_ATTRIBUTE static void destoryInstance() { return destroyInstance(); }
     
     /**
-     * Stop tasks.
+     * Stop tasks. The tasks of this type that did not start yet are dropped, and so are their callbacks.
      *
      * @param type Task type you want to stop.
      */
@@ -87,7 +90,7 @@ public:
     /**
      * Enqueue a asynchronous task.
      *
-     * @param type task type is io task, network task or others, each type of task has a thread to deal with it.
+     * @param type task type is io task, network task or others. Only used by stopTasks.
      * @param callback callback when the task is finished. The callback is called in the main thread instead of task thread.
      * @param callbackParam parameter used by the callback.
      * @param task: task can be lambda function to be performed off thread.
@@ -98,7 +101,7 @@ public:
     /**
     * Enqueue a asynchronous task.
     *
-    * @param type task type is io task, network task or others, each type of task has a thread to deal with it.
+    * @param type task type is io task, network task or others. Only used by stopTasks.
     * @param task: task can be lambda function to be performed off thread.
     * @lua NA
     */
@@ -109,120 +112,13 @@ CC_CONSTRUCTOR_ACCESS:
     ~AsyncTaskPool();
     
 protected:
-    
-    // thread tasks internally used
-    class ThreadTasks {
-        struct AsyncTaskCallBack
-        {
-            TaskCallBack          callback;
-            void*                 callbackParam;
-        };
-    public:
-        ThreadTasks()
-        : _stop(false)
-        {
-            _thread = std::thread(
-                                  [this]
-                                  {
-                                      for(;;)
-                                      {
-                                          std::function<void()> task;
-                                          AsyncTaskCallBack callback;
-                                          {
-                                              std::unique_lock<std::mutex> lock(this->_queueMutex);
-                                              this->_condition.wait(lock,
-                                                                    [this]{ return this->_stop || !this->_tasks.empty(); });
-                                              if(this->_stop && this->_tasks.empty())
-                                                  return;
-                                              task = std::move(this->_tasks.front());
-                                              callback = std::move(this->_taskCallBacks.front());
-                                              this->_tasks.pop();
-                                              this->_taskCallBacks.pop();
-                                          }
-                                          
-                                          task();
-                                          Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::bind(callback.callback, callback.callbackParam));
-                                      }
-                                  }
-                                  );
-        }
-        ~ThreadTasks()
-        {
-            {
-                std::unique_lock<std::mutex> lock(_queueMutex);
-                _stop = true;
-                
-                while(_tasks.size())
-                    _tasks.pop();
-                while (_taskCallBacks.size())
-                    _taskCallBacks.pop();
-            }
-            _condition.notify_all();
-            _thread.join();
-        }
-        void clear()
-        {
-            std::unique_lock<std::mutex> lock(_queueMutex);
-            while(_tasks.size())
-                _tasks.pop();
-            while (_taskCallBacks.size())
-                _taskCallBacks.pop();
-        }
-
-        void enqueue(TaskCallBack callback, void* callbackParam, std::function<void()> task)
-        {
-            AsyncTaskCallBack taskCallBack;
-            taskCallBack.callback = std::move(callback);
-            taskCallBack.callbackParam = callbackParam;
-
-            {
-                std::unique_lock<std::mutex> lock(_queueMutex);
-                
-                // don't allow enqueueing after stopping the pool
-                if(_stop)
-                {
-                    CC_ASSERT(0 && "already stop");
-                    return;
-                }
-                
-                _tasks.push(std::move(task));
-                _taskCallBacks.push(std::move(taskCallBack));
-            }
-            _condition.notify_one();
-        }
-    private:
-        
-        // need to keep track of thread so we can join them
-        std::thread _thread;
-        // the task queue
-        std::queue< std::function<void()> > _tasks;
-        std::queue<AsyncTaskCallBack> _taskCallBacks;
-        
-        // synchronization
-        std::mutex _queueMutex;
-        std::condition_variable _condition;
-        bool _stop;
-    };
-    
-    //tasks
-    ThreadTasks _threadTasks[int(TaskType::TASK_MAX_TYPE)];
+    // stopTasks() bumps the generation of a task type, the tasks enqueued before that are skipped.
+    // Shared with the queued jobs, which may outlive the pool.
+    std::shared_ptr<std::atomic<unsigned int>> _generations[int(TaskType::TASK_MAX_TYPE)];
     
     static AsyncTaskPool* s_asyncTaskPool;
 };
 
-inline void AsyncTaskPool::stopTasks(TaskType type)
-{
-    auto& threadTask = _threadTasks[(int)type];
-    threadTask.clear();
-}
-
-inline void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, TaskCallBack callback, void* callbackParam, std::function<void()> task)
-{
-    auto& threadTask = _threadTasks[(int)type];
-    
-    threadTask.enqueue(std::move(callback), callbackParam, std::move(task));
-}
-
 inline void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, std::function<void()> task)
 {
     enqueue(type, [](void*) {}, nullptr, std::move(task));
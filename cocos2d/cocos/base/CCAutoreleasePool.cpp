@@ -26,25 +26,33 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
 
+#include <chrono>
+
 NS_CC_BEGIN
 
 AutoreleasePool::AutoreleasePool()
-: _name("")
+: _firstChunk(nullptr)
+, _lastChunk(nullptr)
+, _spareChunks(nullptr)
+, _spareChunkCount(0)
+, _name("")
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
-    _managedObjectArray.reserve(150);
     PoolManager::getInstance()->push(this);
 }
 
 AutoreleasePool::AutoreleasePool(const std::string &name)
-: _name(name)
+: _firstChunk(nullptr)
+, _lastChunk(nullptr)
+, _spareChunks(nullptr)
+, _spareChunkCount(0)
+, _name(name)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
-    _managedObjectArray.reserve(150);
     PoolManager::getInstance()->push(this);
 }
 
@@ -52,13 +60,52 @@ AutoreleasePool::~AutoreleasePool()
 {
     CCLOGINFO("deallocing AutoreleasePool: %p", this);
     clear();
+
+    // objects autoreleased by the last destructors are released too, like they were when the pool was cleared
+    while (_firstChunk)
+    {
+        clear();
+    }
+
+    while (_spareChunks)
+    {
+        Chunk* next = _spareChunks->next;
+        delete _spareChunks;
+        _spareChunks = next;
+    }
     
     PoolManager::getInstance()->pop();
 }
 
+void AutoreleasePool::appendChunk()
+{
+    Chunk* chunk = _spareChunks;
+    if (chunk)
+    {
+        _spareChunks = chunk->next;
+        --_spareChunkCount;
+    }
+    else
+    {
+        chunk = new Chunk;
+    }
+
+    chunk->next = nullptr;
+    chunk->count = 0;
+    if (_lastChunk)
+        _lastChunk->next = chunk;
+    else
+        _firstChunk = chunk;
+    _lastChunk = chunk;
+}
+
 void AutoreleasePool::addObject(Ref* object)
 {
-    _managedObjectArray.push_back(object);
+    if (!_lastChunk || _lastChunk->count == CHUNK_CAPACITY)
+    {
+        appendChunk();
+    }
+    _lastChunk->objects[_lastChunk->count++] = object;
 }
 
 void AutoreleasePool::clear()
@@ -66,11 +113,29 @@ void AutoreleasePool::clear()
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = true;
 #endif
-    std::vector<Ref*> releasings;
-    releasings.swap(_managedObjectArray);
-    for (const auto &obj : releasings)
+    // objects autoreleased while releasing go to new chunks and stay in the pool until the next clear
+    Chunk* releasings = _firstChunk;
+    _firstChunk = _lastChunk = nullptr;
+
+    while (releasings)
     {
-        obj->release();
+        for (int i = 0, count = releasings->count; i < count; ++i)
+        {
+            releasings->objects[i]->release();
+        }
+
+        Chunk* next = releasings->next;
+        if (_spareChunkCount < MAX_SPARE_CHUNKS)
+        {
+            releasings->next = _spareChunks;
+            _spareChunks = releasings;
+            ++_spareChunkCount;
+        }
+        else
+        {
+            delete releasings;
+        }
+        releasings = next;
     }
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = false;
@@ -79,21 +144,33 @@ void AutoreleasePool::clear()
 
 bool AutoreleasePool::contains(Ref* object) const
 {
-    for (const auto& obj : _managedObjectArray)
+    for (Chunk* chunk = _firstChunk; chunk; chunk = chunk->next)
     {
-        if (obj == object)
-            return true;
+        for (int i = 0; i < chunk->count; ++i)
+        {
+            if (chunk->objects[i] == object)
+                return true;
+        }
     }
     return false;
 }
 
 void AutoreleasePool::dump()
 {
-    CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(_managedObjectArray.size()));
+    int count = 0;
+    for (Chunk* chunk = _firstChunk; chunk; chunk = chunk->next)
+    {
+        count += chunk->count;
+    }
+
+    CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), count);
     CCLOG("%20s%20s%20s", "Object pointer", "Object id", "reference count");
-    for (const auto &obj : _managedObjectArray)
+    for (Chunk* chunk = _firstChunk; chunk; chunk = chunk->next)
     {
-        CCLOG("%20p%20u\n", obj, obj->getReferenceCount());
+        for (int i = 0; i < chunk->count; ++i)
+        {
+            CCLOG("%20p%20u\n", chunk->objects[i], chunk->objects[i]->getReferenceCount());
+        }
     }
 }
 
@@ -124,6 +201,8 @@ void PoolManager::destroyInstance()
 }
 
 PoolManager::PoolManager()
+: _deferredDeletionEnabled(false)
+, _deferredDeletionBudget(0.002f)
 {
     _releasePoolStack.reserve(10);
 }
@@ -131,6 +210,8 @@ PoolManager::PoolManager()
 PoolManager::~PoolManager()
 {
     CCLOGINFO("deallocing PoolManager: %p", this);
+
+    setDeferredDeletionEnabled(false);
     
     while (!_releasePoolStack.empty())
     {
@@ -167,4 +248,62 @@ void PoolManager::pop()
     _releasePoolStack.pop_back();
 }
 
+void PoolManager::setDeferredDeletionEnabled(bool enabled)
+{
+    if (enabled)
+    {
+        _threadId = std::this_thread::get_id();
+        _deferredDeletionEnabled.store(true, std::memory_order_release);
+    }
+    else
+    {
+        _deferredDeletionEnabled.store(false, std::memory_order_release);
+        flushDeferredDeletions();
+    }
+}
+
+bool PoolManager::deferDeletion(Ref* object)
+{
+    if (!_deferredDeletionEnabled.load(std::memory_order_acquire) || std::this_thread::get_id() != _threadId)
+        return false;
+
+    _deferredDeletions.push_back(object);
+    return true;
+}
+
+void PoolManager::processDeferredDeletions()
+{
+    if (_deferredDeletions.empty())
+        return;
+
+    // the clock is only read every few deletions, and each frame makes some progress whatever the budget
+    static const int DELETIONS_PER_CHECK = 16;
+
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::duration<float>(_deferredDeletionBudget);
+    while (!_deferredDeletions.empty())
+    {
+        for (int i = 0; i < DELETIONS_PER_CHECK && !_deferredDeletions.empty(); ++i)
+        {
+            // the destructor may queue more objects
+            Ref* object = _deferredDeletions.back();
+            _deferredDeletions.pop_back();
+            delete object;
+        }
+
+        if (std::chrono::steady_clock::now() - start >= budget)
+            break;
+    }
+}
+
+void PoolManager::flushDeferredDeletions()
+{
+    while (!_deferredDeletions.empty())
+    {
+        Ref* object = _deferredDeletions.back();
+        _deferredDeletions.pop_back();
+        delete object;
+    }
+}
+
 NS_CC_END
@@ -26,8 +26,10 @@ THE SOFTWARE.
 #ifndef __AUTORELEASEPOOL_H__
 #define __AUTORELEASEPOOL_H__
 
+#include <atomic>
 #include <vector>
 #include <string>
+#include <thread>
 #include "base/CCRef.h"
 
 /**
@@ -124,16 +126,34 @@ public:
     void dump();
     
 private:
+    /** Number of objects stored in one chunk, a chunk is about 8 KB on 64-bit platforms. */
+    static const int CHUNK_CAPACITY = 1022;
+    /** Number of emptied chunks kept for reuse, the others are freed. */
+    static const int MAX_SPARE_CHUNKS = 8;
+
+    struct Chunk
+    {
+        Chunk* next;
+        int count;
+        Ref* objects[CHUNK_CAPACITY];
+    };
+
+    void appendChunk();
+
     /**
-     * The underlying array of object managed by the pool.
+     * The objects managed by the pool, stored in a list of fixed size chunks.
+     *
+     * Adding an object never moves the objects already in the pool, and the emptied
+     * chunks are reused by the next frames instead of being freed.
      *
-     * Although Array retains the object once when an object is added, proper
-     * Ref::release() is called outside the array to make sure that the pool
-     * does not affect the managed object's reference count. So an object can
-     * be destructed properly by calling Ref::release() even if the object
-     * is in the pool.
+     * The pool doesn't retain the objects it manages, proper Ref::release() is called
+     * when the pool is cleared. So an object can be destructed properly by calling
+     * Ref::release() even if the object is in the pool.
      */
-    std::vector<Ref*> _managedObjectArray;
+    Chunk* _firstChunk;
+    Chunk* _lastChunk;
+    Chunk* _spareChunks;
+    int _spareChunkCount;
     std::string _name;
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
@@ -168,8 +188,35 @@ public:
 
     bool isObjectInPools(Ref* obj) const;
 
+    /**
+     * Enables or disables deferred deletion, disabled by default.
+     *
+     * When enabled, an object whose reference count drops to 0 on the cocos thread isn't deleted right away:
+     * it is queued, and the queue is drained by `processDeferredDeletions()` at the end of every frame,
+     * for at most the time budget. Objects released by the destructors running then are queued too,
+     * so tearing down a large scene is spread over several frames instead of causing a hitch.
+     * Objects released on other threads are still deleted immediately.
+     *
+     * Must be called on the cocos thread. Disabling it deletes all the queued objects.
+     */
+    void setDeferredDeletionEnabled(bool enabled);
+    bool isDeferredDeletionEnabled() const { return _deferredDeletionEnabled.load(std::memory_order_relaxed); }
+
+    /** Sets the time in seconds `processDeferredDeletions()` may spend every frame, 0.002 by default. */
+    void setDeferredDeletionBudget(float seconds) { _deferredDeletionBudget = seconds; }
+    float getDeferredDeletionBudget() const { return _deferredDeletionBudget; }
+
+    /** Returns the number of objects waiting to be deleted. */
+    ssize_t getDeferredDeletionCount() const { return (ssize_t)_deferredDeletions.size(); }
+
+    /** Deletes queued objects until the queue is empty or the time budget is spent. Called by the Director every frame. */
+    void processDeferredDeletions();
+
+    /** Deletes all the queued objects, including the ones they release. */
+    void flushDeferredDeletions();
 
     friend class AutoreleasePool;
+    friend class Ref;
     
 private:
     PoolManager();
@@ -177,10 +224,19 @@ private:
     
     void push(AutoreleasePool *pool);
     void pop();
+
+    /** Queues the object if deferred deletion applies to it, returns false if it must be deleted now. */
+    bool deferDeletion(Ref* object);
     
     static PoolManager* s_singleInstance;
     
     std::vector<AutoreleasePool*> _releasePoolStack;
+
+    // read by the threads releasing objects
+    std::atomic<bool> _deferredDeletionEnabled;
+    float _deferredDeletionBudget;
+    std::thread::id _threadId;
+    std::vector<Ref*> _deferredDeletions;
 };
 /**
  * @endcond
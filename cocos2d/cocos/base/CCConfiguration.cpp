@@ -26,6 +26,10 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCConfiguration.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "platform/CCFileUtils.h"
 #include "base/CCEventCustom.h"
 #include "base/CCDirector.h"
@@ -35,6 +39,19 @@ NS_CC_BEGIN
 
 extern const char* cocos2dVersion();
 
+// ETC2 is core in OpenGL ES 3.0 without an extension string, the drivers list it with the compressed formats
+static bool isCompressedFormatAvailable(GLenum format)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+    if (count <= 0)
+        return false;
+
+    std::vector<GLint> formats(count);
+    glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    return std::find(formats.begin(), formats.end(), (GLint)format) != formats.end();
+}
+
 Configuration* Configuration::s_sharedConfiguration = nullptr;
 
 const char* Configuration::CONFIG_FILE_LOADED = "config_file_loaded";
@@ -46,10 +63,13 @@ Configuration::Configuration()
 , _supportsETC1(false)
 , _supportsS3TC(false)
 , _supportsATITC(false)
+, _supportsETC2(false)
+, _supportsASTC(false)
 , _supportsNPOT(false)
 , _supportsBGRA8888(false)
 , _supportsDiscardFramebuffer(false)
 , _supportsShareableVAO(false)
+, _supportsInstancedArrays(false)
 , _supportsOESMapBuffer(false)
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
@@ -142,6 +162,13 @@ void Configuration::gatherGPUInfo()
     _supportsPVRTC = checkForGLExtension("GL_IMG_texture_compression_pvrtc");
 	_valueDict["gl.supports_PVRTC"] = Value(_supportsPVRTC);
 
+    _supportsETC2 = checkForGLExtension("GL_ARB_ES3_compatibility")
+        || (isCompressedFormatAvailable(GL_COMPRESSED_RGB8_ETC2) && isCompressedFormatAvailable(GL_COMPRESSED_RGBA8_ETC2_EAC));
+    _valueDict["gl.supports_ETC2"] = Value(_supportsETC2);
+
+    _supportsASTC = checkForGLExtension("GL_KHR_texture_compression_astc_ldr");
+    _valueDict["gl.supports_ASTC"] = Value(_supportsASTC);
+
     _supportsNPOT = true;
 	_valueDict["gl.supports_NPOT"] = Value(_supportsNPOT);
 	
@@ -158,6 +185,17 @@ void Configuration::gatherGPUInfo()
 #endif
     _valueDict["gl.supports_vertex_array_object"] = Value(_supportsShareableVAO);
 
+#ifdef CC_PLATFORM_PC
+    _supportsInstancedArrays = checkForGLExtension("GL_ARB_instanced_arrays");
+#else
+    _supportsInstancedArrays = checkForGLExtension("GL_EXT_instanced_arrays");
+#endif
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+    // the entry points are resolved at runtime, see CCGLViewImpl-android.cpp
+    _supportsInstancedArrays = _supportsInstancedArrays && glVertexAttribDivisorEXTEXT && glDrawElementsInstancedEXTEXT;
+#endif
+    _valueDict["gl.supports_instanced_arrays"] = Value(_supportsInstancedArrays);
+
     _supportsOESMapBuffer = checkForGLExtension("GL_OES_mapbuffer");
     _valueDict["gl.supports_OES_map_buffer"] = Value(_supportsOESMapBuffer);
 
@@ -259,6 +297,16 @@ bool Configuration::supportsATITC() const
     return _supportsATITC;
 }
 
+bool Configuration::supportsETC2() const
+{
+    return _supportsETC2;
+}
+
+bool Configuration::supportsASTC() const
+{
+    return _supportsASTC;
+}
+
 bool Configuration::supportsBGRA8888() const
 {
 	return _supportsBGRA8888;
@@ -295,6 +343,11 @@ bool Configuration::supportsMapBuffer() const
 #endif
 }
 
+bool Configuration::supportsInstancedArrays() const
+{
+    return _supportsInstancedArrays;
+}
+
 bool Configuration::supportsOESDepth24() const
 {
     return _supportsOESDepth24;
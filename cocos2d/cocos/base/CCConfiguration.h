@@ -126,6 +126,20 @@ public:
      * @return Is true if supports ATITC Texture Compressed.
      */
     bool supportsATITC() const;
+
+    /** Whether or not ETC2 Texture Compressed is supported.
+     *
+     * @return Is true if supports ETC2 Texture Compressed.
+     * @since v3.17
+     */
+    bool supportsETC2() const;
+
+    /** Whether or not ASTC (LDR profile) Texture Compressed is supported.
+     *
+     * @return Is true if supports ASTC Texture Compressed.
+     * @since v3.17
+     */
+    bool supportsASTC() const;
     
     /** Whether or not BGRA8888 textures are supported.
      *
@@ -147,6 +161,13 @@ public:
      */
 	bool supportsShareableVAO() const;
 
+    /** Whether or not instanced arrays (glVertexAttribDivisor + glDrawElementsInstanced) are supported.
+     *
+     * @return Is true if supports GL_ARB_instanced_arrays on desktop or GL_EXT_instanced_arrays on mobile.
+     * @since v3.17
+     */
+    bool supportsInstancedArrays() const;
+
     /** Whether or not OES_depth24 is supported.
      *
      * @return Is true if supports OES_depth24.
@@ -263,10 +284,13 @@ protected:
     bool            _supportsETC1;
     bool            _supportsS3TC;
     bool            _supportsATITC;
+    bool            _supportsETC2;
+    bool            _supportsASTC;
     bool            _supportsNPOT;
     bool            _supportsBGRA8888;
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
+    bool            _supportsInstancedArrays;
     bool            _supportsOESMapBuffer;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
@@ -63,6 +63,8 @@
 #include "base/CCScheduler.h"
 #include "platform/CCPlatformConfig.h"
 #include "base/CCConfiguration.h"
+#include "base/CCFrameProfiler.h"
+#include "base/CCObjectPool.h"
 #include "2d/CCScene.h"
 #include "platform/CCFileUtils.h"
 #include "renderer/CCTextureCache.h"
@@ -502,6 +504,8 @@ Console::Console()
     createCommandFileUtils();
     createCommandFps();
     createCommandHelp();
+    createCommandPool();
+    createCommandProfiler();
     createCommandProjection();
     createCommandResolution();
     createCommandSceneGraph();
@@ -1086,6 +1090,28 @@ void Console::createCommandHelp()
     addCommand({"help", "Print this message. Args: [ ]", CC_CALLBACK_2(Console::commandHelp, this)});
 }
 
+void Console::createCommandPool()
+{
+    addCommand({"pool", "Print the usage and fragmentation of the object pool. Args: [-h | help | mark | leaks | ]",
+        CC_CALLBACK_2(Console::commandPool, this)});
+    addSubCommand("pool", {"mark", "Remembers the live objects, [pool leaks] reports the ones allocated after it.",
+        CC_CALLBACK_2(Console::commandPoolSubCommandMark, this)});
+    addSubCommand("pool", {"leaks", "Prints the objects allocated since [pool mark] that are still alive.",
+        CC_CALLBACK_2(Console::commandPoolSubCommandLeaks, this)});
+}
+
+void Console::createCommandProfiler()
+{
+    addCommand({"profiler", "Capture frames with the frame profiler. Args: [-h | help | start | stop | save | ]",
+        CC_CALLBACK_2(Console::commandProfiler, this)});
+    addSubCommand("profiler", {"start", "profiler start [frames]: starts a capture, stopped after the given number of frames if any.",
+        CC_CALLBACK_2(Console::commandProfilerSubCommandStart, this)});
+    addSubCommand("profiler", {"stop", "Stops the capture.",
+        CC_CALLBACK_2(Console::commandProfilerSubCommandStop, this)});
+    addSubCommand("profiler", {"save", "profiler save [filename]: writes the capture as a Chrome trace in the writable path, trace.json by default.",
+        CC_CALLBACK_2(Console::commandProfilerSubCommandSave, this)});
+}
+
 void Console::createCommandProjection()
 {
     addCommand({"projection", "Change or print the current projection. Args: [-h | help | 2d | 3d | ]",
@@ -1110,10 +1136,12 @@ void Console::createCommandSceneGraph()
 
 void Console::createCommandTexture()
 {
-    addCommand({"texture", "Flush or print the TextureCache info. Args: [-h | help | flush | ] ",
+    addCommand({"texture", "Flush or print the TextureCache info. Args: [-h | help | flush | budget [MB] | ] ",
         CC_CALLBACK_2(Console::commandTextures, this)});
     addSubCommand("texture", {"flush", "Purges the dictionary of loaded textures.",
         CC_CALLBACK_2(Console::commandTexturesSubCommandFlush, this)});
+    addSubCommand("texture", {"budget", "Prints the texture memory usage. Args: [MB] sets the budget, 0 removes it.",
+        CC_CALLBACK_2(Console::commandTexturesSubCommandBudget, this)});
 }
 
 void Console::createCommandTouch()
@@ -1244,6 +1272,81 @@ void Console::commandHelp(int fd, const std::string& /*args*/)
     sendHelp(fd, _commands, "\nAvailable commands:\n");
 }
 
+void Console::commandPool(int fd, const std::string& /*args*/)
+{
+    auto info = ObjectPool::getInfo();
+    Console::Utility::mydprintf(fd, "%s", info.c_str());
+}
+
+void Console::commandPoolSubCommandMark(int fd, const std::string& /*args*/)
+{
+    ObjectPool::mark();
+    Console::Utility::mydprintf(fd, "Object pool marked\n");
+}
+
+void Console::commandPoolSubCommandLeaks(int fd, const std::string& /*args*/)
+{
+    auto info = ObjectPool::getLeaksInfo();
+    Console::Utility::mydprintf(fd, "%s", info.c_str());
+}
+
+void Console::commandProfiler(int fd, const std::string& /*args*/)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto profiler = FrameProfiler::getInstance();
+        Console::Utility::mydprintf(fd, "Frame profiler: %s, %u frames captured, %u events dropped\n",
+                                    profiler->isCapturing() ? "capturing" : "stopped",
+                                    profiler->getCapturedFrameCount(), profiler->getDroppedEventCount());
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
+void Console::commandProfilerSubCommandStart(int fd, const std::string& args)
+{
+    auto argv = Console::Utility::split(args, ' ');
+    unsigned int frames = 0;
+    if (argv.size() == 2 && Console::Utility::isFloat(argv[1]))
+    {
+        frames = (unsigned int)utils::atof(argv[1].c_str());
+    }
+    else if (argv.size() > 1)
+    {
+        const char msg[] = "profiler: invalid arguments.\n";
+        Console::Utility::sendToConsole(fd, msg, strlen(msg));
+        return;
+    }
+
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        FrameProfiler::getInstance()->startCapture(frames);
+    });
+}
+
+void Console::commandProfilerSubCommandStop(int /*fd*/, const std::string& /*args*/)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [](){
+        FrameProfiler::getInstance()->stopCapture();
+    });
+}
+
+void Console::commandProfilerSubCommandSave(int fd, const std::string& args)
+{
+    auto argv = Console::Utility::split(args, ' ');
+    std::string filename = argv.size() > 1 ? argv[1] : "trace.json";
+
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        std::string fullPath = FileUtils::getInstance()->getWritablePath() + filename;
+        if (FrameProfiler::getInstance()->saveTrace(fullPath))
+            Console::Utility::mydprintf(fd, "Trace saved to %s\n", fullPath.c_str());
+        else
+            Console::Utility::mydprintf(fd, "profiler: can't write %s\n", fullPath.c_str());
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
 void Console::commandProjection(int fd, const std::string& /*args*/)
 {
     auto director = Director::getInstance();
@@ -1348,6 +1451,44 @@ void Console::commandTexturesSubCommandFlush(int /*fd*/, const std::string& /*ar
     });
 }
 
+void Console::commandTexturesSubCommandBudget(int fd, const std::string& args)
+{
+    // args starts with "budget"
+    auto argv = Console::Utility::split(args, ' ');
+    bool setBudget = false;
+    float megabytes = 0;
+    if (argv.size() == 2)
+    {
+        if (!Console::Utility::isFloat(argv[1]) || (megabytes = utils::atof(argv[1].c_str())) < 0)
+        {
+            Console::Utility::mydprintf(fd, "invalid budget: %s\n", argv[1].c_str());
+            return;
+        }
+        setBudget = true;
+    }
+
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        TextureCache* textureCache = Director::getInstance()->getTextureCache();
+        if (setBudget)
+        {
+            textureCache->setMemoryBudget(static_cast<size_t>(megabytes * 1024 * 1024));
+        }
+
+        TextureCache::MemoryStats stats = textureCache->getMemoryStats();
+        Console::Utility::mydprintf(fd, "budget: %.2f MB%s\nusage: %.2f MB in %u textures, %.2f MB unused\nevicted: %u textures, %u evictions, %u reloads\n",
+            stats.budget / (1024.0f*1024.0f),
+            stats.budget == 0 ? " (none)" : "",
+            stats.usage / (1024.0f*1024.0f),
+            stats.textureCount,
+            stats.unusedUsage / (1024.0f*1024.0f),
+            stats.evictedCount,
+            stats.evictions,
+            stats.reloads);
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
 void Console::commandTouchSubCommandTap(int fd, const std::string& args)
 {
     auto argv = Console::Utility::split(args,' ');
@@ -234,6 +234,8 @@ protected:
     void createCommandFileUtils();
     void createCommandFps();
     void createCommandHelp();
+    void createCommandPool();
+    void createCommandProfiler();
     void createCommandProjection();
     void createCommandResolution();
     void createCommandSceneGraph();
@@ -258,6 +260,13 @@ protected:
     void commandFps(int fd, const std::string& args);
     void commandFpsSubCommandOnOff(int fd, const std::string& args);
     void commandHelp(int fd, const std::string& args);
+    void commandPool(int fd, const std::string& args);
+    void commandPoolSubCommandMark(int fd, const std::string& args);
+    void commandPoolSubCommandLeaks(int fd, const std::string& args);
+    void commandProfiler(int fd, const std::string& args);
+    void commandProfilerSubCommandStart(int fd, const std::string& args);
+    void commandProfilerSubCommandStop(int fd, const std::string& args);
+    void commandProfilerSubCommandSave(int fd, const std::string& args);
     void commandProjection(int fd, const std::string& args);
     void commandProjectionSubCommand2d(int fd, const std::string& args);
     void commandProjectionSubCommand3d(int fd, const std::string& args);
@@ -266,6 +275,7 @@ protected:
     void commandSceneGraph(int fd, const std::string& args);
     void commandTextures(int fd, const std::string& args);
     void commandTexturesSubCommandFlush(int fd, const std::string& args);
+    void commandTexturesSubCommandBudget(int fd, const std::string& args);
     void commandTouchSubCommandTap(int fd, const std::string& args);
     void commandTouchSubCommandSwipe(int fd, const std::string& args);
     void commandUpload(int fd);
@@ -61,6 +61,9 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFrameProfiler.h"
+#include "base/CCFrameArena.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 
@@ -251,6 +254,11 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+    CC_PROFILE_ZONE("Director::drawScene");
+
+    // the temporary memory of the previous frame isn't referenced anymore
+    FrameArena::getInstance()->reset();
+
     // calculate "global" dt
     calculateDeltaTime();
     
@@ -262,11 +270,14 @@ void Director::drawScene()
     //tick before glClear: issue #533
     if (! _paused)
     {
+        CC_PROFILE_ZONE("Director::update");
         _eventDispatcher->dispatchEvent(_eventBeforeUpdate);
         _scheduler->update(_deltaTime);
         _eventDispatcher->dispatchEvent(_eventAfterUpdate);
     }
 
+    FrameProfiler::getInstance()->beginGPUFrame();
+
     _renderer->clear();
     experimental::FrameBuffer::clearAllFBOs();
     
@@ -289,10 +300,14 @@ void Director::drawScene()
 #endif
         //clear draw stats
         _renderer->clearDrawStats();
+        GL::resetElidedCallCount();
         
         //render the scene
         if(_openGLView)
+        {
+            CC_PROFILE_ZONE("Director::renderScene");
             _openGLView->renderScene(_runningScene, _renderer);
+        }
         
         _eventDispatcher->dispatchEvent(_eventAfterVisit);
     }
@@ -314,6 +329,8 @@ void Director::drawScene()
     
     _renderer->render();
 
+    FrameProfiler::getInstance()->endGPUFrame();
+
     _eventDispatcher->dispatchEvent(_eventAfterDraw);
 
     popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
@@ -323,6 +340,7 @@ void Director::drawScene()
     // swap buffers
     if (_openGLView)
     {
+        CC_PROFILE_ZONE("Director::swapBuffers");
         _openGLView->swapBuffers();
     }
 
@@ -458,7 +476,7 @@ void Director::initMatrixStack()
     }
 
     _modelViewMatrixStack.push(Mat4::IDENTITY);
-    std::stack<Mat4> projectionMatrixStack;
+    MatrixStack projectionMatrixStack;
     projectionMatrixStack.push(Mat4::IDENTITY);
     _projectionMatrixStackList.push_back(projectionMatrixStack);
     _textureMatrixStack.push(Mat4::IDENTITY);
@@ -472,7 +490,7 @@ void Director::resetMatrixStack()
 void Director::initProjectionMatrixStack(size_t stackCount)
 {
     _projectionMatrixStackList.clear();
-    std::stack<Mat4> projectionMatrixStack;
+    MatrixStack projectionMatrixStack;
     projectionMatrixStack.push(Mat4::IDENTITY);
     for (size_t i = 0; i < stackCount; ++i)
         _projectionMatrixStackList.push_back(projectionMatrixStack);
@@ -1073,6 +1091,9 @@ void Director::reset()
     CC_SAFE_RELEASE_NULL(_FPSLabel);
     CC_SAFE_RELEASE_NULL(_drawnBatchesLabel);
     CC_SAFE_RELEASE_NULL(_drawnVerticesLabel);
+
+    // the queued objects may still reference the caches purged below
+    PoolManager::getInstance()->flushDeferredDeletions();
     
     // purge bitmap cache
     FontFNT::purgeCachedData();
@@ -1103,6 +1124,8 @@ void Director::reset()
     GLProgramStateCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destroyInstance();
+    JobSystem::destroyInstance();
+    FrameProfiler::destroyInstance();
     
     // cocos2d-x specific data structures
     UserDefault::destroyInstance();
@@ -1253,6 +1276,7 @@ void Director::showStats()
     }
 
     static unsigned long prevCalls = 0;
+    static unsigned long prevElidedCalls = 0;
     static unsigned long prevVerts = 0;
 
     ++_frames;
@@ -1260,29 +1284,32 @@ void Director::showStats()
     
     if (_displayStats && _FPSLabel && _drawnBatchesLabel && _drawnVerticesLabel)
     {
-        char buffer[30] = {0};
+        char buffer[64] = {0};
 
         // Probably we don't need this anymore since
         // the framerate is using a low-pass filter
         // to make the FPS stable
         if (_accumDt > CC_DIRECTOR_STATS_INTERVAL)
         {
-            sprintf(buffer, "%.1f / %.3f", _frames / _accumDt, _secondsPerFrame);
+            snprintf(buffer, sizeof(buffer), "%.1f / %.3f", _frames / _accumDt, _secondsPerFrame);
             _FPSLabel->setString(buffer);
             _accumDt = 0;
             _frames = 0;
         }
 
         auto currentCalls = (unsigned long)_renderer->getDrawnBatches();
+        // the state changes skipped by the GL state cache
+        auto currentElidedCalls = (unsigned long)GL::getElidedCallCount();
         auto currentVerts = (unsigned long)_renderer->getDrawnVertices();
-        if( currentCalls != prevCalls ) {
-            sprintf(buffer, "GL calls:%6lu", currentCalls);
+        if( currentCalls != prevCalls || currentElidedCalls != prevElidedCalls ) {
+            snprintf(buffer, sizeof(buffer), "GL calls:%6lu skip:%6lu", currentCalls, currentElidedCalls);
             _drawnBatchesLabel->setString(buffer);
             prevCalls = currentCalls;
+            prevElidedCalls = currentElidedCalls;
         }
 
         if( currentVerts != prevVerts) {
-            sprintf(buffer, "GL verts:%6lu", currentVerts);
+            snprintf(buffer, sizeof(buffer), "GL verts:%6lu", currentVerts);
             _drawnVerticesLabel->setString(buffer);
             prevVerts = currentVerts;
         }
@@ -1472,10 +1499,21 @@ void Director::mainLoop()
     }
     else if (! _invalid)
     {
+        FrameProfiler::getInstance()->beginFrame();
+
         drawScene();
      
         // release the objects
-        PoolManager::getInstance()->getCurrentPool()->clear();
+        {
+            CC_PROFILE_ZONE("AutoreleasePool::clear");
+            PoolManager::getInstance()->getCurrentPool()->clear();
+        }
+        {
+            CC_PROFILE_ZONE("PoolManager::processDeferredDeletions");
+            PoolManager::getInstance()->processDeferredDeletions();
+        }
+
+        FrameProfiler::getInstance()->endFrame();
     }
 }
 
@@ -616,12 +616,17 @@ protected:
 
     void initMatrixStack();
 
-    std::stack<Mat4> _modelViewMatrixStack;
+    /** Matrix stacks are pushed and popped for every visited node: backed by a vector, whose capacity is kept,
+        rather than by a deque, which allocates and frees a block every time the depth crosses a block boundary.
+     */
+    typedef std::stack<Mat4, std::vector<Mat4>> MatrixStack;
+
+    MatrixStack _modelViewMatrixStack;
     /** In order to support GL MultiView features, we need to use the matrix array,
         but we don't know the number of MultiView, so using the vector instead.
      */
-    std::vector< std::stack<Mat4> > _projectionMatrixStackList;
-    std::stack<Mat4> _textureMatrixStack;
+    std::vector<MatrixStack> _projectionMatrixStackList;
+    MatrixStack _textureMatrixStack;
 
     /** Scheduler associated with this director
      @since v2.0
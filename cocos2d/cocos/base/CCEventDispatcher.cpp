@@ -39,6 +39,8 @@
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
 #include "2d/CCCamera.h"
+#include "base/CCFrameProfiler.h"
+#include "base/CCFrameArena.h"
 
 #define DUMP_LISTENER_ITEM_PRIORITY_INFO 0
 
@@ -202,7 +204,6 @@ void EventDispatcher::EventListenerVector::clear()
 EventDispatcher::EventDispatcher()
 : _inDispatch(0)
 , _isEnabled(false)
-, _nodePriorityIndex(0)
 {
     _toAddedListeners.reserve(50);
     _toRemovedListeners.reserve(50);
@@ -222,73 +223,53 @@ EventDispatcher::~EventDispatcher()
     removeAllEventListeners();
 }
 
-void EventDispatcher::visitTarget(Node* node, bool isRootNode)
+const EventDispatcher::NodeOrder& EventDispatcher::getNodeOrder(Node* node)
 {
-    node->sortAllChildren();
-    
-    int i = 0;
-    auto& children = node->getChildren();
-    
-    auto childrenCount = children.size();
-    
-    if(childrenCount > 0)
-    {
-        Node* child = nullptr;
-        // visit children zOrder < 0
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            
-            if ( child && child->getLocalZOrder() < 0 )
-                visitTarget(child, false);
-            else
-                break;
-        }
-        
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-        
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            if (child)
-                visitTarget(child, false);
-        }
-    }
-    else
-    {
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-    }
-    
-    if (isRootNode)
+    auto iter = _nodeOrderMap.find(node);
+    if (iter != _nodeOrderMap.end())
+        return iter->second;
+
+    auto& order = _nodeOrderMap[node];
+    order.globalZOrder = node->getGlobalZOrder();
+
+    // the siblings are drawn in the order of their local z order and order of arrival, see Node::sortNodes
+    const Node* current = node;
+    for (; current->getParent(); current = current->getParent())
     {
-        std::vector<float> globalZOrders;
-        globalZOrders.reserve(_globalZOrderNodeMap.size());
-        
-        for (const auto& e : _globalZOrderNodeMap)
-        {
-            globalZOrders.push_back(e.first);
-        }
-        
-        std::stable_sort(globalZOrders.begin(), globalZOrders.end(), [](const float a, const float b){
-            return a < b;
-        });
-        
-        for (const auto& globalZ : globalZOrders)
-        {
-            for (const auto& n : _globalZOrderNodeMap[globalZ])
-            {
-                _nodePriorityMap[n] = ++_nodePriorityIndex;
-            }
-        }
-        
-        _globalZOrderNodeMap.clear();
+        order.path.emplace_back(current->getLocalZOrder(), current->_orderOfArrival);
     }
+    std::reverse(order.path.begin(), order.path.end());
+    order.root = current;
+
+    return order;
+}
+
+bool EventDispatcher::isDrawnBefore(const NodeOrder& a, const NodeOrder& b, const Node* scene)
+{
+    // nodes outside of the running scene all share the lowest priority
+    bool aInScene = a.root == scene;
+    bool bInScene = b.root == scene;
+    if (aInScene != bInScene)
+        return bInScene;
+    if (!aInScene)
+        return false;
+
+    if (a.globalZOrder != b.globalZOrder)
+        return a.globalZOrder < b.globalZOrder;
+
+    size_t common = std::min(a.path.size(), b.path.size());
+    for (size_t i = 0; i < common; ++i)
+    {
+        if (a.path[i] != b.path[i])
+            return a.path[i] < b.path[i];
+    }
+
+    // one node is an ancestor of the other: children with a negative local z order are drawn before their parent
+    if (a.path.size() < b.path.size())
+        return b.path[common].first >= 0;
+    if (a.path.size() > b.path.size())
+        return a.path[common].first < 0;
+    return false;
 }
 
 void EventDispatcher::pauseEventListenersForTarget(Node* target, bool recursive/* = false */)
@@ -357,7 +338,7 @@ void EventDispatcher::removeEventListenersForTarget(Node* target, bool recursive
 {
     // Ensure the node is removed from these immediately also.
     // Don't want any dangling pointers or the possibility of dealing with deleted objects..
-    _nodePriorityMap.erase(target);
+    _nodeOrderMap.erase(target);
     _dirtyNodes.erase(target);
 
     auto listenerIter = _nodeListenersMap.find(target);
@@ -436,6 +417,7 @@ void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener*
         if (listeners->empty())
         {
             _nodeListenersMap.erase(found);
+            _nodeOrderMap.erase(node);
             delete listeners;
         }
     }
@@ -552,8 +534,8 @@ void EventDispatcher::debugCheckNodeHasNoEventListenersOnDestruction(Node* node)
         }
     }
     
-    // Check the node priority map
-    for (const auto & keyValuePair : _nodePriorityMap)
+    // Check the node order map
+    for (const auto & keyValuePair : _nodeOrderMap)
     {
         CCASSERT(keyValuePair.first != node,
                  "Node should have no event listeners registered for it upon destruction!");
@@ -802,6 +784,11 @@ void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, c
 }
 
 void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+{
+    dispatchTouchEventToListeners(listeners, onEvent, nullptr);
+}
+
+void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent, const Touch* beganTouch)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -834,15 +821,11 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
         {
             // priority == 0, scene graph priority
             
-            // first, get all enabled, unPaused and registered listeners
-            std::vector<EventListener*> sceneListeners;
-            for (auto& l : *sceneGraphPriorityListeners)
-            {
-                if (l->isEnabled() && !l->isPaused() && l->isRegistered())
-                {
-                    sceneListeners.push_back(l);
-                }
-            }
+            // first, get all enabled, unPaused and registered listeners, unless the hit grid already narrowed them down
+            FrameVector<EventListener*> sceneListeners;
+            bool sceneListenersCollected = false;
+            FrameVector<EventListener*> candidates;
+
             // second, for all camera call all listeners
             // get a copy of cameras, prevent it's been modified in listener callback
             // if camera's depth is greater, process it earlier
@@ -857,12 +840,39 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
                 
                 Camera::_visitingCamera = camera;
                 auto cameraFlag = (unsigned short)camera->getCameraFlag();
-                for (auto& l : sceneListeners)
+
+                const FrameVector<EventListener*>* triedListeners = &sceneListeners;
+                if (beganTouch && _touchHitGrid.query(*sceneGraphPriorityListeners, camera, beganTouch->getLocation(), candidates))
+                {
+                    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](EventListener* l) {
+                        return !l->isEnabled() || l->isPaused() || !l->isRegistered();
+                    }), candidates.end());
+                    triedListeners = &candidates;
+                }
+                else if (!sceneListenersCollected)
+                {
+                    sceneListeners.reserve(sceneGraphPriorityListeners->size());
+                    for (auto& l : *sceneGraphPriorityListeners)
+                    {
+                        if (l->isEnabled() && !l->isPaused() && l->isRegistered())
+                        {
+                            sceneListeners.push_back(l);
+                        }
+                    }
+                    sceneListenersCollected = true;
+                }
+
+                for (auto& l : *triedListeners)
                 {
                     if (nullptr == l->getAssociatedNode() || 0 == (l->getAssociatedNode()->getCameraMask() & cameraFlag))
                     {
                         continue;
                     }
+                    if (beganTouch && static_cast<EventListenerTouchOneByOne*>(l)->isHitTestEnabled()
+                        && !TouchHitGrid::hitTest(static_cast<EventListenerTouchOneByOne*>(l), camera, beganTouch->getLocation()))
+                    {
+                        continue;
+                    }
                     if (onEvent(l))
                     {
                         shouldStopPropagation = true;
@@ -902,6 +912,8 @@ void EventDispatcher::dispatchEvent(Event* event)
 {
     if (!_isEnabled)
         return;
+
+    CC_PROFILE_ZONE("EventDispatcher::dispatchEvent");
     
     updateDirtyFlagForSceneGraph();
     
@@ -1067,8 +1079,9 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
                 return false;
             };
             
-            //
-            dispatchTouchEventToListeners(oneByOneListeners, onTouchEvent);
+            // the lambda captures too much to fit in std::function, a reference to it does
+            dispatchTouchEventToListeners(oneByOneListeners, std::ref(onTouchEvent),
+                                          event->getEventCode() == EventTouch::EventCode::BEGAN ? touches : nullptr);
             if (event->isStopped())
             {
                 return;
@@ -1134,7 +1147,7 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
             return false;
         };
         
-        dispatchTouchEventToListeners(allAtOnceListeners, onTouchesEvent);
+        dispatchTouchEventToListeners(allAtOnceListeners, std::ref(onTouchesEvent));
         if (event->isStopped())
         {
             return;
@@ -1322,22 +1335,35 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     if (sceneGraphListeners == nullptr)
         return;
 
-    // Reset priority index
-    _nodePriorityIndex = 0;
-    _nodePriorityMap.clear();
+    // the hit grid stores positions in the sorted listeners
+    if (listenerID == EventListenerTouchOneByOne::LISTENER_ID)
+    {
+        _touchHitGrid.invalidate();
+    }
+
+    // only the nodes marked dirty since the last sort walk up to the root again, the scene graph isn't visited
+    FrameVector<std::pair<EventListener*, const NodeOrder*>> entries;
+    entries.reserve(sceneGraphListeners->size());
+    for (auto& l : *sceneGraphListeners)
+    {
+        entries.emplace_back(l, &getNodeOrder(l->getAssociatedNode()));
+    }
 
-    visitTarget(rootNode, true);
-    
     // After sort: priority < 0, > 0
-    std::stable_sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [this](const EventListener* l1, const EventListener* l2) {
-        return _nodePriorityMap[l1->getAssociatedNode()] > _nodePriorityMap[l2->getAssociatedNode()];
+    frameStableSort(entries.begin(), entries.end(), [rootNode](const std::pair<EventListener*, const NodeOrder*>& e1, const std::pair<EventListener*, const NodeOrder*>& e2) {
+        return isDrawnBefore(*e2.second, *e1.second, rootNode);
     });
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        (*sceneGraphListeners)[i] = entries[i].first;
+    }
     
 #if DUMP_LISTENER_ITEM_PRIORITY_INFO
     log("-----------------------------------");
-    for (auto& l : *sceneGraphListeners)
+    for (auto& e : entries)
     {
-        log("listener priority: node ([%s]%p), priority (%d)", typeid(*l->_node).name(), l->_node, _nodePriorityMap[l->_node]);
+        log("listener priority: node ([%s]%p), global z (%f), depth (%d)", typeid(*e.first->_node).name(), e.first->_node, e.second->globalZOrder, (int)e.second->path.size());
     }
 #endif
 }
@@ -1354,7 +1380,7 @@ void EventDispatcher::sortEventListenersOfFixedPriority(const EventListener::Lis
         return;
     
     // After sort: priority < 0, > 0
-    std::stable_sort(fixedListeners->begin(), fixedListeners->end(), [](const EventListener* l1, const EventListener* l2) {
+    frameStableSort(fixedListeners->begin(), fixedListeners->end(), [](const EventListener* l1, const EventListener* l2) {
         return l1->getFixedPriority() < l2->getFixedPriority();
     });
     
@@ -1533,6 +1559,7 @@ void EventDispatcher::setDirtyForNode(Node* node)
     if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
     {
         _dirtyNodes.insert(node);
+        _nodeOrderMap.erase(node);
     }
 
     // Also set the dirty flag for node's children
@@ -26,6 +26,7 @@
 #ifndef __CC_EVENT_DISPATCHER_H__
 #define __CC_EVENT_DISPATCHER_H__
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <unordered_map>
@@ -35,6 +36,7 @@
 #include "platform/CCPlatformMacros.h"
 #include "base/CCEventListener.h"
 #include "base/CCEvent.h"
+#include "base/CCTouchHitGrid.h"
 #include "platform/CCStdC.h"
 
 /**
@@ -47,6 +49,7 @@ NS_CC_BEGIN
 class Event;
 class EventTouch;
 class Node;
+class Touch;
 class EventCustom;
 class EventListenerCustom;
 
@@ -294,6 +297,9 @@ protected:
      *  When listener process touch event, can get current camera by Camera::getVisitingCamera().
      */
     void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+
+    /** Same as above, but only tries the listeners with hit testing enabled that `beganTouch` lands on */
+    void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent, const Touch* beganTouch);
     
     void releaseListener(EventListener* listener);
     
@@ -309,8 +315,21 @@ protected:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
     
-    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
-    void visitTarget(Node* node, bool isRootNode);
+    /** Draw order of a node with scene graph priority listeners, cached until the node is marked dirty */
+    struct NodeOrder
+    {
+        /** The topmost ancestor, only nodes of the running scene get a priority */
+        const Node* root;
+        float globalZOrder;
+        /** Local z order and order of arrival of the node and its ancestors, the child of the root first */
+        std::vector<std::pair<std::int32_t, std::uint32_t>> path;
+    };
+
+    /** Gets the cached draw order of a node, computes it by walking up to the root if the node is dirty */
+    const NodeOrder& getNodeOrder(Node* node);
+
+    /** Whether a is drawn before b, i.e. gets a lower scene graph priority */
+    static bool isDrawnBefore(const NodeOrder& a, const NodeOrder& b, const Node* scene);
 
     /** Remove all listeners in _toRemoveListeners list and cleanup */
     void cleanToRemovedListeners();
@@ -324,11 +343,11 @@ protected:
     /** The map of node and event listeners */
     std::unordered_map<Node*, std::vector<EventListener*>*> _nodeListenersMap;
     
-    /** The map of node and its event priority */
-    std::unordered_map<Node*, int> _nodePriorityMap;
-    
-    /** key: Global Z Order, value: Sorted Nodes */
-    std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
+    /** Broadphase of the one by one touch listeners with hit testing enabled */
+    TouchHitGrid _touchHitGrid;
+
+    /** The draw order of the nodes associated with scene graph priority listeners */
+    std::unordered_map<Node*, NodeOrder> _nodeOrderMap;
     
     /** The listeners to be added after dispatching event */
     std::vector<EventListener*> _toAddedListeners;
@@ -345,8 +364,6 @@ protected:
     /** Whether to enable dispatching event */
     bool _isEnabled;
     
-    int _nodePriorityIndex;
-    
     std::set<std::string> _internalCustomListenerIDs;
 };
 
@@ -33,6 +33,7 @@
 NS_CC_BEGIN
 
 const std::string EventListenerTouchOneByOne::LISTENER_ID = "__cc_touch_one_by_one";
+unsigned int EventListenerTouchOneByOne::s_hitTestVersion = 0;
 
 EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 : onTouchBegan(nullptr)
@@ -40,6 +41,7 @@ EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 , onTouchEnded(nullptr)
 , onTouchCancelled(nullptr)
 , _needSwallow(false)
+, _hitTestEnabled(false)
 {
 }
 
@@ -68,6 +70,24 @@ bool EventListenerTouchOneByOne::isSwallowTouches()
     return _needSwallow;
 }
 
+void EventListenerTouchOneByOne::setHitTestEnabled(bool enabled)
+{
+    if (_hitTestEnabled != enabled)
+    {
+        _hitTestEnabled = enabled;
+        ++s_hitTestVersion;
+    }
+}
+
+void EventListenerTouchOneByOne::setHitTestRect(const Rect& rect)
+{
+    if (!rect.equals(_hitTestRect))
+    {
+        _hitTestRect = rect;
+        ++s_hitTestVersion;
+    }
+}
+
 EventListenerTouchOneByOne* EventListenerTouchOneByOne::create()
 {
     auto ret = new (std::nothrow) EventListenerTouchOneByOne();
@@ -109,6 +129,8 @@ EventListenerTouchOneByOne* EventListenerTouchOneByOne::clone()
         
         ret->_claimedTouches = _claimedTouches;
         ret->_needSwallow = _needSwallow;
+        ret->_hitTestEnabled = _hitTestEnabled;
+        ret->_hitTestRect = _hitTestRect;
     }
     else
     {
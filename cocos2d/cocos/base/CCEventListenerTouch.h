@@ -28,6 +28,7 @@
 #define __cocos2d_libs__CCTouchEventListener__
 
 #include "base/CCEventListener.h"
+#include "math/CCGeometry.h"
 #include <vector>
 
 /**
@@ -68,6 +69,28 @@ public:
      * @return True if needs to swall touches.
      */
     bool isSwallowTouches();
+
+    /** Lets the EventDispatcher skip onTouchBegan when the touch misses the associated node.
+     * The touch is tested against the hit test rect through the camera dispatching it, like ui::Widget::hitTest() does,
+     * so onTouchBegan doesn't need its own convertToNodeSpace and rect test.
+     * With many such listeners in a scene, the dispatcher only tries the candidates found in a screen space grid of their bounds.
+     * The grid is kept across frames and rebuilt by the next touch once a node with hit testing, or one of its ancestors, moved
+     * when the scene was visited. Until the next visit, a node moved by a touch callback is only found near where it was drawn,
+     * a touch at its new position misses it.
+     *
+     * @param enabled True to hit test the touches before onTouchBegan. Only used by listeners with scene graph priority.
+     */
+    void setHitTestEnabled(bool enabled);
+    /** Whether the touches are hit tested before onTouchBegan. */
+    bool isHitTestEnabled() const { return _hitTestEnabled; }
+
+    /** Sets the hit test area, in the coordinate space of the associated node.
+     *
+     * @param rect The area to test, an empty rect (default) uses the content size of the node.
+     */
+    void setHitTestRect(const Rect& rect);
+    /** Gets the hit test area set by setHitTestRect(). */
+    const Rect& getHitTestRect() const { return _hitTestRect; }
     
     /// Overrides
     virtual EventListenerTouchOneByOne* clone() override;
@@ -91,8 +114,14 @@ CC_CONSTRUCTOR_ACCESS:
 private:
     std::vector<Touch*> _claimedTouches;
     bool _needSwallow;
+    bool _hitTestEnabled;
+    Rect _hitTestRect;
+
+    // bumped when a hit test setting changes, the touch hit grid is rebuilt on the next touch
+    static unsigned int s_hitTestVersion;
     
     friend class EventDispatcher;
+    friend class TouchHitGrid;
 };
 
 /** @class EventListenerTouchAllAtOnce
@@ -0,0 +1,177 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFrameArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include "base/ccMacros.h"
+#include "base/allocator/CCAllocatorDiagnostics.h"
+
+NS_CC_BEGIN
+
+FrameArena* FrameArena::getInstance()
+{
+    static thread_local FrameArena t_arena;
+    return &t_arena;
+}
+
+FrameArena::FrameArena()
+: _chunks(nullptr)
+, _chunkCount(0)
+, _capacity(0)
+, _used(0)
+, _frameHighWater(0)
+, _lastFrameHighWater(0)
+, _peakHighWater(0)
+, _frames(0)
+{
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+    static std::atomic<int> s_arenaCount(0);
+    char tag[32];
+    snprintf(tag, sizeof(tag), "FrameArena #%d", ++s_arenaCount);
+    AllocatorBase::setTag(tag);
+    allocator::AllocatorDiagnostics::instance()->trackAllocator(this);
+#endif
+}
+
+FrameArena::~FrameArena()
+{
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+    allocator::AllocatorDiagnostics::instance()->untrackAllocator(this);
+#endif
+    releaseChunks();
+}
+
+FrameArena::Chunk* FrameArena::allocateChunk(size_t capacity)
+{
+    // use malloc directly, the arena must not recurse into an overridden global new
+    Chunk* chunk = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + capacity));
+    if (!chunk)
+        return nullptr;
+
+    chunk->next = _chunks;
+    chunk->capacity = capacity;
+    chunk->offset = 0;
+    _chunks = chunk;
+    ++_chunkCount;
+    _capacity += capacity;
+    return chunk;
+}
+
+void FrameArena::releaseChunks()
+{
+    while (_chunks)
+    {
+        Chunk* next = _chunks->next;
+        std::free(_chunks);
+        _chunks = next;
+    }
+    _chunkCount = 0;
+    _capacity = 0;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    CCASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+    if (size == 0)
+        size = 1;
+
+    Chunk* chunk = _chunks;
+    char* start = chunk ? chunkData(chunk) + chunk->offset : nullptr;
+    char* address = chunk ? (char*)aligned(start, alignment) : nullptr;
+    if (!chunk || address + size > chunkData(chunk) + chunk->capacity)
+    {
+        // the rest of the current chunk is wasted until the next reset merges the chunks
+        size_t capacity = std::max(chunk ? chunk->capacity * 2 : (size_t)DEFAULT_CHUNK_SIZE, size + alignment);
+        chunk = allocateChunk(capacity);
+        if (!chunk)
+        {
+            CCLOGERROR("FrameArena: failed to allocate a chunk of %d bytes", (int)capacity);
+            return nullptr;
+        }
+        start = chunkData(chunk);
+        address = (char*)aligned(start, alignment);
+    }
+
+    size_t consumed = (address + size) - start;
+    chunk->offset += consumed;
+    _used += consumed;
+    _frameHighWater = std::max(_frameHighWater, _used);
+    return address;
+}
+
+void FrameArena::deallocate(void* address, size_t size)
+{
+    if (!address || !_chunks)
+        return;
+
+    // only the latest allocation can be given back, the alignment padding in front of it stays used
+    if (size == 0)
+        size = 1;
+    if (static_cast<char*>(address) + size == chunkData(_chunks) + _chunks->offset)
+    {
+        _chunks->offset -= size;
+        _used -= size;
+    }
+}
+
+void FrameArena::reset()
+{
+    size_t highWater = _frameHighWater;
+    _lastFrameHighWater.store(highWater, std::memory_order_relaxed);
+    if (highWater > _peakHighWater.load(std::memory_order_relaxed))
+        _peakHighWater.store(highWater, std::memory_order_relaxed);
+    _frames.fetch_add(1, std::memory_order_relaxed);
+
+    if (_chunkCount > 1)
+    {
+        // the frame didn't fit in one chunk: replace them with a single one big enough for all of them
+        size_t capacity = _capacity;
+        releaseChunks();
+        allocateChunk(capacity);
+    }
+    else if (_chunks)
+    {
+        _chunks->offset = 0;
+    }
+
+    _used = 0;
+    _frameHighWater = 0;
+}
+
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+std::string FrameArena::diagnostics() const
+{
+    std::stringstream s;
+    s << AllocatorBase::tag() << " frames:" << _frames.load(std::memory_order_relaxed)
+      << " last frame:" << getLastFrameHighWater() << " peak frame:" << getPeakHighWater() << "\n";
+    return s.str();
+}
+#endif
+
+NS_CC_END
@@ -0,0 +1,253 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __BASE_CCFRAMEARENA_H__
+#define __BASE_CCFRAMEARENA_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/allocator/CCAllocatorBase.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @class FrameArena
+ * @brief Linear allocator for temporary memory that only has to live until the end of the current frame.
+ *
+ * Every thread owns its own arena, returned by `getInstance()`, so allocating never takes a lock.
+ * An allocation bumps an offset in a chunk; freeing is a no-op, except for the most recent allocation
+ * which is given back so short lived containers don't accumulate. All the memory is reclaimed at once
+ * by `reset()`. The arena of the main thread is reset by `Director::drawScene()` at the start of every
+ * frame, the arenas of the JobSystem workers once every job finished. Any other thread using its arena
+ * must reset it itself when the memory it took is no longer used: its arena is never reset otherwise,
+ * and grows with every allocation that isn't the latest one given back.
+ *
+ * The chunks are kept across resets. When a frame needed more than one chunk, they are merged into a single
+ * chunk of the same total size, so the arena quickly settles on the size the game actually needs.
+ *
+ * Memory coming from the arena must not be used after the next reset and must not be handed to another thread.
+ * Use `FrameArenaAllocator` to put STL containers in the arena.
+ * When CC_ENABLE_ALLOCATOR_DIAGNOSTICS is enabled, the arenas report their high-water marks to `AllocatorDiagnostics`.
+ * @since v3.17
+ */
+class CC_DLL FrameArena : public allocator::AllocatorBase
+{
+public:
+    /** Size in bytes of the first chunk allocated by an arena. */
+    static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    /** Returns the arena of the calling thread. */
+    static FrameArena* getInstance();
+
+    FrameArena();
+    virtual ~FrameArena();
+
+    /** Returns `size` bytes aligned to `alignment`, which must be a power of two, or nullptr when the system is out of memory. */
+    void* allocate(size_t size, size_t alignment = kDefaultAlignment);
+
+    /** Gives the memory back if it is the latest allocation, does nothing otherwise. */
+    void deallocate(void* address, size_t size);
+
+    /** Reclaims all the memory allocated since the last reset and records the high-water mark of the frame. */
+    void reset();
+
+    /** Returns the number of bytes currently allocated from the arena. */
+    size_t getUsedSize() const { return _used; }
+
+    /** Returns the number of bytes held by the chunks of the arena. */
+    size_t getCapacity() const { return _capacity; }
+
+    /** Returns the highest number of bytes allocated at once between the last two resets. */
+    size_t getLastFrameHighWater() const { return _lastFrameHighWater.load(std::memory_order_relaxed); }
+
+    /** Returns the highest number of bytes allocated at once during any frame. */
+    size_t getPeakHighWater() const { return _peakHighWater.load(std::memory_order_relaxed); }
+
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+    virtual std::string diagnostics() const override;
+#endif
+
+protected:
+    struct Chunk
+    {
+        Chunk* next;
+        size_t capacity;
+        size_t offset;
+    };
+
+    Chunk* allocateChunk(size_t capacity);
+    void releaseChunks();
+    char* chunkData(Chunk* chunk) const { return reinterpret_cast<char*>(chunk) + sizeof(Chunk); }
+
+    // the current chunk is at the head, older chunks of the frame follow it
+    Chunk* _chunks;
+    size_t _chunkCount;
+    size_t _capacity;
+    size_t _used;
+    size_t _frameHighWater;
+    std::atomic<size_t> _lastFrameHighWater;
+    std::atomic<size_t> _peakHighWater;
+    std::atomic<unsigned int> _frames;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(FrameArena);
+};
+
+/** @class FrameArenaAllocator
+ * @brief STL compatible allocator taking its memory from a FrameArena.
+ *
+ * A container using it must be destroyed before the arena is reset, and must stay on the thread that created it.
+ * @code
+ * FrameVector<Node*> visible;  // same as std::vector<Node*, FrameArenaAllocator<Node*>>
+ * visible.reserve(count);
+ * @endcode
+ * @since v3.17
+ */
+template <typename T>
+class FrameArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind { typedef FrameArenaAllocator<U> other; };
+
+    /** Allocates from the arena of the calling thread. */
+    FrameArenaAllocator() : _arena(FrameArena::getInstance()) {}
+    explicit FrameArenaAllocator(FrameArena* arena) : _arena(arena) {}
+    template <typename U>
+    FrameArenaAllocator(const FrameArenaAllocator<U>& other) : _arena(other.getArena()) {}
+
+    T* allocate(size_type n, const void* /*hint*/ = nullptr)
+    {
+        size_t alignment = alignof(T) > (size_t)FrameArena::kDefaultAlignment ? alignof(T) : (size_t)FrameArena::kDefaultAlignment;
+        void* address = _arena->allocate(n * sizeof(T), alignment);
+        // the containers expect the allocators to throw rather than to return nullptr
+        if (address == nullptr)
+            throw std::bad_alloc();
+        return static_cast<T*>(address);
+    }
+
+    void deallocate(T* p, size_type n) { _arena->deallocate(p, n * sizeof(T)); }
+
+    size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) { new ((void*)p) U(std::forward<Args>(args)...); }
+
+    template <typename U>
+    void destroy(U* p) { p->~U(); }
+
+    FrameArena* getArena() const { return _arena; }
+
+private:
+    FrameArena* _arena;
+};
+
+template <typename T, typename U>
+inline bool operator==(const FrameArenaAllocator<T>& a, const FrameArenaAllocator<U>& b) { return a.getArena() == b.getArena(); }
+
+template <typename T, typename U>
+inline bool operator!=(const FrameArenaAllocator<T>& a, const FrameArenaAllocator<U>& b) { return a.getArena() != b.getArena(); }
+
+/** A std::vector whose storage comes from the FrameArena of the calling thread. */
+template <typename T>
+using FrameVector = std::vector<T, FrameArenaAllocator<T>>;
+
+/** Same as std::stable_sort, but the buffer of the merges comes from the FrameArena of the calling thread
+ * instead of the heap, for the sorts done every frame.
+ */
+template <typename RandomIt, typename Compare>
+void frameStableSort(RandomIt first, RandomIt last, Compare comp)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    const ptrdiff_t count = last - first;
+    const ptrdiff_t RUN_LENGTH = 32;
+
+    // short runs sorted by insertion
+    for (ptrdiff_t start = 0; start < count; start += RUN_LENGTH)
+    {
+        RandomIt runBegin = first + start;
+        RandomIt runEnd = first + std::min(start + RUN_LENGTH, count);
+        for (RandomIt it = runBegin + 1; it < runEnd; ++it)
+        {
+            T value = std::move(*it);
+            RandomIt hole = it;
+            for (; hole > runBegin && comp(value, *(hole - 1)); --hole)
+                *hole = std::move(*(hole - 1));
+            *hole = std::move(value);
+        }
+    }
+    if (count <= RUN_LENGTH)
+        return;
+
+    // merged back and forth between the range and the buffer, std::merge takes the left element first when equal
+    FrameVector<T> buffer(count);
+    bool inBuffer = false;
+    for (ptrdiff_t width = RUN_LENGTH; width < count; width *= 2)
+    {
+        for (ptrdiff_t left = 0; left < count; left += 2 * width)
+        {
+            ptrdiff_t middle = std::min(left + width, count);
+            ptrdiff_t right = std::min(left + 2 * width, count);
+            if (inBuffer)
+                std::merge(std::make_move_iterator(buffer.begin() + left), std::make_move_iterator(buffer.begin() + middle),
+                           std::make_move_iterator(buffer.begin() + middle), std::make_move_iterator(buffer.begin() + right),
+                           first + left, comp);
+            else
+                std::merge(std::make_move_iterator(first + left), std::make_move_iterator(first + middle),
+                           std::make_move_iterator(first + middle), std::make_move_iterator(first + right),
+                           buffer.begin() + left, comp);
+        }
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer)
+        std::move(buffer.begin(), buffer.end(), first);
+}
+
+// end of base group
+/// @}
+
+NS_CC_END
+
+#endif // __BASE_CCFRAMEARENA_H__
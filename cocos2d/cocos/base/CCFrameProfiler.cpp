@@ -0,0 +1,539 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCFrameProfiler.h"
+
+#include <cstdio>
+
+#include "base/CCConfiguration.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCGL.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+#include <EGL/egl.h>
+#endif
+
+NS_CC_BEGIN
+
+// number of frames the GPU may lag behind before a frame is not timed
+static const unsigned int GPU_QUERY_COUNT = 4;
+
+static const FrameProfiler::Zone s_frameZone = { "Frame", "frame" };
+static const FrameProfiler::Zone s_gpuFrameZone = { "GPU Frame", "gpu" };
+
+std::atomic<bool> FrameProfiler::s_capturing(false);
+std::atomic<unsigned int> FrameProfiler::s_epoch(0);
+
+// read by the recording threads, destroyInstance() waits for the ones that may still use it
+static std::atomic<FrameProfiler*> s_sharedFrameProfiler(nullptr);
+static std::atomic<int> s_recordingThreads(0);
+static int s_instanceCounter = 0;
+
+// GL timer queries: core / ARB on GLEW platforms, EXT_timer_query on mac,
+// EXT_disjoint_timer_query resolved at runtime on android, nothing on iOS
+namespace
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+
+    PFNGLGENQUERIESEXTPROC s_glGenQueries = nullptr;
+    PFNGLDELETEQUERIESEXTPROC s_glDeleteQueries = nullptr;
+    PFNGLBEGINQUERYEXTPROC s_glBeginQuery = nullptr;
+    PFNGLENDQUERYEXTPROC s_glEndQuery = nullptr;
+    PFNGLGETQUERYOBJECTUIVEXTPROC s_glGetQueryObjectuiv = nullptr;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC s_glGetQueryObjectui64v = nullptr;
+
+    bool loadTimerQueries()
+    {
+        if (!Configuration::getInstance()->checkForGLExtension("GL_EXT_disjoint_timer_query"))
+            return false;
+
+        s_glGenQueries = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+        s_glDeleteQueries = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+        s_glBeginQuery = (PFNGLBEGINQUERYEXTPROC)eglGetProcAddress("glBeginQueryEXT");
+        s_glEndQuery = (PFNGLENDQUERYEXTPROC)eglGetProcAddress("glEndQueryEXT");
+        s_glGetQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+        s_glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+        return s_glGenQueries && s_glDeleteQueries && s_glBeginQuery && s_glEndQuery && s_glGetQueryObjectuiv && s_glGetQueryObjectui64v;
+    }
+
+    void genQuery(GLuint* query) { s_glGenQueries(1, query); }
+    void deleteQuery(GLuint* query) { s_glDeleteQueries(1, query); }
+    void beginQuery(GLuint query) { s_glBeginQuery(GL_TIME_ELAPSED_EXT, query); }
+    void endQuery() { s_glEndQuery(GL_TIME_ELAPSED_EXT); }
+    bool isQueryAvailable(GLuint query)
+    {
+        GLuint available = 0;
+        s_glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        return available != 0;
+    }
+    uint64_t getQueryResult(GLuint query)
+    {
+        GLuint64 result = 0;
+        s_glGetQueryObjectui64v(query, GL_QUERY_RESULT_EXT, &result);
+        return result;
+    }
+    bool isDisjoint()
+    {
+        // the results are meaningless if the GPU changed its clock or was preempted
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        return disjoint != 0;
+    }
+
+#elif defined(CC_PLATFORM_PC)
+
+    bool loadTimerQueries()
+    {
+        auto configuration = Configuration::getInstance();
+        return configuration->checkForGLExtension("GL_ARB_timer_query") || configuration->checkForGLExtension("GL_EXT_timer_query");
+    }
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_MAC
+    const GLenum TIME_ELAPSED = GL_TIME_ELAPSED_EXT;
+    void getQueryObjectui64v(GLuint query, GLenum name, GLuint64* result) { glGetQueryObjectui64vEXT(query, name, (GLuint64EXT*)result); }
+#else
+    const GLenum TIME_ELAPSED = GL_TIME_ELAPSED;
+    void getQueryObjectui64v(GLuint query, GLenum name, GLuint64* result) { glGetQueryObjectui64v(query, name, result); }
+#endif
+
+    void genQuery(GLuint* query) { glGenQueries(1, query); }
+    void deleteQuery(GLuint* query) { glDeleteQueries(1, query); }
+    void beginQuery(GLuint query) { glBeginQuery(TIME_ELAPSED, query); }
+    void endQuery() { glEndQuery(TIME_ELAPSED); }
+    bool isQueryAvailable(GLuint query)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        return available != 0;
+    }
+    uint64_t getQueryResult(GLuint query)
+    {
+        GLuint64 result = 0;
+        getQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+        return result;
+    }
+    bool isDisjoint() { return false; }
+
+#else
+
+    bool loadTimerQueries() { return false; }
+    void genQuery(GLuint* /*query*/) {}
+    void deleteQuery(GLuint* /*query*/) {}
+    void beginQuery(GLuint /*query*/) {}
+    void endQuery() {}
+    bool isQueryAvailable(GLuint /*query*/) { return false; }
+    uint64_t getQueryResult(GLuint /*query*/) { return 0; }
+    bool isDisjoint() { return false; }
+
+#endif
+
+    struct RecordingScope
+    {
+        RecordingScope() { s_recordingThreads.fetch_add(1); }
+        ~RecordingScope() { s_recordingThreads.fetch_sub(1); }
+    };
+
+    void appendEscaped(std::string& json, const char* text)
+    {
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                json += '\\';
+            json += *c;
+        }
+    }
+}
+
+FrameProfiler* FrameProfiler::getInstance()
+{
+    FrameProfiler* profiler = s_sharedFrameProfiler.load();
+    if (!profiler)
+    {
+        profiler = new (std::nothrow) FrameProfiler();
+        s_sharedFrameProfiler.store(profiler);
+    }
+    return profiler;
+}
+
+void FrameProfiler::destroyInstance()
+{
+    FrameProfiler* profiler = s_sharedFrameProfiler.load();
+    if (profiler)
+    {
+        profiler->stopCapture();
+        s_sharedFrameProfiler.store(nullptr);
+
+        // the threads which got the profiler before it was cleared may still be writing their last zones
+        while (s_recordingThreads.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+        delete profiler;
+    }
+}
+
+FrameProfiler::ThreadBuffer::ThreadBuffer()
+: id(0)
+, count(0)
+, epoch(0)
+, dropped(0)
+{
+    for (auto& chunk : chunks)
+    {
+        chunk = nullptr;
+    }
+}
+
+FrameProfiler::ThreadBuffer::~ThreadBuffer()
+{
+    for (auto& chunk : chunks)
+    {
+        delete[] chunk;
+    }
+}
+
+FrameProfiler::FrameProfiler()
+: _instanceId(++s_instanceCounter)
+, _captureBegin(0)
+, _framesToCapture(0)
+, _capturedFrames(0)
+, _frameBegin(0)
+, _gpuTimerChecked(false)
+, _gpuTimerSupported(false)
+, _currentQuery(0)
+, _gpuFrameStarted(false)
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    releaseGPUTimer();
+
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    for (auto& buffer : _buffers)
+    {
+        delete buffer;
+    }
+    _buffers.clear();
+}
+
+FrameProfiler::ThreadBuffer* FrameProfiler::getThreadBuffer()
+{
+    static thread_local ThreadBuffer* t_buffer = nullptr;
+    static thread_local int t_instanceId = 0;
+
+    FrameProfiler* profiler = s_sharedFrameProfiler.load();
+    if (!profiler)
+        return nullptr;
+
+    if (t_instanceId != profiler->_instanceId)
+    {
+        ThreadBuffer* buffer = new (std::nothrow) ThreadBuffer();
+        if (!buffer)
+            return nullptr;
+
+        buffer->threadId = std::this_thread::get_id();
+        buffer->epoch.store(s_epoch.load(std::memory_order_acquire), std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(profiler->_buffersMutex);
+        buffer->id = (int)profiler->_buffers.size() + 1;
+        profiler->_buffers.push_back(buffer);
+
+        t_buffer = buffer;
+        t_instanceId = profiler->_instanceId;
+    }
+    return t_buffer;
+}
+
+void FrameProfiler::record(const Zone* zone, int64_t begin, int64_t end)
+{
+    RecordingScope scope;
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (!buffer)
+        return;
+
+    // the owning thread drops the events of the previous capture the first time it records in a new one
+    unsigned int epoch = s_epoch.load(std::memory_order_acquire);
+    if (buffer->epoch.load(std::memory_order_relaxed) != epoch)
+    {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->epoch.store(epoch, std::memory_order_release);
+    }
+
+    unsigned int count = buffer->count.load(std::memory_order_relaxed);
+    unsigned int chunk = count / ThreadBuffer::EVENTS_PER_CHUNK;
+    if (chunk < ThreadBuffer::MAX_CHUNKS && !buffer->chunks[chunk])
+    {
+        buffer->chunks[chunk] = new (std::nothrow) Event[ThreadBuffer::EVENTS_PER_CHUNK];
+    }
+    if (chunk >= ThreadBuffer::MAX_CHUNKS || !buffer->chunks[chunk])
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event& event = buffer->getEvent(count);
+    event.zone = zone;
+    event.begin = begin;
+    event.end = end;
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void FrameProfiler::startCapture(unsigned int frames)
+{
+    stopCapture();
+
+    // a lost context invalidates the queries, create them again for every capture
+    releaseGPUTimer();
+    _gpuEvents.clear();
+
+    _captureBegin = now();
+    _framesToCapture = frames;
+    _capturedFrames = 0;
+    _frameBegin = 0;
+
+    s_epoch.fetch_add(1, std::memory_order_release);
+    s_capturing.store(true, std::memory_order_release);
+}
+
+void FrameProfiler::stopCapture()
+{
+    s_capturing.store(false, std::memory_order_release);
+}
+
+unsigned int FrameProfiler::getDroppedEventCount() const
+{
+    unsigned int epoch = s_epoch.load(std::memory_order_acquire);
+    unsigned int dropped = 0;
+
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    for (const auto& buffer : _buffers)
+    {
+        if (buffer->epoch.load(std::memory_order_acquire) == epoch)
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (!isCapturing())
+        return;
+
+    _cocosThreadId = std::this_thread::get_id();
+    _frameBegin = now();
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!isCapturing() || _frameBegin == 0)
+        return;
+
+    record(&s_frameZone, _frameBegin, now());
+    _frameBegin = 0;
+
+    ++_capturedFrames;
+    if (_framesToCapture > 0 && _capturedFrames >= _framesToCapture)
+    {
+        stopCapture();
+    }
+}
+
+bool FrameProfiler::initGPUTimer()
+{
+    _gpuTimerChecked = true;
+    _gpuTimerSupported = loadTimerQueries();
+    if (!_gpuTimerSupported)
+        return false;
+
+    _queries.resize(GPU_QUERY_COUNT);
+    for (auto& query : _queries)
+    {
+        GLuint name = 0;
+        genQuery(&name);
+        query.query = name;
+        query.cpuBegin = 0;
+        query.pending = false;
+    }
+    _currentQuery = 0;
+    return true;
+}
+
+void FrameProfiler::releaseGPUTimer()
+{
+    for (auto& query : _queries)
+    {
+        GLuint name = query.query;
+        deleteQuery(&name);
+    }
+    _queries.clear();
+    _gpuTimerChecked = false;
+    _gpuTimerSupported = false;
+    _gpuFrameStarted = false;
+}
+
+void FrameProfiler::collectGPUTimes(bool wait)
+{
+    if (!_gpuTimerSupported)
+        return;
+
+    bool collected = false;
+    size_t firstEvent = _gpuEvents.size();
+    for (auto& query : _queries)
+    {
+        if (!query.pending || (!wait && !isQueryAvailable(query.query)))
+            continue;
+
+        uint64_t elapsed = getQueryResult(query.query);
+        query.pending = false;
+        collected = true;
+
+        // results of a previous capture may still come in
+        if (query.cpuBegin >= _captureBegin)
+        {
+            Event event;
+            event.zone = &s_gpuFrameZone;
+            event.begin = query.cpuBegin;
+            event.end = query.cpuBegin + (int64_t)elapsed;
+            _gpuEvents.push_back(event);
+        }
+    }
+
+    if (collected && isDisjoint())
+    {
+        _gpuEvents.resize(firstEvent);
+    }
+}
+
+void FrameProfiler::beginGPUFrame()
+{
+    if (!isCapturing())
+        return;
+
+    if (!_gpuTimerChecked)
+        initGPUTimer();
+    if (!_gpuTimerSupported)
+        return;
+
+    collectGPUTimes(false);
+
+    // the GPU is more than GPU_QUERY_COUNT frames late, don't wait for it
+    auto& query = _queries[_currentQuery];
+    if (query.pending)
+        return;
+
+    // the GPU time is drawn from the CPU time the frame started being submitted
+    query.cpuBegin = now();
+    beginQuery(query.query);
+    _gpuFrameStarted = true;
+}
+
+void FrameProfiler::endGPUFrame()
+{
+    if (!_gpuFrameStarted)
+        return;
+
+    endQuery();
+    _queries[_currentQuery].pending = true;
+    _currentQuery = (_currentQuery + 1) % _queries.size();
+    _gpuFrameStarted = false;
+}
+
+std::string FrameProfiler::getTraceJSON()
+{
+    collectGPUTimes(true);
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+        buffers = _buffers;
+    }
+
+    std::string json;
+    json.reserve(1024 * 1024);
+    json += "{\"traceEvents\":[\n";
+
+    char buffer[256];
+    bool first = true;
+    auto appendEvent = [&](const Event& event, int tid) {
+        json += first ? "" : ",\n";
+        first = false;
+        json += "{\"name\":\"";
+        appendEscaped(json, event.zone->name);
+        json += "\",\"cat\":\"";
+        appendEscaped(json, event.zone->category);
+        snprintf(buffer, sizeof(buffer), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                 (event.begin - _captureBegin) / 1000.0, (event.end - event.begin) / 1000.0, tid);
+        json += buffer;
+    };
+    auto appendThreadName = [&](int tid, const char* name) {
+        json += first ? "" : ",\n";
+        first = false;
+        snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", tid, name);
+        json += buffer;
+    };
+
+    // tid 0 is the GPU
+    if (!_gpuEvents.empty())
+    {
+        appendThreadName(0, "GPU");
+        for (const auto& event : _gpuEvents)
+            appendEvent(event, 0);
+    }
+
+    unsigned int epoch = s_epoch.load(std::memory_order_acquire);
+    for (const auto& threadBuffer : buffers)
+    {
+        if (threadBuffer->epoch.load(std::memory_order_acquire) != epoch)
+            continue;
+        unsigned int count = threadBuffer->count.load(std::memory_order_acquire);
+        if (count == 0)
+            continue;
+
+        if (threadBuffer->threadId == _cocosThreadId)
+        {
+            appendThreadName(threadBuffer->id, "cocos thread");
+        }
+        else
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "thread %d", threadBuffer->id);
+            appendThreadName(threadBuffer->id, name);
+        }
+
+        for (unsigned int i = 0; i < count; ++i)
+            appendEvent(threadBuffer->getEvent(i), threadBuffer->id);
+    }
+
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+}
+
+bool FrameProfiler::saveTrace(const std::string& fullPath)
+{
+    return FileUtils::getInstance()->writeStringToFile(getTraceJSON(), fullPath);
+}
+
+NS_CC_END
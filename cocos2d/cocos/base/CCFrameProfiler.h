@@ -0,0 +1,236 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __BASE_CCFRAMEPROFILER_H__
+#define __BASE_CCFRAMEPROFILER_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @class FrameProfiler
+ * @brief Low overhead frame profiler recording nested CPU zones and the GPU time of every frame.
+ *
+ * Zones are declared with the CC_PROFILE_ZONE macro, which creates a static zone descriptor and a scoped object
+ * timing the rest of the block. While no capture is running, a zone costs one relaxed atomic load.
+ * While capturing, every thread writes the zones it closes into its own buffer without taking any lock.
+ * The buffer of a thread is only allocated once it records during a capture, by chunks of 4096 events (96 KB),
+ * up to 65536 events per capture.
+ *
+ * When GL timer queries are available (GL_ARB_timer_query / GL_EXT_timer_query on desktop,
+ * GL_EXT_disjoint_timer_query on Android), the GPU time of every frame is measured too. The results are read
+ * a few frames later, so measuring never stalls the pipeline.
+ *
+ * The captured frames can be exported in the Chrome trace_event JSON format and opened in chrome://tracing.
+ * The capture can also be controlled at runtime with the `profiler` console command.
+ *
+ * The profiler is compiled in unless CC_ENABLE_FRAME_PROFILER is set to 0 in ccConfig.h,
+ * so per-frame breakdowns can be captured from release builds. The older averaging profiler in
+ * CCProfiling.h is still available through CC_ENABLE_PROFILERS.
+ * @since v3.17
+ */
+class CC_DLL FrameProfiler
+{
+public:
+    /** Static description of a zone, created by CC_PROFILE_ZONE. */
+    struct Zone
+    {
+        const char* name;
+        const char* category;
+    };
+
+    /** Records the time spent between its construction and its destruction. */
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(const Zone* zone)
+        : _zone(s_capturing.load(std::memory_order_relaxed) ? zone : nullptr)
+        , _begin(_zone ? now() : 0)
+        {
+        }
+
+        ~ScopedZone()
+        {
+            if (_zone)
+                record(_zone, _begin, now());
+        }
+
+    private:
+        const Zone* _zone;
+        int64_t _begin;
+    };
+
+    /** Returns the shared profiler. */
+    static FrameProfiler* getInstance();
+
+    /** Stops the capture and releases the shared profiler with all the captured events. */
+    static void destroyInstance();
+
+    /** Drops the previous capture and starts recording.
+     *
+     * @param frames Number of frames to capture before stopping automatically, 0 to capture until stopCapture().
+     */
+    void startCapture(unsigned int frames = 0);
+
+    /** Stops recording. The captured events are kept until the next startCapture(). */
+    void stopCapture();
+
+    /** Returns whether a capture is running. */
+    bool isCapturing() const { return s_capturing.load(std::memory_order_relaxed); }
+
+    /** Returns the number of frames recorded by the current or last capture. */
+    unsigned int getCapturedFrameCount() const { return _capturedFrames; }
+
+    /** Returns the number of events that didn't fit in the per-thread buffers during the current or last capture. */
+    unsigned int getDroppedEventCount() const;
+
+    /** Returns the current or last capture in the Chrome trace_event JSON format. Call it from the cocos thread. */
+    std::string getTraceJSON();
+
+    /** Writes getTraceJSON() to a file. Returns false if the file can't be written. */
+    bool saveTrace(const std::string& fullPath);
+
+    /** Marks the beginning of a frame. Called by the Director. */
+    void beginFrame();
+
+    /** Marks the end of a frame. Called by the Director. */
+    void endFrame();
+
+    /** Starts the GPU timer of the frame. Called by the Director before the first draw call of a frame. */
+    void beginGPUFrame();
+
+    /** Stops the GPU timer of the frame. Called by the Director after the last draw call of a frame. */
+    void endGPUFrame();
+
+    /** Returns a monotonic time in nanoseconds. */
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** Records a zone closed by the calling thread. */
+    static void record(const Zone* zone, int64_t begin, int64_t end);
+
+protected:
+    struct Event
+    {
+        const Zone* zone;
+        int64_t begin;
+        int64_t end;
+    };
+
+    /** Events of one thread. Only the owning thread writes, readers only look at the first `count` events. */
+    struct ThreadBuffer
+    {
+        static const unsigned int EVENTS_PER_CHUNK = 4096;
+        static const unsigned int MAX_CHUNKS = 16;
+
+        ThreadBuffer();
+        ~ThreadBuffer();
+
+        Event& getEvent(unsigned int index) const { return chunks[index / EVENTS_PER_CHUNK][index % EVENTS_PER_CHUNK]; }
+
+        int id;
+        std::thread::id threadId;
+        // allocated by the owning thread before it publishes a count covering them, kept for the next captures
+        Event* chunks[MAX_CHUNKS];
+        std::atomic<unsigned int> count;
+        std::atomic<unsigned int> epoch;
+        std::atomic<unsigned int> dropped;
+    };
+
+    /** A GPU timer query waiting for its result. */
+    struct PendingQuery
+    {
+        unsigned int query;
+        int64_t cpuBegin;
+        bool pending;
+    };
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    static ThreadBuffer* getThreadBuffer();
+    bool initGPUTimer();
+    void releaseGPUTimer();
+    void collectGPUTimes(bool wait);
+
+    static std::atomic<bool> s_capturing;
+    static std::atomic<unsigned int> s_epoch;
+
+    // thread local buffers created for another instance are not reused
+    int _instanceId;
+    mutable std::mutex _buffersMutex;
+    std::vector<ThreadBuffer*> _buffers;
+
+    int64_t _captureBegin;
+    unsigned int _framesToCapture;
+    unsigned int _capturedFrames;
+    int64_t _frameBegin;
+    std::thread::id _cocosThreadId;
+
+    // GPU timer, only touched by the cocos thread
+    bool _gpuTimerChecked;
+    bool _gpuTimerSupported;
+    std::vector<PendingQuery> _queries;
+    unsigned int _currentQuery;
+    bool _gpuFrameStarted;
+    std::vector<Event> _gpuEvents;
+};
+
+// end of base group
+/// @}
+
+NS_CC_END
+
+#define CC_PROFILE_CONCAT_(__a__, __b__) __a__##__b__
+#define CC_PROFILE_CONCAT(__a__, __b__) CC_PROFILE_CONCAT_(__a__, __b__)
+
+#if CC_ENABLE_FRAME_PROFILER
+/** Times the rest of the enclosing block as a zone of the given category. The name must be a string literal. */
+#define CC_PROFILE_ZONE_CATEGORY(__name__, __category__) \
+    static const NS_CC::FrameProfiler::Zone CC_PROFILE_CONCAT(__ccProfileZone, __LINE__) = { __name__, __category__ }; \
+    NS_CC::FrameProfiler::ScopedZone CC_PROFILE_CONCAT(__ccProfileScope, __LINE__)(&CC_PROFILE_CONCAT(__ccProfileZone, __LINE__))
+#else
+#define CC_PROFILE_ZONE_CATEGORY(__name__, __category__) do {} while (0)
+#endif
+
+/** Times the rest of the enclosing block as a zone of the "cocos2d" category. The name must be a string literal. */
+#define CC_PROFILE_ZONE(__name__) CC_PROFILE_ZONE_CATEGORY(__name__, "cocos2d")
+
+#endif // __BASE_CCFRAMEPROFILER_H__
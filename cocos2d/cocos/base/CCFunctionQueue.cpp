@@ -0,0 +1,95 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFunctionQueue.h"
+
+NS_CC_BEGIN
+
+FunctionQueue::FunctionQueue(size_t capacity)
+: _enqueuePos(0)
+, _dequeuePos(0)
+, _discardEnd(0)
+{
+    size_t size = 2;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    _cells = new (std::nothrow) Cell[size];
+    _mask = size - 1;
+    for (size_t i = 0; i < size; ++i)
+    {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+FunctionQueue::~FunctionQueue()
+{
+    discardAll();
+    while (runOne())
+    {
+    }
+    delete [] _cells;
+}
+
+bool FunctionQueue::isReady() const
+{
+    return _cells[_dequeuePos & _mask].sequence.load(std::memory_order_acquire) == _dequeuePos + 1;
+}
+
+bool FunctionQueue::runOne()
+{
+    size_t pos = _dequeuePos;
+    Cell& cell = _cells[pos & _mask];
+    if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+    {
+        return false;
+    }
+
+    // move on before running, the function may run the queue again
+    ++_dequeuePos;
+
+    if (pos >= _discardEnd.load(std::memory_order_acquire))
+    {
+        cell.run(&cell.storage);
+    }
+    cell.destroy(&cell.storage);
+
+    // hand the cell back to the producers
+    cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+void FunctionQueue::discardAll()
+{
+    size_t end = _enqueuePos.load(std::memory_order_acquire);
+    size_t current = _discardEnd.load(std::memory_order_relaxed);
+    while (current < end && !_discardEnd.compare_exchange_weak(current, end, std::memory_order_release))
+    {
+    }
+}
+
+NS_CC_END
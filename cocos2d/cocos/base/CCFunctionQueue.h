@@ -0,0 +1,178 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __BASE_CCFUNCTIONQUEUE_H__
+#define __BASE_CCFUNCTIONQUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @class FunctionQueue
+ * @brief A bounded lock-free queue of functions, filled by any number of threads and run by a single thread.
+ *
+ * Every slot of the ring stores its callable inline when it's not larger than INLINE_SIZE bytes,
+ * so pushing a lambda with a few captures, or a std::function, doesn't allocate.
+ * INLINE_SIZE is at least the size of std::function, which depends on the standard library
+ * (32 bytes with libstdc++, 48 with libc++, 64 with MSVC on 64-bit targets).
+ * Larger callables are moved to the heap.
+ *
+ * Used by Scheduler::performFunctionInCocosThread.
+ * @since v3.17
+ */
+class CC_DLL FunctionQueue
+{
+public:
+    /** Callables up to this size are stored inside the queue. */
+    static const size_t INLINE_SIZE = sizeof(std::function<void()>) > 40 ? sizeof(std::function<void()>) : 40;
+    /** Callables aligned up to this are stored inside the queue. */
+    static const size_t INLINE_ALIGNMENT = alignof(std::function<void()>) > alignof(void*) ? alignof(std::function<void()>) : alignof(void*);
+
+    /**
+     * @param capacity Number of slots of the ring, rounded up to a power of two.
+     */
+    explicit FunctionQueue(size_t capacity);
+    /** Destroys the functions still queued without running them. */
+    ~FunctionQueue();
+
+    /** Adds a function at the end of the queue. Thread safe.
+     * @return false if the queue is full, in which case the function is left untouched.
+     */
+    template <typename F>
+    bool tryPush(F&& function);
+
+    /** Removes the oldest function and runs it.
+     * Must only be called from the consumer thread, it may be called again from inside the function it runs.
+     * @return false if there was no function ready to run.
+     */
+    bool runOne();
+
+    /** Returns whether a function is ready to run. Must only be called from the consumer thread. */
+    bool isReady() const;
+
+    /** Discards all the functions pushed so far. They are destroyed by the consumer without being run.
+     * Thread safe.
+     */
+    void discardAll();
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        void (*run)(void* storage);
+        void (*destroy)(void* storage);
+        typename std::aligned_storage<INLINE_SIZE, INLINE_ALIGNMENT>::type storage;
+    };
+
+    template <typename F, bool Inline>
+    struct Ops;
+
+    Cell* _cells;
+    size_t _mask;
+
+    // producers and consumer positions live on separate cache lines
+    char _padding0[64];
+    std::atomic<size_t> _enqueuePos;
+    char _padding1[64];
+    size_t _dequeuePos;
+    std::atomic<size_t> _discardEnd;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(FunctionQueue);
+};
+
+// callables stored inside the cell
+template <typename F>
+struct FunctionQueue::Ops<F, true>
+{
+    static void construct(void* storage, F&& function) { new (storage) F(std::move(function)); }
+    static void construct(void* storage, const F& function) { new (storage) F(function); }
+    static void run(void* storage) { (*static_cast<F*>(storage))(); }
+    static void destroy(void* storage) { static_cast<F*>(storage)->~F(); }
+};
+
+// callables too large for a cell, the cell stores a pointer
+template <typename F>
+struct FunctionQueue::Ops<F, false>
+{
+    static void construct(void* storage, F&& function) { *static_cast<F**>(storage) = new F(std::move(function)); }
+    static void construct(void* storage, const F& function) { *static_cast<F**>(storage) = new F(function); }
+    static void run(void* storage) { (**static_cast<F**>(storage))(); }
+    static void destroy(void* storage) { delete *static_cast<F**>(storage); }
+};
+
+template <typename F>
+bool FunctionQueue::tryPush(F&& function)
+{
+    typedef typename std::decay<F>::type Callable;
+    typedef Ops<Callable, sizeof(Callable) <= INLINE_SIZE && alignof(Callable) <= INLINE_ALIGNMENT> CallableOps;
+
+    Cell* cell = nullptr;
+    size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        cell = &_cells[pos & _mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // the consumer didn't free this cell yet
+            return false;
+        }
+        else
+        {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    CallableOps::construct(&cell->storage, std::forward<F>(function));
+    cell->run = &CallableOps::run;
+    cell->destroy = &CallableOps::destroy;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// end of base group
+/** @} */
+
+NS_CC_END
+
+#endif // __BASE_CCFUNCTIONQUEUE_H__
@@ -0,0 +1,298 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "base/CCDirector.h"
+#include "base/CCFrameArena.h"
+#include "base/CCScheduler.h"
+
+NS_CC_BEGIN
+
+class JobSystem::Job
+{
+public:
+    Job()
+    : priority(Priority::NORMAL)
+    , pendingDependencies(0)
+    , finished(false)
+    {
+    }
+
+    std::function<void()> work;
+    std::function<void()> mainThreadCallback;
+    Priority priority;
+    std::atomic<int> pendingDependencies;
+
+    std::mutex mutex; // guards finished and continuations
+    std::vector<JobHandle> continuations;
+    std::atomic<bool> finished;
+};
+
+struct JobSystem::Worker
+{
+    std::thread thread;
+    std::mutex mutex;
+    std::deque<JobHandle> jobs[(int)Priority::COUNT];
+};
+
+JobSystem* JobSystem::s_jobSystem = nullptr;
+
+// index of the worker running on this thread, -1 on the other threads
+static thread_local int t_workerIndex = -1;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (s_jobSystem == nullptr)
+    {
+        s_jobSystem = new (std::nothrow) JobSystem();
+    }
+    return s_jobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    delete s_jobSystem;
+    s_jobSystem = nullptr;
+}
+
+JobSystem::JobSystem()
+: _nextWorker(0)
+, _queuedJobs(0)
+, _stop(false)
+{
+    // leave a core to the cocos thread, but keep 2 workers so that a job blocked on IO doesn't stall the others
+    int count = std::max(2, (int)std::thread::hardware_concurrency() - 1);
+    for (int i = 0; i < count; ++i)
+    {
+        _workers.emplace_back(new (std::nothrow) Worker());
+    }
+
+    // all the workers must exist before any of them tries to steal
+    for (int i = 0; i < count; ++i)
+    {
+        _workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
+    }
+    _sleepCondition.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker->thread.join();
+    }
+}
+
+JobSystem::JobHandle JobSystem::schedule(std::function<void()> work, Priority priority)
+{
+    return scheduleAfter(std::vector<JobHandle>(), std::move(work), nullptr, priority);
+}
+
+JobSystem::JobHandle JobSystem::schedule(std::function<void()> work, std::function<void()> mainThreadCallback, Priority priority)
+{
+    return scheduleAfter(std::vector<JobHandle>(), std::move(work), std::move(mainThreadCallback), priority);
+}
+
+JobSystem::JobHandle JobSystem::scheduleAfter(const std::vector<JobHandle>& dependencies, std::function<void()> work,
+                                              std::function<void()> mainThreadCallback, Priority priority)
+{
+    CCASSERT(priority < Priority::COUNT, "Invalid priority");
+
+    auto job = std::make_shared<Job>();
+    job->work = std::move(work);
+    job->mainThreadCallback = std::move(mainThreadCallback);
+    job->priority = priority;
+
+    // hold the job back until all the dependencies are registered
+    job->pendingDependencies = 1;
+    for (const auto& dependency : dependencies)
+    {
+        if (!dependency)
+            continue;
+
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (!dependency->finished.load(std::memory_order_relaxed))
+        {
+            dependency->continuations.push_back(job);
+            ++job->pendingDependencies;
+        }
+    }
+
+    if (--job->pendingDependencies == 0)
+    {
+        submit(job);
+    }
+    return job;
+}
+
+bool JobSystem::isFinished(const JobHandle& job)
+{
+    return !job || job->finished.load(std::memory_order_acquire);
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    while (!isFinished(job))
+    {
+        JobHandle other = findJob(t_workerIndex);
+        if (other)
+        {
+            run(other);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::submit(const JobHandle& job)
+{
+    int index = t_workerIndex;
+    if (index < 0)
+    {
+        index = (int)(_nextWorker++ % _workers.size());
+    }
+
+    auto& worker = _workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->jobs[(int)job->priority].push_back(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        ++_queuedJobs;
+    }
+    _sleepCondition.notify_one();
+}
+
+JobSystem::JobHandle JobSystem::findJob(int workerIndex)
+{
+    JobHandle job;
+    int count = (int)_workers.size();
+
+    for (int priority = 0; priority < (int)Priority::COUNT && !job; ++priority)
+    {
+        // newest job of our own deque, it's the most likely to be in the cache
+        if (workerIndex >= 0)
+        {
+            auto& worker = _workers[workerIndex];
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            auto& jobs = worker->jobs[priority];
+            if (!jobs.empty())
+            {
+                job = std::move(jobs.back());
+                jobs.pop_back();
+                break;
+            }
+        }
+
+        // oldest job of another worker
+        for (int i = 1; i <= count && !job; ++i)
+        {
+            int victimIndex = (workerIndex + i) % count;
+            if (victimIndex == workerIndex)
+                continue;
+
+            auto& victim = _workers[victimIndex];
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            auto& jobs = victim->jobs[priority];
+            if (!jobs.empty())
+            {
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+        }
+    }
+
+    if (job)
+    {
+        --_queuedJobs;
+    }
+    return job;
+}
+
+void JobSystem::run(const JobHandle& job)
+{
+    if (job->work)
+    {
+        job->work();
+        // release what the work captured, the handle may be kept for a long time
+        job->work = nullptr;
+    }
+
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished.store(true, std::memory_order_release);
+        continuations.swap(job->continuations);
+    }
+
+    if (job->mainThreadCallback)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::move(job->mainThreadCallback));
+        job->mainThreadCallback = nullptr;
+    }
+
+    for (const auto& continuation : continuations)
+    {
+        if (--continuation->pendingDependencies == 0)
+        {
+            submit(continuation);
+        }
+    }
+}
+
+void JobSystem::workerLoop(int workerIndex)
+{
+    t_workerIndex = workerIndex;
+
+    while (!_stop.load())
+    {
+        JobHandle job = findJob(workerIndex);
+        if (job)
+        {
+            run(job);
+            // a job is the frame of a worker, the jobs run by wait() belong to the job that waits
+            FrameArena::getInstance()->reset();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepCondition.wait(lock, [this] { return _stop.load() || _queuedJobs.load() > 0; });
+    }
+}
+
+NS_CC_END
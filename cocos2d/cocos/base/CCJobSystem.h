@@ -0,0 +1,142 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __BASE_CCJOBSYSTEM_H__
+#define __BASE_CCJOBSYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @class JobSystem
+ * @brief Runs jobs on a pool of worker threads, one per spare core.
+ *
+ * Every worker owns a deque of jobs per priority. A worker runs the newest job of its own deques first
+ * and, when they are empty, steals the oldest job of another worker. Jobs scheduled from a worker thread
+ * go to that worker, jobs scheduled from other threads are spread over the workers.
+ *
+ * A job may depend on other jobs: it is queued once all of them finished. A job may also have a callback
+ * that is run in the cocos thread once the job finished, through Scheduler::performFunctionInCocosThread.
+ *
+ * Jobs run in parallel and in no particular order, unless they depend on each other.
+ * @since v3.17
+ * @js NA
+ */
+class CC_DLL JobSystem
+{
+public:
+    enum class Priority
+    {
+        HIGH,
+        NORMAL,
+        LOW,
+        COUNT,
+    };
+
+    class Job;
+    typedef std::shared_ptr<Job> JobHandle;
+
+    /** Returns the shared instance of the job system, the workers are started on the first call. */
+    static JobSystem* getInstance();
+
+    /** Stops the workers and destroys the job system. Queued jobs are dropped, running jobs are waited for. */
+    static void destroyInstance();
+
+    /** Schedules a job.
+     * @param work Function run in a worker thread.
+     * @param priority Jobs with a higher priority are run first.
+     */
+    JobHandle schedule(std::function<void()> work, Priority priority = Priority::NORMAL);
+
+    /** Schedules a job with a callback run in the cocos thread once the job finished.
+     * @param work Function run in a worker thread.
+     * @param mainThreadCallback Function run in the cocos thread after `work`.
+     * @param priority Jobs with a higher priority are run first.
+     */
+    JobHandle schedule(std::function<void()> work, std::function<void()> mainThreadCallback, Priority priority = Priority::NORMAL);
+
+    /** Schedules a job that only starts once all the given jobs finished.
+     * @param dependencies Jobs that must finish first. Finished jobs and empty handles are ignored.
+     * @param work Function run in a worker thread.
+     * @param mainThreadCallback Function run in the cocos thread after `work`, may be nullptr.
+     * @param priority Jobs with a higher priority are run first.
+     */
+    JobHandle scheduleAfter(const std::vector<JobHandle>& dependencies, std::function<void()> work,
+                            std::function<void()> mainThreadCallback = nullptr, Priority priority = Priority::NORMAL);
+
+    /** Returns whether the work of the job finished. Its main thread callback may not have run yet. */
+    static bool isFinished(const JobHandle& job);
+
+    /** Blocks until the job finished, running other queued jobs in the meantime. */
+    void wait(const JobHandle& job);
+
+    /** Returns the number of worker threads. */
+    int getWorkerCount() const { return (int)_workers.size(); }
+
+CC_CONSTRUCTOR_ACCESS:
+    JobSystem();
+    ~JobSystem();
+
+protected:
+    struct Worker;
+
+    void submit(const JobHandle& job);
+    JobHandle findJob(int workerIndex);
+    void run(const JobHandle& job);
+    void workerLoop(int workerIndex);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<unsigned int> _nextWorker;
+
+    // sleeping workers
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    std::atomic<int> _queuedJobs;
+    std::atomic<bool> _stop;
+
+    static JobSystem* s_jobSystem;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(JobSystem);
+};
+
+// end of base group
+/** @} */
+
+NS_CC_END
+
+#endif // __BASE_CCJOBSYSTEM_H__
@@ -0,0 +1,424 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCObjectPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <iomanip>
+#include <sstream>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    const size_t NUM_SIZE_CLASSES = ObjectPool::MAX_POOLED_SIZE / ObjectPool::GRANULARITY;
+    const uint32_t LARGE_SIZE_CLASS = (uint32_t)NUM_SIZE_CLASSES;
+    // number of blocks moved at once between a thread cache and its size class
+    const unsigned int BATCH_SIZE = 16;
+    // a thread cache gives half of its blocks back once it holds more than this
+    const unsigned int MAX_CACHED_BLOCKS = 4 * BATCH_SIZE;
+    const size_t PAGE_SIZE = 64 * 1024;
+
+    const uint32_t LIVE_MAGIC = 0x4f50a11c;
+    const uint32_t FREED_MAGIC = 0x4f50f4ee;
+
+    // kept in front of every object, its size keeps the objects aligned like malloc does
+    struct BlockHeader
+    {
+        uint32_t sizeClass;
+        uint32_t size;
+        uint32_t magic;
+        uint32_t padding;
+    };
+    static_assert(sizeof(BlockHeader) == ObjectPool::GRANULARITY, "the block header must keep the alignment");
+
+    // a free block reuses the beginning of its header, the magic stays readable to catch double frees
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+    static_assert(sizeof(FreeBlock) <= offsetof(BlockHeader, magic), "a free block must not overwrite the magic");
+
+    struct SizeClass
+    {
+        SizeClass()
+        : freeList(nullptr)
+        , freeCount(0)
+        , reservedBlocks(0)
+        , liveObjects(0)
+        , liveBytes(0)
+        , peakObjects(0)
+        , markedObjects(0)
+        {}
+
+        std::mutex mutex;
+        FreeBlock* freeList;
+        size_t freeCount;
+        size_t reservedBlocks;
+        std::vector<void*> pages;
+
+        std::atomic<size_t> liveObjects;
+        std::atomic<size_t> liveBytes;
+        std::atomic<size_t> peakObjects;
+        std::atomic<size_t> markedObjects;
+    };
+
+    size_t blockSizeOf(size_t sizeClass)
+    {
+        return (sizeClass + 1) * ObjectPool::GRANULARITY;
+    }
+
+    // never destroyed: objects may still be freed while the statics of other modules are destroyed
+    SizeClass* getSizeClasses()
+    {
+        static SizeClass* s_sizeClasses = new SizeClass[NUM_SIZE_CLASSES + 1];
+        return s_sizeClasses;
+    }
+
+    void trackAllocation(SizeClass& sizeClass, size_t size)
+    {
+        size_t live = sizeClass.liveObjects.fetch_add(1, std::memory_order_relaxed) + 1;
+        sizeClass.liveBytes.fetch_add(size, std::memory_order_relaxed);
+
+        size_t peak = sizeClass.peakObjects.load(std::memory_order_relaxed);
+        while (live > peak && !sizeClass.peakObjects.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void trackDeallocation(SizeClass& sizeClass, size_t size)
+    {
+        sizeClass.liveObjects.fetch_sub(1, std::memory_order_relaxed);
+        sizeClass.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    // must be called with the size class locked
+    bool grow(SizeClass& sizeClass, size_t index)
+    {
+        size_t blockBytes = sizeof(BlockHeader) + blockSizeOf(index);
+        size_t count = std::max((size_t)BATCH_SIZE, PAGE_SIZE / blockBytes);
+        char* page = static_cast<char*>(std::malloc(count * blockBytes));
+        if (!page)
+            return false;
+
+        sizeClass.pages.push_back(page);
+        for (size_t i = count; i > 0; --i)
+        {
+            char* block = page + (i - 1) * blockBytes;
+            reinterpret_cast<BlockHeader*>(block)->magic = FREED_MAGIC;
+            FreeBlock* freeBlock = reinterpret_cast<FreeBlock*>(block);
+            freeBlock->next = sizeClass.freeList;
+            sizeClass.freeList = freeBlock;
+        }
+        sizeClass.freeCount += count;
+        sizeClass.reservedBlocks += count;
+        return true;
+    }
+
+    // trivially destructible, so it can still be read while the thread's cache is being destroyed
+    thread_local bool t_cacheDestroyed = false;
+
+    struct ThreadCache
+    {
+        ThreadCache()
+        {
+            for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+            {
+                heads[i] = nullptr;
+                counts[i] = 0;
+            }
+        }
+
+        ~ThreadCache()
+        {
+            for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+            {
+                release(i, counts[i]);
+            }
+            t_cacheDestroyed = true;
+        }
+
+        bool refill(size_t index)
+        {
+            SizeClass& sizeClass = getSizeClasses()[index];
+            std::lock_guard<std::mutex> lock(sizeClass.mutex);
+            if (sizeClass.freeCount < BATCH_SIZE && !grow(sizeClass, index) && sizeClass.freeCount == 0)
+                return false;
+
+            while (sizeClass.freeList && counts[index] < BATCH_SIZE)
+            {
+                FreeBlock* block = sizeClass.freeList;
+                sizeClass.freeList = block->next;
+                --sizeClass.freeCount;
+
+                block->next = heads[index];
+                heads[index] = block;
+                ++counts[index];
+            }
+            return true;
+        }
+
+        void release(size_t index, unsigned int count)
+        {
+            if (count == 0)
+                return;
+
+            FreeBlock* first = heads[index];
+            FreeBlock* last = first;
+            for (unsigned int i = 1; i < count; ++i)
+            {
+                last = last->next;
+            }
+            heads[index] = last->next;
+            counts[index] -= count;
+
+            SizeClass& sizeClass = getSizeClasses()[index];
+            std::lock_guard<std::mutex> lock(sizeClass.mutex);
+            last->next = sizeClass.freeList;
+            sizeClass.freeList = first;
+            sizeClass.freeCount += count;
+        }
+
+        FreeBlock* heads[NUM_SIZE_CLASSES];
+        unsigned int counts[NUM_SIZE_CLASSES];
+    };
+
+    ThreadCache* getThreadCache()
+    {
+        if (t_cacheDestroyed)
+            return nullptr;
+
+        static thread_local ThreadCache t_cache;
+        return &t_cache;
+    }
+}
+
+void* ObjectPool::allocate(size_t size)
+{
+    SizeClass* sizeClasses = getSizeClasses();
+
+    if (size > MAX_POOLED_SIZE)
+    {
+        BlockHeader* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + size));
+        if (!header)
+            return nullptr;
+
+        header->sizeClass = LARGE_SIZE_CLASS;
+        header->size = (uint32_t)size;
+        header->magic = LIVE_MAGIC;
+        trackAllocation(sizeClasses[LARGE_SIZE_CLASS], size);
+        return header + 1;
+    }
+
+    size_t index = size > 0 ? (size - 1) / GRANULARITY : 0;
+    FreeBlock* block = nullptr;
+
+    ThreadCache* cache = getThreadCache();
+    if (cache)
+    {
+        if (!cache->heads[index] && !cache->refill(index))
+            return nullptr;
+
+        block = cache->heads[index];
+        cache->heads[index] = block->next;
+        --cache->counts[index];
+    }
+    else
+    {
+        // the thread is exiting, go to the size class directly
+        SizeClass& sizeClass = sizeClasses[index];
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        if (!sizeClass.freeList && !grow(sizeClass, index))
+            return nullptr;
+
+        block = sizeClass.freeList;
+        sizeClass.freeList = block->next;
+        --sizeClass.freeCount;
+    }
+
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+    CCASSERT(header->magic == FREED_MAGIC, "ObjectPool: a free block was overwritten");
+    header->sizeClass = (uint32_t)index;
+    header->size = (uint32_t)size;
+    header->magic = LIVE_MAGIC;
+    trackAllocation(sizeClasses[index], size);
+    return header + 1;
+}
+
+void* ObjectPool::allocateOrThrow(size_t size)
+{
+    void* address = allocate(size);
+    if (address == nullptr)
+        throw std::bad_alloc();
+    return address;
+}
+
+void ObjectPool::deallocate(void* address)
+{
+    if (!address)
+        return;
+
+    BlockHeader* header = static_cast<BlockHeader*>(address) - 1;
+    CCASSERT(header->magic == LIVE_MAGIC, "ObjectPool: freeing memory that is not allocated by the pool, or freeing it twice");
+
+    SizeClass* sizeClasses = getSizeClasses();
+    size_t index = header->sizeClass;
+    trackDeallocation(sizeClasses[index], header->size);
+
+    if (index == LARGE_SIZE_CLASS)
+    {
+        header->magic = FREED_MAGIC;
+        std::free(header);
+        return;
+    }
+
+    header->magic = FREED_MAGIC;
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(header);
+
+    ThreadCache* cache = getThreadCache();
+    if (cache)
+    {
+        block->next = cache->heads[index];
+        cache->heads[index] = block;
+        if (++cache->counts[index] > MAX_CACHED_BLOCKS)
+        {
+            cache->release(index, MAX_CACHED_BLOCKS / 2);
+        }
+    }
+    else
+    {
+        SizeClass& sizeClass = sizeClasses[index];
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        block->next = sizeClass.freeList;
+        sizeClass.freeList = block;
+        ++sizeClass.freeCount;
+    }
+}
+
+std::vector<ObjectPool::SizeClassInfo> ObjectPool::getSizeClassInfo()
+{
+    std::vector<SizeClassInfo> result;
+    SizeClass* sizeClasses = getSizeClasses();
+    for (size_t i = 0; i <= NUM_SIZE_CLASSES; ++i)
+    {
+        SizeClass& sizeClass = sizeClasses[i];
+        SizeClassInfo info;
+        info.blockSize = i == LARGE_SIZE_CLASS ? 0 : blockSizeOf(i);
+        info.liveObjects = sizeClass.liveObjects.load(std::memory_order_relaxed);
+        info.liveBytes = sizeClass.liveBytes.load(std::memory_order_relaxed);
+        info.peakObjects = sizeClass.peakObjects.load(std::memory_order_relaxed);
+        info.sinceMark = (ptrdiff_t)info.liveObjects - (ptrdiff_t)sizeClass.markedObjects.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(sizeClass.mutex);
+            info.reservedBlocks = sizeClass.reservedBlocks;
+        }
+
+        if (info.peakObjects > 0 || i == LARGE_SIZE_CLASS)
+            result.push_back(info);
+    }
+    return result;
+}
+
+void ObjectPool::mark()
+{
+    SizeClass* sizeClasses = getSizeClasses();
+    for (size_t i = 0; i <= NUM_SIZE_CLASSES; ++i)
+    {
+        sizeClasses[i].markedObjects.store(sizeClasses[i].liveObjects.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+std::string ObjectPool::getInfo()
+{
+    std::stringstream s;
+    s << "Object pool is " << (CC_ENABLE_OBJECT_POOL ? "enabled" : "disabled (CC_ENABLE_OBJECT_POOL is 0)") << "\n";
+    s << std::setw(8) << "size" << std::setw(10) << "live" << std::setw(10) << "peak"
+      << std::setw(10) << "reserved" << std::setw(12) << "live KB" << std::setw(12) << "reserved KB" << std::setw(8) << "used" << "\n";
+
+    size_t totalLive = 0, totalReserved = 0;
+    for (const auto& info : getSizeClassInfo())
+    {
+        if (info.blockSize == 0)
+        {
+            s << std::setw(8) << "large" << std::setw(10) << info.liveObjects << std::setw(10) << info.peakObjects
+              << std::setw(10) << "-" << std::setw(12) << info.liveBytes / 1024 << "\n";
+            continue;
+        }
+
+        size_t reservedBytes = info.reservedBlocks * (sizeof(BlockHeader) + info.blockSize);
+        totalLive += info.liveBytes;
+        totalReserved += reservedBytes;
+        s << std::setw(8) << info.blockSize << std::setw(10) << info.liveObjects << std::setw(10) << info.peakObjects
+          << std::setw(10) << info.reservedBlocks << std::setw(12) << info.liveBytes / 1024 << std::setw(12) << reservedBytes / 1024
+          << std::setw(7) << (reservedBytes ? info.liveBytes * 100 / reservedBytes : 0) << "%\n";
+    }
+
+    // everything reserved but not holding a live object is lost to headers, rounding and free blocks
+    s << "pooled: " << totalLive / 1024 << " KB live in " << totalReserved / 1024 << " KB reserved, fragmentation "
+      << (totalReserved ? 100 - totalLive * 100 / totalReserved : 0) << "%\n";
+    return s.str();
+}
+
+std::string ObjectPool::getLeaksInfo()
+{
+    std::stringstream s;
+    size_t leaked = 0;
+    for (const auto& info : getSizeClassInfo())
+    {
+        if (info.sinceMark <= 0)
+            continue;
+
+        leaked += info.sinceMark;
+        if (info.blockSize == 0)
+            s << "  " << info.sinceMark << " large objects\n";
+        else
+            s << "  " << info.sinceMark << " objects of " << info.blockSize - GRANULARITY + 1 << " to " << info.blockSize << " bytes\n";
+    }
+
+    if (leaked == 0)
+        return "No object allocated since the mark is still alive\n";
+    return std::to_string(leaked) + " objects allocated since the mark are still alive:\n" + s.str();
+}
+
+void ObjectPool::flushThreadCache()
+{
+    ThreadCache* cache = getThreadCache();
+    if (!cache)
+        return;
+
+    for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+    {
+        cache->release(i, cache->counts[i]);
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,134 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __BASE_CCOBJECTPOOL_H__
+#define __BASE_CCOBJECTPOOL_H__
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "base/ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @class ObjectPool
+ * @brief Size-segregated pool for the small objects that are created and destroyed the most, like nodes and actions.
+ *
+ * Requests are rounded up to a multiple of GRANULARITY bytes and served from the matching size class.
+ * Every thread keeps a small cache of free blocks per size class, so allocating and freeing on the same
+ * thread doesn't take any lock. The caches exchange blocks with the shared size classes in batches.
+ * Blocks may be freed on another thread than the one that allocated them.
+ * Requests larger than MAX_POOLED_SIZE go to malloc.
+ *
+ * The memory of a size class is never given back to the system, it is reused by the next objects of a similar size.
+ *
+ * Classes opt in with the CC_USE_OBJECT_POOL macro, which only has an effect when CC_ENABLE_OBJECT_POOL
+ * is set to 1 in ccConfig.h. Node, Action and Touch use it, so all their subclasses are pooled too.
+ *
+ * The `pool` console command prints the usage and fragmentation of every size class, and reports
+ * the objects still alive since a mark, e.g. after a scene was pushed and popped again.
+ * @since v3.17
+ */
+class CC_DLL ObjectPool
+{
+public:
+    /** Size classes are multiples of this number of bytes. */
+    static const size_t GRANULARITY = 16;
+    /** Requests up to this size are pooled. */
+    static const size_t MAX_POOLED_SIZE = 2048;
+
+    /** Usage of one size class. */
+    struct SizeClassInfo
+    {
+        /** Largest object served by this size class. */
+        size_t blockSize;
+        /** Number of objects currently allocated. */
+        size_t liveObjects;
+        /** Sum of the requested sizes of the objects currently allocated. */
+        size_t liveBytes;
+        /** Highest number of objects allocated at once. */
+        size_t peakObjects;
+        /** Number of blocks obtained from the system. */
+        size_t reservedBlocks;
+        /** Number of objects still allocated that weren't when `mark()` was called. */
+        ptrdiff_t sinceMark;
+    };
+
+    /** Allocates at least `size` bytes. Returns nullptr when the system is out of memory. */
+    static void* allocate(size_t size);
+
+    /** Same as `allocate()`, but throws std::bad_alloc when the system is out of memory, like the global `operator new`. */
+    static void* allocateOrThrow(size_t size);
+
+    /** Frees memory returned by `allocate()`. Does nothing for nullptr. */
+    static void deallocate(void* address);
+
+    /** Returns the usage of the size classes that were used at least once, plus one entry with a block size of 0 for the large objects. */
+    static std::vector<SizeClassInfo> getSizeClassInfo();
+
+    /** Remembers the number of live objects of every size class, `getLeaksInfo()` reports what was allocated since. */
+    static void mark();
+
+    /** Returns a readable description of the usage and fragmentation of the pool. */
+    static std::string getInfo();
+
+    /** Returns a readable description of the size classes that have more live objects than when `mark()` was called. */
+    static std::string getLeaksInfo();
+
+    /** Gives the free blocks cached by the calling thread back to the shared size classes. */
+    static void flushThreadCache();
+};
+
+/** @def CC_USE_OBJECT_POOL
+ * Declares class-specific `operator new` and `operator delete` using the ObjectPool.
+ * Must be used in the public section of a class; all the subclasses inherit them.
+ * Does nothing unless CC_ENABLE_OBJECT_POOL is set to 1.
+ */
+#if CC_ENABLE_OBJECT_POOL
+#define CC_USE_OBJECT_POOL \
+    static void* operator new(size_t size) { return cocos2d::ObjectPool::allocateOrThrow(size); } \
+    static void* operator new(size_t size, const std::nothrow_t&) noexcept { return cocos2d::ObjectPool::allocate(size); } \
+    static void* operator new(size_t, void* address) noexcept { return address; } \
+    static void operator delete(void* address) { cocos2d::ObjectPool::deallocate(address); } \
+    static void operator delete(void* address, const std::nothrow_t&) noexcept { cocos2d::ObjectPool::deallocate(address); } \
+    static void operator delete(void*, void*) noexcept {}
+#else
+#define CC_USE_OBJECT_POOL
+#endif
+
+// end of base group
+/// @}
+
+NS_CC_END
+
+#endif // __BASE_CCOBJECTPOOL_H__
@@ -147,7 +147,11 @@ void Ref::release()
 #if CC_REF_LEAK_DETECTION
         untrackRef(this);
 #endif
-        delete this;
+        auto manager = PoolManager::s_singleInstance;
+        if (!manager || !manager->deferDeletion(this))
+        {
+            delete this;
+        }
     }
 }
 
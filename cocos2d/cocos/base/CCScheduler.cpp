@@ -27,33 +27,27 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
-#include "base/utlist.h"
 #include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
+#include "base/CCFrameProfiler.h"
 
 NS_CC_BEGIN
 
 // data structures
 
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
-{
-    struct _listEntry   *prev, *next;
-    ccSchedulerFunc     callback;
-    void                *target;
-    int                 priority;
-    bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
-
 typedef struct _hashUpdateEntry
 {
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
+    size_t              index;      // index of the entry in _updateEntries, or in _updateEntriesToAdd when pending
+    bool                pending;
     void                *target;
-    ccSchedulerFunc     callback;
     UT_hash_handle      hh;
 } tHashUpdateEntry;
 
@@ -62,7 +56,6 @@ typedef struct _hashSelectorEntry
 {
     ccArray             *timers;
     void                *target;
-    int                 timerIndex;
     Timer               *currentTimer;
     bool                paused;
     UT_hash_handle      hh;
@@ -80,6 +73,12 @@ Timer::Timer()
 , _delay(0.0f)
 , _interval(0.0f)
 , _aborted(false)
+, _entry(nullptr)
+, _lastUpdateTime(0.0)
+, _pausedTime(0.0f)
+, _wheelDeadline(0)
+, _wheelSlot(-1)
+, _wheelIndex(-1)
 {
 }
 
@@ -151,6 +150,23 @@ bool Timer::isExhausted() const
     return !_runForever && _timesExecuted > _repeat;
 }
 
+float Timer::getTimeToNextTrigger() const
+{
+    // the first update only starts the timer
+    if (_elapsed == -1)
+    {
+        return 0.0f;
+    }
+
+    if (_useDelay)
+    {
+        return _delay - _elapsed;
+    }
+
+    // _interval == 0 triggers every frame
+    return _interval - _elapsed;
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -242,6 +258,150 @@ void TimerScriptHandler::cancel()
 
 #endif
 
+// TimerWheel
+
+TimerWheel::TimerWheel()
+: _tick(0)
+{
+}
+
+int TimerWheel::getSlot(long long deadline) const
+{
+    long long delta = deadline - _tick;
+    if (delta <= 0)
+    {
+        return DUE_SLOT;
+    }
+
+    if (delta < LEVEL0_SIZE)
+    {
+        return (int)(deadline & (LEVEL0_SIZE - 1));
+    }
+
+    for (int level = 1; level < LEVELS; ++level)
+    {
+        int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+        long long span = 1LL << (shift + LEVEL_BITS);
+        if (delta >= span)
+        {
+            if (level < LEVELS - 1)
+            {
+                continue;
+            }
+            // beyond the range of the wheel: park it in the last level, it is re-bucketed when its slot is reached
+            deadline = _tick + span - 1;
+        }
+        return LEVEL0_SIZE + (level - 1) * LEVEL_SIZE + (int)((deadline >> shift) & (LEVEL_SIZE - 1));
+    }
+
+    CCASSERT(false, "unreachable");
+    return DUE_SLOT;
+}
+
+void TimerWheel::insert(Timer* timer, int slot)
+{
+    auto& bucket = _slots[slot];
+    timer->_wheelSlot = slot;
+    timer->_wheelIndex = (int)bucket.size();
+    bucket.push_back(timer);
+}
+
+void TimerWheel::add(Timer* timer, long long deadline)
+{
+    CCASSERT(timer->_wheelSlot < 0, "The timer is already in the wheel");
+    timer->_wheelDeadline = deadline;
+    insert(timer, getSlot(deadline));
+}
+
+void TimerWheel::remove(Timer* timer)
+{
+    int slot = timer->_wheelSlot;
+    if (slot < 0)
+    {
+        return;
+    }
+
+    auto& bucket = _slots[slot];
+    if (slot == EXPIRED_SLOT)
+    {
+        // the expired timers may be iterated right now, keep the indices stable
+        bucket[timer->_wheelIndex] = nullptr;
+    }
+    else
+    {
+        Timer* last = bucket.back();
+        bucket[timer->_wheelIndex] = last;
+        last->_wheelIndex = timer->_wheelIndex;
+        bucket.pop_back();
+    }
+
+    timer->_wheelSlot = -1;
+    timer->_wheelIndex = -1;
+}
+
+void TimerWheel::cascade(int slot)
+{
+    _cascadeBuffer.swap(_slots[slot]);
+    for (auto timer : _cascadeBuffer)
+    {
+        insert(timer, getSlot(timer->_wheelDeadline));
+    }
+    _cascadeBuffer.clear();
+}
+
+void TimerWheel::expire(int slot)
+{
+    for (auto timer : _slots[slot])
+    {
+        insert(timer, EXPIRED_SLOT);
+    }
+    _slots[slot].clear();
+}
+
+void TimerWheel::advance(long long tick)
+{
+    CCASSERT(_slots[EXPIRED_SLOT].empty(), "The expired timers of the previous advance were not cleared");
+
+    if (tick - _tick > LEVEL0_SIZE)
+    {
+        // a long frame: re-bucket all the timers instead of walking every tick
+        _tick = tick;
+        for (int slot = 0; slot < DUE_SLOT; ++slot)
+        {
+            if (!_slots[slot].empty())
+            {
+                cascade(slot);
+            }
+        }
+    }
+    else
+    {
+        while (_tick < tick)
+        {
+            ++_tick;
+
+            // entering a new turn of the first level: move the timers of the next slot of each level one level down
+            if ((_tick & (LEVEL0_SIZE - 1)) == 0)
+            {
+                for (int level = 1; level < LEVELS; ++level)
+                {
+                    int index = (int)((_tick >> (LEVEL0_BITS + (level - 1) * LEVEL_BITS)) & (LEVEL_SIZE - 1));
+                    cascade(LEVEL0_SIZE + (level - 1) * LEVEL_SIZE + index);
+                    if (index != 0)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            expire((int)(_tick & (LEVEL0_SIZE - 1)));
+        }
+    }
+
+    // timers whose deadline was already reached when they were added, or while cascading
+    expire(DUE_SLOT);
+}
+
 // implementation of Scheduler
 
 // Priority level reserved for system services.
@@ -250,19 +410,26 @@ const int Scheduler::PRIORITY_SYSTEM = INT_MIN;
 // Minimum priority level for user scheduling.
 const int Scheduler::PRIORITY_NON_SYSTEM_MIN = PRIORITY_SYSTEM + 1;
 
+// Functions queued by other threads before the cocos thread runs them. Bursts larger than that go to a vector.
+static const size_t FUNCTION_QUEUE_CAPACITY = 512;
+
 Scheduler::Scheduler(void)
 : _timeScale(1.0f)
-, _updatesNegList(nullptr)
-, _updates0List(nullptr)
-, _updatesPosList(nullptr)
+, _updateEntriesDirty(false)
 , _hashForUpdates(nullptr)
 , _hashForTimers(nullptr)
+, _timerTime(0.0)
 , _currentTarget(nullptr)
 , _currentTargetSalvaged(false)
 , _updateHashLocked(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _functionQueue(FUNCTION_QUEUE_CAPACITY)
+, _functionsOverflowing(false)
+, _performBatchIndex(0)
+, _performBatchDiscarded(false)
+, _performFunctionsTimeBudget(0.0f)
 {
     // I don't expect to have more than 30 functions to all per frame
     _functionsToPerform.reserve(30);
@@ -322,6 +489,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                startTimer(timer);
                 return;
             }
         }
@@ -330,7 +498,9 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
 
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
+    timer->_entry = element;
     ccArrayAppendObject(element->timers, timer);
+    startTimer(timer);
     timer->release();
 }
 
@@ -362,14 +532,9 @@ void Scheduler::unschedule(const std::string &key, void *target)
                     timer->setAborted();
                 }
 
+                _timerWheel.remove(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
                 if (element->timers->num == 0)
                 {
                     if (_currentTarget == element)
@@ -388,83 +553,98 @@ void Scheduler::unschedule(const std::string &key, void *target)
     }
 }
 
-void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused)
+void Scheduler::startTimer(Timer *timer)
+{
+    timer->_lastUpdateTime = _timerTime;
+    timer->_pausedTime = 0.0f;
+    if (! timer->_entry->paused)
+    {
+        linkTimer(timer);
+    }
+}
+
+void Scheduler::linkTimer(Timer *timer)
 {
-    tListEntry *listElement = new (std::nothrow) tListEntry();
+    _timerWheel.remove(timer);
 
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->priority = priority;
-    listElement->paused = paused;
-    listElement->next = listElement->prev = nullptr;
-    listElement->markedForDeletion = false;
+    double deadline = timer->_lastUpdateTime + timer->getTimeToNextTrigger();
+    // rounded down: a timer may be looked at a tick early, never a tick late
+    _timerWheel.add(timer, (long long)std::floor(deadline * TimerWheel::TICKS_PER_SECOND));
+}
 
-    // empty list ?
-    if (! *list)
+void Scheduler::setTimersPaused(tHashTimerEntry *element, bool paused)
+{
+    if (element->paused == paused)
     {
-        DL_APPEND(*list, listElement);
+        return;
     }
-    else
-    {
-        bool added = false;
+    element->paused = paused;
 
-        for (tListEntry *element = *list; element; element = element->next)
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = (Timer*)element->timers->arr[i];
+        if (paused)
         {
-            if (priority < element->priority)
-            {
-                if (element == *list)
-                {
-                    DL_PREPEND(*list, listElement);
-                }
-                else
-                {
-                    listElement->next = element;
-                    listElement->prev = element->prev;
-
-                    element->prev->next = listElement;
-                    element->prev = listElement;
-                }
-
-                added = true;
-                break;
-            }
+            // paused timers leave the wheel, and keep the time they already ran since their last update
+            _timerWheel.remove(timer);
+            timer->_pausedTime = (float)(_timerTime - timer->_lastUpdateTime);
         }
-
-        // Not added? priority has the higher value. Append it.
-        if (! added)
+        else
         {
-            DL_APPEND(*list, listElement);
+            timer->_lastUpdateTime = _timerTime - timer->_pausedTime;
+            timer->_pausedTime = 0.0f;
+            linkTimer(timer);
         }
     }
+}
 
-    // update hash entry for quick access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
+void Scheduler::removeTimers(tHashTimerEntry *element)
+{
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        _timerWheel.remove((Timer*)element->timers->arr[i]);
+    }
 }
 
-void Scheduler::appendIn(_listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused)
+Scheduler::UpdateEntry& Scheduler::getUpdateEntry(tHashUpdateEntry *element)
 {
-    tListEntry *listElement = new (std::nothrow) tListEntry();
+    return element->pending ? _updateEntriesToAdd[element->index] : _updateEntries[element->index];
+}
+
+void Scheduler::flushUpdateEntries()
+{
+    if (! _updateEntriesDirty)
+    {
+        return;
+    }
+    _updateEntriesDirty = false;
 
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->paused = paused;
-    listElement->priority = 0;
-    listElement->markedForDeletion = false;
+    auto isRemoved = [](const UpdateEntry& e) { return e.markedForDeletion; };
+    auto byPriority = [](const UpdateEntry& a, const UpdateEntry& b) { return a.priority < b.priority; };
 
-    DL_APPEND(*list, listElement);
+    _updateEntries.erase(std::remove_if(_updateEntries.begin(), _updateEntries.end(), isRemoved), _updateEntries.end());
+    _updateEntriesToAdd.erase(std::remove_if(_updateEntriesToAdd.begin(), _updateEntriesToAdd.end(), isRemoved),
+                              _updateEntriesToAdd.end());
 
-    // update hash entry for quicker access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
+    if (! _updateEntriesToAdd.empty())
+    {
+        // stable, the entries with the same priority are called in the order they were scheduled
+        std::stable_sort(_updateEntriesToAdd.begin(), _updateEntriesToAdd.end(), byPriority);
+
+        std::vector<UpdateEntry> entries;
+        entries.reserve(_updateEntries.size() + _updateEntriesToAdd.size());
+        std::merge(std::make_move_iterator(_updateEntries.begin()), std::make_move_iterator(_updateEntries.end()),
+                   std::make_move_iterator(_updateEntriesToAdd.begin()), std::make_move_iterator(_updateEntriesToAdd.end()),
+                   std::back_inserter(entries), byPriority);
+        _updateEntries.swap(entries);
+        _updateEntriesToAdd.clear();
+    }
+
+    for (size_t i = 0, size = _updateEntries.size(); i < size; ++i)
+    {
+        _updateEntries[i].hashEntry->index = i;
+        _updateEntries[i].hashEntry->pending = false;
+    }
 }
 
 void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused)
@@ -474,7 +654,7 @@ void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target,
     if (hashElement)
     {
         // change priority: should unschedule it first
-        if (hashElement->entry->priority != priority)
+        if (getUpdateEntry(hashElement).priority != priority)
         {
             unscheduleUpdate(target);
         }
@@ -486,21 +666,24 @@ void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target,
         }
     }
 
-    // most of the updates are going to be 0, that's way there
-    // is an special list for updates with priority 0
-    if (priority == 0)
-    {
-        appendIn(&_updates0List, callback, target, paused);
-    }
-    else if (priority < 0)
-    {
-        priorityIn(&_updatesNegList, callback, target, priority, paused);
-    }
-    else
-    {
-        // priority > 0
-        priorityIn(&_updatesPosList, callback, target, priority, paused);
-    }
+    // update hash entry for quick access
+    hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
+    hashElement->target = target;
+    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
+
+    UpdateEntry entry;
+    entry.callback = callback;
+    entry.target = target;
+    entry.hashEntry = hashElement;
+    entry.priority = priority;
+    entry.paused = paused;
+    entry.markedForDeletion = false;
+
+    // merged at the beginning of the next tick, or at the end of this one, so (un)scheduling many targets is linear
+    hashElement->pending = true;
+    hashElement->index = _updateEntriesToAdd.size();
+    _updateEntriesToAdd.push_back(std::move(entry));
+    _updateEntriesDirty = true;
 }
 
 bool Scheduler::isScheduled(const std::string& key, const void *target) const
@@ -534,27 +717,17 @@ bool Scheduler::isScheduled(const std::string& key, const void *target) const
     return false;
 }
 
-void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
+void Scheduler::removeUpdateFromHash(tHashUpdateEntry *element)
 {
-    tHashUpdateEntry *element = nullptr;
-
-    HASH_FIND_PTR(_hashForUpdates, &entry->target, element);
-    if (element)
-    {
-        // list entry
-        DL_DELETE(*element->list, element->entry);
-        if (!_updateHashLocked)
-            CC_SAFE_DELETE(element->entry);
-        else
-        {
-            element->entry->markedForDeletion = true;
-            _updateDeleteVector.push_back(element->entry);
-        }
-
-        // hash entry
-        HASH_DEL(_hashForUpdates, element);
-        free(element);
-    }
+    // the entry is erased by flushUpdateEntries(), it may be the one being called
+    auto& entry = getUpdateEntry(element);
+    entry.markedForDeletion = true;
+    entry.hashEntry = nullptr;
+    _updateEntriesDirty = true;
+
+    // hash entry
+    HASH_DEL(_hashForUpdates, element);
+    free(element);
 }
 
 void Scheduler::unscheduleUpdate(void *target)
@@ -567,7 +740,7 @@ void Scheduler::unscheduleUpdate(void *target)
     tHashUpdateEntry *element = nullptr;
     HASH_FIND_PTR(_hashForUpdates, &target, element);
     if (element)
-        this->removeUpdateFromHash(element->entry);
+        this->removeUpdateFromHash(element);
 }
 
 void Scheduler::unscheduleAll(void)
@@ -590,33 +763,16 @@ void Scheduler::unscheduleAllWithMinPriority(int minPriority)
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
+    for (auto entries : { &_updateEntries, &_updateEntriesToAdd })
     {
-        DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+        for (const auto& entry : *entries)
         {
-            if(entry->priority >= minPriority)
+            if (! entry.markedForDeletion && entry.priority >= minPriority)
             {
-                unscheduleUpdate(entry->target);
+                unscheduleUpdate(entry.target);
             }
         }
     }
-
-    if(minPriority <= 0)
-    {
-        DL_FOREACH_SAFE(_updates0List, entry, tmp)
-        {
-            unscheduleUpdate(entry->target);
-        }
-    }
-
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
-    {
-        if(entry->priority >= minPriority)
-        {
-            unscheduleUpdate(entry->target);
-        }
-    }
 #if CC_ENABLE_SCRIPT_BINDING
     _scriptHandlerEntries.clear();
 #endif
@@ -642,6 +798,7 @@ void Scheduler::unscheduleAllForTarget(void *target)
             element->currentTimer->retain();
             element->currentTimer->setAborted();
         }
+        removeTimers(element);
         ccArrayRemoveAllObjects(element->timers);
 
         if (_currentTarget == element)
@@ -690,7 +847,7 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = false;
+        setTimersPaused(element, false);
     }
 
     // update selector
@@ -698,8 +855,7 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
     if (elementUpdate)
     {
-        CCASSERT(elementUpdate->entry != nullptr, "elementUpdate's entry can't be nullptr!");
-        elementUpdate->entry->paused = false;
+        getUpdateEntry(elementUpdate).paused = false;
     }
 }
 
@@ -712,7 +868,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
     }
 
     // update selector
@@ -720,8 +876,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
     if (elementUpdate)
     {
-        CCASSERT(elementUpdate->entry != nullptr, "elementUpdate's entry can't be nullptr!");
-        elementUpdate->entry->paused = true;
+        getUpdateEntry(elementUpdate).paused = true;
     }
 }
 
@@ -742,7 +897,7 @@ bool Scheduler::isTargetPaused(void *target)
     HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
     if ( elementUpdate )
     {
-        return elementUpdate->entry->paused;
+        return getUpdateEntry(elementUpdate).paused;
     }
     
     return false;  // should never get here
@@ -761,42 +916,23 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
         idsWithSelectors.insert(element->target);
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
+    for (auto entries : { &_updateEntries, &_updateEntriesToAdd })
     {
-        DL_FOREACH_SAFE( _updatesNegList, entry, tmp ) 
+        for (auto& entry : *entries)
         {
-            if(entry->priority >= minPriority)
+            if (! entry.markedForDeletion && entry.priority >= minPriority)
             {
-                entry->paused = true;
-                idsWithSelectors.insert(entry->target);
+                entry.paused = true;
+                idsWithSelectors.insert(entry.target);
             }
         }
     }
 
-    if(minPriority <= 0)
-    {
-        DL_FOREACH_SAFE( _updates0List, entry, tmp )
-        {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
-        }
-    }
-
-    DL_FOREACH_SAFE( _updatesPosList, entry, tmp ) 
-    {
-        if(entry->priority >= minPriority) 
-        {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
-        }
-    }
-
     return idsWithSelectors;
 }
 
@@ -808,20 +944,103 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
 }
 
 void Scheduler::performFunctionInCocosThread(std::function<void ()> function)
+{
+    performFunctionInCocosThread<std::function<void()>>(std::move(function));
+}
+
+void Scheduler::performFunctionInCocosThreadOverflow(std::function<void()>&& function)
 {
     std::lock_guard<std::mutex> lock(_performMutex);
+    _functionsOverflowing.store(true, std::memory_order_release);
     _functionsToPerform.push_back(std::move(function));
 }
 
 void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
 {
     std::unique_lock<std::mutex> lock(_performMutex);
+    _functionQueue.discardAll();
     _functionsToPerform.clear();
+    _functionsOverflowing.store(false, std::memory_order_release);
+    _performBatchDiscarded.store(true, std::memory_order_release);
+}
+
+void Scheduler::performFunctions()
+{
+    // Testing is faster than locking / unlocking.
+    // And almost never there will be functions scheduled to be called.
+    if (_performBatchIndex >= _performBatch.size()
+        && !_functionQueue.isReady()
+        && !_functionsOverflowing.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    CC_PROFILE_ZONE("Scheduler::performFunctions");
+
+    auto start = std::chrono::steady_clock::now();
+    auto isOutOfTime = [this, &start]() {
+        return _performFunctionsTimeBudget > 0
+            && std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() >= _performFunctionsTimeBudget;
+    };
+
+    bool batchTaken = false;
+    for (;;)
+    {
+        // what is left of the overflow functions, they are older than the ones in the queue
+        if (_performBatchDiscarded.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(_performMutex);
+            if (_performBatchDiscarded.load(std::memory_order_relaxed))
+            {
+                _performBatch.clear();
+                _performBatchIndex = 0;
+                _performBatchDiscarded.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        while (_performBatchIndex < _performBatch.size())
+        {
+            auto function = std::move(_performBatch[_performBatchIndex++]);
+            function();
+            if (isOutOfTime())
+            {
+                return;
+            }
+        }
+        _performBatch.clear();
+        _performBatchIndex = 0;
+
+        while (_functionQueue.runOne())
+        {
+            if (isOutOfTime())
+            {
+                return;
+            }
+        }
+
+        // the functions that didn't fit the queue, once per frame so a flood of functions can't stall the frame
+        if (batchTaken || !_functionsOverflowing.load(std::memory_order_acquire))
+        {
+            break;
+        }
+
+        // fixed #4123: the functions must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
+        std::lock_guard<std::mutex> lock(_performMutex);
+        _performBatch.swap(_functionsToPerform);
+        _functionsOverflowing.store(false, std::memory_order_release);
+        _performBatchDiscarded.store(false, std::memory_order_relaxed);
+        batchTaken = true;
+    }
 }
 
 // main loop
 void Scheduler::update(float dt)
 {
+    CC_PROFILE_ZONE("Scheduler::update");
+
+    // add the updates scheduled since the last tick
+    flushUpdateEntries();
+
     _updateHashLocked = true;
 
     if (_timeScale != 1.0f)
@@ -833,86 +1052,72 @@ void Scheduler::update(float dt)
     // Selector callbacks
     //
 
-    // Iterate over all the Updates' selectors
-    tListEntry *entry, *tmp;
-
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+    // Iterate over all the Updates' selectors, sorted by priority.
+    // The vector is not resized while _updateHashLocked is set.
+    for (size_t i = 0, size = _updateEntries.size(); i < size; ++i)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        auto& entry = _updateEntries[i];
+        if ((! entry.paused) && (! entry.markedForDeletion))
         {
-            entry->callback(dt);
+            entry.callback(dt);
         }
     }
 
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, entry, tmp)
-    {
-        if ((! entry->paused) && (! entry->markedForDeletion))
-        {
-            entry->callback(dt);
-        }
-    }
+    // Update the custom selectors that expire during this frame, the others are not touched
+    _timerTime += dt;
+    _timerWheel.advance((long long)std::floor(_timerTime * TimerWheel::TICKS_PER_SECOND));
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    const auto& expiredTimers = _timerWheel.getExpiredTimers();
+    for (size_t i = 0; i < expiredTimers.size(); ++i)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        // nullptr when unscheduled or paused by a previous callback
+        Timer *timer = expiredTimers[i];
+        if (timer == nullptr)
         {
-            entry->callback(dt);
+            continue;
         }
-    }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
-    {
+        _timerWheel.remove(timer);
+
+        tHashTimerEntry *elt = timer->_entry;
+        CCASSERT(!elt->paused, "A paused timer should not be in the wheel");
+        CCASSERT(!timer->isAborted(), "An aborted timer should not be updated");
         _currentTarget = elt;
         _currentTargetSalvaged = false;
+        elt->currentTimer = timer;
 
-        if (! _currentTarget->paused)
-        {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                CCASSERT
-                  ( !elt->currentTimer->isAborted(),
-                    "An aborted timer should not be updated" );
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimer->isAborted())
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
+        float elapsed = (float)(_timerTime - timer->_lastUpdateTime);
+        timer->_lastUpdateTime = _timerTime;
+        timer->update(elapsed);
 
-                elt->currentTimer = nullptr;
-            }
+        if (timer->isAborted())
+        {
+            // The currentTimer told the remove itself. To prevent the timer from
+            // accidentally deallocating itself before finishing its step, we retained
+            // it. Now that step is done, it's safe to release it.
+            timer->release();
+        }
+        else if (! elt->paused)
+        {
+            linkTimer(timer);
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
+        elt->currentTimer = nullptr;
 
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
+        if (_currentTargetSalvaged && elt->timers->num == 0)
         {
-            removeHashElement(_currentTarget);
+            removeHashElement(elt);
         }
     }
- 
-    // delete all updates that are removed in update
-    for (auto &e : _updateDeleteVector)
-        delete e;
-
-    _updateDeleteVector.clear();
+    _timerWheel.clearExpiredTimers();
 
     _updateHashLocked = false;
     _currentTarget = nullptr;
 
+    // remove the updates unscheduled and add the ones scheduled during this tick
+    flushUpdateEntries();
+
 #if CC_ENABLE_SCRIPT_BINDING
     //
     // Script callbacks
@@ -938,19 +1143,7 @@ void Scheduler::update(float dt)
     //
     // Functions allocated from another thread
     //
-
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = std::move(_functionsToPerform);
-        _performMutex.unlock();
-        
-        for (const auto &function : temp) {
-            function();
-        }
-    }
+    performFunctions();
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
@@ -989,15 +1182,18 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                startTimer(timer);
                 return;
             }
         }
         ccArrayEnsureExtraCapacity(element->timers, 1);
     }
-    
+
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
+    timer->_entry = element;
     ccArrayAppendObject(element->timers, timer);
+    startTimer(timer);
     timer->release();
 }
 
@@ -1062,14 +1258,9 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
                     timer->setAborted();
                 }
                 
+                _timerWheel.remove(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
                 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
                 if (element->timers->num == 0)
                 {
                     if (_currentTarget == element)
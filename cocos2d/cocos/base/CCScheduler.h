@@ -29,17 +29,22 @@ THE SOFTWARE.
 #ifndef __CCSCHEDULER_H__
 #define __CCSCHEDULER_H__
 
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <set>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
+#include "base/CCFunctionQueue.h"
 #include "base/uthash.h"
 
 NS_CC_BEGIN
 
 class Scheduler;
+class TimerWheel;
+struct _hashSelectorEntry;
 
 typedef std::function<void(float)> ccSchedulerFunc;
 
@@ -61,6 +66,11 @@ public:
     
     /** triggers the timer */
     void update(float dt);
+
+    /** Returns the time left before the next call to update() may trigger the timer.
+     A value <= 0 means that the timer has to be updated on the next frame.
+     */
+    float getTimeToNextTrigger() const;
     
 protected:
     Scheduler* _scheduler; // weak ref
@@ -72,6 +82,18 @@ protected:
     float _delay;
     float _interval;
     bool _aborted;
+
+private:
+    friend class Scheduler;
+    friend class TimerWheel;
+
+    // bookkeeping of the Scheduler's timer wheel
+    struct _hashSelectorEntry* _entry; // the target entry owning this timer
+    double _lastUpdateTime;            // scheduler time of the last update
+    float _pausedTime;                 // time accumulated before the target was paused
+    long long _wheelDeadline;
+    int _wheelSlot;                    // -1 when not in the wheel
+    int _wheelIndex;
 };
 
 
@@ -131,6 +153,55 @@ private:
 
 #endif
 
+/** A hierarchical timer wheel, used by the Scheduler to only update the timers that are about to expire.
+
+ Time is measured in ticks of 1 millisecond of scheduler time. The first level has one slot per tick,
+ each of the next levels has 64 slots covering 64 slots of the level below. A timer is stored in the slot
+ of the lowest level that can hold its deadline and moves down one level each time the wheel reaches
+ its slot, until it lands in the first level and expires.
+ */
+class CC_DLL TimerWheel
+{
+public:
+    static const int TICKS_PER_SECOND = 1000;
+
+    TimerWheel();
+
+    /** Adds a timer expiring at the given tick. Timers whose deadline already passed expire on the next advance(). */
+    void add(Timer* timer, long long deadline);
+    /** Removes a timer from the wheel. Does nothing if the timer is not in the wheel. */
+    void remove(Timer* timer);
+    /** Moves the wheel to the given tick and collects the timers that expired in getExpiredTimers(). */
+    void advance(long long tick);
+    /** Returns the timers collected by the last advance().
+     Removed timers are replaced by nullptr, so the vector can be iterated while timers are removed.
+     */
+    const std::vector<Timer*>& getExpiredTimers() const { return _slots[EXPIRED_SLOT]; }
+    /** Forgets the expired timers. They must all have been removed or re-added. */
+    void clearExpiredTimers() { _slots[EXPIRED_SLOT].clear(); }
+
+    long long getTick() const { return _tick; }
+
+private:
+    static const int LEVEL0_BITS = 8;
+    static const int LEVEL0_SIZE = 1 << LEVEL0_BITS;
+    static const int LEVEL_BITS = 6;
+    static const int LEVEL_SIZE = 1 << LEVEL_BITS;
+    static const int LEVELS = 5;
+    static const int DUE_SLOT = LEVEL0_SIZE + (LEVELS - 1) * LEVEL_SIZE;
+    static const int EXPIRED_SLOT = DUE_SLOT + 1;
+    static const int SLOT_COUNT = EXPIRED_SLOT + 1;
+
+    int getSlot(long long deadline) const;
+    void insert(Timer* timer, int slot);
+    void cascade(int slot);
+    void expire(int slot);
+
+    long long _tick;
+    std::vector<Timer*> _slots[SLOT_COUNT];
+    std::vector<Timer*> _cascadeBuffer;
+};
+
 /**
  * @endcond
  */
@@ -140,8 +211,6 @@ private:
  * @{
  */
 
-struct _listEntry;
-struct _hashSelectorEntry;
 struct _hashUpdateEntry;
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -428,6 +497,41 @@ public:
      @js NA
      */
     void performFunctionInCocosThread(std::function<void()> function);
+
+    /** Calls a function on the cocos2d thread. Useful when you need to call a cocos2d function from another thread.
+     This function is thread safe and lock-free. Callables of up to FunctionQueue::INLINE_SIZE bytes are queued
+     without any heap allocation.
+     @param function The function to be run in cocos2d thread.
+     @since v3.17
+     @js NA
+     @lua NA
+     */
+    template <typename F>
+    void performFunctionInCocosThread(F&& function)
+    {
+        // once the queue overflowed, keep using the overflow vector until it is drained so the order is kept
+        if (!_functionsOverflowing.load(std::memory_order_acquire) && _functionQueue.tryPush(std::forward<F>(function)))
+        {
+            return;
+        }
+        performFunctionInCocosThreadOverflow(std::function<void()>(std::forward<F>(function)));
+    }
+
+    /** Sets how long the functions queued with performFunctionInCocosThread may run in one frame.
+     The functions that don't fit the budget are run in the next frames, in order. At least one function
+     is run per frame.
+     @param seconds The time budget in seconds, 0 means no limit. The default is 0.
+     @since v3.17
+     @js NA
+     */
+    void setPerformFunctionsTimeBudget(float seconds) { _performFunctionsTimeBudget = seconds; }
+
+    /** Gets the time budget of the functions queued with performFunctionInCocosThread.
+     @see setPerformFunctionsTimeBudget
+     @since v3.17
+     @js NA
+     */
+    float getPerformFunctionsTimeBudget() const { return _performFunctionsTimeBudget; }
     
     /**
      * Remove all pending functions queued to be performed with Scheduler::performFunctionInCocosThread
@@ -508,27 +612,49 @@ protected:
     void schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused);
     
     void removeHashElement(struct _hashSelectorEntry *element);
-    void removeUpdateFromHash(struct _listEntry *entry);
+    void removeUpdateFromHash(struct _hashUpdateEntry *element);
 
     // update specific
 
-    void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
-    void appendIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused);
+    struct UpdateEntry
+    {
+        ccSchedulerFunc callback;
+        void *target;
+        struct _hashUpdateEntry *hashEntry; // nullptr once unscheduled
+        int priority;
+        bool paused;
+        bool markedForDeletion; // selector will no longer be called and entry will be removed at the end of the tick
+    };
+
+    UpdateEntry& getUpdateEntry(struct _hashUpdateEntry *element);
+    void flushUpdateEntries();
+
+    // timer specific
+
+    void startTimer(Timer *timer);
+    void linkTimer(Timer *timer);
+    void setTimersPaused(struct _hashSelectorEntry *element, bool paused);
+    void removeTimers(struct _hashSelectorEntry *element);
+
+    // perform function specific
 
+    void performFunctionInCocosThreadOverflow(std::function<void()>&& function);
+    void performFunctions();
 
     float _timeScale;
 
     //
     // "updates with priority" stuff
     //
-    struct _listEntry *_updatesNegList;        // list of priority < 0
-    struct _listEntry *_updates0List;            // list priority == 0
-    struct _listEntry *_updatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
-    std::vector<struct _listEntry *> _updateDeleteVector; // the vector holds list entries that needs to be deleted after update
+    std::vector<UpdateEntry> _updateEntries;      // sorted by priority, called in that order
+    std::vector<UpdateEntry> _updateEntriesToAdd; // entries scheduled since the last flush, merged once per tick
+    bool _updateEntriesDirty;                     // entries were marked for deletion or added since the last flush
+    struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the update entries for pause,delete,etc
 
     // Used for "selectors with interval"
     struct _hashSelectorEntry *_hashForTimers;
+    TimerWheel _timerWheel;
+    double _timerTime; // scaled time elapsed since the creation of the scheduler
     struct _hashSelectorEntry *_currentTarget;
     bool _currentTargetSalvaged;
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
@@ -539,8 +665,14 @@ protected:
 #endif
     
     // Used for "perform Function"
+    FunctionQueue _functionQueue;
+    std::atomic<bool> _functionsOverflowing; // the queue was full, functions go to _functionsToPerform
     std::vector<std::function<void()>> _functionsToPerform;
     std::mutex _performMutex;
+    std::vector<std::function<void()>> _performBatch; // overflow functions being run by the cocos thread
+    size_t _performBatchIndex;
+    std::atomic<bool> _performBatchDiscarded;
+    float _performFunctionsTimeBudget;
 };
 
 // end of base group
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #define __CC_TOUCH_H__
 
 #include "base/CCRef.h"
+#include "base/CCObjectPool.h"
 #include "math/CCGeometry.h"
 
 NS_CC_BEGIN
@@ -44,6 +45,8 @@ NS_CC_BEGIN
 class CC_DLL Touch : public Ref
 {
 public:
+    CC_USE_OBJECT_POOL
+
     /** 
      * Dispatch mode, how the touches are dispatched.
      * @js NA
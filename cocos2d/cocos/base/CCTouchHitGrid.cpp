@@ -0,0 +1,250 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCTouchHitGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "2d/CCCamera.h"
+#include "2d/CCNode.h"
+#include "base/CCDirector.h"
+#include "base/CCEventListenerTouch.h"
+
+NS_CC_BEGIN
+
+const float TouchHitGrid::CELL_SIZE = 128.0f;
+
+unsigned int TouchHitGrid::s_nodeVersion = 0;
+
+// listeners spanning more cells than this are tried for every touch
+static const int MAX_CELLS_PER_ENTRY = 64;
+// the grids of the cameras least recently touched are dropped past this count
+static const size_t MAX_LAYERS = 8;
+
+// Node::visit() only reports the changes of the nodes it visits
+static bool isVisited(const Node* node)
+{
+    if (!node->isRunning())
+        return false;
+
+    for (; node != nullptr; node = node->getParent())
+    {
+        if (!node->isVisible())
+            return false;
+    }
+    return true;
+}
+
+static Rect getHitTestRect(const EventListenerTouchOneByOne* listener, const Node* node)
+{
+    const Rect& rect = listener->getHitTestRect();
+    return rect.equals(Rect::ZERO) ? Rect(Vec2::ZERO, node->getContentSize()) : rect;
+}
+
+// screen space bounds of a rect of the node, false if a corner is behind the camera
+static bool projectRect(const Node* node, const Rect& rect, const Mat4& viewProjection, const Size& winSize, Rect& bounds)
+{
+    const Mat4 transform = viewProjection * node->getNodeToWorldTransform();
+    const Vec2 corners[4] = { Vec2(rect.getMinX(), rect.getMinY()), Vec2(rect.getMaxX(), rect.getMinY()),
+                              Vec2(rect.getMinX(), rect.getMaxY()), Vec2(rect.getMaxX(), rect.getMaxY()) };
+
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        Vec4 clipPos;
+        transform.transformVector(Vec4(corners[i].x, corners[i].y, 0.0f, 1.0f), &clipPos);
+        if (clipPos.w <= 0.0f)
+            return false;
+
+        // same mapping as Camera::projectGL()
+        float x = (clipPos.x / clipPos.w + 1.0f) * 0.5f * winSize.width;
+        float y = (clipPos.y / clipPos.w + 1.0f) * 0.5f * winSize.height;
+        if (i == 0)
+        {
+            minX = maxX = x;
+            minY = maxY = y;
+        }
+        else
+        {
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+    }
+
+    // one point of slack, the exact test unprojects the touch instead
+    bounds.setRect(minX - 1.0f, minY - 1.0f, maxX - minX + 2.0f, maxY - minY + 2.0f);
+    return true;
+}
+
+TouchHitGrid::TouchHitGrid()
+{
+}
+
+bool TouchHitGrid::hitTest(const EventListenerTouchOneByOne* listener, const Camera* camera, const Vec2& location)
+{
+    Node* node = listener->getAssociatedNode();
+    if (node == nullptr)
+        return false;
+
+    return isScreenPointInRect(location, camera, node->getWorldToNodeTransform(), getHitTestRect(listener, node), nullptr);
+}
+
+void TouchHitGrid::invalidate()
+{
+    _layers.clear();
+}
+
+bool TouchHitGrid::isStale(const Layer& layer, const std::vector<EventListener*>& listeners, const Camera* camera) const
+{
+    return layer.hitTestVersion != EventListenerTouchOneByOne::s_hitTestVersion
+        || layer.nodeVersion != s_nodeVersion
+        || layer.listeners != listeners
+        || std::memcmp(layer.viewProjection.m, camera->getViewProjectionMatrix().m, sizeof(layer.viewProjection.m)) != 0;
+}
+
+void TouchHitGrid::build(Layer& layer, const std::vector<EventListener*>& listeners, const Camera* camera)
+{
+    layer.viewProjection = camera->getViewProjectionMatrix();
+    layer.hitTestVersion = EventListenerTouchOneByOne::s_hitTestVersion;
+    layer.nodeVersion = s_nodeVersion;
+    layer.listeners = listeners;
+    layer.cells.clear();
+    layer.always.clear();
+    layer.testedCount = 0;
+
+    const Size& winSize = Director::getInstance()->getWinSize();
+    for (int i = 0, count = (int)listeners.size(); i < count; ++i)
+    {
+        auto listener = static_cast<EventListenerTouchOneByOne*>(listeners[i]);
+        Node* node = listener->getAssociatedNode();
+
+        Rect bounds;
+        if (!listener->isHitTestEnabled() || node == nullptr || !isVisited(node)
+            || !projectRect(node, getHitTestRect(listener, node), layer.viewProjection, winSize, bounds))
+        {
+            layer.always.push_back(i);
+            continue;
+        }
+
+        // its changes and the changes of its ancestors invalidate the grid from now on
+        node->_touchHitGridIndexed = true;
+
+        ++layer.testedCount;
+
+        double minX = std::floor(bounds.getMinX() / CELL_SIZE);
+        double minY = std::floor(bounds.getMinY() / CELL_SIZE);
+        double maxX = std::floor(bounds.getMaxX() / CELL_SIZE);
+        double maxY = std::floor(bounds.getMaxY() / CELL_SIZE);
+        if ((maxX - minX + 1) * (maxY - minY + 1) > MAX_CELLS_PER_ENTRY)
+        {
+            layer.always.push_back(i);
+            continue;
+        }
+
+        for (int x = (int)minX; x <= (int)maxX; ++x)
+        {
+            for (int y = (int)minY; y <= (int)maxY; ++y)
+            {
+                layer.cells[makeKey(x, y)].push_back(i);
+            }
+        }
+    }
+}
+
+bool TouchHitGrid::collect(const Layer& layer, const std::vector<EventListener*>& listeners, const Vec2& location, FrameVector<EventListener*>& candidates)
+{
+    _indices.clear();
+
+    auto cell = layer.cells.find(makeKey((int)std::floor(location.x / CELL_SIZE), (int)std::floor(location.y / CELL_SIZE)));
+    if (cell != layer.cells.end())
+    {
+        _indices.insert(_indices.end(), cell->second.begin(), cell->second.end());
+    }
+    _indices.insert(_indices.end(), layer.always.begin(), layer.always.end());
+
+    // back to priority order
+    std::sort(_indices.begin(), _indices.end());
+
+    candidates.clear();
+    for (const auto& index : _indices)
+    {
+        // the listeners were changed without being re-sorted since the layer was built
+        if (index >= (int)listeners.size() || listeners[index] != layer.listeners[index])
+            return false;
+
+        candidates.push_back(listeners[index]);
+    }
+    return true;
+}
+
+bool TouchHitGrid::query(const std::vector<EventListener*>& listeners, const Camera* camera, const Vec2& location, FrameVector<EventListener*>& candidates)
+{
+    Layer* layer = nullptr;
+    for (auto& e : _layers)
+    {
+        if (e.camera == camera)
+        {
+            layer = &e;
+            break;
+        }
+    }
+
+    if (layer == nullptr)
+    {
+        // the cameras that weren't used for a while may be gone
+        if (_layers.size() >= MAX_LAYERS)
+        {
+            _layers.erase(std::min_element(_layers.begin(), _layers.end(), [](const Layer& a, const Layer& b) {
+                return a.lastUsedFrame < b.lastUsedFrame;
+            }));
+        }
+
+        _layers.push_back(Layer());
+        layer = &_layers.back();
+        layer->camera = camera;
+        build(*layer, listeners, camera);
+    }
+    else if (isStale(*layer, listeners, camera))
+    {
+        build(*layer, listeners, camera);
+    }
+    layer->lastUsedFrame = Director::getInstance()->getTotalFrames();
+
+    if (layer->testedCount == 0)
+        return false;
+
+    if (!collect(*layer, listeners, location, candidates))
+    {
+        build(*layer, listeners, camera);
+        collect(*layer, listeners, location, candidates);
+    }
+    return true;
+}
+
+NS_CC_END
@@ -0,0 +1,116 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCTOUCHHITGRID_H__
+#define __CCTOUCHHITGRID_H__
+
+#include <vector>
+#include <unordered_map>
+
+#include "math/CCGeometry.h"
+#include "math/Mat4.h"
+#include "base/CCFrameArena.h"
+
+/// @cond DO_NOT_SHOW
+
+NS_CC_BEGIN
+
+class Camera;
+class EventListener;
+class EventListenerTouchOneByOne;
+
+/** @class TouchHitGrid
+ * @brief Screen space broadphase of the one by one touch listeners that have hit testing enabled.
+ *
+ * For every camera, the bounds of the hit test rects are projected on the screen and bucketed in a uniform grid,
+ * so a touch only tries the listeners whose bounds contain it. Listeners without hit testing are always candidates.
+ * The grid of a camera is kept across frames and rebuilt lazily by the next touch once the listeners, their hit test
+ * settings, the camera or the transform of an indexed node or of one of its ancestors changed. The transforms are
+ * checked when the scene graph is visited, nodes that aren't visited (hidden ones) are always candidates.
+ * Used by EventDispatcher, see `EventListenerTouchOneByOne::setHitTestEnabled()`.
+ */
+class CC_DLL TouchHitGrid
+{
+public:
+    /** Size in points of one grid cell. */
+    static const float CELL_SIZE;
+
+    TouchHitGrid();
+
+    /** Drops the grids of all cameras, to be called when the listeners were reordered. */
+    void invalidate();
+
+    /** Called by Node::visit() when the transform or the content size of an indexed node changed. */
+    static void markNodeChanged() { ++s_nodeVersion; }
+
+    /** Collects the listeners that may claim a touch at `location` seen through `camera`, in the order of `listeners`.
+     *
+     * @param listeners The scene graph priority listeners of EventListenerTouchOneByOne, sorted by priority.
+     * @param camera The camera dispatching the touch.
+     * @param location The location of the touch in OpenGL coordinates.
+     * @param candidates Cleared and filled with the candidates, the listeners with hit testing still need the exact test.
+     * @return False when no listener has hit testing enabled: all listeners are candidates and `candidates` is left empty.
+     */
+    bool query(const std::vector<EventListener*>& listeners, const Camera* camera, const Vec2& location, FrameVector<EventListener*>& candidates);
+
+    /** The exact test: whether a touch at `location` seen through `camera` lands in the hit test rect of the listener. */
+    static bool hitTest(const EventListenerTouchOneByOne* listener, const Camera* camera, const Vec2& location);
+
+protected:
+    typedef long long CellKey;
+
+    struct Layer
+    {
+        // only compared, the camera may be gone
+        const Camera* camera;
+        Mat4 viewProjection;
+        unsigned int lastUsedFrame;
+        unsigned int hitTestVersion;
+        unsigned int nodeVersion;
+        // snapshot of the listeners the layer was built from, the cells store indices in it
+        std::vector<EventListener*> listeners;
+        std::unordered_map<CellKey, std::vector<int>> cells;
+        // listeners without hit testing, whose bounds can't be projected or cover too many cells
+        std::vector<int> always;
+        int testedCount;
+    };
+
+    CellKey makeKey(int x, int y) const { return ((CellKey)x << 32) | (unsigned int)y; }
+    bool isStale(const Layer& layer, const std::vector<EventListener*>& listeners, const Camera* camera) const;
+    void build(Layer& layer, const std::vector<EventListener*>& listeners, const Camera* camera);
+    bool collect(const Layer& layer, const std::vector<EventListener*>& listeners, const Vec2& location, FrameVector<EventListener*>& candidates);
+
+    std::vector<Layer> _layers;
+    std::vector<int> _indices;
+
+    // incremented when an indexed node changed
+    static unsigned int s_nodeVersion;
+};
+
+NS_CC_END
+
+/// @endcond
+
+#endif // __CCTOUCHHITGRID_H__
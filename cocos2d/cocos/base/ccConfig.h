@@ -247,6 +247,16 @@ THE SOFTWARE.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_FRAME_PROFILER
+ * If enabled, the zones declared with CC_PROFILE_ZONE are compiled in and can be captured at runtime with
+ * FrameProfiler or the `profiler` console command. A zone costs one atomic load while no capture is running,
+ * so it is enabled by default, release builds included.
+ * To disable set it to 0.
+ */
+#ifndef CC_ENABLE_FRAME_PROFILER
+#define CC_ENABLE_FRAME_PROFILER 1
+#endif
+
 /** Enable Lua engine debug log. */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
@@ -384,6 +394,14 @@ THE SOFTWARE.
 # define CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE 0
 # endif//CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
 
+/** @def CC_ENABLE_OBJECT_POOL
+ * Allocate the classes using CC_USE_OBJECT_POOL, like Node, Action and Touch, from the ObjectPool
+ * instead of the global new and delete.
+ */
+#ifndef CC_ENABLE_OBJECT_POOL
+# define CC_ENABLE_OBJECT_POOL 0
+#endif
+
 /** @def CC_ALLOCATOR_GLOBAL
  * Specify allocator to use for global allocator.
  */
@@ -31,7 +31,7 @@ THE SOFTWARE.
 #include "md5/md5.h"
 
 #include "base/CCDirector.h"
-#include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/CCEventDispatcher.h"
 #include "base/base64.h"
 #include "base/ccUTF8.h"
@@ -129,9 +129,9 @@ void onCaptureScreen(const std::function<void(bool, const std::string&)>& afterC
                 outputFile = FileUtils::getInstance()->getWritablePath() + filename;
             }
 
-            // Save image in AsyncTaskPool::TaskType::TASK_IO thread, and call afterCaptured in mainThread
+            // Save image in a JobSystem worker, and call afterCaptured in mainThread
             static bool succeedSaveToFile = false;
-            std::function<void(void*)> mainThread = [afterCaptured, outputFile](void* /*param*/)
+            std::function<void()> mainThread = [afterCaptured, outputFile]()
             {
                 if (afterCaptured)
                 {
@@ -140,11 +140,11 @@ void onCaptureScreen(const std::function<void(bool, const std::string&)>& afterC
                 startedCapture = false;
             };
 
-            AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, std::move(mainThread), nullptr, [image, outputFile]()
+            JobSystem::getInstance()->schedule([image, outputFile]()
             {
                 succeedSaveToFile = image->saveToFile(outputFile);
                 delete image;
-            });
+            }, std::move(mainThread));
         }
         else
         {
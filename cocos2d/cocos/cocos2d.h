@@ -40,6 +40,7 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -49,6 +50,10 @@ THE SOFTWARE.
 #include "base/CCIMEDispatcher.h"
 #include "base/CCMap.h"
 #include "base/CCNS.h"
+#include "base/CCObjectPool.h"
+#include "base/CCFrameProfiler.h"
+#include "base/CCFrameArena.h"
+#include "base/CCFunctionQueue.h"
 #include "base/CCProfiling.h"
 #include "base/CCProperties.h"
 #include "base/CCRef.h"
@@ -136,6 +141,7 @@ THE SOFTWARE.
 #include "2d/CCProtectedNode.h"
 #include "2d/CCRenderTexture.h"
 #include "2d/CCScene.h"
+#include "2d/CCSpatialIndex.h"
 #include "2d/CCTransition.h"
 #include "2d/CCTransitionPageTurn.h"
 #include "2d/CCTransitionProgress.h"
@@ -176,6 +182,7 @@ THE SOFTWARE.
 #include "renderer/CCVertexIndexData.h"
 #include "renderer/CCFrameBuffer.h"
 #include "renderer/ccGLStateCache.h"
+#include "renderer/ccPixelConversion.h"
 #include "renderer/ccShaders.h"
 
 // physics
@@ -186,6 +193,7 @@ THE SOFTWARE.
 #include "physics/CCPhysicsWorld.h"
 
 // platform
+#include "platform/CCAssetPack.h"
 #include "platform/CCCommon.h"
 #include "platform/CCDevice.h"
 #include "platform/CCFileUtils.h"
@@ -242,6 +250,7 @@ THE SOFTWARE.
 #include "2d/CCSprite.h"
 #include "2d/CCAutoPolygon.h"
 #include "2d/CCSpriteBatchNode.h"
+#include "2d/CCSpriteInstanceBatch.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
 
@@ -0,0 +1,241 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCAssetPack.h"
+
+#include <cstring>
+#include <zlib.h>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t bucketCount;
+        uint32_t bucketsOffset;
+        uint32_t entriesOffset;
+        uint32_t namesOffset;
+        uint32_t namesSize;
+    };
+
+    const char MAGIC[4] = { 'C', 'C', 'P', 'K' };
+
+    static_assert(sizeof(Header) == 32, "the header of an asset pack is 32 bytes");
+    static_assert(sizeof(AssetPack::Entry) == 32, "the entries of an asset pack are 32 bytes");
+
+    // 32 bits FNV-1a, the offset basis is mixed with the seed
+    const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    const uint32_t FNV_PRIME = 16777619u;
+}
+
+AssetPack::AssetPack()
+: _entryCount(0)
+, _bucketCount(0)
+, _buckets(nullptr)
+, _entries(nullptr)
+, _names(nullptr)
+, _namesSize(0)
+{
+}
+
+AssetPack::~AssetPack()
+{
+}
+
+uint32_t AssetPack::hashPath(const char* path, size_t length, uint32_t seed)
+{
+    uint32_t hash = FNV_OFFSET_BASIS ^ seed;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(path[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+bool AssetPack::init(const std::string& path, const std::string& mountPoint)
+{
+    _path = path;
+    _mountPoint = mountPoint;
+    if (!_mountPoint.empty() && _mountPoint.back() != '/')
+        _mountPoint += '/';
+
+    // the index is read in place, the entries are only touched when they are read
+    _data = FileUtils::getInstance()->getContentsView(path, FileUtils::AccessPattern::RANDOM);
+    if (_data.isNull() || static_cast<size_t>(_data.getSize()) < sizeof(Header))
+    {
+        CCLOG("AssetPack: can't read %s", path.c_str());
+        return false;
+    }
+
+    const unsigned char* bytes = _data.getBytes();
+    const uint64_t size = static_cast<uint64_t>(_data.getSize());
+
+    Header header;
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    {
+        CCLOG("AssetPack: %s isn't an asset pack of version %u", path.c_str(), VERSION);
+        return false;
+    }
+
+    if (header.bucketsOffset % alignof(uint32_t) != 0 || header.entriesOffset % alignof(Entry) != 0
+        || header.bucketsOffset + (uint64_t)header.bucketCount * sizeof(uint32_t) > size
+        || header.entriesOffset + (uint64_t)header.entryCount * sizeof(Entry) > size
+        || header.namesOffset + (uint64_t)header.namesSize > size
+        || (header.entryCount > 0 && header.bucketCount == 0))
+    {
+        CCLOG("AssetPack: %s is truncated or corrupted", path.c_str());
+        return false;
+    }
+
+    _entryCount = header.entryCount;
+    _bucketCount = header.bucketCount;
+    _buckets = reinterpret_cast<const uint32_t*>(bytes + header.bucketsOffset);
+    _entries = reinterpret_cast<const Entry*>(bytes + header.entriesOffset);
+    _names = reinterpret_cast<const char*>(bytes + header.namesOffset);
+    _namesSize = header.namesSize;
+
+    for (uint32_t i = 0; i < _entryCount; ++i)
+    {
+        const Entry& entry = _entries[i];
+        if ((uint64_t)entry.nameOffset + entry.nameLength > _namesSize || entry.dataOffset + entry.storedSize > size)
+        {
+            CCLOG("AssetPack: %s has an invalid entry %u", path.c_str(), i);
+            return false;
+        }
+    }
+    return true;
+}
+
+int AssetPack::findEntry(const char* path, size_t length) const
+{
+    if (_entryCount == 0)
+        return -1;
+
+    uint32_t seed = _buckets[hashPath(path, length, 0) % _bucketCount];
+    uint32_t index = hashPath(path, length, seed) % _entryCount;
+
+    // the perfect hash maps any path to an entry, check it is the right one
+    const Entry& entry = _entries[index];
+    if (entry.nameLength != length || memcmp(_names + entry.nameOffset, path, length) != 0)
+        return -1;
+    return static_cast<int>(index);
+}
+
+int AssetPack::findEntryForFullPath(const std::string& fullPath) const
+{
+    if (fullPath.size() <= _mountPoint.size() || fullPath.compare(0, _mountPoint.size(), _mountPoint) != 0)
+        return -1;
+
+    return findEntry(fullPath.c_str() + _mountPoint.size(), fullPath.size() - _mountPoint.size());
+}
+
+uint32_t AssetPack::getEntrySize(int index) const
+{
+    CCASSERT(index >= 0 && static_cast<uint32_t>(index) < _entryCount, "Invalid entry index");
+    return getEntry(index).size;
+}
+
+bool AssetPack::inflateEntry(const Entry& entry, unsigned char* buffer) const
+{
+    const unsigned char* stored = _data.getBytes() + entry.dataOffset;
+    if (entry.compression == Compression::NONE)
+    {
+        if (entry.storedSize != entry.size)
+            return false;
+        memcpy(buffer, stored, entry.size);
+    }
+    else if (entry.compression == Compression::ZLIB)
+    {
+        uLongf length = entry.size;
+        if (uncompress(buffer, &length, stored, entry.storedSize) != Z_OK || length != entry.size)
+            return false;
+    }
+    else
+    {
+        return false;
+    }
+
+    return crc32(crc32(0L, Z_NULL, 0), buffer, entry.size) == entry.checksum;
+}
+
+FileUtils::Status AssetPack::readEntry(int index, ResizableBuffer* buffer) const
+{
+    CCASSERT(index >= 0 && static_cast<uint32_t>(index) < _entryCount, "Invalid entry index");
+    const Entry& entry = getEntry(index);
+
+    buffer->resize(entry.size);
+    if (entry.size > 0 && !inflateEntry(entry, static_cast<unsigned char*>(buffer->buffer())))
+    {
+        CCLOG("AssetPack: the entry %.*s of %s is corrupted", (int)entry.nameLength, _names + entry.nameOffset, _path.c_str());
+        buffer->resize(0);
+        return FileUtils::Status::ReadFailed;
+    }
+    return FileUtils::Status::OK;
+}
+
+FileView AssetPack::getEntryView(int index) const
+{
+    CCASSERT(index >= 0 && static_cast<uint32_t>(index) < _entryCount, "Invalid entry index");
+    const Entry& entry = getEntry(index);
+
+    FileView view;
+    if (entry.size == 0)
+        return view;
+
+    if (entry.compression == Compression::NONE && entry.storedSize == entry.size)
+    {
+        const unsigned char* stored = _data.getBytes() + entry.dataOffset;
+        if (crc32(crc32(0L, Z_NULL, 0), stored, entry.size) != entry.checksum)
+        {
+            CCLOG("AssetPack: the entry %.*s of %s is corrupted", (int)entry.nameLength, _names + entry.nameOffset, _path.c_str());
+            return view;
+        }
+
+        // share the mapping of the pack
+        view._owner = _data._owner;
+        view._bytes = stored;
+        view._size = entry.size;
+        return view;
+    }
+
+    auto data = std::make_shared<Data>();
+    ResizableBufferAdapter<Data> buffer(data.get());
+    if (readEntry(index, &buffer) == FileUtils::Status::OK)
+    {
+        view._bytes = data->getBytes();
+        view._size = data->getSize();
+        view._owner = std::move(data);
+    }
+    return view;
+}
+
+NS_CC_END
@@ -0,0 +1,144 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __PLATFORM_CCASSETPACK_H__
+#define __PLATFORM_CCASSETPACK_H__
+
+#include <string>
+#include <cstdint>
+
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/** @brief A read-only archive of resources mounted by FileUtils::mountAssetPack.
+ *
+ * Asset packs are built by tools/asset-pack/build_asset_pack.py. The pack is mapped in memory once,
+ * a file is found with a perfect hash of its path, so no stat nor open is needed to find or read a file.
+ *
+ * Layout, all the integers are little endian:
+ * - Header: "CCPK", version, entry count, bucket count, then the offsets of the buckets, the entries and the names, and the size of the names.
+ * - Buckets: one 32 bits seed per bucket. The entry of a path is at fnv1a(path, seeds[fnv1a(path, 0) % bucketCount]) % entryCount.
+ * - Entries: 32 bytes each, see AssetPack::Entry.
+ * - Names: the paths of the entries, relative to the mount point, without terminating '\0'.
+ * - Data: the contents of the entries, aligned to 16 bytes. Stored entries can be used in place, others are deflated with zlib.
+ *
+ * @since v3.17
+ */
+class CC_DLL AssetPack
+{
+public:
+    /** The compression of an entry. */
+    enum class Compression : uint32_t
+    {
+        NONE = 0,
+        ZLIB = 1
+    };
+
+    /** The entry of a file in the pack. */
+    struct Entry
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint64_t dataOffset;
+        uint32_t size;
+        uint32_t storedSize;
+        Compression compression;
+        /** CRC-32 of the uncompressed contents. */
+        uint32_t checksum;
+    };
+
+    static const uint32_t VERSION = 1;
+
+    AssetPack();
+    ~AssetPack();
+
+    /** Opens a pack file.
+     * @param path The path of the pack file.
+     * @param mountPoint The directory the files of the pack appear in, it should end with a '/'.
+     * @return true if the pack is valid.
+     */
+    bool init(const std::string& path, const std::string& mountPoint);
+
+    /** Gets the path of the pack file. */
+    const std::string& getPath() const { return _path; }
+
+    /** Gets the directory the files of the pack appear in. */
+    const std::string& getMountPoint() const { return _mountPoint; }
+
+    /** Gets the number of files in the pack. */
+    uint32_t getEntryCount() const { return _entryCount; }
+
+    /** Finds a file by its path relative to the mount point.
+     * @return The index of the entry, -1 if the pack doesn't contain the file.
+     */
+    int findEntry(const char* path, size_t length) const;
+
+    /** Finds a file by its full path, it must be under the mount point.
+     * @return The index of the entry, -1 if the pack doesn't contain the file.
+     */
+    int findEntryForFullPath(const std::string& fullPath) const;
+
+    /** Gets the uncompressed size of an entry. */
+    uint32_t getEntrySize(int index) const;
+
+    /** Reads the uncompressed contents of an entry and verifies its checksum. */
+    FileUtils::Status readEntry(int index, ResizableBuffer* buffer) const;
+
+    /** Gets a view on the contents of an entry.
+     * Stored entries aren't copied, the view shares the mapping of the pack.
+     * @return A null view if the entry can't be read or is corrupted.
+     */
+    FileView getEntryView(int index) const;
+
+    /** Computes the hash of a path used by the perfect hash table. */
+    static uint32_t hashPath(const char* path, size_t length, uint32_t seed);
+
+private:
+    const Entry& getEntry(int index) const { return _entries[index]; }
+    bool inflateEntry(const Entry& entry, unsigned char* buffer) const;
+
+    std::string _path;
+    std::string _mountPoint;
+    FileView _data;
+
+    uint32_t _entryCount;
+    uint32_t _bucketCount;
+    const uint32_t* _buckets;
+    const Entry* _entries;
+    const char* _names;
+    uint32_t _namesSize;
+};
+
+// end of platform group
+/** @} */
+
+NS_CC_END
+
+#endif // __PLATFORM_CCASSETPACK_H__
@@ -26,12 +26,16 @@ THE SOFTWARE.
 
 #include "platform/CCFileUtils.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <stack>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "platform/CCSAXParser.h"
+#include "platform/CCAssetPack.h"
 //#include "base/ccUtils.h"
 
 #include "tinyxml2/tinyxml2.h"
@@ -42,6 +46,19 @@ THE SOFTWARE.
 #endif
 #include <sys/stat.h>
 
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#define CC_FILEUTILS_USE_MMAP 1
+#define CC_FILEUTILS_USE_DIRECTORY_LISTING 1
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#else
+#define CC_FILEUTILS_USE_MMAP 0
+#define CC_FILEUTILS_USE_DIRECTORY_LISTING 0
+#endif
+
 #define DECLARE_GUARD std::lock_guard<std::recursive_mutex> mutexGuard(_mutex)
 
 NS_CC_BEGIN
@@ -396,6 +413,8 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+        purgeCachedEntriesForPath(fullPath);
 
     delete doc;
     return ret;
@@ -436,6 +455,8 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+        purgeCachedEntriesForPath(fullPath);
 
     delete doc;
     return ret;
@@ -551,10 +572,18 @@ void FileUtils::setDelegate(FileUtils *delegate)
         delete s_sharedFileUtils;
 
     s_sharedFileUtils = delegate;
+    // delegates usually override getContents to transform the contents of the files
+    if (delegate)
+    {
+        delegate->setUseMappedFiles(false);
+        delegate->_useDirectoryListings = false;
+    }
 }
 
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _useDirectoryListings(true)
+    , _useMappedFiles(true)
+    , _writablePath("")
 {
 }
 
@@ -599,6 +628,7 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath) c
 
         fclose(fp);
 
+        purgeCachedEntriesForPath(fullPath);
         return true;
     } while (0);
 
@@ -625,6 +655,10 @@ void FileUtils::purgeCachedEntries()
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _directoryListings.clear();
+
+    std::lock_guard<std::mutex> lock(_mappedFilesMutex);
+    _mappedFiles.clear();
 }
 
 std::string FileUtils::getStringFromFile(const std::string& filename) const
@@ -670,6 +704,10 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     if (fullPath.empty())
         return Status::NotExists;
 
+    Status status;
+    if (getContentsFromAssetPacks(fullPath, buffer, &status))
+        return status;
+
     std::string suitableFullPath = fs->getSuitableFOpen(fullPath);
 
     struct stat statBuf;
@@ -699,6 +737,263 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     return Status::OK;
 }
 
+FileUtils::Status FileUtils::getContentsPrefix(const std::string& filename, size_t maxSize, ResizableBuffer* buffer) const
+{
+    if (filename.empty())
+        return Status::NotExists;
+
+    std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return Status::NotExists;
+
+    // the asset pack entries are mapped, and an overridden getContents may need the whole file
+    if (!_useMappedFiles || findInAssetPacks(fullPath, nullptr) >= 0)
+    {
+        FileView view = getContentsView(fullPath, AccessPattern::NORMAL);
+        if (view.isNull())
+            return Status::ReadFailed;
+
+        size_t size = std::min(maxSize, static_cast<size_t>(view.getSize()));
+        buffer->resize(size);
+        memcpy(buffer->buffer(), view.getBytes(), size);
+        return Status::OK;
+    }
+
+    std::string suitableFullPath = getSuitableFOpen(fullPath);
+
+    struct stat statBuf;
+    if (stat(suitableFullPath.c_str(), &statBuf) == -1) {
+        return Status::ReadFailed;
+    }
+
+    if (!(statBuf.st_mode & S_IFREG)) {
+        return Status::NotRegularFileType;
+    }
+
+    FILE *fp = fopen(suitableFullPath.c_str(), "rb");
+    if (!fp)
+        return Status::OpenFailed;
+
+    size_t size = std::min(maxSize, static_cast<size_t>(statBuf.st_size));
+
+    buffer->resize(size);
+    size_t readsize = fread(buffer->buffer(), 1, size, fp);
+    fclose(fp);
+
+    if (readsize < size) {
+        buffer->resize(readsize);
+        return Status::ReadFailed;
+    }
+
+    return Status::OK;
+}
+
+// files smaller than this are cheaper to read than to map
+static const off_t MAPPED_FILE_MIN_SIZE = 64 * 1024;
+// unused mappings are dropped from the cache past this count
+static const size_t MAX_MAPPED_FILES = 32;
+
+struct FileUtils::MappedFile
+{
+    void* address;
+    size_t size;
+#if CC_FILEUTILS_USE_MMAP
+    dev_t device;
+    ino_t inode;
+    time_t modified;
+
+    ~MappedFile()
+    {
+        munmap(address, size);
+    }
+#endif
+};
+
+Data FileView::copy() const
+{
+    Data data;
+    if (!isNull())
+        data.copy(_bytes, _size);
+    return data;
+}
+
+FileView FileUtils::makeFileView(std::shared_ptr<const void> owner, const unsigned char* bytes, ssize_t size)
+{
+    FileView view;
+    view._bytes = bytes;
+    view._size = size;
+    view._owner = std::move(owner);
+    return view;
+}
+
+void FileUtils::setUseMappedFiles(bool useMappedFiles)
+{
+    _useMappedFiles = useMappedFiles;
+}
+
+bool FileUtils::isUseMappedFiles() const
+{
+    return _useMappedFiles;
+}
+
+FileView FileUtils::getContentsView(const std::string& filename, AccessPattern pattern) const
+{
+    FileView view;
+    if (filename.empty())
+        return view;
+
+    std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return view;
+
+    // otherwise an overridden getContents would be bypassed
+    if (_useMappedFiles)
+    {
+        std::shared_ptr<AssetPack> pack;
+        int index = findInAssetPacks(fullPath, &pack);
+        if (index >= 0)
+            return pack->getEntryView(index);
+    }
+
+#if CC_FILEUTILS_USE_MMAP
+    struct stat statBuf;
+    if (_useMappedFiles && stat(fullPath.c_str(), &statBuf) == 0 && S_ISREG(statBuf.st_mode) && statBuf.st_size >= MAPPED_FILE_MIN_SIZE)
+    {
+        std::shared_ptr<MappedFile> mappedFile;
+        {
+            std::lock_guard<std::mutex> lock(_mappedFilesMutex);
+            auto it = _mappedFiles.find(fullPath);
+            if (it != _mappedFiles.end())
+            {
+                auto& cached = it->second;
+                // the file was replaced since it was mapped
+                if (cached->device == statBuf.st_dev && cached->inode == statBuf.st_ino && cached->modified == statBuf.st_mtime
+                    && cached->size == static_cast<size_t>(statBuf.st_size))
+                    mappedFile = cached;
+                else
+                    _mappedFiles.erase(it);
+            }
+        }
+
+        if (!mappedFile)
+        {
+            int fd = open(fullPath.c_str(), O_RDONLY);
+            if (fd != -1)
+            {
+                void* address = mmap(nullptr, statBuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                close(fd);
+
+                if (address != MAP_FAILED)
+                {
+                    mappedFile = std::make_shared<MappedFile>();
+                    mappedFile->address = address;
+                    mappedFile->size = statBuf.st_size;
+                    mappedFile->device = statBuf.st_dev;
+                    mappedFile->inode = statBuf.st_ino;
+                    mappedFile->modified = statBuf.st_mtime;
+
+                    std::lock_guard<std::mutex> lock(_mappedFilesMutex);
+                    if (_mappedFiles.size() >= MAX_MAPPED_FILES)
+                    {
+                        for (auto it = _mappedFiles.begin(); it != _mappedFiles.end();)
+                        {
+                            if (it->second.use_count() == 1)
+                                it = _mappedFiles.erase(it);
+                            else
+                                ++it;
+                        }
+                    }
+                    _mappedFiles[fullPath] = mappedFile;
+                }
+            }
+        }
+
+        if (mappedFile)
+        {
+            int advice = MADV_NORMAL;
+            if (pattern == AccessPattern::SEQUENTIAL)
+                advice = MADV_SEQUENTIAL;
+            else if (pattern == AccessPattern::RANDOM)
+                advice = MADV_RANDOM;
+            madvise(mappedFile->address, mappedFile->size, advice);
+
+            view._bytes = static_cast<const unsigned char*>(mappedFile->address);
+            view._size = static_cast<ssize_t>(mappedFile->size);
+            view._owner = std::move(mappedFile);
+            return view;
+        }
+    }
+#else
+    CC_UNUSED_PARAM(pattern);
+#endif
+
+    auto data = std::make_shared<Data>();
+    if (getContents(fullPath, data.get()) == Status::OK && !data->isNull())
+    {
+        view._bytes = data->getBytes();
+        view._size = data->getSize();
+        view._owner = std::move(data);
+    }
+    return view;
+}
+
+bool FileUtils::mountAssetPack(const std::string& packPath, const std::string& mountPoint)
+{
+    auto pack = std::make_shared<AssetPack>();
+    if (!pack->init(fullPathForFilename(packPath), mountPoint.empty() ? _defaultResRootPath : mountPoint))
+        return false;
+
+    DECLARE_GUARD;
+    unmountAssetPack(packPath);
+    _assetPacks.push_back(pack);
+    // the packs are looked up before the file system, forget the files found there
+    _fullPathCache.clear();
+    return true;
+}
+
+bool FileUtils::unmountAssetPack(const std::string& packPath)
+{
+    DECLARE_GUARD;
+    std::string fullPath = fullPathForFilename(packPath);
+    for (auto it = _assetPacks.begin(); it != _assetPacks.end(); ++it)
+    {
+        if ((*it)->getPath() == fullPath)
+        {
+            _assetPacks.erase(it);
+            _fullPathCache.clear();
+            return true;
+        }
+    }
+    return false;
+}
+
+int FileUtils::findInAssetPacks(const std::string& fullPath, std::shared_ptr<AssetPack>* pack) const
+{
+    DECLARE_GUARD;
+    for (auto it = _assetPacks.rbegin(); it != _assetPacks.rend(); ++it)
+    {
+        int index = (*it)->findEntryForFullPath(fullPath);
+        if (index >= 0)
+        {
+            if (pack)
+                *pack = *it;
+            return index;
+        }
+    }
+    return -1;
+}
+
+bool FileUtils::getContentsFromAssetPacks(const std::string& fullPath, ResizableBuffer* buffer, Status* status) const
+{
+    std::shared_ptr<AssetPack> pack;
+    int index = findInAssetPacks(fullPath, &pack);
+    if (index < 0)
+        return false;
+
+    *status = pack->readEntry(index, buffer);
+    return true;
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, ssize_t *size) const
 {
     CCASSERT(!filename.empty() && size != nullptr && mode != nullptr, "Invalid parameters.");
@@ -816,9 +1111,6 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
 
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
-    
-    DECLARE_GUARD;
-
     if (filename.empty())
     {
         return "";
@@ -829,34 +1121,89 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if(cacheIter != _fullPathCache.end())
+    // Already Cached ? The cache is thread safe, loaders don't wait for each other
+    std::string fullpath;
+    if (_fullPathCache.find(filename, fullpath))
     {
-        return cacheIter->second;
+        if (fullpath.empty() && isPopupNotify())
+        {
+            CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
+        }
+        return fullpath;
     }
 
+    DECLARE_GUARD;
+
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
 
-    std::string fullpath;
+    size_t pos = newFilename.find_last_of('/');
+    std::string file_path = (pos != std::string::npos) ? newFilename.substr(0, pos + 1) : "";
+    std::string file = (pos != std::string::npos) ? newFilename.substr(pos + 1) : newFilename;
+
+    // the asset packs are looked up first, they don't need any stat
+    if (!_assetPacks.empty())
+    {
+        for (const auto& searchIt : _searchPathArray)
+        {
+            for (const auto& resolutionIt : _searchResolutionsOrderArray)
+            {
+                // same path as getPathForFilename would make
+                fullpath = searchIt + file_path + resolutionIt;
+                if (!fullpath.empty() && fullpath.back() != '/')
+                    fullpath += '/';
+                fullpath += file;
+
+                if (findInAssetPacks(fullpath, nullptr) >= 0)
+                {
+                    _fullPathCache.insert(filename, fullpath);
+                    return fullpath;
+                }
+            }
+        }
+    }
 
+    std::string directory;
     for (const auto& searchIt : _searchPathArray)
     {
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            // searchPath + file_path + resourceDirectory
+            directory = searchIt + file_path + resolutionIt;
+            if (!directory.empty() && directory.back() != '/')
+                directory += '/';
+
+            // the files that may exist are still resolved by getPathForFilename, it may be overridden
+            if (isMissingFromDirectoryListing(directory, file))
+                fullpath.clear();
+            else
+                fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
 
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
-                _fullPathCache.emplace(filename, fullpath);
+                _fullPathCache.insert(filename, fullpath);
                 return fullpath;
             }
 
         }
     }
 
+    // remember the file is missing, it won't be searched again until the cache is purged,
+    // unless it may be downloaded to the writable path without FileUtils knowing
+    const std::string writablePath = getWritablePath();
+    bool searchesWritablePath = false;
+    for (const auto& searchIt : _searchPathArray)
+    {
+        if (!writablePath.empty() && searchIt.compare(0, writablePath.size(), writablePath) == 0)
+        {
+            searchesWritablePath = true;
+            break;
+        }
+    }
+    if (!searchesWritablePath)
+        _fullPathCache.insert(filename, "");
+
     if(isPopupNotify()){
         CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
@@ -865,6 +1212,108 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
     return "";
 }
 
+#if CC_FILEUTILS_USE_DIRECTORY_LISTING
+// file systems may be case insensitive (APFS, HFS+, FAT), so the names are compared ignoring the case
+static bool foldFileName(const char* name, std::string& folded)
+{
+    folded.clear();
+    for (; *name; ++name)
+    {
+        unsigned char c = static_cast<unsigned char>(*name);
+        // non ASCII names may also be normalized by the file system, they aren't compared
+        if (c >= 0x80)
+            return false;
+        folded += static_cast<char>(std::tolower(c));
+    }
+    return true;
+}
+#endif
+
+bool FileUtils::isMissingFromDirectoryListing(const std::string& directory, const std::string& filename) const
+{
+#if CC_FILEUTILS_USE_DIRECTORY_LISTING
+    if (!_useDirectoryListings)
+        return false;
+
+    std::string foldedName;
+    if (!foldFileName(filename.c_str(), foldedName))
+        return false;
+
+    DECLARE_GUARD;
+
+    auto it = _directoryListings.find(directory);
+    if (it == _directoryListings.end())
+    {
+        std::shared_ptr<std::unordered_set<std::string>> listing;
+
+        // files may be downloaded to the writable path without FileUtils knowing, don't list it
+        const std::string writablePath = getWritablePath();
+        if (!directory.empty() && directory[0] == '/'
+            && (writablePath.empty() || directory.compare(0, writablePath.size(), writablePath) != 0))
+        {
+            DIR* dir = opendir(directory.c_str());
+            if (dir)
+            {
+                listing = std::make_shared<std::unordered_set<std::string>>();
+                std::string folded;
+                while (struct dirent* entry = readdir(dir))
+                {
+                    if (entry->d_type == DT_DIR)
+                        continue;
+
+                    if (entry->d_type != DT_REG)
+                    {
+                        // symbolic links and file systems without d_type
+                        struct stat st;
+                        if (stat((directory + entry->d_name).c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+                            continue;
+                    }
+
+                    if (!foldFileName(entry->d_name, folded))
+                    {
+                        // a non ASCII name may match an ASCII one once folded by the file system
+                        listing.reset();
+                        break;
+                    }
+                    listing->insert(folded);
+                }
+                closedir(dir);
+            }
+            else if (errno == ENOENT || errno == ENOTDIR)
+            {
+                // a missing directory contains no file
+                listing = std::make_shared<std::unordered_set<std::string>>();
+            }
+        }
+        it = _directoryListings.emplace(directory, std::move(listing)).first;
+    }
+
+    return it->second && it->second->count(foldedName) == 0;
+#else
+    CC_UNUSED_PARAM(directory);
+    CC_UNUSED_PARAM(filename);
+    return false;
+#endif
+}
+
+void FileUtils::purgeCachedEntriesForPath(const std::string& fullPath) const
+{
+    DECLARE_GUARD;
+
+    // a new file may now be found
+    _fullPathCache.clearMissing();
+
+    // the listings of the parent directory and of its sub directories
+    std::string directory = fullPath.substr(0, fullPath.find_last_of('/') + 1);
+    for (auto it = _directoryListings.begin(); it != _directoryListings.end();)
+    {
+        if (it->first.compare(0, directory.size(), directory) == 0)
+            it = _directoryListings.erase(it);
+        else
+            ++it;
+    }
+}
+
 
 std::string FileUtils::fullPathForDirectory(const std::string &dir) const
 {
@@ -881,10 +1330,10 @@ std::string FileUtils::fullPathForDirectory(const std::string &dir) const
     }
 
     // Already Cached ?
-    auto cacheIter = _fullPathCacheDir.find(dir);
-    if(cacheIter != _fullPathCacheDir.end())
+    std::string cachedPath;
+    if (_fullPathCacheDir.find(dir, cachedPath))
     {
-        return cacheIter->second;
+        return cachedPath;
     }
     std::string longdir = dir;
     std::string fullpath;
@@ -904,7 +1353,7 @@ std::string FileUtils::fullPathForDirectory(const std::string &dir) const
             if (exists && !fullpath.empty())
             {
                 // Using the filename passed in as key.
-                _fullPathCacheDir.emplace(dir, fullpath);
+                _fullPathCacheDir.insert(dir, fullpath);
                 return fullpath;
             }
 
@@ -1078,9 +1527,14 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
     if (front) {
         _originalSearchPaths.insert(_originalSearchPaths.begin(), searchpath);
         _searchPathArray.insert(_searchPathArray.begin(), path);
+        // the new path takes precedence over the files already found
+        _fullPathCache.clear();
+        _fullPathCacheDir.clear();
     } else {
         _originalSearchPaths.push_back(searchpath);
         _searchPathArray.push_back(path);
+        // the files already found keep their full path, only the missing ones may be found now
+        _fullPathCache.clearMissing();
     }
 }
 
@@ -1131,7 +1585,7 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
-        return isFileExistInternal(filename);
+        return findInAssetPacks(filename, nullptr) >= 0 || isFileExistInternal(filename);
     }
     else
     {
@@ -1168,10 +1622,10 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
     }
 
     // Already Cached ?
-    auto cacheIter = _fullPathCacheDir.find(dirPath);
-    if( cacheIter != _fullPathCacheDir.end() )
+    std::string cachedPath;
+    if (_fullPathCacheDir.find(dirPath, cachedPath))
     {
-        return isDirectoryExistInternal(cacheIter->second);
+        return isDirectoryExistInternal(cachedPath);
     }
 
     std::string fullpath;
@@ -1183,7 +1637,7 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
             fullpath = fullPathForDirectory(searchIt + dirPath + resolutionIt);
             if (isDirectoryExistInternal(fullpath))
             {
-                _fullPathCacheDir.emplace(dirPath, fullpath);
+                _fullPathCacheDir.insert(dirPath, fullpath);
                 return true;
             }
         }
@@ -1406,6 +1860,8 @@ bool FileUtils::createDirectory(const std::string& path) const
             closedir(dir);
         }
     }
+
+    purgeCachedEntriesForPath(path);
     return true;
 }
 
@@ -1429,18 +1885,16 @@ bool FileUtils::removeDirectory(const std::string& path) const
 #if !defined(CC_TARGET_OS_TVOS)
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
-    if (nftw(path.c_str(), unlink_cb, 64, FTW_DEPTH | FTW_PHYS) == -1)
-        return false;
-    else
-        return true;
+    bool ret = nftw(path.c_str(), unlink_cb, 64, FTW_DEPTH | FTW_PHYS) != -1;
+    purgeCachedEntriesForPath(path);
+    return ret;
 #else
     std::string command = "rm -r ";
     // Path may include space.
     command += "\"" + path + "\"";
-    if (system(command.c_str()) >= 0)
-        return true;
-    else
-        return false;
+    bool ret = system(command.c_str()) >= 0;
+    purgeCachedEntriesForPath(path);
+    return ret;
 #endif // (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
 
 #else
@@ -1453,6 +1907,7 @@ bool FileUtils::removeFile(const std::string &path) const
     if (remove(path.c_str())) {
         return false;
     } else {
+        purgeCachedEntriesForPath(path);
         return true;
     }
 }
@@ -1469,6 +1924,9 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+
+    purgeCachedEntriesForPath(oldfullpath);
+    purgeCachedEntriesForPath(newfullpath);
     return true;
 }
 
@@ -1498,6 +1956,11 @@ long FileUtils::getFileSize(const std::string &filepath) const
             return 0;
     }
 
+    std::shared_ptr<AssetPack> pack;
+    int index = findInAssetPacks(fullpath, &pack);
+    if (index >= 0)
+        return static_cast<long>(pack->getEntrySize(index));
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat(fullpath.c_str(), &info);
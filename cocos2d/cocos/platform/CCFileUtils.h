@@ -29,14 +29,18 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 #include <mutex>
+#include <memory>
 
 #include "platform/CCPlatformMacros.h"
+#include "platform/CCFullPathCache.h"
 #include "base/ccTypes.h"
 #include "base/CCValue.h"
 #include "base/CCData.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/CCScheduler.h"
 #include "base/CCDirector.h"
 
@@ -118,6 +122,41 @@ public:
     }
 };
 
+/** @brief A read-only view on the contents of a file, returned by FileUtils::getContentsView.
+ * It exposes the same accessors as Data but doesn't own the bytes: they belong to a memory mapping
+ * of the file shared by all the views of that file, or to a private copy when the file can't be mapped.
+ * The bytes stay valid as long as a view refers to them, even after FileUtils::purgeCachedEntries.
+ * A mapped file must not be truncated or rewritten in place while a view on it is alive.
+ * @since v3.17
+ */
+class CC_DLL FileView
+{
+public:
+    FileView() : _bytes(nullptr), _size(0) {}
+
+    /** Gets the bytes of the file, nullptr if the file couldn't be read. */
+    const unsigned char* getBytes() const { return _bytes; }
+
+    /** Gets the size of the file in bytes. */
+    ssize_t getSize() const { return _size; }
+
+    /** Checks whether the view is empty. */
+    bool isNull() const { return _bytes == nullptr || _size == 0; }
+
+    /** Copies the bytes in a Data owning them. */
+    Data copy() const;
+
+private:
+    friend class FileUtils;
+    friend class AssetPack;
+
+    std::shared_ptr<const void> _owner;
+    const unsigned char* _bytes;
+    ssize_t _size;
+};
+
+class AssetPack;
+
 /** Helper class to handle file operations. */
 class CC_DLL FileUtils
 {
@@ -274,6 +313,98 @@ public:
     }
     virtual Status getContents(const std::string& filename, ResizableBuffer* buffer) const;
 
+    /** How the contents returned by getContentsView will be read. It is only a hint given to the system. */
+    enum class AccessPattern
+    {
+        NORMAL,
+        /** Read once from the beginning to the end, e.g. images, plists or json files. */
+        SEQUENTIAL,
+        /** Read here and there for a long time, e.g. font files or texture containers. */
+        RANDOM
+    };
+
+    /**
+     *  Gets a read-only view on the contents of a file without copying it.
+     *
+     *  On POSIX platforms, large files are memory mapped once and the mapping is cached,
+     *  so reading the same file again doesn't hit the disk nor copy anything.
+     *  On Android, the large assets stored uncompressed in the apk (e.g. images and asset packs) are mapped from the apk,
+     *  without being cached. Small files and files that can't be mapped (e.g. compressed apk assets or obb files)
+     *  are read with getContents.
+     *
+     *  @note Mapped files and asset pack entries don't go through getContents, see setUseMappedFiles.
+     *
+     *  @param[in] filename The resource file name which contains the path.
+     *  @param[in] pattern How the contents will be read.
+     *  @return The view on the contents of the file, a null view if the file couldn't be read.
+     *  @since v3.17
+     */
+    virtual FileView getContentsView(const std::string& filename, AccessPattern pattern = AccessPattern::SEQUENTIAL) const;
+
+    /**
+     *  Reads the beginning of a file, e.g. to parse the header of an image without reading the whole image.
+     *  Unlike getContentsView, it doesn't read the whole file from an Android apk.
+     *
+     *  @param[in] filename The resource file name which contains the path.
+     *  @param[in] maxSize The number of bytes to read, less are read if the file is smaller.
+     *  @param[out] buffer The buffer the bytes are read to.
+     *  @return Status::OK when the beginning of the file was read.
+     *  @since v3.17
+     */
+    template <
+        typename T,
+        typename Enable = typename std::enable_if<
+            std::is_base_of< ResizableBuffer, ResizableBufferAdapter<T> >::value
+        >::type
+    >
+    Status getContentsPrefix(const std::string& filename, size_t maxSize, T* buffer) const {
+        ResizableBufferAdapter<T> buf(buffer);
+        return getContentsPrefix(filename, maxSize, &buf);
+    }
+    virtual Status getContentsPrefix(const std::string& filename, size_t maxSize, ResizableBuffer* buffer) const;
+
+    /**
+     *  Sets whether getContentsView may map the files and return views on asset pack entries.
+     *  When disabled, getContentsView reads every file with getContents, which is needed when a subclass
+     *  overrides getContents to decrypt or transform the contents. It is disabled for the delegates given to
+     *  setDelegate, which may enable it again. Set it before loading any file.
+     *
+     *  @param useMappedFiles true by default.
+     *  @since v3.17
+     */
+    void setUseMappedFiles(bool useMappedFiles);
+
+    /**
+     *  Whether getContentsView may map the files.
+     *
+     *  @since v3.17
+     */
+    bool isUseMappedFiles() const;
+
+    /**
+     *  Mounts an asset pack built by tools/asset-pack/build_asset_pack.py.
+     *
+     *  The files of the pack appear under the mount point. They are looked up before the files of the
+     *  file system in every search path and resolution directory, so finding them needs no stat, and
+     *  they take precedence over loose files. The pack mounted last is looked up first.
+     *
+     *  @param packPath The path of the pack file.
+     *  @param mountPoint The directory the files of the pack appear in, the default resource root path if empty.
+     *  @return true if the pack was mounted.
+     *  @since v3.17
+     */
+    bool mountAssetPack(const std::string& packPath, const std::string& mountPoint = "");
+
+    /**
+     *  Unmounts an asset pack mounted by mountAssetPack.
+     *  Views returned by getContentsView on its files stay valid.
+     *
+     *  @param packPath The path given to mountAssetPack.
+     *  @return true if the pack was mounted.
+     *  @since v3.17
+     */
+    bool unmountAssetPack(const std::string& packPath);
+
     /**
      *  Gets resource file data
      *
@@ -845,7 +976,7 @@ public:
     virtual void listFilesRecursivelyAsync(const std::string& dirPath, std::function<void(std::vector<std::string>)> callback) const;
 
     /** Returns the full path cache. */
-    const std::unordered_map<std::string, std::string> getFullPathCache() const { return _fullPathCache; }
+    const std::unordered_map<std::string, std::string> getFullPathCache() const { return _fullPathCache.snapshot(); }
 
     /**
      *  Gets the new filename from the filename lookup dictionary.
@@ -915,6 +1046,48 @@ protected:
      */
     virtual std::string fullPathForDirectory(const std::string &dirname) const;
 
+    /**
+     *  Finds a file in the mounted asset packs.
+     *  @param fullPath The full path of the file.
+     *  @param pack The pack containing the file, may be nullptr.
+     *  @return The index of the entry in the pack, -1 if no pack contains the file.
+     *  @since v3.17
+     */
+    int findInAssetPacks(const std::string& fullPath, std::shared_ptr<AssetPack>* pack) const;
+
+    /**
+     *  Reads a file from the mounted asset packs, platform getContents should call it first.
+     *  @return true if a pack contains the file, status is then the status of the read.
+     *  @since v3.17
+     */
+    bool getContentsFromAssetPacks(const std::string& fullPath, ResizableBuffer* buffer, Status* status) const;
+
+    /**
+     *  Creates a view on bytes kept alive by owner, for the platforms mapping files their own way.
+     *  @since v3.17
+     */
+    static FileView makeFileView(std::shared_ptr<const void> owner, const unsigned char* bytes, ssize_t size);
+
+    /**
+     *  Checks with the cached listing of a directory that a file isn't in it, without any stat.
+     *  Only the absolute directories outside of the writable path are listed. The names are compared
+     *  ignoring the case and non ASCII names are never known to be missing, since the file system may
+     *  be case insensitive or normalize the names.
+     *  @param directory The directory, ending with a '/'.
+     *  @param filename The name of the file in the directory.
+     *  @return true if the file is surely missing, false if the file system has to be checked.
+     *  @since v3.17
+     */
+    bool isMissingFromDirectoryListing(const std::string& directory, const std::string& filename) const;
+
+    /**
+     *  Forgets the cached entries a change of the file or directory at fullPath may invalidate.
+     *  It is called when FileUtils writes, removes or renames a file, files changed by other means
+     *  need a call to purgeCachedEntries.
+     *  @since v3.17
+     */
+    void purgeCachedEntriesForPath(const std::string& fullPath) const;
+
     /**
     * mutex used to protect fields. 
     */
@@ -958,15 +1131,43 @@ protected:
 
     /**
      *  The full path cache for normal files. When a file is found, it will be added into this cache.
-     *  This variable is used for improving the performance of file search.
+     *  Files that weren't found are cached too, with an empty full path.
+     *  This variable is used for improving the performance of file search, it can be read without locking _mutex.
      */
-    mutable std::unordered_map<std::string, std::string> _fullPathCache;
+    mutable FullPathCache _fullPathCache;
 
     /**
      *  The full path cache for directories. When a diretory is found, it will be added into this cache.
      *  This variable is used for improving the performance of file search.
      */
-    mutable std::unordered_map<std::string, std::string> _fullPathCacheDir;
+    mutable FullPathCache _fullPathCacheDir;
+
+    /**
+     *  The names of the files in the directories searched by fullPathForFilename, in lower case, by directory.
+     *  nullptr if the directory can't be listed. Protected by _mutex.
+     */
+    mutable std::unordered_map<std::string, std::shared_ptr<const std::unordered_set<std::string>>> _directoryListings;
+
+    /**
+     *  Whether fullPathForFilename skips the directories a file is missing from. Disabled for the delegates
+     *  given to setDelegate, since they may override getPathForFilename.
+     */
+    bool _useDirectoryListings;
+
+    struct MappedFile;
+
+    /**
+     *  The memory mapped files returned by getContentsView, by full path.
+     *  The views share the ownership of the mappings, removing them from the cache doesn't invalidate the views.
+     */
+    mutable std::unordered_map<std::string, std::shared_ptr<MappedFile>> _mappedFiles;
+    mutable std::mutex _mappedFilesMutex;
+    bool _useMappedFiles;
+
+    /**
+     *  The mounted asset packs, the last mounted is looked up first.
+     */
+    std::vector<std::shared_ptr<AssetPack>> _assetPacks;
 
     /**
      * Writable path.
@@ -1005,7 +1206,7 @@ protected:
         
 #endif
 
-        AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [](void*){}, nullptr, std::move(lambda));
+        JobSystem::getInstance()->schedule(std::move(lambda));
     }
 };
 
@@ -0,0 +1,93 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "platform/CCFullPathCache.h"
+
+NS_CC_BEGIN
+
+FullPathCache::Stripe& FullPathCache::getStripe(const std::string& name) const
+{
+    return _stripes[std::hash<std::string>()(name) % STRIPE_COUNT];
+}
+
+bool FullPathCache::find(const std::string& name, std::string& fullPath) const
+{
+    auto& stripe = getStripe(name);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+
+    auto it = stripe.entries.find(name);
+    if (it == stripe.entries.end())
+        return false;
+
+    fullPath = it->second;
+    return true;
+}
+
+void FullPathCache::insert(const std::string& name, const std::string& fullPath)
+{
+    auto& stripe = getStripe(name);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    stripe.entries[name] = fullPath;
+}
+
+void FullPathCache::clear()
+{
+    for (auto& stripe : _stripes)
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.entries.clear();
+    }
+}
+
+void FullPathCache::clearMissing()
+{
+    for (auto& stripe : _stripes)
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (auto it = stripe.entries.begin(); it != stripe.entries.end();)
+        {
+            if (it->second.empty())
+                it = stripe.entries.erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+std::unordered_map<std::string, std::string> FullPathCache::snapshot() const
+{
+    std::unordered_map<std::string, std::string> entries;
+    for (auto& stripe : _stripes)
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (const auto& entry : stripe.entries)
+        {
+            if (!entry.second.empty())
+                entries.insert(entry);
+        }
+    }
+    return entries;
+}
+
+NS_CC_END
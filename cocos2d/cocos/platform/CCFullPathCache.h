@@ -0,0 +1,89 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __PLATFORM_CCFULLPATHCACHE_H__
+#define __PLATFORM_CCFULLPATHCACHE_H__
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/** @brief A thread-safe map from the names given to FileUtils to their full paths.
+ *
+ * The entries are spread over several stripes, each one with its own mutex, so loaders
+ * resolving paths on several threads don't wait for each other.
+ * A name mapped to an empty path is known to be missing, so it isn't searched again.
+ * @since v3.17
+ */
+class CC_DLL FullPathCache
+{
+public:
+    static const int STRIPE_COUNT = 16;
+
+    /** Finds a name in the cache.
+     * @param name The name given to FileUtils.
+     * @param fullPath The cached full path, empty if the name is known to be missing.
+     * @return true if the name is in the cache.
+     */
+    bool find(const std::string& name, std::string& fullPath) const;
+
+    /** Adds a name to the cache, an empty full path means the name is missing. */
+    void insert(const std::string& name, const std::string& fullPath);
+
+    /** Removes all the names. */
+    void clear();
+
+    /** Removes the names known to be missing, e.g. when a file was written or a search path added. */
+    void clearMissing();
+
+    /** Gets a copy of the names that were found, with their full path. */
+    std::unordered_map<std::string, std::string> snapshot() const;
+
+private:
+    struct Stripe
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::string> entries;
+    };
+
+    Stripe& getStripe(const std::string& name) const;
+
+    mutable Stripe _stripes[STRIPE_COUNT];
+};
+
+// end of platform group
+/** @} */
+
+NS_CC_END
+
+#endif // __PLATFORM_CCFULLPATHCACHE_H__
@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include "platform/CCImage.h"
 
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <ctype.h>
 
 #include "base/CCData.h"
@@ -109,6 +111,7 @@ extern "C"
 #include "base/CCConfiguration.h"
 #include "base/ccUtils.h"
 #include "base/ZipUtils.h"
+#include "renderer/ccPixelConversion.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtils-android.h"
 #endif
@@ -428,6 +431,32 @@ namespace
 
 //////////////////////////////////////////////////////////////////////////
 
+//struct and data for etc2(pkm 2.0) and astc struct
+namespace
+{
+    const unsigned char ETC2_PKM_MAGIC[] = { 'P', 'K', 'M', ' ', '2', '0' };
+    const ssize_t ETC2_PKM_HEADER_SIZE = 16;
+    const int ETC2_PKM_FORMAT_RGB = 1;
+    const int ETC2_PKM_FORMAT_RGBA = 3;
+
+    const unsigned char ASTC_MAGIC[] = { 0x13, 0xAB, 0xA1, 0x5C };
+
+    struct ASTCTexHeader
+    {
+        unsigned char magic[4];
+        unsigned char blockDimX;
+        unsigned char blockDimY;
+        unsigned char blockDimZ;
+        // 24 bits little endian sizes
+        unsigned char xsize[3];
+        unsigned char ysize[3];
+        unsigned char zsize[3];
+    };
+}
+//etc2 and astc struct end
+
+//////////////////////////////////////////////////////////////////////////
+
 namespace
 {
     typedef struct 
@@ -491,6 +520,7 @@ Image::Image()
 , _renderFormat(Texture2D::PixelFormat::NONE)
 , _numberOfMipmaps(0)
 , _hasPremultipliedAlpha(false)
+, _decodeBuffer(nullptr)
 {
 
 }
@@ -511,7 +541,7 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    FileView data = FileUtils::getInstance()->getContentsView(_filePath, FileUtils::AccessPattern::SEQUENTIAL);
 
     if (!data.isNull())
     {
@@ -522,12 +552,16 @@ bool Image::initWithImageFile(const std::string& path)
 }
 
 bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
+{
+    FileView data = FileUtils::getInstance()->getContentsView(fullpath, FileUtils::AccessPattern::SEQUENTIAL);
+    return initWithImageFileThreadSafe(fullpath, data);
+}
+
+bool Image::initWithImageFileThreadSafe(const std::string& fullpath, const FileView& data)
 {
     bool ret = false;
     _filePath = fullpath;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
-
     if (!data.isNull())
     {
         ret = initWithImageData(data.getBytes(), data.getSize());
@@ -590,6 +624,12 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
         case Format::ATITC:
             ret = initWithATITCData(unpackedData, unpackedLen);
             break;
+        case Format::ETC2:
+            ret = initWithETC2Data(unpackedData, unpackedLen);
+            break;
+        case Format::ASTC:
+            ret = initWithASTCData(unpackedData, unpackedLen);
+            break;
         default:
             {
                 // load and detect image format
@@ -618,6 +658,104 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
     return ret;
 }
 
+bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen, ResizableBuffer* buffer)
+{
+    CCASSERT(buffer != nullptr, "Invalid buffer");
+
+    _decodeBuffer = buffer;
+    bool ret = initWithImageData(data, dataLen);
+    _decodeBuffer = nullptr;
+
+    // compressed textures and mipmaps are uploaded from the image
+    if (ret && (_unpack || _numberOfMipmaps > 1 || isCompressed()))
+    {
+        ret = false;
+    }
+
+    if (_data != nullptr && _data != buffer->buffer())
+    {
+        // decoded into memory of its own
+        if (ret)
+        {
+            buffer->resize(_dataLen);
+            memcpy(buffer->buffer(), _data, _dataLen);
+        }
+        if (_unpack)
+        {
+            for (int i = 0; i < _numberOfMipmaps; ++i)
+                CC_SAFE_DELETE_ARRAY(_mipmaps[i].address);
+            _unpack = false;
+        }
+        else
+        {
+            free(_data);
+        }
+    }
+    else if (ret)
+    {
+        // the PNG decoder may ask for a bit more room
+        buffer->resize(_dataLen);
+    }
+
+    // the buffer owns the pixels
+    _data = nullptr;
+    _numberOfMipmaps = 0;
+
+    return ret;
+}
+
+unsigned char* Image::allocateData(size_t size)
+{
+    if (_decodeBuffer != nullptr)
+    {
+        _decodeBuffer->resize(size);
+        return static_cast<unsigned char*>(_decodeBuffer->buffer());
+    }
+    return static_cast<unsigned char*>(malloc(size));
+}
+
+bool Image::initWithImageHeader(const unsigned char * data, ssize_t dataLen)
+{
+    if (! data || dataLen <= 0)
+    {
+        return false;
+    }
+
+    _fileType = detectFormat(data, dataLen);
+
+    switch (_fileType)
+    {
+    case Format::PNG:
+        return initWithPngData(data, dataLen, DecodeMode::HEADER);
+    case Format::JPG:
+        return initWithJpgData(data, dataLen, DecodeMode::HEADER);
+    case Format::WEBP:
+        return initWithWebpData(data, dataLen, DecodeMode::HEADER);
+    default:
+        return false;
+    }
+}
+
+bool Image::initWithImagePreview(const unsigned char * data, ssize_t dataLen)
+{
+    if (! data || dataLen <= 0)
+    {
+        return false;
+    }
+
+    _fileType = detectFormat(data, dataLen);
+
+    switch (_fileType)
+    {
+    case Format::PNG:
+        return initWithPngData(data, dataLen, DecodeMode::PREVIEW);
+    case Format::JPG:
+        return initWithJpgData(data, dataLen, DecodeMode::PREVIEW);
+    default:
+        return false;
+    }
+}
+
 bool Image::isPng(const unsigned char * data, ssize_t dataLen)
 {
     if (dataLen <= 8)
@@ -660,6 +798,16 @@ bool Image::isATITC(const unsigned char *data, ssize_t /*dataLen*/)
     return true;
 }
 
+bool Image::isEtc2(const unsigned char * data, ssize_t dataLen)
+{
+    return dataLen >= ETC2_PKM_HEADER_SIZE && memcmp(data, ETC2_PKM_MAGIC, sizeof(ETC2_PKM_MAGIC)) == 0;
+}
+
+bool Image::isAstc(const unsigned char * data, ssize_t dataLen)
+{
+    return static_cast<size_t>(dataLen) >= sizeof(ASTCTexHeader) && memcmp(data, ASTC_MAGIC, sizeof(ASTC_MAGIC)) == 0;
+}
+
 bool Image::isJpg(const unsigned char * data, ssize_t dataLen)
 {
     if (dataLen <= 4)
@@ -747,6 +895,14 @@ Image::Format Image::detectFormat(const unsigned char * data, ssize_t dataLen)
     {
         return Format::ATITC;
     }
+    else if (isEtc2(data, dataLen))
+    {
+        return Format::ETC2;
+    }
+    else if (isAstc(data, dataLen))
+    {
+        return Format::ASTC;
+    }
     else
     {
         return Format::UNKNOWN;
@@ -922,10 +1078,10 @@ bool Image::encodeWithWIC(const std::string& filePath, bool isToRGB, GUID contai
 
 #endif //CC_USE_WIC
 
-bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
+bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen, DecodeMode mode)
 {
 #if CC_USE_WIC
-    return decodeWithWIC(data, dataLen);
+    return mode == DecodeMode::FULL && decodeWithWIC(data, dataLen);
 #elif CC_USE_JPEG
     /* these are standard libjpeg structures for reading(decompression) */
     struct jpeg_decompress_struct cinfo;
@@ -935,8 +1091,7 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
      */
     struct MyErrorMgr jerr;
     /* libjpeg data structure for storing one row, that is, scanline of an image */
-    JSAMPROW row_pointer[1] = {0};
-    unsigned long location = 0;
+    JSAMPROW row_pointers[4] = {0};
 
     bool ret = false;
     do 
@@ -979,6 +1134,24 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
             _renderFormat = Texture2D::PixelFormat::RGB888;
         }
 
+        if (mode == DecodeMode::HEADER)
+        {
+            _width  = cinfo.image_width;
+            _height = cinfo.image_height;
+            jpeg_destroy_decompress( &cinfo );
+            ret = true;
+            break;
+        }
+
+        if (mode == DecodeMode::PREVIEW)
+        {
+            /* the IDCT outputs 1/8 of the size directly, it skips most of the decoding */
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = 8;
+            cinfo.dct_method = JDCT_IFAST;
+            cinfo.do_fancy_upsampling = FALSE;
+        }
+
         /* Start decompression jpeg here */
         jpeg_start_decompress( &cinfo );
 
@@ -987,16 +1160,19 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
         _height = cinfo.output_height;
 
         _dataLen = cinfo.output_width*cinfo.output_height*cinfo.output_components;
-        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        _data = allocateData(_dataLen);
         CC_BREAK_IF(! _data);
 
         /* now actually read the jpeg into the raw buffer */
-        /* read one scan line at a time */
+        /* read up to 4 scan lines at a time, the decoder outputs rec_outbuf_height of them per call */
         while (cinfo.output_scanline < cinfo.output_height)
         {
-            row_pointer[0] = _data + location;
-            location += cinfo.output_width*cinfo.output_components;
-            jpeg_read_scanlines(&cinfo, row_pointer, 1);
+            JDIMENSION count = std::min<JDIMENSION>(cinfo.output_height - cinfo.output_scanline, sizeof(row_pointers) / sizeof(row_pointers[0]));
+            for (JDIMENSION i = 0; i < count; ++i)
+            {
+                row_pointers[i] = _data + (size_t)(cinfo.output_scanline + i) * cinfo.output_width * cinfo.output_components;
+            }
+            jpeg_read_scanlines(&cinfo, row_pointers, count);
         }
 
     /* When read image file with broken data, jpeg_finish_decompress() may cause error.
@@ -1017,10 +1193,10 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
 #endif // CC_USE_JPEG
 }
 
-bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
+bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen, DecodeMode mode)
 {
 #if CC_USE_WIC
-    return decodeWithWIC(data, dataLen);
+    return mode == DecodeMode::FULL && decodeWithWIC(data, dataLen);
 #elif CC_USE_PNG
     // length of bytes to check if it is a valid png file
 #define PNGSIGSIZE  8
@@ -1097,6 +1273,11 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
         {
             png_set_packing(png_ptr);
         }
+        // png_read_image() combines the Adam7 passes of interlaced images, the preview only reads the first one
+        if (mode != DecodeMode::PREVIEW)
+        {
+            png_set_interlace_handling(png_ptr);
+        }
         // update info
         png_read_update_info(png_ptr, info_ptr);
         color_type = png_get_color_type(png_ptr, info_ptr);
@@ -1119,51 +1300,82 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
             break;
         }
 
+        if (mode == DecodeMode::HEADER)
+        {
+            // the same as premultipliedAlpha() below
+            _hasPremultipliedAlpha = (color_type == PNG_COLOR_TYPE_RGB_ALPHA && CC_ENABLE_PREMULTIPLIED_ALPHA != 0);
+            ret = true;
+            break;
+        }
+
         // read png data
         png_size_t rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
-
-        rowbytes = png_get_rowbytes(png_ptr, info_ptr);
 
-        _dataLen = rowbytes * _height;
-        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-        if (!_data)
+        if (mode == DecodeMode::PREVIEW)
         {
-            if (row_pointers != nullptr)
-            {
-                free(row_pointers);
-            }
-            break;
-        }
+            CC_BREAK_IF(png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_ADAM7);
 
-        for (unsigned short i = 0; i < _height; ++i)
+            // without png_set_interlace_handling() the Adam7 passes are read one after the other
+            // as smaller images, the first one holds 1 pixel out of 8 in both directions
+            _width = PNG_PASS_COLS(_width, 0);
+            _height = PNG_PASS_ROWS(_height, 0);
+            rowbytes = ((png_size_t)_width * png_get_channels(png_ptr, info_ptr) * png_get_bit_depth(png_ptr, info_ptr) + 7) / 8;
+        }
+        else
         {
-            row_pointers[i] = _data + i*rowbytes;
+            rowbytes = png_get_rowbytes(png_ptr, info_ptr);
         }
-        png_read_image(png_ptr, row_pointers);
 
-        png_read_end(png_ptr, nullptr);
+        // png_read_row() writes a full row even for the passes of interlaced images,
+        // the last row of the preview needs the room of a full one
+        _dataLen = rowbytes * _height;
+        _data = allocateData(_dataLen - rowbytes + png_get_rowbytes(png_ptr, info_ptr));
+        CC_BREAK_IF(!_data);
 
         // premultiplied alpha for RGBA8888
-        if (color_type == PNG_COLOR_TYPE_RGB_ALPHA)
+        bool premultiply = (color_type == PNG_COLOR_TYPE_RGB_ALPHA && PNG_PREMULTIPLIED_ALPHA_ENABLED && CC_ENABLE_PREMULTIPLIED_ALPHA != 0);
+
+        if (mode == DecodeMode::PREVIEW || png_get_interlace_type(png_ptr, info_ptr) == PNG_INTERLACE_NONE)
         {
-            if (PNG_PREMULTIPLIED_ALPHA_ENABLED)
+            // the rows are decoded in place and premultiplied while they are in the cache,
+            // the rest of the file isn't needed by the preview
+            for (int i = 0; i < _height; ++i)
             {
-                premultipliedAlpha();
+                png_bytep row = _data + i * rowbytes;
+                png_read_row(png_ptr, row, nullptr);
+                if (premultiply)
+                {
+                    PixelConversion::premultiplyAlpha(row, _width);
+                }
             }
-            else
+        }
+        else
+        {
+            // all the passes of interlaced images are needed to complete a row
+            png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
+            CC_BREAK_IF(!row_pointers);
+
+            for (int i = 0; i < _height; ++i)
             {
-#if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
-                _hasPremultipliedAlpha = true;
-#endif
+                row_pointers[i] = _data + i*rowbytes;
+            }
+            png_read_image(png_ptr, row_pointers);
+            free(row_pointers);
+
+            if (premultiply)
+            {
+                PixelConversion::premultiplyAlpha(_data, (ssize_t)_width * _height);
             }
         }
 
-        if (row_pointers != nullptr)
+        if (mode != DecodeMode::PREVIEW)
         {
-            free(row_pointers);
+            png_read_end(png_ptr, nullptr);
         }
 
+        // the same as premultipliedAlpha(), with or without PNG_PREMULTIPLIED_ALPHA_ENABLED
+        _hasPremultipliedAlpha = (color_type == PNG_COLOR_TYPE_RGB_ALPHA && CC_ENABLE_PREMULTIPLIED_ALPHA != 0);
+
         ret = true;
     } while (0);
 
@@ -1774,6 +1986,115 @@ bool Image::initWithETCData(const unsigned char * data, ssize_t dataLen)
     return false;
 }
 
+bool Image::initWithETC2Data(const unsigned char * data, ssize_t dataLen)
+{
+    if (!isEtc2(data, dataLen))
+    {
+        return false;
+    }
+
+    // the PKM 2.0 header is big endian, the padded size is followed by the size of the image
+    int format = (data[6] << 8) | data[7];
+    _width = (data[12] << 8) | data[13];
+    _height = (data[14] << 8) | data[15];
+
+    if (0 == _width || 0 == _height)
+    {
+        return false;
+    }
+
+    int blockSize = 0;
+    if (ETC2_PKM_FORMAT_RGB == format)
+    {
+        _renderFormat = Texture2D::PixelFormat::ETC2_RGB;
+        blockSize = 8;
+    }
+    else if (ETC2_PKM_FORMAT_RGBA == format)
+    {
+        _renderFormat = Texture2D::PixelFormat::ETC2_RGBA;
+        blockSize = 16;
+    }
+    else
+    {
+        CCLOG("cocos2d: unsupported ETC2 format: %d", format);
+        return false;
+    }
+
+    if (!Configuration::getInstance()->supportsETC2())
+    {
+        CCLOG("cocos2d: Hardware ETC2 decoder not present, no software decoder is available");
+        return false;
+    }
+
+    ssize_t size = ((_width + 3) / 4) * ((_height + 3) / 4) * blockSize;
+    if (dataLen - ETC2_PKM_HEADER_SIZE < size)
+    {
+        CCLOG("cocos2d: the ETC2 data is truncated");
+        return false;
+    }
+
+    _dataLen = size;
+    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+    memcpy(_data, data + ETC2_PKM_HEADER_SIZE, _dataLen);
+    return true;
+}
+
+bool Image::initWithASTCData(const unsigned char * data, ssize_t dataLen)
+{
+    if (!isAstc(data, dataLen))
+    {
+        return false;
+    }
+
+    const ASTCTexHeader* header = reinterpret_cast<const ASTCTexHeader*>(data);
+    _width = header->xsize[0] | (header->xsize[1] << 8) | (header->xsize[2] << 16);
+    _height = header->ysize[0] | (header->ysize[1] << 8) | (header->ysize[2] << 16);
+    int depth = header->zsize[0] | (header->zsize[1] << 8) | (header->zsize[2] << 16);
+
+    if (0 == _width || 0 == _height || depth != 1 || header->blockDimZ != 1)
+    {
+        CCLOG("cocos2d: unsupported ASTC image, only 2D images are supported");
+        return false;
+    }
+
+    if (4 == header->blockDimX && 4 == header->blockDimY)
+    {
+        _renderFormat = Texture2D::PixelFormat::ASTC_4x4;
+    }
+    else if (6 == header->blockDimX && 6 == header->blockDimY)
+    {
+        _renderFormat = Texture2D::PixelFormat::ASTC_6x6;
+    }
+    else if (8 == header->blockDimX && 8 == header->blockDimY)
+    {
+        _renderFormat = Texture2D::PixelFormat::ASTC_8x8;
+    }
+    else
+    {
+        CCLOG("cocos2d: unsupported ASTC block size: %dx%d", header->blockDimX, header->blockDimY);
+        return false;
+    }
+
+    if (!Configuration::getInstance()->supportsASTC())
+    {
+        CCLOG("cocos2d: Hardware ASTC decoder not present, no software decoder is available");
+        return false;
+    }
+
+    // every block takes 128 bits whatever its size
+    ssize_t size = ((_width + header->blockDimX - 1) / header->blockDimX) * ((_height + header->blockDimY - 1) / header->blockDimY) * 16;
+    if (dataLen - static_cast<ssize_t>(sizeof(ASTCTexHeader)) < size)
+    {
+        CCLOG("cocos2d: the ASTC data is truncated");
+        return false;
+    }
+
+    _dataLen = size;
+    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+    memcpy(_data, data + sizeof(ASTCTexHeader), _dataLen);
+    return true;
+}
+
 bool Image::initWithTGAData(tImageTGA* tgaData)
 {
     bool ret = false;
@@ -2118,7 +2439,7 @@ bool Image::initWithPVRData(const unsigned char * data, ssize_t dataLen)
     return initWithPVRv2Data(data, dataLen) || initWithPVRv3Data(data, dataLen);
 }
 
-bool Image::initWithWebpData(const unsigned char * data, ssize_t dataLen)
+bool Image::initWithWebpData(const unsigned char * data, ssize_t dataLen, DecodeMode mode)
 {
 #if CC_USE_WEBP
     bool ret = false;
@@ -2140,9 +2461,18 @@ bool Image::initWithWebpData(const unsigned char * data, ssize_t dataLen)
         
         //we ask webp to give data with premultiplied alpha
         _hasPremultipliedAlpha = (config.input.has_alpha != 0);
+
+        // lossy WebP has no quicker low resolution decoding
+        CC_BREAK_IF(mode == DecodeMode::PREVIEW);
+        if (mode == DecodeMode::HEADER)
+        {
+            ret = true;
+            break;
+        }
         
         _dataLen = _width * _height * (config.input.has_alpha?4:3);
-        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        _data = allocateData(_dataLen);
+        CC_BREAK_IF(!_data);
         
         config.output.u.RGBA.rgba = static_cast<uint8_t*>(_data);
         config.output.u.RGBA.stride = _width * (config.input.has_alpha?4:3);
@@ -2151,7 +2481,10 @@ bool Image::initWithWebpData(const unsigned char * data, ssize_t dataLen)
         
         if (WebPDecode(static_cast<const uint8_t*>(data), dataLen, &config) != VP8_STATUS_OK)
         {
-            free(_data);
+            if (_decodeBuffer == nullptr)
+            {
+                free(_data);
+            }
             _data = nullptr;
             break;
         }
@@ -2462,17 +2795,35 @@ void Image::premultipliedAlpha()
 #else
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-    }
+    // same results as CC_RGB_PREMULTIPLY_ALPHA
+    PixelConversion::premultiplyAlpha(_data, (ssize_t)_width * _height);
     
     _hasPremultipliedAlpha = true;
 #endif
 }
 
+bool Image::convertToFormat(Texture2D::PixelFormat format)
+{
+    if (format == Texture2D::PixelFormat::AUTO || format == Texture2D::PixelFormat::NONE || format == _renderFormat)
+        return false;
+
+    // Texture2D::initWithImage() doesn't convert these either
+    if (_data == nullptr || _unpack || _numberOfMipmaps > 1 || isCompressed())
+        return false;
+
+    unsigned char* outData = nullptr;
+    ssize_t outDataLen = 0;
+    Texture2D::PixelFormat outFormat = Texture2D::convertDataToFormat(_data, _dataLen, _renderFormat, format, &outData, &outDataLen);
+    if (outData == nullptr || outData == _data)
+        return false;
+
+    free(_data);
+    _data = outData;
+    _dataLen = outDataLen;
+    _renderFormat = outFormat;
+    return true;
+}
+
 
 void Image::setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
 {
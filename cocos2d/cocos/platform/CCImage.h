@@ -45,6 +45,9 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class ResizableBuffer;
+class FileView;
+
 /**
  * @addtogroup platform
  * @{
@@ -93,6 +96,10 @@ public:
         S3TC,
         //! ATITC
         ATITC,
+        //! ETC2, in a PKM 2.0 file
+        ETC2,
+        //! ASTC
+        ASTC,
         //! TGA
         TGA,
         //! Raw Data
@@ -133,6 +140,42 @@ public:
     */
     bool initWithImageData(const unsigned char * data, ssize_t dataLen);
 
+    /**
+    @brief Reads the size and the pixel format of a PNG, JPEG or WebP image without decoding its pixels.
+    The image has no data, getWidth(), getHeight(), getRenderFormat() and hasPremultipliedAlpha()
+    return what initWithImageData() would give for the same data.
+    @param data  stream buffer which holds the image data, only its header is read.
+    @param dataLen  data length expressed in (number of) bytes.
+    @return false if the data isn't a PNG, JPEG or WebP image.
+    @since v3.17
+    */
+    bool initWithImageHeader(const unsigned char * data, ssize_t dataLen);
+
+    /**
+    @brief Same as initWithImageData(), but the pixels are decoded into the buffer, e.g. a std::vector
+    wrapped in a ResizableBufferAdapter and reused from an image to the next one.
+    The PNG, JPEG and WebP decoders write straight into it, the other formats are copied.
+    The image keeps no data: getWidth(), getHeight(), getRenderFormat(), getDataLen() and
+    hasPremultipliedAlpha() describe the pixels of the buffer.
+    @param data  stream buffer which holds the image data.
+    @param dataLen  data length expressed in (number of) bytes.
+    @param buffer  the buffer resized to the decoded pixels.
+    @return false if the image can't be decoded, or if it is compressed or has mipmaps.
+    @since v3.17
+    */
+    bool initWithImageData(const unsigned char * data, ssize_t dataLen, ResizableBuffer* buffer);
+
+    /**
+    @brief Decodes a low resolution version of the image, 1/8 of its width and height, far quicker
+    than the full image. Only JPEG images, scaled down while they are decoded, and interlaced PNG images,
+    from their first Adam7 pass, have one.
+    @param data  stream buffer which holds the image data.
+    @param dataLen  data length expressed in (number of) bytes.
+    @return false if the image has no quick low resolution version.
+    @since v3.17
+    */
+    bool initWithImagePreview(const unsigned char * data, ssize_t dataLen);
+
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const unsigned char * data, ssize_t dataLen, int width, int height, int bitsPerComponent, bool preMulti = false);
 
@@ -161,21 +204,42 @@ public:
      */
     bool saveToFile(const std::string &filename, bool isToRGB = true);
 
+    /**
+     @brief    Converts the uncompressed image data to the pixel format of the texture it is used for,
+               so that Texture2D::initWithImage() only uploads it. Can be called from any thread.
+     @param    format    the pixel format to convert to, AUTO and NONE keep the current one.
+     @return   true if the data was converted.
+     @since v3.17
+     */
+    bool convertToFormat(Texture2D::PixelFormat format);
+
 protected:
+    /** What the decoders read from the data. */
+    enum class DecodeMode
+    {
+        // the size and the format only
+        HEADER,
+        // a low resolution version, see initWithImagePreview()
+        PREVIEW,
+        FULL
+    };
+
 #if CC_USE_WIC
     bool encodeWithWIC(const std::string& filePath, bool isToRGB, GUID containerFormat);
     bool decodeWithWIC(const unsigned char *data, ssize_t dataLen);
 #endif
-    bool initWithJpgData(const unsigned char *  data, ssize_t dataLen);
-    bool initWithPngData(const unsigned char * data, ssize_t dataLen);
+    bool initWithJpgData(const unsigned char * data, ssize_t dataLen, DecodeMode mode = DecodeMode::FULL);
+    bool initWithPngData(const unsigned char * data, ssize_t dataLen, DecodeMode mode = DecodeMode::FULL);
     bool initWithTiffData(const unsigned char * data, ssize_t dataLen);
-    bool initWithWebpData(const unsigned char * data, ssize_t dataLen);
+    bool initWithWebpData(const unsigned char * data, ssize_t dataLen, DecodeMode mode = DecodeMode::FULL);
     bool initWithPVRData(const unsigned char * data, ssize_t dataLen);
     bool initWithPVRv2Data(const unsigned char * data, ssize_t dataLen);
     bool initWithPVRv3Data(const unsigned char * data, ssize_t dataLen);
     bool initWithETCData(const unsigned char * data, ssize_t dataLen);
     bool initWithS3TCData(const unsigned char * data, ssize_t dataLen);
     bool initWithATITCData(const unsigned char *data, ssize_t dataLen);
+    bool initWithETC2Data(const unsigned char * data, ssize_t dataLen);
+    bool initWithASTCData(const unsigned char * data, ssize_t dataLen);
     typedef struct sImageTGA tImageTGA;
     bool initWithTGAData(tImageTGA* tgaData);
 
@@ -183,6 +247,9 @@ protected:
     bool saveImageToJPG(const std::string& filePath);
     
     void premultipliedAlpha();
+
+    // the memory of the decoded pixels, from _decodeBuffer when there is one
+    unsigned char* allocateData(size_t size);
     
 protected:
     /**
@@ -206,6 +273,8 @@ protected:
     // false if we can't auto detect the image is premultiplied or not.
     bool _hasPremultipliedAlpha;
     std::string _filePath;
+    // set by initWithImageData(data, dataLen, buffer) while the image is decoded
+    ResizableBuffer* _decodeBuffer;
 
 
 protected:
@@ -221,6 +290,8 @@ protected:
      @return  true if loaded correctly.
      */
     bool initWithImageFileThreadSafe(const std::string& fullpath);
+    // same with the contents of the file already read
+    bool initWithImageFileThreadSafe(const std::string& fullpath, const FileView& data);
     
     Format detectFormat(const unsigned char * data, ssize_t dataLen);
     bool isPng(const unsigned char * data, ssize_t dataLen);
@@ -231,6 +302,8 @@ protected:
     bool isEtc(const unsigned char * data, ssize_t dataLen);
     bool isS3TC(const unsigned char * data,ssize_t dataLen);
     bool isATITC(const unsigned char *data, ssize_t dataLen);
+    bool isEtc2(const unsigned char * data, ssize_t dataLen);
+    bool isAstc(const unsigned char * data, ssize_t dataLen);
 };
 
 // end of platform group
@@ -37,6 +37,9 @@ THE SOFTWARE.
 
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
 
 #define  LOG_TAG    "CCFileUtils-android.cpp"
 #define  LOGD(...)  __android_log_print(ANDROID_LOG_DEBUG,LOG_TAG,__VA_ARGS__)
@@ -352,6 +355,10 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
 
     string fullPath = fullPathForFilename(filename);
 
+    FileUtils::Status status;
+    if (getContentsFromAssetPacks(fullPath, buffer, &status))
+        return status;
+
     if (fullPath[0] == '/')
         return FileUtils::getContents(fullPath, buffer);
 
@@ -396,6 +403,110 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
     return FileUtils::Status::OK;
 }
 
+FileUtils::Status FileUtilsAndroid::getContentsPrefix(const std::string& filename, size_t maxSize, ResizableBuffer* buffer) const
+{
+    static const std::string apkprefix("assets/");
+    if (filename.empty())
+        return FileUtils::Status::NotExists;
+
+    string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return FileUtils::Status::NotExists;
+
+    // the obb file only reads whole files
+    if (fullPath[0] == '/' || obbfile || !isUseMappedFiles() || findInAssetPacks(fullPath, nullptr) >= 0)
+        return FileUtils::getContentsPrefix(fullPath, maxSize, buffer);
+
+    string relativePath = string();
+    size_t position = fullPath.find(apkprefix);
+    if (0 == position) {
+        // "assets/" is at the beginning of the path and we don't want it
+        relativePath += fullPath.substr(apkprefix.size());
+    } else {
+        relativePath = fullPath;
+    }
+
+    if (nullptr == assetmanager) {
+        LOGD("... FileUtilsAndroid::assetmanager is nullptr");
+        return FileUtils::Status::NotInitialized;
+    }
+
+    AAsset* asset = AAssetManager_open(assetmanager, relativePath.data(), AASSET_MODE_STREAMING);
+    if (nullptr == asset) {
+        LOGD("asset is nullptr");
+        return FileUtils::Status::OpenFailed;
+    }
+
+    auto size = std::min(static_cast<off_t>(maxSize), AAsset_getLength(asset));
+    buffer->resize(size);
+
+    int readsize = AAsset_read(asset, buffer->buffer(), size);
+    AAsset_close(asset);
+
+    if (readsize < size) {
+        if (readsize >= 0)
+            buffer->resize(readsize);
+        return FileUtils::Status::ReadFailed;
+    }
+
+    return FileUtils::Status::OK;
+}
+
+FileView FileUtilsAndroid::getContentsView(const std::string& filename, AccessPattern pattern) const
+{
+    // smaller assets are cheaper to read than to map
+    static const off_t MAPPED_ASSET_MIN_SIZE = 64 * 1024;
+    static const std::string apkprefix("assets/");
+
+    string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty() || fullPath[0] == '/' || obbfile || nullptr == assetmanager
+        || !isUseMappedFiles() || findInAssetPacks(fullPath, nullptr) >= 0)
+        return FileUtils::getContentsView(filename, pattern);
+
+    string relativePath = string();
+    size_t position = fullPath.find(apkprefix);
+    if (0 == position) {
+        // "assets/" is at the beginning of the path and we don't want it
+        relativePath += fullPath.substr(apkprefix.size());
+    } else {
+        relativePath = fullPath;
+    }
+
+    AAsset* asset = AAssetManager_open(assetmanager, relativePath.data(), AASSET_MODE_UNKNOWN);
+    if (nullptr == asset)
+        return FileView();
+
+    // only the assets stored uncompressed have a file descriptor, on the apk itself
+    off_t start = 0;
+    off_t length = 0;
+    int fd = -1;
+    if (AAsset_getLength(asset) >= MAPPED_ASSET_MIN_SIZE)
+        fd = AAsset_openFileDescriptor(asset, &start, &length);
+    AAsset_close(asset);
+    if (fd < 0)
+        return FileUtils::getContentsView(filename, pattern);
+
+    // mappings start on a page boundary
+    off_t pageOffset = start % sysconf(_SC_PAGESIZE);
+    size_t mappedSize = static_cast<size_t>(length + pageOffset);
+    void* address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, start - pageOffset);
+    close(fd);
+    if (address == MAP_FAILED)
+        return FileUtils::getContentsView(filename, pattern);
+
+    int advice = MADV_NORMAL;
+    if (pattern == AccessPattern::SEQUENTIAL)
+        advice = MADV_SEQUENTIAL;
+    else if (pattern == AccessPattern::RANDOM)
+        advice = MADV_RANDOM;
+    madvise(address, mappedSize, advice);
+
+    std::shared_ptr<const void> mapping(address, [mappedSize](const void* mappedAddress) {
+        munmap(const_cast<void*>(mappedAddress), mappedSize);
+    });
+    return makeFileView(std::move(mapping), static_cast<const unsigned char*>(address) + pageOffset, static_cast<ssize_t>(length));
+}
+
 string FileUtilsAndroid::getWritablePath() const
 {
     // Fix for Nexus 10 (Android 4.2 multi-user environment)
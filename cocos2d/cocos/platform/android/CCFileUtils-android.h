@@ -70,6 +70,8 @@ public:
     virtual std::string getNewFilename(const std::string &filename) const override;
 
     virtual FileUtils::Status getContents(const std::string& filename, ResizableBuffer* buffer) const override;
+    virtual FileUtils::Status getContentsPrefix(const std::string& filename, size_t maxSize, ResizableBuffer* buffer) const override;
+    virtual FileView getContentsView(const std::string& filename, AccessPattern pattern = AccessPattern::SEQUENTIAL) const override;
 
     virtual std::string getWritablePath() const override;
     virtual bool isAbsolutePath(const std::string& strPath) const override;
@@ -66,6 +66,13 @@ extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT;
 #define glBindVertexArrayOES glBindVertexArrayOESEXT
 #define glDeleteVertexArraysOES glDeleteVertexArraysOESEXT
 
+// GL_EXT_instanced_arrays, null if the extension is not available
+extern PFNGLVERTEXATTRIBDIVISOREXTPROC glVertexAttribDivisorEXTEXT;
+extern PFNGLDRAWELEMENTSINSTANCEDEXTPROC glDrawElementsInstancedEXTEXT;
+
+#define glVertexAttribDivisorEXT glVertexAttribDivisorEXTEXT
+#define glDrawElementsInstancedEXT glDrawElementsInstancedEXTEXT
+
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 
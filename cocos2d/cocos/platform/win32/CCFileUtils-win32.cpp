@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "platform/win32/CCFileUtils-win32.h"
 #include "platform/win32/CCUtils-win32.h"
 #include "platform/CCCommon.h"
+#include "platform/CCAssetPack.h"
 #include "tinydir/tinydir.h"
 #include <Shlobj.h>
 #include <cstdlib>
@@ -180,6 +181,10 @@ FileUtils::Status FileUtilsWin32::getContents(const std::string& filename, Resiz
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    FileUtils::Status status;
+    if (getContentsFromAssetPacks(fullPath, buffer, &status))
+        return status;
+
     HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -276,6 +281,11 @@ void FileUtilsWin32::listFilesRecursively(const std::string& dirPath, std::vecto
 
 long FileUtilsWin32::getFileSize(const std::string &filepath) const
 {
+    std::shared_ptr<AssetPack> pack;
+    int index = findInAssetPacks(filepath, &pack);
+    if (index >= 0)
+        return static_cast<long>(pack->getEntrySize(index));
+
     struct _stat tmp;
     if (_stat(filepath.c_str(), &tmp) == 0)
     {
@@ -29,6 +29,7 @@ NS_CC_BEGIN
 
 CustomCommand::CustomCommand()
 : func(nullptr)
+, _flags(0)
 {
     _type = RenderCommand::Type::CUSTOM_COMMAND;
 }
@@ -36,6 +37,8 @@ CustomCommand::CustomCommand()
 void CustomCommand::init(float depth, const cocos2d::Mat4 &modelViewTransform, uint32_t flags)
 {
     RenderCommand::init(depth, modelViewTransform, flags);
+    _mv = modelViewTransform;
+    _flags = flags;
 }
 
 void CustomCommand::init(float globalOrder)
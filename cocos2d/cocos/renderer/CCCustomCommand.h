@@ -67,10 +67,22 @@ public:
     void execute();
     //TODO: This function is not used, it should be removed.
     bool isTranslucent() { return true; }
-    /**Callback function.*/
+    /**Callback function.
+    Prefer lambdas that only capture `this`: they fit in the small buffer of std::function,
+    binding a Mat4 or a member function pointer allocates on the heap every time `func` is assigned.
+    */
     std::function<void()> func;
 
+    /**Returns the model view matrix given to `init`.*/
+    const Mat4& getModelView() const { return _mv; }
+    /**Returns the flags given to `init`.*/
+    uint32_t getFlags() const { return _flags; }
+
 protected:
+    /**Model view matrix, kept so callbacks don't need to bind it.*/
+    Mat4 _mv;
+    /**Flags given to `init`.*/
+    uint32_t _flags;
 };
 
 NS_CC_END
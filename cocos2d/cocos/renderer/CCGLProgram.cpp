@@ -112,6 +112,7 @@ const char* GLProgram::SHADER_3D_SKYBOX = "Shader3DSkybox";
 const char* GLProgram::SHADER_3D_TERRAIN = "Shader3DTerrain";
 const char* GLProgram::SHADER_CAMERA_CLEAR = "ShaderCameraClear";
 const char* GLProgram::SHADER_LAYER_RADIAL_GRADIENT = "ShaderLayerRadialGradient";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED = "ShaderPositionTextureColor_instanced";
 
 
 // uniform names
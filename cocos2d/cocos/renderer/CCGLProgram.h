@@ -186,6 +186,9 @@ public:
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, but without multiply vertex by MVP matrix.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP;
+    /**Built in shader for 2d instanced quads, see SpriteInstanceBatch. Reads the quad corner from a_position and the per instance
+     color, uv rect, axes and origin from a_color, a_texCoord, a_texCoord1 and a_texCoord2.*/
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED;
     /**Built in shader for 2d. Support Position, Texture vertex attribute, but include alpha test.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, include alpha test and without multiply vertex by MVP matrix.*/
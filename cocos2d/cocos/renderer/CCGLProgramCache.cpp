@@ -77,6 +77,7 @@ enum {
     kShaderType_ETC1ASPositionTextureGray,
     kShaderType_ETC1ASPositionTextureGray_noMVP,
     kShaderType_LayerRadialGradient,
+    kShaderType_PositionTextureColor_instanced,
     kShaderType_MAX,
 };
 
@@ -312,6 +313,10 @@ void GLProgramCache::loadDefaultGLPrograms()
     p = new(std::nothrow) GLProgram();
     loadDefaultGLProgram(p, kShaderType_LayerRadialGradient);
     _programs.emplace(GLProgram::SHADER_LAYER_RADIAL_GRADIENT, p);
+
+    p = new(std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_instanced);
+    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED, p);
 }
 
 void GLProgramCache::reloadDefaultGLPrograms()
@@ -483,6 +488,10 @@ void GLProgramCache::reloadDefaultGLPrograms()
     p = getGLProgram(GLProgram::SHADER_LAYER_RADIAL_GRADIENT);
     loadDefaultGLProgram(p, kShaderType_LayerRadialGradient);
     _programs.emplace(GLProgram::SHADER_LAYER_RADIAL_GRADIENT, p);
+
+    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_instanced);
 }
 
 void GLProgramCache::reloadDefaultGLProgramsRelativeToLights()
@@ -639,6 +648,9 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_LayerRadialGradient:
             p->initWithByteArrays(ccPosition_vert, ccShader_LayerRadialGradient_frag);
             break;
+        case kShaderType_PositionTextureColor_instanced:
+            p->initWithByteArrays(ccPositionTextureColor_instanced_vert, ccPositionTextureColor_noMVP_frag);
+            break;
         default:
             CCLOG("cocos2d: %s:%d, error shader type", __FUNCTION__, __LINE__);
             return;
@@ -80,10 +80,8 @@ GroupCommand::GroupCommand()
 
 void GroupCommand::init(float globalOrder)
 {
+    // the command keeps its render queue from a frame to the next one, the id is recycled when it is destroyed
     _globalOrder = globalOrder;
-    auto manager = Director::getInstance()->getRenderer()->getGroupCommandManager();
-    manager->releaseGroupID(_renderQueueID);
-    _renderQueueID = manager->getGroupID();
 }
 
 GroupCommand::~GroupCommand()
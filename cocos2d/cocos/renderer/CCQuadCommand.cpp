@@ -38,19 +38,14 @@ NS_CC_BEGIN
 
 int QuadCommand::__indexCapacity = -1;
 GLushort* QuadCommand::__indices = nullptr;
+std::vector<GLushort*> QuadCommand::__retiredIndices;
 
-QuadCommand::QuadCommand():
-_indexSize(-1),
-_ownedIndices()
+QuadCommand::QuadCommand()
 {
 }
 
 QuadCommand::~QuadCommand()
 {
-    for (auto& indices : _ownedIndices)
-    {
-        CC_SAFE_DELETE_ARRAY(indices);
-    }
 }
 
 void QuadCommand::init(float globalOrder, GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, ssize_t quadCount,
@@ -59,7 +54,7 @@ void QuadCommand::init(float globalOrder, GLuint textureID, GLProgramState* glPr
     CCASSERT(glProgramState, "Invalid GLProgramState");
     CCASSERT(glProgramState->getVertexAttribsFlags() == 0, "No custom attributes are supported in QuadCommand");
 
-    if (quadCount * 6 > _indexSize)
+    if (quadCount * 6 > __indexCapacity)
         reIndex((int)quadCount*6);
 
     Triangles triangles;
@@ -78,19 +73,24 @@ void QuadCommand::reIndex(int indicesCount)
         indicesCount = std::max(indicesCount, 2048);
     }
 
-    if (indicesCount > __indexCapacity)
-    {
-        // if resizing is needed, get needed size plus 25%, but not bigger that max size
-        indicesCount *= 1.25;
-        indicesCount = std::min(indicesCount, 65536);
+    if (indicesCount <= __indexCapacity)
+        return;
 
-        CCLOG("cocos2d: QuadCommand: resizing index size from [%d] to [%d]", __indexCapacity, indicesCount);
+    // if resizing is needed, get needed size plus 25%, but not bigger that max size
+    indicesCount *= 1.25;
+    indicesCount = std::min(indicesCount, 65536);
+    if (indicesCount <= __indexCapacity)
+        return;
 
-        _ownedIndices.push_back(__indices);
-        __indices = new (std::nothrow) GLushort[indicesCount];
-        __indexCapacity = indicesCount;
-    }
+    CCLOG("cocos2d: QuadCommand: resizing index size from [%d] to [%d]", __indexCapacity, indicesCount);
+
+    // commands initialized earlier in this frame still point to the old buffer
+    if (__indices)
+        __retiredIndices.push_back(__indices);
+    __indices = new (std::nothrow) GLushort[indicesCount];
+    __indexCapacity = indicesCount;
 
+    // the indices of a quad never change, so the buffer is only filled when it grows
     for( int i=0; i < __indexCapacity/6; i++)
     {
         __indices[i*6+0] = (GLushort) (i*4+0);
@@ -100,8 +100,15 @@ void QuadCommand::reIndex(int indicesCount)
         __indices[i*6+4] = (GLushort) (i*4+2);
         __indices[i*6+5] = (GLushort) (i*4+1);
     }
+}
 
-    _indexSize = indicesCount;
+void QuadCommand::releaseRetiredIndices()
+{
+    for (auto& indices : __retiredIndices)
+    {
+        CC_SAFE_DELETE_ARRAY(indices);
+    }
+    __retiredIndices.clear();
 }
 
 void QuadCommand::init(float globalOrder, GLuint textureID, GLProgramState* shader, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, ssize_t quadCount, const Mat4 &mv)
@@ -72,14 +72,17 @@ public:
         const Mat4& mv, uint32_t flags);
 
 protected:
-    void reIndex(int indices);
-
-    int _indexSize;
-    std::vector<GLushort*> _ownedIndices;
+    static void reIndex(int indices);
+    // frees the index buffers replaced during the frame, called by the Renderer once all commands were drawn
+    static void releaseRetiredIndices();
 
     // shared across all instances
     static int __indexCapacity;
     static GLushort* __indices;
+    // buffers that may still be referenced by commands queued in the current frame
+    static std::vector<GLushort*> __retiredIndices;
+
+    friend class Renderer;
 };
 
 NS_CC_END
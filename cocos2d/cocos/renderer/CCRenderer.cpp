@@ -28,12 +28,14 @@
 #include <algorithm>
 
 #include "renderer/CCTrianglesCommand.h"
+#include "renderer/CCQuadCommand.h"
 #include "renderer/CCBatchCommand.h"
 #include "renderer/CCCustomCommand.h"
 #include "renderer/CCGroupCommand.h"
 #include "renderer/CCPrimitiveCommand.h"
 #include "renderer/CCMeshCommand.h"
 #include "renderer/CCGLProgramCache.h"
+#include "base/CCFrameArena.h"
 #include "renderer/CCMaterial.h"
 #include "renderer/CCTechnique.h"
 #include "renderer/CCPass.h"
@@ -45,6 +47,7 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCFrameProfiler.h"
 #include "2d/CCCamera.h"
 #include "2d/CCScene.h"
 
@@ -112,9 +115,10 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    // the merge buffers come from the frame arena, std::stable_sort would allocate them every frame
+    frameStableSort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
+    frameStableSort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
+    frameStableSort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -631,6 +635,8 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
 
 void Renderer::render()
 {
+    CC_PROFILE_ZONE("Renderer::render");
+
     //Uncomment this once everything is rendered by new renderer
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -661,6 +667,7 @@ void Renderer::clean()
         // {
         //     cmd->releaseToCommandPool();
         // }
+        // the queues keep their capacity, so that steady frames don't allocate
         _renderGroups[j].clear();
     }
 
@@ -669,6 +676,9 @@ void Renderer::clean()
     _filledVertex = 0;
     _filledIndex = 0;
     _lastBatchedMeshCommand = nullptr;
+
+    // no queued command refers to the index buffers replaced during this frame anymore
+    QuadCommand::releaseRetiredIndices();
 }
 
 void Renderer::clear()
@@ -733,6 +743,8 @@ void Renderer::drawBatchedTriangles()
     if(_queuedTriangleCommands.empty())
         return;
 
+    CC_PROFILE_ZONE("Renderer::flushTriangles");
+
     CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_BATCH_TRIANGLES");
 
     _filledVertex = 0;
@@ -236,7 +236,7 @@ protected:
     /* clear color set outside be used in setGLDefaultValues() */
     Color4F _clearColor;
 
-    std::stack<int> _commandGroupStack;
+    std::stack<int, std::vector<int>> _commandGroupStack;
     
     std::vector<RenderQueue> _renderGroups;
 
@@ -31,9 +31,15 @@ THE SOFTWARE.
 #include <errno.h>
 #include <stack>
 #include <cctype>
+#include <climits>
+#include <ctime>
 #include <list>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
 
 #include "renderer/CCTexture2D.h"
+#include "renderer/ccGLStateCache.h"
 #include "base/ccMacros.h"
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
@@ -41,6 +47,9 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
 #include "base/CCNinePatchImageParser.h"
+#include "base/CCConfiguration.h"
+#include "base/CCJobSystem.h"
+#include "xxhash.h"
 
 
 
@@ -50,6 +59,106 @@ NS_CC_BEGIN
 
 std::string TextureCache::s_etc1AlphaFileSuffix = "@alpha";
 
+namespace
+{
+    const char* DECODED_IMAGE_DIRECTORY = "decoded-images/";
+    const char DECODED_IMAGE_MAGIC[4] = { 'C', 'C', 'D', 'I' };
+    const uint32_t DECODED_IMAGE_VERSION = 2;
+    const char* DECODED_IMAGE_EXTENSION = ".pixels";
+    // the pixels are uploaded from the mapped file, GL_UNPACK_ALIGNMENT is up to 8
+    const uint32_t DECODED_IMAGE_DATA_ALIGNMENT = 16;
+
+    // the files of the decoded image cache hold this header, the path of the image, a padding then the pixels
+    struct DecodedImageHeader
+    {
+        char magic[4];
+        uint32_t version;
+        // the image file the pixels are decoded from
+        uint32_t sourceSize;
+        uint32_t sourceHash;
+        uint32_t pathLength;
+        int32_t pixelFormat;
+        int32_t width;
+        int32_t height;
+        uint32_t hasPremultipliedAlpha;
+        uint32_t dataOffset;
+        uint32_t dataLen;
+        // seconds since the epoch, the oldest entries are removed first when the cache is too big
+        uint32_t savedTime;
+    };
+
+    bool hashSource(const FileView& source, uint32_t* hash)
+    {
+        if (source.isNull() || source.getSize() > INT_MAX)
+            return false;
+        *hash = XXH32(source.getBytes(), static_cast<int>(source.getSize()), 0);
+        return true;
+    }
+
+    bool endsWith(const std::string& str, const char* suffix)
+    {
+        size_t length = strlen(suffix);
+        return str.size() >= length && str.compare(str.size() - length, length, suffix) == 0;
+    }
+
+    // removes the entries of images that don't exist anymore, e.g. an absolute path changed by an update,
+    // the entries of older versions and the files left by a crash, then the oldest entries over sizeLimit
+    void sweepDecodedImageCache(const std::string& directory, size_t sizeLimit)
+    {
+        struct Entry
+        {
+            std::string file;
+            size_t size;
+            uint32_t savedTime;
+        };
+        std::vector<Entry> entries;
+        size_t totalSize = 0;
+
+        auto fileUtils = FileUtils::getInstance();
+        for (const auto& file : fileUtils->listFiles(directory))
+        {
+            if (endsWith(file, "/"))
+                continue;
+
+            bool valid = false;
+            DecodedImageHeader header;
+            FILE* fp = endsWith(file, DECODED_IMAGE_EXTENSION) ? fopen(fileUtils->getSuitableFOpen(file).c_str(), "rb") : nullptr;
+            if (fp != nullptr)
+            {
+                if (fread(&header, sizeof(header), 1, fp) == 1 && memcmp(header.magic, DECODED_IMAGE_MAGIC, sizeof(header.magic)) == 0
+                    && header.version == DECODED_IMAGE_VERSION && header.pathLength < 4096)
+                {
+                    std::string path(header.pathLength, '\0');
+                    valid = (header.pathLength == 0 || fread(&path[0], header.pathLength, 1, fp) == 1) && fileUtils->isFileExist(path);
+                }
+                fclose(fp);
+            }
+
+            if (!valid)
+            {
+                fileUtils->removeFile(file);
+                continue;
+            }
+
+            Entry entry = { file, static_cast<size_t>(header.dataOffset) + header.dataLen, header.savedTime };
+            totalSize += entry.size;
+            entries.push_back(entry);
+        }
+
+        if (totalSize <= sizeLimit)
+            return;
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.savedTime < b.savedTime; });
+        for (const auto& entry : entries)
+        {
+            if (totalSize <= sizeLimit)
+                break;
+            if (fileUtils->removeFile(entry.file))
+                totalSize -= entry.size;
+        }
+    }
+}
+
 // implementation TextureCache
 
 void TextureCache::setETC1AlphaFileSuffix(const std::string& suffix)
@@ -67,10 +176,84 @@ TextureCache * TextureCache::getInstance()
     return Director::getInstance()->getTextureCache();
 }
 
+struct TextureCache::AsyncStruct
+{
+public:
+    AsyncStruct
+    ( const std::string& fn,const std::function<void(Texture2D*)>& f,
+      const std::string& key, AsyncPriority p )
+      : filename(fn), callback(f),callbackKey( key ),
+        pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
+        priority(p),
+        loadSuccess(false),
+        cancelled(false),
+        texture(nullptr)
+    {}
+
+    ~AsyncStruct()
+    {
+        CC_SAFE_RELEASE(texture);
+    }
+
+    std::string filename;
+    std::function<void(Texture2D*)> callback;
+    std::string callbackKey;
+    Image image;
+    Image imageAlpha;
+    Texture2D::PixelFormat pixelFormat;
+    AsyncPriority priority;
+    bool loadSuccess;
+    // set in GL thread, read by the decoders to skip the request
+    std::atomic<bool> cancelled;
+    // the retained texture of a streamed image, updated in place with preview then image
+    Texture2D* texture;
+    Image preview;
+    // empty if the image isn't in the decoded image cache
+    std::string decodedImageFile;
+    // the cached pixels, when the image isn't decoded
+    DecodedImage decoded;
+};
+
+// the unused textures are evicted when the cache is over its memory budget at this interval
+static const float MEMORY_BUDGET_CHECK_INTERVAL = 1.0f;
+// streamImage() parses the size of an image from this many bytes at most, unless its header is further
+static const size_t IMAGE_HEADER_MAX_SIZE = 64 * 1024;
+// the decoder threads keep their decode buffer up to the pixels of a 2048 x 2048 RGBA8888 image
+static const size_t DECODE_BUFFER_MAX_SIZE = 16 * 1024 * 1024;
+
+static size_t getTextureBytes(Texture2D* texture)
+{
+    if (texture->getPixelsWide() == 0 || texture->getPixelsHigh() == 0)
+        return 0;
+
+    // Each texture takes up width * height * bytesPerPixel bytes, its mipmaps a third more.
+    size_t bytes = static_cast<size_t>(texture->getPixelsWide()) * texture->getPixelsHigh() * texture->getBitsPerPixelForFormat() / 8;
+    if (texture->hasMipmaps())
+        bytes += bytes / 3;
+    if (texture->getAlphaTexture() != nullptr)
+        bytes += getTextureBytes(texture->getAlphaTexture());
+    return bytes;
+}
+
+static int getDefaultAsyncDecoderCount()
+{
+    // as many as the JobSystem workers
+    int count = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    return std::max(count, 2);
+}
+
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _decodeJobs(std::make_shared<DecodeJobs>())
+, _decodeJobCount(0)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _asyncDecoderCount(getDefaultAsyncDecoderCount())
+, _asyncUploadBudget(0.005f)
+, _streamingThreshold(0)
+, _memoryBudget(0)
+, _memoryUsage(0)
+, _evictions(0)
+, _reloads(0)
 {
 }
 
@@ -81,7 +264,11 @@ TextureCache::~TextureCache()
     for (auto& texture : _textures)
         texture.second->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    waitForQuit();
+
+    // requests still pending when the decoders quit
+    for (auto& asyncStruct : _asyncStructQueue)
+        delete asyncStruct;
 }
 
 void TextureCache::destroyInstance()
@@ -102,66 +289,19 @@ std::string TextureCache::getDescription() const
     return StringUtils::format("<TextureCache | Number of textures = %d>", static_cast<int>(_textures.size()));
 }
 
-struct TextureCache::AsyncStruct
-{
-public:
-    AsyncStruct
-    ( const std::string& fn,const std::function<void(Texture2D*)>& f,
-      const std::string& key )
-      : filename(fn), callback(f),callbackKey( key ),
-        pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
-    {}
-
-    std::string filename;
-    std::function<void(Texture2D*)> callback;
-    std::string callbackKey;
-    Image image;
-    Image imageAlpha;
-    Texture2D::PixelFormat pixelFormat;
-    bool loadSuccess;
-};
-
-/**
- The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
-
- the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
-
- the object's life time:
- - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
-
- Note:
- - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
-
- How to deal add image many times?
- - At first, this situation is abnormal, we only ensure the logic is correct.
- - If the image has been loaded, the after load image call will return immediately.
- - If the image request is in queue already, there will be more than one request in queue,
- - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
-
- Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
- problem.
-
- Call unbindImageAsync(path) to prevent the call to the callback when the
- texture is loaded.
- */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback)
 {
-    addImageAsync( path, callback, path );
+    addImageAsync( path, callback, path, AsyncPriority::VISIBLE );
 }
 
 /**
  The addImageAsync logic follow the steps:
  - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
+ - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (decode jobs of the JobSystem)
  - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+
+ There is one request queue and one response queue per AsyncPriority, the VISIBLE ones are always
+ popped first. Several decode jobs run in parallel, up to getAsyncDecoderCount(), so the responses don't come back in request order.
  
  the Critical Area include these members:
  - _requestQueue: locked by _requestMutex
@@ -169,7 +309,7 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
+ - image data: new in a decode job, delete in GL thread(by Image instance)
  
  Note:
  - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
@@ -181,8 +321,8 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
  
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
- problem.
+ - With several decode jobs many images can be decoded in one frame, so
+ addImageAsyncCallback stops once _asyncUploadBudget is spent and continues next frame.
 
  The callbackKey allows to unbind the callback in cases where the loading of
  path is requested by several sources simultaneously. Each source can then
@@ -190,14 +330,22 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  unbindImageAsync(path) would be ambiguous.
  */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+{
+    addImageAsync(path, callback, callbackKey, AsyncPriority::VISIBLE);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority)
 {
     Texture2D *texture = nullptr;
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(getCompressedTexturePath(path));
 
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
+    {
         texture = it->second;
+        touchTexture(fullpath);
+    }
 
     if (texture != nullptr)
     {
@@ -211,12 +359,21 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
-    // lazy init
-    if (_loadingThread == nullptr)
+    // generate async struct
+    AsyncStruct *data =
+      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey, priority);
+
+    queueAsyncStruct(data);
+}
+
+void TextureCache::queueAsyncStruct(AsyncStruct* asyncStruct)
+{
+    // loading again after waitForQuit(), the jobs of before still queued don't start
+    if (_needQuit)
     {
-        // create a new thread to load images
+        _decodeJobs = std::make_shared<DecodeJobs>();
+        _decodeJobCount = 0;
         _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
     }
 
     if (0 == _asyncRefCount)
@@ -226,15 +383,54 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     ++_asyncRefCount;
 
-    // generate async struct
-    AsyncStruct *data =
-      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
-    
+    // the decoders don't read the settings of the cache, they may change meanwhile
+    asyncStruct->decodedImageFile = getDecodedImageFile(asyncStruct->filename, asyncStruct->pixelFormat);
+
     // add async struct into queue
-    _asyncStructQueue.push_back(data);
+    _asyncStructQueue.push_back(asyncStruct);
     std::unique_lock<std::mutex> ul(_requestMutex);
-    _requestQueue.push_back(data);
-    _sleepCondition.notify_one();
+    _requestQueue[static_cast<int>(asyncStruct->priority)].push_back(asyncStruct);
+
+    // the running jobs decode the requests until there are none left, another one is only needed below the limit
+    if (_decodeJobCount < _asyncDecoderCount)
+    {
+        ++_decodeJobCount;
+        ul.unlock();
+
+        auto decodeJobs = _decodeJobs;
+        auto priority = asyncStruct->priority == AsyncPriority::VISIBLE ? JobSystem::Priority::NORMAL : JobSystem::Priority::LOW;
+        JobSystem::getInstance()->schedule([this, decodeJobs]() {
+            {
+                std::lock_guard<std::mutex> lock(decodeJobs->mutex);
+                if (decodeJobs->quit)
+                    return;
+                ++decodeJobs->running;
+            }
+
+            loadImage();
+
+            std::lock_guard<std::mutex> lock(decodeJobs->mutex);
+            --decodeJobs->running;
+            decodeJobs->finished.notify_all();
+        }, priority);
+    }
+}
+
+void TextureCache::cancelImageAsync(const std::string& callbackKey)
+{
+    for (auto& asyncStruct : _asyncStructQueue)
+    {
+        if (asyncStruct->callbackKey == callbackKey)
+        {
+            asyncStruct->callback = nullptr;
+            asyncStruct->cancelled = true;
+        }
+    }
+}
+
+void TextureCache::setAsyncDecoderCount(int count)
+{
+    _asyncDecoderCount = std::max(count, 1);
 }
 
 void TextureCache::unbindImageAsync(const std::string& callbackKey)
@@ -269,31 +465,74 @@ void TextureCache::unbindAllImageAsync()
 void TextureCache::loadImage()
 {
     AsyncStruct *asyncStruct = nullptr;
-    while (!_needQuit)
+    while (true)
     {
         std::unique_lock<std::mutex> ul(_requestMutex);
-        // pop an AsyncStruct from request queue
-        if (_requestQueue.empty())
+        if (_needQuit)
         {
-            asyncStruct = nullptr;
+            break;
         }
-        else
+
+        // pop an AsyncStruct from request queue, visible requests first
+        asyncStruct = nullptr;
+        for (auto& requestQueue : _requestQueue)
         {
-            asyncStruct = _requestQueue.front();
-            _requestQueue.pop_front();
+            if (!requestQueue.empty())
+            {
+                asyncStruct = requestQueue.front();
+                requestQueue.pop_front();
+                break;
+            }
         }
 
+        // the job ends, the next request schedules another one
         if (nullptr == asyncStruct) {
-            if (_needQuit) {
-                break;
-            }
-            _sleepCondition.wait(ul);
-            continue;
+            --_decodeJobCount;
+            break;
         }
         ul.unlock();
 
-        // load image
-        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+        // cancelled requests are only handed back to the GL thread to be released
+        if (asyncStruct->cancelled)
+        {
+            std::lock_guard<std::mutex> lock(_responseMutex);
+            _responseQueue[static_cast<int>(asyncStruct->priority)].push_back(asyncStruct);
+            continue;
+        }
+
+        // read once for the preview, the decoded image cache and the image
+        FileView source = FileUtils::getInstance()->getContentsView(asyncStruct->filename);
+
+        // a streamed image shows its low resolution version while the full one is decoded
+        if (asyncStruct->texture != nullptr)
+        {
+            if (!source.isNull() && asyncStruct->preview.initWithImagePreview(source.getBytes(), source.getSize()))
+            {
+                asyncStruct->preview.convertToFormat(asyncStruct->pixelFormat);
+
+                std::lock_guard<std::mutex> lock(_responseMutex);
+                _previewQueue.push_back(asyncStruct);
+            }
+        }
+
+        // the pixels of the last launches are uploaded as they are, a streamed texture is updated from an image
+        if (!asyncStruct->decodedImageFile.empty())
+        {
+            if (asyncStruct->texture == nullptr && loadDecodedImage(asyncStruct->decodedImageFile, asyncStruct->filename, source, &asyncStruct->decoded))
+            {
+                asyncStruct->loadSuccess = true;
+
+                std::lock_guard<std::mutex> lock(_responseMutex);
+                _responseQueue[static_cast<int>(asyncStruct->priority)].push_back(asyncStruct);
+                continue;
+            }
+        }
+
+        // load image, converted here rather than on the GL thread in initWithImage(),
+        // except the nine-patch images, their insets are parsed from the RGBA8888 pixels
+        bool convert = !NinePatchImageParser::isNinePatchImage(asyncStruct->filename);
+        asyncStruct->loadSuccess = decodeImage(&asyncStruct->image, asyncStruct->filename, source,
+                                               convert ? asyncStruct->pixelFormat : Texture2D::PixelFormat::AUTO);
 
         // ETC1 ALPHA supports.
         if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
@@ -302,33 +541,101 @@ void TextureCache::loadImage()
             if (FileUtils::getInstance()->isFileExist(alphaFile))
                 asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
         }
+
+        if (asyncStruct->loadSuccess && convert && !asyncStruct->decodedImageFile.empty())
+        {
+            saveDecodedImage(asyncStruct->decodedImageFile, asyncStruct->filename, source, &asyncStruct->image);
+        }
+
         // push the asyncStruct to response queue
         _responseMutex.lock();
-        _responseQueue.push_back(asyncStruct);
+        _responseQueue[static_cast<int>(asyncStruct->priority)].push_back(asyncStruct);
         _responseMutex.unlock();
     }
 }
 
+bool TextureCache::decodeImage(Image* image, const std::string& fullpath, const FileView& source, Texture2D::PixelFormat pixelFormat)
+{
+    // the images converted to another format are decoded into a buffer kept by the decoder thread,
+    // rather than into pixels allocated for each image and freed right after the conversion
+    Image header;
+    if (!source.isNull() && pixelFormat != Texture2D::PixelFormat::AUTO && pixelFormat != Texture2D::PixelFormat::NONE
+        && header.initWithImageHeader(source.getBytes(), source.getSize()) && header.getRenderFormat() != pixelFormat)
+    {
+        static thread_local std::vector<unsigned char> t_decodeBuffer;
+        ResizableBufferAdapter<std::vector<unsigned char>> buffer(&t_decodeBuffer);
+
+        bool converted = false;
+        image->_filePath = fullpath;
+        if (image->initWithImageData(source.getBytes(), source.getSize(), &buffer))
+        {
+            unsigned char* outData = nullptr;
+            ssize_t outDataLen = 0;
+            Texture2D::PixelFormat outFormat = Texture2D::convertDataToFormat(t_decodeBuffer.data(), image->_dataLen, image->_renderFormat, pixelFormat, &outData, &outDataLen);
+            if (outData != nullptr && outData != t_decodeBuffer.data())
+            {
+                image->_data = outData;
+                image->_dataLen = outDataLen;
+                image->_renderFormat = outFormat;
+                converted = true;
+            }
+        }
+
+        // the buffer of a very large image isn't kept for the next ones
+        if (t_decodeBuffer.capacity() > DECODE_BUFFER_MAX_SIZE)
+        {
+            std::vector<unsigned char>().swap(t_decodeBuffer);
+        }
+
+        if (converted)
+        {
+            return true;
+        }
+    }
+
+    bool ret = image->initWithImageFileThreadSafe(fullpath, source);
+    if (ret)
+    {
+        image->convertToFormat(pixelFormat);
+    }
+    return ret;
+}
+
 void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
     Texture2D *texture = nullptr;
     AsyncStruct *asyncStruct = nullptr;
+    auto start = std::chrono::steady_clock::now();
+
+    // the low resolution images of the streamed textures are small, they are all uploaded
+    std::deque<AsyncStruct*> previewQueue;
+    _responseMutex.lock();
+    previewQueue.swap(_previewQueue);
+    _responseMutex.unlock();
+
+    for (auto& preview : previewQueue)
+    {
+        updateStreamingTexture(preview->texture, &preview->preview, preview->pixelFormat);
+    }
+
     while (true)
     {
-        // pop an AsyncStruct from response queue
+        // pop an AsyncStruct from response queue, visible requests first
+        asyncStruct = nullptr;
         _responseMutex.lock();
-        if (_responseQueue.empty())
+        for (auto& responseQueue : _responseQueue)
         {
-            asyncStruct = nullptr;
+            if (!responseQueue.empty())
+            {
+                asyncStruct = responseQueue.front();
+                responseQueue.pop_front();
+                break;
+            }
         }
-        else
+        // the full image replaces a low resolution one still waiting
+        if (asyncStruct != nullptr && asyncStruct->texture != nullptr)
         {
-            asyncStruct = _responseQueue.front();
-            _responseQueue.pop_front();
-
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
+            _previewQueue.erase(std::remove(_previewQueue.begin(), _previewQueue.end(), asyncStruct), _previewQueue.end());
         }
         _responseMutex.unlock();
 
@@ -336,16 +643,59 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
             break;
         }
 
+        // the requests are decoded in parallel, they don't complete in the order of _asyncStructQueue
+        auto queued = std::find(_asyncStructQueue.begin(), _asyncStructQueue.end(), asyncStruct);
+        CC_ASSERT(queued != _asyncStructQueue.end());
+        _asyncStructQueue.erase(queued);
+
         // check the image has been convert to texture or not
         auto it = _textures.find(asyncStruct->filename);
-        if (it != _textures.end())
+        if (asyncStruct->cancelled)
+        {
+            texture = nullptr;
+        }
+        else if (asyncStruct->texture != nullptr)
+        {
+            // a streamed image, its texture is updated even if it was removed from the cache
+            texture = asyncStruct->texture;
+            if (asyncStruct->loadSuccess && updateStreamingTexture(texture, &asyncStruct->image, asyncStruct->pixelFormat))
+            {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                // the pixel format of the image is known now
+                VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
+#endif
+                if (it != _textures.end() && it->second == texture)
+                    updateTextureBytes(asyncStruct->filename);
+            }
+            else
+            {
+                CCLOG("cocos2d: failed to stream the image %s", asyncStruct->filename.c_str());
+            }
+        }
+        else if (it != _textures.end())
         {
             texture = it->second;
+            touchTexture(asyncStruct->filename);
         }
         else
         {
+            if (asyncStruct->loadSuccess && asyncStruct->decoded.data != nullptr)
+            {
+                texture = createTextureWithDecodedImage(asyncStruct->decoded, asyncStruct->filename);
+                if (texture != nullptr)
+                {
+                    texture->autorelease();
+                    // cache the texture. retain it, since it is added in the map
+                    texture->retain();
+                    cacheTexture(asyncStruct->filename, texture, true);
+                }
+                else
+                {
+                    CCLOG("cocos2d: failed to call TextureCache::addImageAsync(%s)", asyncStruct->filename.c_str());
+                }
+            }
             // convert image to texture
-            if (asyncStruct->loadSuccess)
+            else if (asyncStruct->loadSuccess)
             {
                 Image* image = &(asyncStruct->image);
                 // generate texture in render thread
@@ -358,10 +708,6 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                 // cache the texture file name
                 VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
 #endif
-                // cache the texture. retain it, since it is added in the map
-                _textures.emplace(asyncStruct->filename, texture);
-                texture->retain();
-
                 texture->autorelease();
                 // ETC1 ALPHA supports.
                 if (asyncStruct->imageAlpha.getFileType() == Image::Format::ETC) {
@@ -371,6 +717,10 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                     }
                     CC_SAFE_RELEASE(alphaTexture);
                 }
+
+                // cache the texture. retain it, since it is added in the map
+                texture->retain();
+                cacheTexture(asyncStruct->filename, texture, true);
             }
             else {
                 texture = nullptr;
@@ -387,6 +737,14 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         // release the asyncStruct
         delete asyncStruct;
         --_asyncRefCount;
+
+        // the remaining responses are handled in the next frames
+        if (_asyncUploadBudget > 0)
+        {
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= _asyncUploadBudget)
+                break;
+        }
     }
 
     if (0 == _asyncRefCount)
@@ -403,14 +761,45 @@ Texture2D * TextureCache::addImage(const std::string &path)
     // MUTEX:
     // Needed since addImageAsync calls this method from a different thread
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(getCompressedTexturePath(path));
     if (fullpath.size() == 0)
     {
         return nullptr;
     }
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
+    {
         texture = it->second;
+        touchTexture(fullpath);
+    }
+
+    // the pixels of the last launches are uploaded as they are
+    std::string decodedImageFile;
+    FileView source;
+    if (!texture)
+    {
+        decodedImageFile = getDecodedImageFile(fullpath, Texture2D::getDefaultAlphaPixelFormat());
+    }
+    if (!decodedImageFile.empty())
+    {
+        DecodedImage decoded;
+        source = FileUtils::getInstance()->getContentsView(fullpath);
+        if (loadDecodedImage(decodedImageFile, fullpath, source, &decoded))
+        {
+            texture = createTextureWithDecodedImage(decoded, fullpath);
+            if (texture)
+            {
+                // texture already retained, no need to re-retain it
+                cacheTexture(fullpath, texture, true);
+            }
+        }
+    }
+
+    if (!texture && _streamingThreshold > 0)
+    {
+        // large images are decoded by the asynchronous decoders
+        texture = streamImage(fullpath);
+    }
 
     if (!texture)
     {
@@ -420,20 +809,28 @@ Texture2D * TextureCache::addImage(const std::string &path)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
-            bool bRet = image->initWithImageFile(fullpath);
+            // the file was already read for the decoded image cache
+            bool bRet = source.isNull() ? image->initWithImageFile(fullpath) : image->initWithImageFileThreadSafe(fullpath, source);
             CC_BREAK_IF(!bRet);
 
+            // the cache holds the pixels as they are uploaded
+            if (!decodedImageFile.empty())
+            {
+                image->convertToFormat(Texture2D::getDefaultAlphaPixelFormat());
+            }
+
             texture = new (std::nothrow) Texture2D();
 
             if (texture && texture->initWithImage(image))
             {
+                if (!decodedImageFile.empty())
+                {
+                    saveDecodedImage(decodedImageFile, fullpath, source, image);
+                }
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
                 VolatileTextureMgr::addImageTexture(texture, fullpath);
 #endif
-                // texture already retained, no need to re-retain it
-                _textures.emplace(fullpath, texture);
-
                 //-- ANDROID ETC1 ALPHA SUPPORTS.
                 std::string alphaFullPath = path + s_etc1AlphaFileSuffix;
                 if (image->getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty() && FileUtils::getInstance()->isFileExist(alphaFullPath))
@@ -451,6 +848,9 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, path);
+
+                // texture already retained, no need to re-retain it
+                cacheTexture(fullpath, texture, true);
             }
             else
             {
@@ -466,6 +866,287 @@ Texture2D * TextureCache::addImage(const std::string &path)
     return texture;
 }
 
+bool TextureCache::isTextureStreaming(Texture2D* texture) const
+{
+    for (auto& asyncStruct : _asyncStructQueue)
+    {
+        if (texture != nullptr && asyncStruct->texture == texture)
+            return true;
+    }
+    return false;
+}
+
+Texture2D* TextureCache::streamImage(const std::string& fullpath)
+{
+    // the nine-patch info is parsed from the full image
+    if (NinePatchImageParser::isNinePatchImage(fullpath))
+    {
+        return nullptr;
+    }
+
+    // the GL thread only reads the beginning of the file, unless the header is further
+    Image header;
+    {
+        Data data;
+        if (FileUtils::getInstance()->getContentsPrefix(fullpath, IMAGE_HEADER_MAX_SIZE, &data) != FileUtils::Status::OK)
+            return nullptr;
+
+        if (!header.initWithImageHeader(data.getBytes(), data.getSize()))
+        {
+            if (static_cast<size_t>(data.getSize()) < IMAGE_HEADER_MAX_SIZE)
+                return nullptr;
+
+            FileView view = FileUtils::getInstance()->getContentsView(fullpath, FileUtils::AccessPattern::NORMAL);
+            if (view.isNull() || !header.initWithImageHeader(view.getBytes(), view.getSize()))
+                return nullptr;
+        }
+    }
+
+    if (static_cast<unsigned long long>(header.getWidth()) * header.getHeight() < _streamingThreshold)
+    {
+        return nullptr;
+    }
+
+    static const unsigned char TRANSPARENT_PIXEL[] = { 0, 0, 0, 0 };
+
+    Texture2D* texture = new (std::nothrow) Texture2D();
+    if (texture == nullptr || !texture->initWithData(TRANSPARENT_PIXEL, sizeof(TRANSPARENT_PIXEL), Texture2D::PixelFormat::RGBA8888, 1, 1, Size(1, 1)))
+    {
+        CC_SAFE_RELEASE(texture);
+        return nullptr;
+    }
+
+    // it has the size of the image from the start, so the sprites get the right rect
+    texture->_pixelsWide = header.getWidth();
+    texture->_pixelsHigh = header.getHeight();
+    texture->_contentSize = Size((float)header.getWidth(), (float)header.getHeight());
+    // the sprites choose their blend function from it when the texture is set
+    texture->_hasPremultipliedAlpha = header.hasPremultipliedAlpha();
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // cache the texture file name
+    VolatileTextureMgr::addImageTexture(texture, fullpath);
+#endif
+    // texture already retained, no need to re-retain it
+    cacheTexture(fullpath, texture, true);
+
+    // no callback key, cancelImageAsync() and unbindImageAsync() don't find it
+    AsyncStruct* asyncStruct = new (std::nothrow) AsyncStruct(fullpath, nullptr, "", AsyncPriority::VISIBLE);
+    asyncStruct->texture = texture;
+    texture->retain();
+    queueAsyncStruct(asyncStruct);
+
+    return texture;
+}
+
+bool TextureCache::updateStreamingTexture(Texture2D* texture, Image* image, Texture2D::PixelFormat pixelFormat)
+{
+    // initWithImage() creates a new GL texture, the parameters set on the current one are kept
+    GLint minFilter = GL_LINEAR, magFilter = GL_LINEAR, wrapS = GL_CLAMP_TO_EDGE, wrapT = GL_CLAMP_TO_EDGE;
+    GL::bindTexture2D(texture->getName());
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &magFilter);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &wrapS);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, &wrapT);
+
+    bool hasMipmaps = texture->hasMipmaps();
+    int pixelsWide = texture->_pixelsWide;
+    int pixelsHigh = texture->_pixelsHigh;
+
+    if (!texture->initWithImage(image, pixelFormat))
+    {
+        return false;
+    }
+
+    // the low resolution versions keep the size of the image, the texture coordinates don't change
+    texture->_pixelsWide = pixelsWide;
+    texture->_pixelsHigh = pixelsHigh;
+    texture->_contentSize = Size((float)pixelsWide, (float)pixelsHigh);
+
+    if (hasMipmaps && image->getWidth() == ccNextPOT(image->getWidth()) && image->getHeight() == ccNextPOT(image->getHeight()))
+    {
+        texture->generateMipmap();
+    }
+    if (!texture->hasMipmaps() && minFilter != GL_NEAREST && minFilter != GL_LINEAR)
+    {
+        minFilter = texture->_antialiasEnabled ? GL_LINEAR : GL_NEAREST;
+    }
+
+    Texture2D::TexParams texParams = { (GLuint)minFilter, (GLuint)magFilter, (GLuint)wrapS, (GLuint)wrapT };
+    texture->setTexParameters(texParams);
+    return true;
+}
+
+void TextureCache::setDecodedImageCacheEnabled(bool enabled, size_t sizeLimit)
+{
+    _decodedImageCachePath.clear();
+    if (!enabled)
+        return;
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string path = fileUtils->getWritablePath() + DECODED_IMAGE_DIRECTORY;
+    if (!fileUtils->isDirectoryExist(path) && !fileUtils->createDirectory(path))
+    {
+        CCLOG("cocos2d: TextureCache: can't create the decoded image cache in %s", path.c_str());
+        return;
+    }
+    _decodedImageCachePath = path;
+
+    // it only reads the headers, but of every entry, the images are loaded meanwhile
+    JobSystem::getInstance()->schedule([path, sizeLimit]() {
+        sweepDecodedImageCache(path, sizeLimit);
+    }, JobSystem::Priority::LOW);
+}
+
+void TextureCache::removeDecodedImageCache()
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string path = fileUtils->getWritablePath() + DECODED_IMAGE_DIRECTORY;
+    if (fileUtils->isDirectoryExist(path))
+        fileUtils->removeDirectory(path);
+    if (!_decodedImageCachePath.empty())
+        fileUtils->createDirectory(_decodedImageCachePath);
+}
+
+std::string TextureCache::getDecodedImageFile(const std::string& fullpath, Texture2D::PixelFormat pixelFormat) const
+{
+    // the nine-patch info is parsed from the decoded image
+    if (_decodedImageCachePath.empty() || NinePatchImageParser::isNinePatchImage(fullpath))
+        return "";
+
+    // the settings changing the decoded pixels are part of the name, the entries of other settings are kept
+    // until the size limit removes them
+    int length = static_cast<int>(fullpath.size());
+    int options = (Image::PNG_PREMULTIPLIED_ALPHA_ENABLED ? 1 : 0) | (CC_ENABLE_PREMULTIPLIED_ALPHA != 0 ? 2 : 0);
+    return StringUtils::format("%s%08x%08x-%d-%d%s", _decodedImageCachePath.c_str(),
+                               XXH32(fullpath.data(), length, 0), XXH32(fullpath.data(), length, 1),
+                               static_cast<int>(pixelFormat), options, DECODED_IMAGE_EXTENSION);
+}
+
+bool TextureCache::loadDecodedImage(const std::string& decodedImageFile, const std::string& fullpath, const FileView& source, DecodedImage* decoded)
+{
+    auto fileUtils = FileUtils::getInstance();
+    uint32_t sourceHash = 0;
+    if (!fileUtils->isFileExist(decodedImageFile) || !hashSource(source, &sourceHash))
+        return false;
+
+    FileView view = fileUtils->getContentsView(decodedImageFile);
+    DecodedImageHeader header;
+    if (view.getSize() < static_cast<ssize_t>(sizeof(header)))
+        return false;
+    memcpy(&header, view.getBytes(), sizeof(header));
+
+    // an image changed since it was cached is decoded again, the entry is replaced then
+    if (memcmp(header.magic, DECODED_IMAGE_MAGIC, sizeof(header.magic)) != 0 || header.version != DECODED_IMAGE_VERSION
+        || header.sourceSize != static_cast<uint32_t>(source.getSize()) || header.sourceHash != sourceHash
+        || header.pathLength != fullpath.size() || header.width <= 0 || header.height <= 0)
+        return false;
+
+    const unsigned char* path = view.getBytes() + sizeof(header);
+    if (header.dataOffset < sizeof(header) + header.pathLength || header.dataOffset % DECODED_IMAGE_DATA_ALIGNMENT != 0
+        || view.getSize() != static_cast<ssize_t>(header.dataOffset) + header.dataLen
+        || memcmp(path, fullpath.data(), header.pathLength) != 0)
+        return false;
+
+    auto pixelFormat = static_cast<Texture2D::PixelFormat>(header.pixelFormat);
+    auto& formats = Texture2D::getPixelFormatInfoMap();
+    auto format = formats.find(pixelFormat);
+    if (format == formats.end() || format->second.compressed
+        || header.dataLen != static_cast<uint64_t>(header.width) * header.height * format->second.bpp / 8)
+        return false;
+
+    decoded->view = view;
+    decoded->data = view.getBytes() + header.dataOffset;
+    decoded->dataLen = header.dataLen;
+    decoded->pixelFormat = pixelFormat;
+    decoded->width = header.width;
+    decoded->height = header.height;
+    decoded->hasPremultipliedAlpha = header.hasPremultipliedAlpha != 0;
+    return true;
+}
+
+void TextureCache::saveDecodedImage(const std::string& decodedImageFile, const std::string& fullpath, const FileView& source, Image* image)
+{
+    // only the images whose decoding takes time
+    switch (image->getFileType())
+    {
+        case Image::Format::PNG:
+        case Image::Format::JPG:
+        case Image::Format::WEBP:
+        case Image::Format::TIFF:
+        case Image::Format::TGA:
+            break;
+        default:
+            return;
+    }
+
+    uint32_t sourceHash = 0;
+    if (image->getData() == nullptr || image->_unpack || image->getNumberOfMipmaps() > 1 || image->isCompressed()
+        || image->getDataLen() > UINT_MAX || !hashSource(source, &sourceHash))
+        return;
+
+    DecodedImageHeader header;
+    memcpy(header.magic, DECODED_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = DECODED_IMAGE_VERSION;
+    header.sourceSize = static_cast<uint32_t>(source.getSize());
+    header.sourceHash = sourceHash;
+    header.pathLength = static_cast<uint32_t>(fullpath.size());
+    header.pixelFormat = static_cast<int32_t>(image->getRenderFormat());
+    header.width = image->getWidth();
+    header.height = image->getHeight();
+    header.hasPremultipliedAlpha = image->hasPremultipliedAlpha() ? 1 : 0;
+    header.dataOffset = static_cast<uint32_t>(sizeof(header) + fullpath.size() + DECODED_IMAGE_DATA_ALIGNMENT - 1) / DECODED_IMAGE_DATA_ALIGNMENT * DECODED_IMAGE_DATA_ALIGNMENT;
+    header.dataLen = static_cast<uint32_t>(image->getDataLen());
+    header.savedTime = static_cast<uint32_t>(time(nullptr));
+    static const char PADDING[DECODED_IMAGE_DATA_ALIGNMENT] = {};
+    size_t paddingLength = header.dataOffset - sizeof(header) - fullpath.size();
+
+    // written aside then renamed, a file being read or written by another thread is never seen half written
+    auto fileUtils = FileUtils::getInstance();
+    std::string tempFile = StringUtils::format("%s.%x.tmp", decodedImageFile.c_str(),
+                                               static_cast<unsigned int>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+    FILE* fp = fopen(fileUtils->getSuitableFOpen(tempFile).c_str(), "wb");
+    if (fp == nullptr)
+        return;
+
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+        && fwrite(fullpath.data(), fullpath.size(), 1, fp) == 1
+        && (paddingLength == 0 || fwrite(PADDING, paddingLength, 1, fp) == 1)
+        && fwrite(image->getData(), image->getDataLen(), 1, fp) == 1;
+    written = (fclose(fp) == 0) && written;
+
+    if (!written || !fileUtils->renameFile(tempFile, decodedImageFile))
+    {
+        CCLOG("cocos2d: TextureCache: can't cache the decoded image %s", fullpath.c_str());
+        fileUtils->removeFile(tempFile);
+    }
+}
+
+Texture2D* TextureCache::createTextureWithDecodedImage(const DecodedImage& decoded, const std::string& fullpath)
+{
+    int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+    if (decoded.width > maxTextureSize || decoded.height > maxTextureSize)
+        return nullptr;
+
+    Texture2D* texture = new (std::nothrow) Texture2D();
+    if (texture == nullptr || !texture->initWithData(decoded.data, decoded.dataLen, decoded.pixelFormat, decoded.width, decoded.height,
+                                                     Size((float)decoded.width, (float)decoded.height)))
+    {
+        CC_SAFE_RELEASE(texture);
+        return nullptr;
+    }
+
+    // what initWithImage() sets from the image
+    texture->_hasPremultipliedAlpha = decoded.hasPremultipliedAlpha;
+    texture->_filePath = fullpath;
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // cache the texture file name
+    VolatileTextureMgr::addImageTexture(texture, fullpath);
+#endif
+    return texture;
+}
+
 void TextureCache::parseNinePatchImage(cocos2d::Image *image, cocos2d::Texture2D *texture, const std::string& path)
 {
     if (NinePatchImageParser::isNinePatchImage(path))
@@ -489,6 +1170,7 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
         auto it = _textures.find(key);
         if (it != _textures.end()) {
             texture = it->second;
+            touchTexture(key);
             break;
         }
 
@@ -498,7 +1180,8 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
         {
             if (texture->initWithImage(image))
             {
-                _textures.emplace(key, texture);
+                // the image can't be loaded again, the texture is never evicted
+                cacheTexture(key, texture, false);
             }
             else
             {
@@ -526,7 +1209,7 @@ bool TextureCache::reloadTexture(const std::string& fileName)
     Texture2D * texture = nullptr;
     Image * image = nullptr;
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(fileName);
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(getCompressedTexturePath(fileName));
     if (fullpath.size() == 0)
     {
         return false;
@@ -552,6 +1235,9 @@ bool TextureCache::reloadTexture(const std::string& fileName)
             CC_BREAK_IF(!bRet);
 
             ret = texture->initWithImage(image);
+
+            // the size or the format of the file may have changed
+            updateTextureBytes(fullpath);
         } while (0);
     }
 
@@ -568,6 +1254,9 @@ void TextureCache::removeAllTextures()
         texture.second->release();
     }
     _textures.clear();
+    _textureUsages.clear();
+    _evictedTextures.clear();
+    _memoryUsage = 0;
 }
 
 void TextureCache::removeUnusedTextures()
@@ -577,8 +1266,7 @@ void TextureCache::removeUnusedTextures()
         if (tex->getReferenceCount() == 1) {
             CCLOG("cocos2d: TextureCache: removing unused texture: %s", it->first.c_str());
 
-            tex->release();
-            it = _textures.erase(it);
+            it = uncacheTexture(it);
         }
         else {
             ++it;
@@ -596,8 +1284,7 @@ void TextureCache::removeTexture(Texture2D* texture)
 
     for (auto it = _textures.cbegin(); it != _textures.cend(); /* nothing */) {
         if (it->second == texture) {
-            it->second->release();
-            it = _textures.erase(it);
+            it = uncacheTexture(it);
             break;
         }
         else
@@ -611,14 +1298,16 @@ void TextureCache::removeTextureForKey(const std::string &textureKeyName)
     auto it = _textures.find(key);
 
     if (it == _textures.end()) {
-        key = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
+        key = FileUtils::getInstance()->fullPathForFilename(getCompressedTexturePath(textureKeyName));
         it = _textures.find(key);
     }
 
     if (it != _textures.end()) {
-        it->second->release();
-        _textures.erase(it);
+        uncacheTexture(it);
     }
+
+    // removed on purpose, it isn't loaded again by getTextureForKey
+    _evictedTextures.erase(key);
 }
 
 Texture2D* TextureCache::getTextureForKey(const std::string &textureKeyName) const
@@ -627,15 +1316,89 @@ Texture2D* TextureCache::getTextureForKey(const std::string &textureKeyName) con
     auto it = _textures.find(key);
 
     if (it == _textures.end()) {
-        key = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
+        key = FileUtils::getInstance()->fullPathForFilename(getCompressedTexturePath(textureKeyName));
         it = _textures.find(key);
     }
 
     if (it != _textures.end())
+    {
+        touchTexture(it->first);
         return it->second;
+    }
+
+    // evicted to fit in the memory budget, the key is its full path
+    if (_evictedTextures.find(key) != _evictedTextures.end())
+    {
+        return const_cast<TextureCache*>(this)->addImage(key);
+    }
     return nullptr;
 }
 
+bool TextureCache::addCompressedTextureManifest(const std::string& manifestFile)
+{
+    // the variants of the manifests, from the best to the worst
+    static const struct
+    {
+        const char* name;
+        bool (Configuration::*isSupported)() const;
+    } VARIANTS[] = {
+        { "astc", &Configuration::supportsASTC },
+        { "etc2", &Configuration::supportsETC2 },
+        { "s3tc", &Configuration::supportsS3TC },
+        { "atitc", &Configuration::supportsATITC },
+        { "pvrtc", &Configuration::supportsPVRTC },
+    };
+
+    ValueMap manifest = FileUtils::getInstance()->getValueMapFromFile(manifestFile);
+    auto texturesIter = manifest.find("textures");
+    if (texturesIter == manifest.end() || texturesIter->second.getType() != Value::Type::MAP)
+    {
+        CCLOG("cocos2d: TextureCache: invalid compressed texture manifest: %s", manifestFile.c_str());
+        return false;
+    }
+
+    std::string directory;
+    size_t slash = manifestFile.find_last_of('/');
+    if (slash != std::string::npos)
+    {
+        directory = manifestFile.substr(0, slash + 1);
+    }
+
+    Configuration* configuration = Configuration::getInstance();
+    for (const auto& texture : texturesIter->second.asValueMap())
+    {
+        if (texture.second.getType() != Value::Type::MAP)
+            continue;
+
+        const ValueMap& variants = texture.second.asValueMap();
+        for (const auto& variant : VARIANTS)
+        {
+            auto variantIter = variants.find(variant.name);
+            if (variantIter != variants.end() && (configuration->*variant.isSupported)())
+            {
+                _compressedTexturePaths[texture.first] = directory + variantIter->second.asString();
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+void TextureCache::removeAllCompressedTextureManifests()
+{
+    _compressedTexturePaths.clear();
+}
+
+const std::string& TextureCache::getCompressedTexturePath(const std::string& path) const
+{
+    if (_compressedTexturePaths.empty())
+        return path;
+
+    auto it = _compressedTexturePaths.find(path);
+    return it != _compressedTexturePaths.end() ? it->second : path;
+}
+
 void TextureCache::reloadAllTextures()
 {
     //will do nothing
@@ -659,12 +1422,15 @@ std::string TextureCache::getTextureFilePath(cocos2d::Texture2D* texture) const
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
-    std::unique_lock<std::mutex> ul(_requestMutex);
-    _needQuit = true;
-    _sleepCondition.notify_one();
-    ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    // the running jobs stop after their current request, the queued ones won't start
+    {
+        std::lock_guard<std::mutex> lock(_requestMutex);
+        _needQuit = true;
+    }
+    std::unique_lock<std::mutex> ul(_decodeJobs->mutex);
+    _decodeJobs->quit = true;
+    auto decodeJobs = _decodeJobs;
+    _decodeJobs->finished.wait(ul, [&decodeJobs]() { return decodeJobs->running == 0; });
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -682,8 +1448,7 @@ std::string TextureCache::getCachedTextureInfo() const
 
         Texture2D* tex = texture.second;
         unsigned int bpp = tex->getBitsPerPixelForFormat();
-        // Each texture takes up width * height * bytesPerPixel bytes.
-        auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
+        auto bytes = getTextureBytes(tex);
         totalBytes += bytes;
         count++;
         snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB\n",
@@ -701,9 +1466,164 @@ std::string TextureCache::getCachedTextureInfo() const
     snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)\n", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
     buffer += buftmp;
 
+    if (_memoryBudget > 0)
+    {
+        snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache budget: %.2f MB, %ld textures evicted, %ld reloaded\n",
+            _memoryBudget / (1024.0f*1024.0f), (long)_evictions, (long)_reloads);
+        buffer += buftmp;
+    }
+
     return buffer;
 }
 
+void TextureCache::setMemoryBudget(size_t bytes)
+{
+    Scheduler* scheduler = Director::getInstance()->getScheduler();
+    if (bytes > 0 && _memoryBudget == 0)
+    {
+        scheduler->schedule(CC_SCHEDULE_SELECTOR(TextureCache::checkMemoryBudget), this, MEMORY_BUDGET_CHECK_INTERVAL, false);
+    }
+    else if (bytes == 0 && _memoryBudget > 0)
+    {
+        scheduler->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::checkMemoryBudget), this);
+    }
+
+    _memoryBudget = bytes;
+    evictUnusedTextures();
+}
+
+TextureCache::MemoryStats TextureCache::getMemoryStats() const
+{
+    MemoryStats stats;
+    stats.budget = _memoryBudget;
+    stats.usage = _memoryUsage;
+    stats.unusedUsage = 0;
+    stats.textureCount = static_cast<unsigned int>(_textures.size());
+    stats.evictedCount = static_cast<unsigned int>(_evictedTextures.size());
+    stats.evictions = _evictions;
+    stats.reloads = _reloads;
+
+    for (auto& texture : _textures)
+    {
+        if (texture.second->getReferenceCount() == 1)
+        {
+            auto usage = _textureUsages.find(texture.first);
+            if (usage != _textureUsages.end())
+                stats.unusedUsage += usage->second.bytes;
+        }
+    }
+    return stats;
+}
+
+void TextureCache::cacheTexture(const std::string& key, Texture2D* texture, bool reloadable)
+{
+    if (!_textures.emplace(key, texture).second)
+    {
+        // already cached, only keep the reference of the cache
+        texture->release();
+        return;
+    }
+
+    TextureUsage usage;
+    usage.bytes = getTextureBytes(texture);
+    usage.lastUsedFrame = Director::getInstance()->getTotalFrames();
+    usage.reloadable = reloadable;
+    _textureUsages[key] = usage;
+    _memoryUsage += usage.bytes;
+
+    if (_evictedTextures.erase(key) != 0)
+    {
+        ++_reloads;
+    }
+
+    evictUnusedTextures();
+}
+
+TextureCache::TextureIterator TextureCache::uncacheTexture(TextureIterator it)
+{
+    auto usage = _textureUsages.find(it->first);
+    if (usage != _textureUsages.end())
+    {
+        _memoryUsage -= usage->second.bytes;
+        _textureUsages.erase(usage);
+    }
+
+    it->second->release();
+    return _textures.erase(it);
+}
+
+void TextureCache::touchTexture(const std::string& key) const
+{
+    auto usage = _textureUsages.find(key);
+    if (usage != _textureUsages.end())
+    {
+        usage->second.lastUsedFrame = Director::getInstance()->getTotalFrames();
+    }
+}
+
+void TextureCache::updateTextureBytes(const std::string& key)
+{
+    auto it = _textures.find(key);
+    auto usage = _textureUsages.find(key);
+    if (it == _textures.end() || usage == _textureUsages.end())
+        return;
+
+    _memoryUsage -= usage->second.bytes;
+    usage->second.bytes = getTextureBytes(it->second);
+    _memoryUsage += usage->second.bytes;
+}
+
+void TextureCache::checkMemoryBudget(float /*dt*/)
+{
+    evictUnusedTextures();
+}
+
+void TextureCache::evictUnusedTextures()
+{
+    if (_memoryBudget == 0)
+        return;
+
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    std::vector<std::pair<unsigned int, TextureIterator>> candidates;
+
+    for (auto it = _textures.cbegin(); it != _textures.cend(); ++it)
+    {
+        auto usage = _textureUsages.find(it->first);
+        if (usage == _textureUsages.end())
+            continue;
+
+        // the textures referenced by nodes are in use now, it dates the moment they stop being used
+        if (it->second->getReferenceCount() > 1)
+        {
+            usage->second.lastUsedFrame = frame;
+        }
+        // the textures used in this frame may not be retained yet by their user
+        else if (usage->second.reloadable && usage->second.lastUsedFrame != frame)
+        {
+            candidates.emplace_back(usage->second.lastUsedFrame, it);
+        }
+    }
+
+    if (_memoryUsage <= _memoryBudget)
+        return;
+
+    // least recently used first
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<unsigned int, TextureIterator>& a, const std::pair<unsigned int, TextureIterator>& b) {
+        return a.first < b.first;
+    });
+
+    for (auto& candidate : candidates)
+    {
+        if (_memoryUsage <= _memoryBudget)
+            break;
+
+        CCLOG("cocos2d: TextureCache: evicting unused texture: %s", candidate.second->first.c_str());
+        _evictedTextures.insert(candidate.second->first);
+        uncacheTexture(candidate.second);
+        ++_evictions;
+    }
+}
+
 void TextureCache::renameTextureWithKey(const std::string& srcName, const std::string& dstName)
 {
     std::string key = srcName;
@@ -725,8 +1645,9 @@ void TextureCache::renameTextureWithKey(const std::string& srcName, const std::s
             if (ret)
             {
                 tex->initWithImage(image);
-                _textures.emplace(fullpath, tex);
-                _textures.erase(it);
+                tex->retain();
+                uncacheTexture(it);
+                cacheTexture(fullpath, tex, true);
             }
             CC_SAFE_DELETE(image);
         }
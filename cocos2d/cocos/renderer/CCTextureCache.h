@@ -31,15 +31,19 @@ THE SOFTWARE.
 
 #include <mutex>
 #include <thread>
+#include <memory>
 #include <condition_variable>
 #include <queue>
+#include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
 #include "platform/CCImage.h"
+#include "platform/CCFileUtils.h"
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     #include <list>
@@ -83,6 +87,17 @@ public:
      */
     CC_DEPRECATED_ATTRIBUTE static void reloadAllTextures();
 
+    /** Priority classes of the asynchronous image loads.
+     * @since v3.17
+     */
+    enum class AsyncPriority
+    {
+        /** The texture is needed now, for example by a node already on screen. */
+        VISIBLE,
+        /** The texture is loaded ahead of time, it is decoded after all the visible requests. */
+        PREFETCH
+    };
+
     // ETC1 ALPHA supports.
     static void setETC1AlphaFileSuffix(const std::string& suffix);
     static std::string getETC1AlphaFileSuffix();
@@ -127,6 +142,120 @@ public:
     
     void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey );
 
+    /** Same as addImageAsync(path, callback, callbackKey) with a priority class.
+     * Requests of the VISIBLE class are decoded and uploaded before the PREFETCH ones.
+     * @param path The file path.
+     * @param callback A callback function would be invoked after the image is loaded.
+     * @param callbackKey The key used to unbind or cancel the request.
+     * @param priority The priority class of the request.
+     * @since v3.17
+     */
+    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority);
+
+    /** Cancels the asynchronous loads bound with the callback key.
+     * Unlike unbindImageAsync, requests that are not decoded yet are dropped and
+     * no texture is created for them. The callbacks won't be invoked.
+     * @param callbackKey The key passed to addImageAsync, the related/absolute path of the file image by default.
+     * @since v3.17
+     */
+    void cancelImageAsync(const std::string &callbackKey);
+
+    /** Sets the number of asynchronous requests decoded at the same time.
+     * The requests are decoded by jobs of the JobSystem, this limits how many of its workers they take.
+     * By default all the workers may decode, one per core leaving one core to the main thread.
+     * @param count The number of requests decoded at the same time, at least 1.
+     * @since v3.17
+     */
+    void setAsyncDecoderCount(int count);
+
+    /** Gets the number of asynchronous requests decoded at the same time.
+     * @since v3.17
+     */
+    int getAsyncDecoderCount() const { return _asyncDecoderCount; }
+
+    /** Sets the time in seconds spent each frame creating textures from the decoded images.
+     * At least one texture is created each frame, the remaining ones wait for the next frames.
+     * 0 means no limit. The default value is 0.005 seconds.
+     * @since v3.17
+     */
+    void setAsyncUploadBudget(float seconds) { _asyncUploadBudget = seconds; }
+
+    /** Gets the time in seconds spent each frame creating textures from the decoded images.
+     * @since v3.17
+     */
+    float getAsyncUploadBudget() const { return _asyncUploadBudget; }
+
+    /** Sets the size from which addImage() streams the PNG, JPEG and WebP images.
+     * addImage() doesn't decode a streamed image: it returns at once a texture of the size of the image,
+     * holding a transparent pixel. The asynchronous decoders then decode the image, first in low resolution
+     * when the file has a quick one (JPEG, interlaced PNG, see Image::initWithImagePreview()), and update
+     * the texture in place. The sprites using the texture show each version without doing anything.
+     * Nine-patch images and compressed files are never streamed.
+     * @param pixels The images of at least this many pixels, width * height, are streamed.
+     * 0 disables the streaming, which is the default.
+     * @since v3.17
+     */
+    void setStreamingThreshold(unsigned int pixels) { _streamingThreshold = pixels; }
+
+    /** Gets the size from which addImage() streams the images, 0 if streaming is disabled.
+     * @since v3.17
+     */
+    unsigned int getStreamingThreshold() const { return _streamingThreshold; }
+
+    /** Checks whether a texture returned by addImage() is still waiting for its full resolution image.
+     * @since v3.17
+     */
+    bool isTextureStreaming(Texture2D* texture) const;
+
+    /** Enables the disk cache of the decoded images, in the "decoded-images" directory of FileUtils::getWritablePath().
+     * The PNG, JPEG, WebP, TIFF and TGA images loaded by addImage() and addImageAsync() are written there once decoded,
+     * converted to the pixel format of their texture and with their alpha premultiplied. The next launches map
+     * the cached pixels and upload them without decoding the image files again.
+     * An entry is only used while its image file has the same contents, checked with a hash, and the default
+     * alpha pixel format is the same. Nine-patch images, compressed and mipmapped files aren't cached.
+     * Enabling the cache removes, in the background, the entries of images that don't exist anymore,
+     * then the oldest entries while the cache takes more than sizeLimit bytes.
+     * It should be called before the images are loaded, e.g. in AppDelegate::applicationDidFinishLaunching().
+     * @param enabled Whether the decoded images are cached, false by default.
+     * @param sizeLimit The storage the cache may take, in bytes, checked when it is enabled.
+     * @since v3.17
+     */
+    void setDecodedImageCacheEnabled(bool enabled, size_t sizeLimit = 256 * 1024 * 1024);
+
+    /** Checks whether the disk cache of the decoded images is enabled.
+     * @since v3.17
+     */
+    bool isDecodedImageCacheEnabled() const { return !_decodedImageCachePath.empty(); }
+
+    /** Removes the files of the disk cache of the decoded images, e.g. to free the storage.
+     * It shouldn't be called while asynchronous loads are running.
+     * @since v3.17
+     */
+    void removeDecodedImageCache();
+
+    /** Adds a manifest of compressed texture variants, as written by tools/texture-compress.
+     * addImage() and addImageAsync() then load the listed images from their best variant the GPU
+     * supports, in the order ASTC, ETC2, S3TC, ATITC and PVRTC. Images without a supported variant are
+     * loaded from their own file. The textures are keyed by the path of the variant, getTextureForKey()
+     * and removeTextureForKey() find them from the path of the image too.
+     * The GPU capabilities must be known, so it should be called after the GLView is set.
+     * @param manifestFile The manifest file, the variants are relative to its directory.
+     * @return false if the manifest can't be read.
+     * @since v3.17
+     */
+    bool addCompressedTextureManifest(const std::string& manifestFile);
+
+    /** Forgets the variants of all the manifests. The textures already loaded stay in the cache.
+     * @since v3.17
+     */
+    void removeAllCompressedTextureManifests();
+
+    /** Gets the file loaded for an image: its selected compressed variant, or the path itself.
+     * @param path The related path of the image, as listed in the manifests.
+     * @since v3.17
+     */
+    const std::string& getCompressedTexturePath(const std::string& path) const;
+
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
@@ -196,6 +325,53 @@ public:
     */
     std::string getCachedTextureInfo() const;
 
+    /** Memory used by the cached textures, see getMemoryStats().
+     * @since v3.17
+     */
+    struct MemoryStats
+    {
+        /** The memory budget in bytes, 0 if there is none. */
+        size_t budget;
+        /** The estimated GPU memory of all the cached textures, in bytes. */
+        size_t usage;
+        /** The part of usage taken by textures only referenced by the cache, that can be evicted. */
+        size_t unusedUsage;
+        /** The number of cached textures. */
+        unsigned int textureCount;
+        /** The number of evicted textures that are reloaded on demand. */
+        unsigned int evictedCount;
+        /** The number of textures evicted since the cache was created. */
+        unsigned int evictions;
+        /** The number of evicted textures reloaded since the cache was created. */
+        unsigned int reloads;
+    };
+
+    /** Sets the memory budget of the cached textures.
+     * When the textures take more memory than the budget, the unused textures loaded from files,
+     * i.e. only referenced by the cache, are removed from the least recently used one until the
+     * cache fits in the budget. The budget is checked when a texture is added and every second.
+     * An evicted texture is loaded again by addImage(), or by getTextureForKey() with its key.
+     * Textures in use are never evicted, so the usage can stay over the budget.
+     * @param bytes The budget in bytes, 0 means no budget, which is the default.
+     * @since v3.17
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /** Gets the memory budget of the cached textures, 0 if there is none.
+     * @since v3.17
+     */
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Gets the estimated GPU memory used by the cached textures, in bytes.
+     * @since v3.17
+     */
+    size_t getMemoryUsage() const { return _memoryUsage; }
+
+    /** Gets the memory used by the cached textures and the eviction counters.
+     * @since v3.17
+     */
+    MemoryStats getMemoryStats() const;
+
     //Wait for texture cache to quit before destroy instance.
     /**Called by director, please do not called outside.*/
     void waitForQuit();
@@ -224,27 +400,102 @@ private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
+    Texture2D* streamImage(const std::string& fullpath);
+    bool updateStreamingTexture(Texture2D* texture, Image* image, Texture2D::PixelFormat pixelFormat);
+
+    // pixels mapped from the disk cache of the decoded images
+    struct DecodedImage
+    {
+        DecodedImage() : data(nullptr), dataLen(0), pixelFormat(Texture2D::PixelFormat::NONE), width(0), height(0), hasPremultipliedAlpha(false) {}
+
+        FileView view;
+        const unsigned char* data;
+        ssize_t dataLen;
+        Texture2D::PixelFormat pixelFormat;
+        int width;
+        int height;
+        bool hasPremultipliedAlpha;
+    };
+
+    // empty if the image isn't cached
+    std::string getDecodedImageFile(const std::string& fullpath, Texture2D::PixelFormat pixelFormat) const;
+    static bool loadDecodedImage(const std::string& decodedImageFile, const std::string& fullpath, const FileView& source, DecodedImage* decoded);
+    static void saveDecodedImage(const std::string& decodedImageFile, const std::string& fullpath, const FileView& source, Image* image);
+    // decodes the image and converts it to the pixel format, AUTO keeps the pixel format of the file
+    static bool decodeImage(Image* image, const std::string& fullpath, const FileView& source, Texture2D::PixelFormat pixelFormat);
+    Texture2D* createTextureWithDecodedImage(const DecodedImage& decoded, const std::string& fullpath);
+
+    typedef std::unordered_map<std::string, Texture2D*>::const_iterator TextureIterator;
+
+    // all the changes of _textures go through these to keep the memory accounting right
+    void cacheTexture(const std::string& key, Texture2D* texture, bool reloadable);
+    TextureIterator uncacheTexture(TextureIterator it);
+    void touchTexture(const std::string& key) const;
+    void updateTextureBytes(const std::string& key);
+    void checkMemoryBudget(float dt);
+    void evictUnusedTextures();
 public:
 protected:
     struct AsyncStruct;
-    
-    std::thread* _loadingThread;
+
+    void queueAsyncStruct(AsyncStruct* asyncStruct);
+
+    // shared with the decode jobs, which may still start once the cache quit
+    struct DecodeJobs
+    {
+        DecodeJobs() : running(0), quit(false) {}
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        int running;
+        bool quit;
+    };
+    std::shared_ptr<DecodeJobs> _decodeJobs;
+    // the decode jobs scheduled, locked by _requestMutex
+    int _decodeJobCount;
 
     std::deque<AsyncStruct*> _asyncStructQueue;
-    std::deque<AsyncStruct*> _requestQueue;
-    std::deque<AsyncStruct*> _responseQueue;
+    // indexed by AsyncPriority
+    std::deque<AsyncStruct*> _requestQueue[2];
+    std::deque<AsyncStruct*> _responseQueue[2];
+    // streamed requests whose low resolution image is decoded, locked by _responseMutex
+    std::deque<AsyncStruct*> _previewQueue;
 
     std::mutex _requestMutex;
     std::mutex _responseMutex;
-    
-    std::condition_variable _sleepCondition;
 
     bool _needQuit;
 
     int _asyncRefCount;
 
+    int _asyncDecoderCount;
+    float _asyncUploadBudget;
+    unsigned int _streamingThreshold;
+    // the directory of the decoded image cache, empty if it is disabled
+    std::string _decodedImageCachePath;
+
     std::unordered_map<std::string, Texture2D*> _textures;
 
+    // image path -> path of its selected compressed variant
+    std::unordered_map<std::string, std::string> _compressedTexturePaths;
+
+    struct TextureUsage
+    {
+        size_t bytes;
+        // Director's frame the texture was last used, by the cache or a node
+        unsigned int lastUsedFrame;
+        // loaded from a file, it can be evicted and loaded again
+        bool reloadable;
+    };
+    // the same keys as _textures, the frames are updated by the const getters too
+    mutable std::unordered_map<std::string, TextureUsage> _textureUsages;
+    // keys of the textures evicted to fit in the budget
+    std::unordered_set<std::string> _evictedTextures;
+    size_t _memoryBudget;
+    size_t _memoryUsage;
+    unsigned int _evictions;
+    unsigned int _reloads;
+
     static std::string s_etc1AlphaFileSuffix;
 };
 
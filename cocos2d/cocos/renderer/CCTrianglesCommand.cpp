@@ -58,7 +58,10 @@ void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState*
         CCLOGERROR("Resize indexCount from %d to %d, size must be multiple times of 3", count, _triangles.indexCount);
     }
     _mv = mv;
-    
+    // set again by the Texture2D overload, a raw texture name has no alpha texture
+    _alphaTextureID = 0;
+
+    // the material ID only depends on the members below, it is cached until one of them changes
     if( _textureID != textureID || _blendType.src != blendType.src || _blendType.dst != blendType.dst ||
        _glProgramState != glProgramState)
     {
@@ -54,6 +54,9 @@ namespace
     static GLuint    s_VAO = 0;
     static GLenum    s_activeTexture = -1;
 
+    // number of GL calls skipped by the cache since the last resetElidedCallCount()
+    static unsigned int s_elidedCalls = 0;
+
 #endif // CC_ENABLE_GL_STATE_CACHE
 }
 
@@ -101,6 +104,10 @@ void useProgram( GLuint program )
         s_currentShaderProgram = program;
         glUseProgram(program);
     }
+    else
+    {
+        ++s_elidedCalls;
+    }
 #else
     glUseProgram(program);
 #endif // CC_ENABLE_GL_STATE_CACHE
@@ -133,6 +140,10 @@ void blendFunc(GLenum sfactor, GLenum dfactor)
         s_blendingDest = dfactor;
         SetBlending(sfactor, dfactor);
     }
+    else
+    {
+        ++s_elidedCalls;
+    }
 #else
     SetBlending( sfactor, dfactor );
 #endif // CC_ENABLE_GL_STATE_CACHE
@@ -172,6 +183,10 @@ void bindTexture2DN(GLuint textureUnit, GLuint textureId)
 		activeTexture(GL_TEXTURE0 + textureUnit);
 		glBindTexture(GL_TEXTURE_2D, textureId);
 	}
+	else
+	{
+		++s_elidedCalls;
+	}
 #else
 	glActiveTexture(GL_TEXTURE0 + textureUnit);
 	glBindTexture(GL_TEXTURE_2D, textureId);
@@ -188,6 +203,10 @@ void bindTextureN(GLuint textureUnit, GLuint textureId, GLuint textureType/* = G
         activeTexture(GL_TEXTURE0 + textureUnit);
         glBindTexture(textureType, textureId);
     }
+    else
+    {
+        ++s_elidedCalls;
+    }
 #else
     glActiveTexture(GL_TEXTURE0 + textureUnit);
     glBindTexture(textureType, textureId);
@@ -222,6 +241,10 @@ void activeTexture(GLenum texture)
         s_activeTexture = texture;
         glActiveTexture(s_activeTexture);
     }
+    else
+    {
+        ++s_elidedCalls;
+    }
 #else
     glActiveTexture(texture);
 #endif
@@ -238,6 +261,10 @@ void bindVAO(GLuint vaoId)
             s_VAO = vaoId;
             glBindVertexArray(vaoId);
         }
+        else
+        {
+            ++s_elidedCalls;
+        }
 #else
         glBindVertexArray(vaoId);
 #endif // CC_ENABLE_GL_STATE_CACHE
@@ -245,6 +272,22 @@ void bindVAO(GLuint vaoId)
     }
 }
 
+unsigned int getElidedCallCount(void)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    return s_elidedCalls;
+#else
+    return 0;
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void resetElidedCallCount(void)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    s_elidedCalls = 0;
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
 // GL Vertex Attrib functions
 
 void enableVertexAttribs(uint32_t flags)
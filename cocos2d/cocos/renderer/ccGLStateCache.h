@@ -183,6 +183,23 @@ void CC_DLL activeTexture(GLenum texture);
  */
 void CC_DLL bindVAO(GLuint vaoId);
 
+/**
+ * Returns the number of glUseProgram(), glBindTexture(), glActiveTexture(), glBlendFunc() and glBindVertexArray()
+ * calls that were skipped because the state was already set, since the last call to resetElidedCallCount().
+ * The Director resets the counter at the beginning of every frame and shows it next to the GL calls
+ * in its stats ("skip").
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it always returns 0.
+ * @since v3.17
+ */
+unsigned int CC_DLL getElidedCallCount(void);
+
+/**
+ * Resets the counter returned by getElidedCallCount().
+ * @since v3.17
+ */
+void CC_DLL resetElidedCallCount(void);
+
 // end of support group
 /// @}
 
@@ -0,0 +1,649 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/ccPixelConversion.h"
+
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CC_PIXEL_CONVERSION_SSE2 1
+    #include <emmintrin.h>
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        // MSVC compiles the AVX2 intrinsics without any flag
+        #define CC_PIXEL_CONVERSION_AVX2 1
+        #define CC_TARGET_AVX2
+    #elif defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 5)
+        #define CC_PIXEL_CONVERSION_AVX2 1
+        #define CC_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define CC_PIXEL_CONVERSION_NEON 1
+    #include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace PixelConversion {
+
+namespace {
+
+typedef void (*ConvertFunction)(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+typedef void (*PremultiplyFunction)(unsigned char* data, ssize_t pixelCount);
+
+struct Kernels
+{
+    InstructionSet instructionSet;
+    ConvertFunction rgba8888ToRGB565;
+    ConvertFunction rgba8888ToRGBA4444;
+    ConvertFunction rgba8888ToRGB5A1;
+    ConvertFunction rgba8888ToA8;
+    ConvertFunction rgba8888ToRGB888;
+    ConvertFunction rgb888ToRGBA8888;
+    PremultiplyFunction premultiplyAlpha;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// scalar kernels, they also convert the pixels left by the vector kernels
+
+void scalarRGBA8888ToRGB565(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *out16++ = (data[0] & 0x00F8) << 8    //R
+            | (data[1] & 0x00FC) << 3         //G
+            | (data[2] & 0x00F8) >> 3;        //B
+    }
+}
+
+void scalarRGBA8888ToRGBA4444(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *out16++ = (data[0] & 0x00F0) << 8    //R
+            | (data[1] & 0x00F0) << 4         //G
+            | (data[2] & 0xF0)                //B
+            | (data[3] & 0xF0) >> 4;          //A
+    }
+}
+
+void scalarRGBA8888ToRGB5A1(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *out16++ = (data[0] & 0x00F8) << 8    //R
+            | (data[1] & 0x00F8) << 3         //G
+            | (data[2] & 0x00F8) >> 2         //B
+            | (data[3] & 0x0080) >> 7;        //A
+    }
+}
+
+void scalarRGBA8888ToA8(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *outData++ = data[3]; //A
+    }
+}
+
+void scalarRGBA8888ToRGB888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *outData++ = data[0];         //R
+        *outData++ = data[1];         //G
+        *outData++ = data[2];         //B
+    }
+}
+
+void scalarRGB888ToRGBA8888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 3)
+    {
+        *outData++ = data[0];         //R
+        *outData++ = data[1];         //G
+        *outData++ = data[2];         //B
+        *outData++ = 0xFF;            //A
+    }
+}
+
+void scalarPremultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        unsigned int alpha = data[3] + 1;
+        data[0] = (unsigned char)((data[0] * alpha) >> 8);
+        data[1] = (unsigned char)((data[1] * alpha) >> 8);
+        data[2] = (unsigned char)((data[2] * alpha) >> 8);
+    }
+}
+
+const Kernels SCALAR_KERNELS = {
+    InstructionSet::SCALAR,
+    scalarRGBA8888ToRGB565,
+    scalarRGBA8888ToRGBA4444,
+    scalarRGBA8888ToRGB5A1,
+    scalarRGBA8888ToA8,
+    scalarRGBA8888ToRGB888,
+    scalarRGB888ToRGBA8888,
+    scalarPremultiplyAlpha
+};
+
+#if CC_PIXEL_CONVERSION_SSE2
+//////////////////////////////////////////////////////////////////////////
+// SSE2 kernels, 4 pixels per register
+
+// the 16 bits values are sign extended, so packing them with signed saturation keeps them intact
+inline __m128i sse2PackTo16(__m128i low, __m128i high)
+{
+    low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+    high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+    return _mm_packs_epi32(low, high);
+}
+
+inline __m128i sse2RGB565(__m128i pixels)
+{
+    __m128i r = _mm_slli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xF8)), 8);
+    __m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xFC)), 3);
+    __m128i b = _mm_srli_epi32(_mm_and_si128(_mm_srli_epi32(pixels, 16), _mm_set1_epi32(0xF8)), 3);
+    return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+inline __m128i sse2RGBA4444(__m128i pixels)
+{
+    __m128i r = _mm_slli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xF0)), 8);
+    __m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xF0)), 4);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), _mm_set1_epi32(0xF0));
+    __m128i a = _mm_srli_epi32(pixels, 28);
+    return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+inline __m128i sse2RGB5A1(__m128i pixels)
+{
+    __m128i r = _mm_slli_epi32(_mm_and_si128(pixels, _mm_set1_epi32(0xF8)), 8);
+    __m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xF8)), 3);
+    __m128i b = _mm_srli_epi32(_mm_and_si128(_mm_srli_epi32(pixels, 16), _mm_set1_epi32(0xF8)), 2);
+    __m128i a = _mm_srli_epi32(pixels, 31);
+    return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+}
+
+#define CC_SSE2_CONVERT_TO_16(name, convert) \
+void name(const unsigned char* data, ssize_t pixelCount, unsigned char* outData) \
+{ \
+    ssize_t i = 0; \
+    for (; i + 8 <= pixelCount; i += 8) \
+    { \
+        __m128i low = _mm_loadu_si128((const __m128i*)(data + i * 4)); \
+        __m128i high = _mm_loadu_si128((const __m128i*)(data + i * 4 + 16)); \
+        _mm_storeu_si128((__m128i*)(outData + i * 2), sse2PackTo16(convert(low), convert(high))); \
+    } \
+    scalar##name(data + i * 4, pixelCount - i, outData + i * 2); \
+}
+
+#define scalarsse2RGBA8888ToRGB565 scalarRGBA8888ToRGB565
+#define scalarsse2RGBA8888ToRGBA4444 scalarRGBA8888ToRGBA4444
+#define scalarsse2RGBA8888ToRGB5A1 scalarRGBA8888ToRGB5A1
+
+CC_SSE2_CONVERT_TO_16(sse2RGBA8888ToRGB565, sse2RGB565)
+CC_SSE2_CONVERT_TO_16(sse2RGBA8888ToRGBA4444, sse2RGBA4444)
+CC_SSE2_CONVERT_TO_16(sse2RGBA8888ToRGB5A1, sse2RGB5A1)
+
+void sse2RGBA8888ToA8(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        const __m128i* in = (const __m128i*)(data + i * 4);
+        __m128i a0 = _mm_srli_epi32(_mm_loadu_si128(in), 24);
+        __m128i a1 = _mm_srli_epi32(_mm_loadu_si128(in + 1), 24);
+        __m128i a2 = _mm_srli_epi32(_mm_loadu_si128(in + 2), 24);
+        __m128i a3 = _mm_srli_epi32(_mm_loadu_si128(in + 3), 24);
+        __m128i a = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+        _mm_storeu_si128((__m128i*)(outData + i), a);
+    }
+    scalarRGBA8888ToA8(data + i * 4, pixelCount - i, outData + i);
+}
+
+void sse2PremultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    // the alpha lanes of two pixels widened to 16 bits
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+    ssize_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(data + i * 4));
+
+        __m128i halves[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+        for (auto& half : halves)
+        {
+            __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(half, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i premultiplied = _mm_srli_epi16(_mm_mullo_epi16(half, _mm_add_epi16(alpha, one)), 8);
+            half = _mm_or_si128(_mm_and_si128(alphaMask, half), _mm_andnot_si128(alphaMask, premultiplied));
+        }
+
+        _mm_storeu_si128((__m128i*)(data + i * 4), _mm_packus_epi16(halves[0], halves[1]));
+    }
+    scalarPremultiplyAlpha(data + i * 4, pixelCount - i);
+}
+
+const Kernels SSE2_KERNELS = {
+    InstructionSet::SSE2,
+    sse2RGBA8888ToRGB565,
+    sse2RGBA8888ToRGBA4444,
+    sse2RGBA8888ToRGB5A1,
+    sse2RGBA8888ToA8,
+    // byte shuffles need SSSE3
+    scalarRGBA8888ToRGB888,
+    scalarRGB888ToRGBA8888,
+    sse2PremultiplyAlpha
+};
+#endif // CC_PIXEL_CONVERSION_SSE2
+
+#if CC_PIXEL_CONVERSION_AVX2
+//////////////////////////////////////////////////////////////////////////
+// AVX2 kernels, 8 pixels per register
+
+CC_TARGET_AVX2 inline __m256i avx2PackTo16(__m256i low, __m256i high)
+{
+    low = _mm256_srai_epi32(_mm256_slli_epi32(low, 16), 16);
+    high = _mm256_srai_epi32(_mm256_slli_epi32(high, 16), 16);
+    // the packs work on each 128 bits lane, put the pixels back in order
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+CC_TARGET_AVX2 inline __m256i avx2RGB565(__m256i pixels)
+{
+    __m256i r = _mm256_slli_epi32(_mm256_and_si256(pixels, _mm256_set1_epi32(0xF8)), 8);
+    __m256i g = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), _mm256_set1_epi32(0xFC)), 3);
+    __m256i b = _mm256_srli_epi32(_mm256_and_si256(_mm256_srli_epi32(pixels, 16), _mm256_set1_epi32(0xF8)), 3);
+    return _mm256_or_si256(_mm256_or_si256(r, g), b);
+}
+
+CC_TARGET_AVX2 inline __m256i avx2RGBA4444(__m256i pixels)
+{
+    __m256i r = _mm256_slli_epi32(_mm256_and_si256(pixels, _mm256_set1_epi32(0xF0)), 8);
+    __m256i g = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), _mm256_set1_epi32(0xF0)), 4);
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), _mm256_set1_epi32(0xF0));
+    __m256i a = _mm256_srli_epi32(pixels, 28);
+    return _mm256_or_si256(_mm256_or_si256(r, g), _mm256_or_si256(b, a));
+}
+
+CC_TARGET_AVX2 inline __m256i avx2RGB5A1(__m256i pixels)
+{
+    __m256i r = _mm256_slli_epi32(_mm256_and_si256(pixels, _mm256_set1_epi32(0xF8)), 8);
+    __m256i g = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), _mm256_set1_epi32(0xF8)), 3);
+    __m256i b = _mm256_srli_epi32(_mm256_and_si256(_mm256_srli_epi32(pixels, 16), _mm256_set1_epi32(0xF8)), 2);
+    __m256i a = _mm256_srli_epi32(pixels, 31);
+    return _mm256_or_si256(_mm256_or_si256(r, g), _mm256_or_si256(b, a));
+}
+
+#define CC_AVX2_CONVERT_TO_16(name, convert) \
+CC_TARGET_AVX2 void name(const unsigned char* data, ssize_t pixelCount, unsigned char* outData) \
+{ \
+    ssize_t i = 0; \
+    for (; i + 16 <= pixelCount; i += 16) \
+    { \
+        __m256i low = _mm256_loadu_si256((const __m256i*)(data + i * 4)); \
+        __m256i high = _mm256_loadu_si256((const __m256i*)(data + i * 4 + 32)); \
+        _mm256_storeu_si256((__m256i*)(outData + i * 2), avx2PackTo16(convert(low), convert(high))); \
+    } \
+    scalar##name(data + i * 4, pixelCount - i, outData + i * 2); \
+}
+
+#define scalaravx2RGBA8888ToRGB565 scalarRGBA8888ToRGB565
+#define scalaravx2RGBA8888ToRGBA4444 scalarRGBA8888ToRGBA4444
+#define scalaravx2RGBA8888ToRGB5A1 scalarRGBA8888ToRGB5A1
+
+CC_AVX2_CONVERT_TO_16(avx2RGBA8888ToRGB565, avx2RGB565)
+CC_AVX2_CONVERT_TO_16(avx2RGBA8888ToRGBA4444, avx2RGBA4444)
+CC_AVX2_CONVERT_TO_16(avx2RGBA8888ToRGB5A1, avx2RGB5A1)
+
+CC_TARGET_AVX2 void avx2RGBA8888ToA8(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    ssize_t i = 0;
+    for (; i + 32 <= pixelCount; i += 32)
+    {
+        const __m256i* in = (const __m256i*)(data + i * 4);
+        __m256i a0 = _mm256_srli_epi32(_mm256_loadu_si256(in), 24);
+        __m256i a1 = _mm256_srli_epi32(_mm256_loadu_si256(in + 1), 24);
+        __m256i a2 = _mm256_srli_epi32(_mm256_loadu_si256(in + 2), 24);
+        __m256i a3 = _mm256_srli_epi32(_mm256_loadu_si256(in + 3), 24);
+        // each 128 bits lane packs its own pixels, the permutation puts the 4 bytes groups back in order
+        __m256i a = _mm256_packus_epi16(_mm256_packs_epi32(a0, a1), _mm256_packs_epi32(a2, a3));
+        _mm256_storeu_si256((__m256i*)(outData + i), _mm256_permutevar8x32_epi32(a, order));
+    }
+    scalarRGBA8888ToA8(data + i * 4, pixelCount - i, outData + i);
+}
+
+CC_TARGET_AVX2 void avx2RGBA8888ToRGB888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    // each store writes 4 bytes past the 12 converted ones, they are overwritten by the next store
+    ssize_t i = 0;
+    for (; i + 6 <= pixelCount; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(data + i * 4));
+        _mm_storeu_si128((__m128i*)(outData + i * 3), _mm_shuffle_epi8(pixels, shuffle));
+    }
+    scalarRGBA8888ToRGB888(data + i * 4, pixelCount - i, outData + i * 3);
+}
+
+CC_TARGET_AVX2 void avx2RGB888ToRGBA8888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+    // each load reads 4 bytes past the 12 converted ones
+    ssize_t i = 0;
+    for (; i + 6 <= pixelCount; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(data + i * 3));
+        _mm_storeu_si128((__m128i*)(outData + i * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+    }
+    scalarRGB888ToRGBA8888(data + i * 3, pixelCount - i, outData + i * 4);
+}
+
+CC_TARGET_AVX2 void avx2PremultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i alphaMask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    // broadcast the alpha of each pixel to its 4 channels
+    const __m256i alphaShuffle = _mm256_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+                                                  6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15);
+
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        __m256i pixels = _mm256_loadu_si256((const __m256i*)(data + i * 4));
+
+        // unpack and pack both work per 128 bits lane, the pixels stay in order
+        __m256i low = _mm256_unpacklo_epi8(pixels, zero);
+        __m256i high = _mm256_unpackhi_epi8(pixels, zero);
+
+        __m256i lowAlpha = _mm256_add_epi16(_mm256_shuffle_epi8(low, alphaShuffle), one);
+        __m256i highAlpha = _mm256_add_epi16(_mm256_shuffle_epi8(high, alphaShuffle), one);
+        __m256i lowPremultiplied = _mm256_srli_epi16(_mm256_mullo_epi16(low, lowAlpha), 8);
+        __m256i highPremultiplied = _mm256_srli_epi16(_mm256_mullo_epi16(high, highAlpha), 8);
+
+        low = _mm256_blendv_epi8(lowPremultiplied, low, alphaMask);
+        high = _mm256_blendv_epi8(highPremultiplied, high, alphaMask);
+
+        _mm256_storeu_si256((__m256i*)(data + i * 4), _mm256_packus_epi16(low, high));
+    }
+    scalarPremultiplyAlpha(data + i * 4, pixelCount - i);
+}
+
+const Kernels AVX2_KERNELS = {
+    InstructionSet::AVX2,
+    avx2RGBA8888ToRGB565,
+    avx2RGBA8888ToRGBA4444,
+    avx2RGBA8888ToRGB5A1,
+    avx2RGBA8888ToA8,
+    avx2RGBA8888ToRGB888,
+    avx2RGB888ToRGBA8888,
+    avx2PremultiplyAlpha
+};
+
+bool isAVX2Supported()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    // the OS saves the AVX registers
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif // CC_PIXEL_CONVERSION_AVX2
+
+#if CC_PIXEL_CONVERSION_NEON
+//////////////////////////////////////////////////////////////////////////
+// NEON kernels, 8 pixels deinterleaved by channel
+
+inline uint16x8_t neonWiden(uint8x8_t channel, uint8_t mask)
+{
+    return vmovl_u8(vand_u8(channel, vdup_n_u8(mask)));
+}
+
+void neonRGBA8888ToRGB565(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(data + i * 4);
+        uint16x8_t out = vshlq_n_u16(neonWiden(pixels.val[0], 0xF8), 8);
+        out = vorrq_u16(out, vshlq_n_u16(neonWiden(pixels.val[1], 0xFC), 3));
+        out = vorrq_u16(out, vshrq_n_u16(neonWiden(pixels.val[2], 0xF8), 3));
+        vst1q_u16((uint16_t*)(outData + i * 2), out);
+    }
+    scalarRGBA8888ToRGB565(data + i * 4, pixelCount - i, outData + i * 2);
+}
+
+void neonRGBA8888ToRGBA4444(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(data + i * 4);
+        uint16x8_t out = vshlq_n_u16(neonWiden(pixels.val[0], 0xF0), 8);
+        out = vorrq_u16(out, vshlq_n_u16(neonWiden(pixels.val[1], 0xF0), 4));
+        out = vorrq_u16(out, neonWiden(pixels.val[2], 0xF0));
+        out = vorrq_u16(out, vshrq_n_u16(vmovl_u8(pixels.val[3]), 4));
+        vst1q_u16((uint16_t*)(outData + i * 2), out);
+    }
+    scalarRGBA8888ToRGBA4444(data + i * 4, pixelCount - i, outData + i * 2);
+}
+
+void neonRGBA8888ToRGB5A1(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(data + i * 4);
+        uint16x8_t out = vshlq_n_u16(neonWiden(pixels.val[0], 0xF8), 8);
+        out = vorrq_u16(out, vshlq_n_u16(neonWiden(pixels.val[1], 0xF8), 3));
+        out = vorrq_u16(out, vshrq_n_u16(neonWiden(pixels.val[2], 0xF8), 2));
+        out = vorrq_u16(out, vshrq_n_u16(vmovl_u8(pixels.val[3]), 7));
+        vst1q_u16((uint16_t*)(outData + i * 2), out);
+    }
+    scalarRGBA8888ToRGB5A1(data + i * 4, pixelCount - i, outData + i * 2);
+}
+
+void neonRGBA8888ToA8(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        uint8x16x4_t pixels = vld4q_u8(data + i * 4);
+        vst1q_u8(outData + i, pixels.val[3]);
+    }
+    scalarRGBA8888ToA8(data + i * 4, pixelCount - i, outData + i);
+}
+
+void neonRGBA8888ToRGB888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        uint8x16x4_t pixels = vld4q_u8(data + i * 4);
+        uint8x16x3_t out = { { pixels.val[0], pixels.val[1], pixels.val[2] } };
+        vst3q_u8(outData + i * 3, out);
+    }
+    scalarRGBA8888ToRGB888(data + i * 4, pixelCount - i, outData + i * 3);
+}
+
+void neonRGB888ToRGBA8888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        uint8x16x3_t pixels = vld3q_u8(data + i * 3);
+        uint8x16x4_t out = { { pixels.val[0], pixels.val[1], pixels.val[2], vdupq_n_u8(0xFF) } };
+        vst4q_u8(outData + i * 4, out);
+    }
+    scalarRGB888ToRGBA8888(data + i * 3, pixelCount - i, outData + i * 4);
+}
+
+void neonPremultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(data + i * 4);
+        uint8x8_t alpha = pixels.val[3];
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            // c * (a + 1) computed as c * a + c, a + 1 doesn't fit in 8 bits
+            uint8x8_t c = pixels.val[channel];
+            pixels.val[channel] = vshrn_n_u16(vaddw_u8(vmull_u8(c, alpha), c), 8);
+        }
+        vst4_u8(data + i * 4, pixels);
+    }
+    scalarPremultiplyAlpha(data + i * 4, pixelCount - i);
+}
+
+const Kernels NEON_KERNELS = {
+    InstructionSet::NEON,
+    neonRGBA8888ToRGB565,
+    neonRGBA8888ToRGBA4444,
+    neonRGBA8888ToRGB5A1,
+    neonRGBA8888ToA8,
+    neonRGBA8888ToRGB888,
+    neonRGB888ToRGBA8888,
+    neonPremultiplyAlpha
+};
+#endif // CC_PIXEL_CONVERSION_NEON
+
+const Kernels* getBestKernels(InstructionSet wanted)
+{
+#if CC_PIXEL_CONVERSION_AVX2
+    if (wanted == InstructionSet::AVX2)
+    {
+        static const bool avx2 = isAVX2Supported();
+        if (avx2)
+            return &AVX2_KERNELS;
+        wanted = InstructionSet::SSE2;
+    }
+#endif
+#if CC_PIXEL_CONVERSION_SSE2
+    if (wanted == InstructionSet::SSE2)
+        return &SSE2_KERNELS;
+#endif
+#if CC_PIXEL_CONVERSION_NEON
+    if (wanted == InstructionSet::NEON)
+        return &NEON_KERNELS;
+#endif
+    return &SCALAR_KERNELS;
+}
+
+std::atomic<const Kernels*> s_kernels(nullptr);
+
+const Kernels* getKernels()
+{
+    const Kernels* kernels = s_kernels.load(std::memory_order_acquire);
+    if (kernels == nullptr)
+    {
+#if CC_PIXEL_CONVERSION_SSE2
+        kernels = getBestKernels(InstructionSet::AVX2);
+#else
+        // the NEON kernels are opt-in with setInstructionSet() until they are checked on more devices
+        kernels = getBestKernels(InstructionSet::SCALAR);
+#endif
+        s_kernels.store(kernels, std::memory_order_release);
+    }
+    return kernels;
+}
+
+} // namespace
+
+InstructionSet getInstructionSet()
+{
+    return getKernels()->instructionSet;
+}
+
+void setInstructionSet(InstructionSet instructionSet)
+{
+    s_kernels.store(getBestKernels(instructionSet), std::memory_order_release);
+}
+
+void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    getKernels()->rgba8888ToRGB565(data, pixelCount, outData);
+}
+
+void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    getKernels()->rgba8888ToRGBA4444(data, pixelCount, outData);
+}
+
+void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    getKernels()->rgba8888ToRGB5A1(data, pixelCount, outData);
+}
+
+void convertRGBA8888ToA8(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    getKernels()->rgba8888ToA8(data, pixelCount, outData);
+}
+
+void convertRGBA8888ToRGB888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    getKernels()->rgba8888ToRGB888(data, pixelCount, outData);
+}
+
+void convertRGB888ToRGBA8888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    getKernels()->rgb888ToRGBA8888(data, pixelCount, outData);
+}
+
+void premultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    getKernels()->premultiplyAlpha(data, pixelCount);
+}
+
+} // namespace PixelConversion
+
+NS_CC_END
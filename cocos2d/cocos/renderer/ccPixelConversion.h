@@ -0,0 +1,88 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCPIXELCONVERSION_H__
+#define __CCPIXELCONVERSION_H__
+
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCStdC.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** Pixel format conversions used when images are turned into textures.
+ * On x86 the kernels use the best instruction set supported by the CPU, chosen at runtime,
+ * and give the same results as the scalar versions. On ARM the scalar kernels are used by default,
+ * the NEON ones are opt-in with setInstructionSet(InstructionSet::NEON).
+ * The functions only touch their parameters, they can be called from any thread.
+ * @since v3.17
+ */
+namespace PixelConversion {
+
+/** The instruction sets the kernels are implemented with. */
+enum class InstructionSet
+{
+    SCALAR,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+/** Gets the instruction set used by the kernels. */
+CC_DLL InstructionSet getInstructionSet();
+
+/** Forces the instruction set used by the kernels, e.g. to compare them or to enable NEON.
+ * An instruction set the CPU doesn't support falls back to a slower one, down to SCALAR.
+ * tools/pixel-conversion-benchmark checks and times the kernels of a device.
+ */
+CC_DLL void setInstructionSet(InstructionSet instructionSet);
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
+CC_DLL void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
+CC_DLL void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGBBBBBA
+CC_DLL void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
+CC_DLL void convertRGBA8888ToA8(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
+CC_DLL void convertRGBA8888ToRGB888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+// RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
+CC_DLL void convertRGB888ToRGBA8888(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+
+/** Premultiplies RGBA8888 pixels in place, the same as CC_RGB_PREMULTIPLY_ALPHA. */
+CC_DLL void premultiplyAlpha(unsigned char* data, ssize_t pixelCount);
+
+} // namespace PixelConversion
+
+// end of renderer group
+/** @} */
+
+NS_CC_END
+
+#endif // __CCPIXELCONVERSION_H__
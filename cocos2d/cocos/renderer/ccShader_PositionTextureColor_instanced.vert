@@ -0,0 +1,47 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+const char* ccPositionTextureColor_instanced_vert = R"(
+attribute vec4 a_position;  // per vertex: corner of the unit quad
+attribute vec4 a_color;     // per instance
+attribute vec4 a_texCoord;  // per instance: uv of the bottom left and top right corners
+attribute vec4 a_texCoord1; // per instance: x axis in xy, y axis in zw
+attribute vec3 a_texCoord2; // per instance: position of the bottom left corner
+
+#ifdef GL_ES
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+#else
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+#endif
+
+void main()
+{
+    vec2 position = a_texCoord2.xy + a_texCoord1.xy * a_position.x + a_texCoord1.zw * a_position.y;
+    gl_Position = CC_MVPMatrix * vec4(position, a_texCoord2.z, 1.0);
+    v_fragmentColor = a_color;
+    v_texCoord = mix(a_texCoord.xy, a_texCoord.zw, a_position.xy);
+}
+)";
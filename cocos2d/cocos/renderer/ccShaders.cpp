@@ -100,4 +100,6 @@ NS_CC_BEGIN
 #include "renderer/ccShader_Position.vert"
 #include "renderer/ccShader_LayerRadialGradient.frag"
 
+#include "renderer/ccShader_PositionTextureColor_instanced.vert"
+
 NS_CC_END
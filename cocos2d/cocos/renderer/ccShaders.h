@@ -100,6 +100,8 @@ extern CC_DLL const GLchar* ccETC1ASPositionTextureGray_frag;
 extern CC_DLL const GLchar* ccPosition_vert;
 extern CC_DLL const GLchar* ccShader_LayerRadialGradient_frag;
 
+extern CC_DLL const GLchar* ccPositionTextureColor_instanced_vert;
+
 NS_CC_END
 /**
  end of support group
@@ -269,13 +269,13 @@ void Layout::stencilClippingVisit(Renderer *renderer, const Mat4& parentTransfor
     renderer->pushGroup(_groupCommand.getRenderQueueID());
     
     _beforeVisitCmdStencil.init(_globalZOrder);
-    _beforeVisitCmdStencil.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
+    _beforeVisitCmdStencil.func = [this]() { _stencilStateManager->onBeforeVisit(); };
     renderer->addCommand(&_beforeVisitCmdStencil);
     
     _clippingStencil->visit(renderer, _modelViewTransform, flags);
     
     _afterDrawStencilCmd.init(_globalZOrder);
-    _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
+    _afterDrawStencilCmd.func = [this]() { _stencilStateManager->onAfterDrawStencil(); };
     renderer->addCommand(&_afterDrawStencilCmd);
     
     int i = 0;      // used by _children
@@ -323,7 +323,7 @@ void Layout::stencilClippingVisit(Renderer *renderer, const Mat4& parentTransfor
 
     
     _afterVisitCmdStencil.init(_globalZOrder);
-    _afterVisitCmdStencil.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+    _afterVisitCmdStencil.func = [this]() { _stencilStateManager->onAfterVisit(); };
     renderer->addCommand(&_afterVisitCmdStencil);
     
     renderer->popGroup();
@@ -381,13 +381,13 @@ void Layout::scissorClippingVisit(Renderer *renderer, const Mat4& parentTransfor
         _clippingRectDirty = true;
     }
     _beforeVisitCmdScissor.init(_globalZOrder);
-    _beforeVisitCmdScissor.func = CC_CALLBACK_0(Layout::onBeforeVisitScissor, this);
+    _beforeVisitCmdScissor.func = [this]() { onBeforeVisitScissor(); };
     renderer->addCommand(&_beforeVisitCmdScissor);
 
     ProtectedNode::visit(renderer, parentTransform, parentFlags);
     
     _afterVisitCmdScissor.init(_globalZOrder);
-    _afterVisitCmdScissor.func = CC_CALLBACK_0(Layout::onAfterVisitScissor, this);
+    _afterVisitCmdScissor.func = [this]() { onAfterVisitScissor(); };
     renderer->addCommand(&_afterVisitCmdScissor);
 }
 
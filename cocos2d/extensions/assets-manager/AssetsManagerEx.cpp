@@ -34,7 +34,7 @@
 #else // from our embedded sources
 #include "unzip.h"
 #endif
-#include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 
 NS_CC_EXT_BEGIN
 
@@ -478,29 +478,27 @@ void AssetsManagerEx::decompressDownloadedZip(const std::string &customId, const
     asyncData->zipFile = storagePath;
     asyncData->succeed = false;
     
-    std::function<void(void*)> decompressFinished = [this](void* param) {
-        auto dataInner = reinterpret_cast<AsyncData*>(param);
-        if (dataInner->succeed)
+    JobSystem::getInstance()->schedule([this, asyncData]() {
+        // Decompress all compressed files
+        if (decompress(asyncData->zipFile))
         {
-            fileSuccess(dataInner->customId, dataInner->zipFile);
+            asyncData->succeed = true;
+        }
+        _fileUtils->removeFile(asyncData->zipFile);
+    }, [this, asyncData]() {
+        if (asyncData->succeed)
+        {
+            fileSuccess(asyncData->customId, asyncData->zipFile);
         }
         else
         {
-            std::string errorMsg = "Unable to decompress file " + dataInner->zipFile;
+            std::string errorMsg = "Unable to decompress file " + asyncData->zipFile;
             // Ensure zip file deletion (if decompress failure cause task thread exit anormally)
-            _fileUtils->removeFile(dataInner->zipFile);
+            _fileUtils->removeFile(asyncData->zipFile);
             dispatchUpdateEvent(EventAssetsManagerEx::EventCode::ERROR_DECOMPRESS, "", errorMsg);
-            fileError(dataInner->customId, errorMsg);
+            fileError(asyncData->customId, errorMsg);
         }
-        delete dataInner;
-    };
-    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, std::move(decompressFinished), (void*)asyncData, [this, asyncData]() {
-        // Decompress all compressed files
-        if (decompress(asyncData->zipFile))
-        {
-            asyncData->succeed = true;
-        }
-        _fileUtils->removeFile(asyncData->zipFile);
+        delete asyncData;
     });
 }
 
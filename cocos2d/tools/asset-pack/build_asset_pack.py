@@ -0,0 +1,174 @@
+#!/usr/bin/python
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Build a read-only asset pack mounted by FileUtils::mountAssetPack.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Build a read-only asset pack mounted by FileUtils::mountAssetPack.
+
+The layout is described in cocos/platform/CCAssetPack.h.
+'''
+
+import os
+import struct
+import sys
+import zlib
+
+from argparse import ArgumentParser
+
+MAGIC = b'CCPK'
+VERSION = 1
+
+HEADER_FORMAT = '<4s7I'
+ENTRY_FORMAT = '<IIQIIII'
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+ENTRY_SIZE = struct.calcsize(ENTRY_FORMAT)
+
+COMPRESSION_NONE = 0
+COMPRESSION_ZLIB = 1
+
+DATA_ALIGNMENT = 16
+ENTRIES_PER_BUCKET = 4
+MAX_SEED = 1 << 24
+
+FNV_OFFSET_BASIS = 2166136261
+FNV_PRIME = 16777619
+
+# already compressed formats are always stored, they can be used in place
+STORED_EXTENSIONS = ('.png', '.jpg', '.jpeg', '.webp', '.pkm', '.pvr', '.ccz', '.gz', '.zip',
+                     '.mp3', '.ogg', '.m4a', '.caf', '.mp4')
+
+
+def hash_path(path, seed):
+    '''32 bits FNV-1a, same as AssetPack::hashPath.'''
+    h = (FNV_OFFSET_BASIS ^ seed) & 0xffffffff
+    for c in bytearray(path):
+        h ^= c
+        h = (h * FNV_PRIME) & 0xffffffff
+    return h
+
+
+def build_perfect_hash(names):
+    '''Returns the seed of each bucket and the entry slot of each name.'''
+    count = len(names)
+    if count == 0:
+        return [], []
+
+    bucket_count = max(1, (count + ENTRIES_PER_BUCKET - 1) // ENTRIES_PER_BUCKET)
+    buckets = [[] for _ in range(bucket_count)]
+    for index, name in enumerate(names):
+        buckets[hash_path(name, 0) % bucket_count].append(index)
+
+    seeds = [0] * bucket_count
+    slots = [None] * count
+    used = [False] * count
+
+    # place the largest buckets first, while most of the slots are free
+    for bucket in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+        members = buckets[bucket]
+        if not members:
+            continue
+
+        seed = 1
+        while seed < MAX_SEED:
+            positions = [hash_path(names[i], seed) % count for i in members]
+            if len(set(positions)) == len(positions) and not any(used[p] for p in positions):
+                break
+            seed += 1
+        else:
+            raise RuntimeError('no perfect hash found, try again with other files')
+
+        seeds[bucket] = seed
+        for index, position in zip(members, positions):
+            slots[index] = position
+            used[position] = True
+
+    return seeds, slots
+
+
+def collect_files(src_dir):
+    files = []
+    for root, dirs, filenames in os.walk(src_dir):
+        dirs.sort()
+        for filename in sorted(filenames):
+            path = os.path.join(root, filename)
+            name = os.path.relpath(path, src_dir).replace(os.sep, '/')
+            files.append((name.encode('utf-8'), path))
+    return files
+
+
+def align(offset, alignment):
+    return (offset + alignment - 1) // alignment * alignment
+
+
+def build_pack(src_dir, dst_file, compress, min_ratio):
+    files = collect_files(src_dir)
+    names = [name for name, _ in files]
+    seeds, slots = build_perfect_hash(names)
+    count = len(files)
+
+    buckets_offset = HEADER_SIZE
+    entries_offset = align(buckets_offset + 4 * len(seeds), 8)
+    names_offset = entries_offset + ENTRY_SIZE * count
+    names_blob = b''.join(names)
+    data_offset = align(names_offset + len(names_blob), DATA_ALIGNMENT)
+
+    entries = [None] * count
+    blobs = []
+    name_offset = 0
+    offset = data_offset
+    stored_total = 0
+    size_total = 0
+    for index, (name, path) in enumerate(files):
+        with open(path, 'rb') as f:
+            data = f.read()
+
+        stored = data
+        compression = COMPRESSION_NONE
+        if compress and os.path.splitext(path)[1].lower() not in STORED_EXTENSIONS and len(data) > 0:
+            deflated = zlib.compress(data, 9)
+            if len(deflated) <= len(data) * min_ratio:
+                stored = deflated
+                compression = COMPRESSION_ZLIB
+
+        checksum = zlib.crc32(data) & 0xffffffff
+        entries[slots[index]] = struct.pack(ENTRY_FORMAT, name_offset, len(name), offset,
+                                            len(data), len(stored), compression, checksum)
+        blobs.append((offset, stored))
+
+        name_offset += len(name)
+        offset = align(offset + len(stored), DATA_ALIGNMENT)
+        stored_total += len(stored)
+        size_total += len(data)
+
+    with open(dst_file, 'wb') as f:
+        f.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, count, len(seeds),
+                            buckets_offset, entries_offset, names_offset, len(names_blob)))
+        f.write(struct.pack('<%dI' % len(seeds), *seeds))
+        f.write(b'\0' * (entries_offset - f.tell()))
+        f.write(b''.join(entries))
+        f.write(names_blob)
+        for blob_offset, blob in blobs:
+            f.write(b'\0' * (blob_offset - f.tell()))
+            f.write(blob)
+
+    print('%s: %d files, %d bytes, %d bytes stored' % (dst_file, count, size_total, stored_total))
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Build a read-only asset pack mounted by FileUtils::mountAssetPack.')
+    parser.add_argument('src_dir', help='the directory to pack, the paths in the pack are relative to it')
+    parser.add_argument('dst_file', help='the asset pack to write')
+    parser.add_argument('--no-compress', dest='compress', action='store_false',
+                        help='store all the files, so they can all be used in place')
+    parser.add_argument('--min-ratio', type=float, default=0.9,
+                        help='a file is deflated only if it shrinks below this ratio (default: 0.9)')
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.src_dir):
+        print('%s is not a directory' % args.src_dir)
+        sys.exit(1)
+
+    build_pack(args.src_dir, args.dst_file, args.compress, args.min_ratio)
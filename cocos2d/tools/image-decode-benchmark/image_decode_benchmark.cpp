@@ -0,0 +1,333 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the PNG and JPEG decoders of Image against the previous ones, which are kept here as the reference,
+// and decoding into pixels allocated for each image against decoding into a reused buffer.
+// See README.md to build it.
+
+#include "platform/CCImage.h"
+#include "platform/CCFileUtils.h"
+#include "renderer/ccPixelConversion.h"
+
+#include "png.h"
+#include "jpeglib.h"
+
+#include <chrono>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace {
+
+const int SYNTHETIC_SIZE = 2048;
+
+struct Result
+{
+    double previousTime;
+    double currentTime;
+    double bufferTime;
+    bool same;
+};
+
+// the decoders before the PNG rows were decoded in place: png_read_image() then a premultiply pass
+// over the whole image, and one JPEG scanline per call
+namespace previous {
+
+struct Source
+{
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+};
+
+void pngReadCallback(png_structp png, png_bytep data, png_size_t length)
+{
+    Source* source = static_cast<Source*>(png_get_io_ptr(png));
+    if (source->offset + length > source->size)
+        png_error(png, "pngReadCallback failed");
+    memcpy(data, source->data + source->offset, length);
+    source->offset += length;
+}
+
+bool decodePng(const Data& file, std::vector<unsigned char>* pixels)
+{
+    if (file.getSize() < 8 || png_sig_cmp(file.getBytes(), 0, 8))
+        return false;
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    std::vector<png_bytep> rows;
+    if (setjmp(png_jmpbuf(png)))
+    {
+        png_destroy_read_struct(&png, &info, nullptr);
+        return false;
+    }
+
+    Source source = { file.getBytes(), (size_t)file.getSize(), 0 };
+    png_set_read_fn(png, &source, pngReadCallback);
+    png_read_info(png, info);
+
+    png_uint_32 width = png_get_image_width(png, info);
+    png_uint_32 height = png_get_image_height(png, info);
+    png_byte bitDepth = png_get_bit_depth(png, info);
+    png_byte colorType = png_get_color_type(png, info);
+    if (colorType == PNG_COLOR_TYPE_PALETTE)
+        png_set_palette_to_rgb(png);
+    if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
+    {
+        bitDepth = 8;
+        png_set_expand_gray_1_2_4_to_8(png);
+    }
+    if (png_get_valid(png, info, PNG_INFO_tRNS))
+        png_set_tRNS_to_alpha(png);
+    if (bitDepth == 16)
+        png_set_strip_16(png);
+    if (bitDepth < 8)
+        png_set_packing(png);
+    png_set_interlace_handling(png);
+    png_read_update_info(png, info);
+    colorType = png_get_color_type(png, info);
+
+    png_size_t rowBytes = png_get_rowbytes(png, info);
+    pixels->resize(rowBytes * height);
+    rows.resize(height);
+    for (png_uint_32 i = 0; i < height; ++i)
+        rows[i] = pixels->data() + i * rowBytes;
+    png_read_image(png, rows.data());
+    png_read_end(png, nullptr);
+
+    if (colorType == PNG_COLOR_TYPE_RGB_ALPHA && CC_ENABLE_PREMULTIPLIED_ALPHA != 0)
+        PixelConversion::premultiplyAlpha(pixels->data(), (ssize_t)width * height);
+
+    png_destroy_read_struct(&png, &info, nullptr);
+    return true;
+}
+
+struct JpegError
+{
+    jpeg_error_mgr manager;
+    jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr info)
+{
+    longjmp(reinterpret_cast<JpegError*>(info->err)->jump, 1);
+}
+
+bool decodeJpeg(const Data& file, std::vector<unsigned char>* pixels)
+{
+    jpeg_decompress_struct info;
+    JpegError error;
+    info.err = jpeg_std_error(&error.manager);
+    error.manager.error_exit = jpegErrorExit;
+    if (setjmp(error.jump))
+    {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, const_cast<unsigned char*>(file.getBytes()), file.getSize());
+    jpeg_read_header(&info, TRUE);
+    if (info.jpeg_color_space != JCS_GRAYSCALE)
+        info.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&info);
+
+    size_t rowBytes = info.output_width * info.output_components;
+    pixels->resize(rowBytes * info.output_height);
+    while (info.output_scanline < info.output_height)
+    {
+        JSAMPROW row = pixels->data() + info.output_scanline * rowBytes;
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+bool decode(const Data& file, std::vector<unsigned char>* pixels)
+{
+    return decodePng(file, pixels) || decodeJpeg(file, pixels);
+}
+
+} // namespace previous
+
+bool decodeImage(const Data& file, std::vector<unsigned char>* pixels)
+{
+    Image image;
+    if (!image.initWithImageData(file.getBytes(), file.getSize()))
+        return false;
+    if (pixels != nullptr)
+        pixels->assign(image.getData(), image.getData() + image.getDataLen());
+    return true;
+}
+
+bool decodeIntoBuffer(const Data& file, std::vector<unsigned char>* buffer)
+{
+    ResizableBufferAdapter<std::vector<unsigned char>> adapter(buffer);
+    Image image;
+    return image.initWithImageData(file.getBytes(), file.getSize(), &adapter);
+}
+
+// the best time of the runs, in milliseconds
+template<typename Decode>
+double timeDecode(const Decode& decode, int runs)
+{
+    double best = 1e9;
+    for (int run = 0; run < runs; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        decode();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+bool benchmark(const Data& file, int runs, Result* result)
+{
+    std::vector<unsigned char> expected, pixels, buffer;
+    if (!previous::decode(file, &expected) || !decodeImage(file, &pixels) || !decodeIntoBuffer(file, &buffer))
+        return false;
+
+    result->same = pixels == expected && buffer == expected;
+    result->previousTime = timeDecode([&file]() { std::vector<unsigned char> out; previous::decode(file, &out); }, runs);
+    result->currentTime = timeDecode([&file]() { decodeImage(file, nullptr); }, runs);
+    result->bufferTime = timeDecode([&file, &buffer]() { decodeIntoBuffer(file, &buffer); }, runs);
+    return true;
+}
+
+bool isDecodedImage(const std::string& path)
+{
+    std::string extension = FileUtils::getInstance()->getFileExtension(path);
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+// noisy gradients, saved to the writable path, larger than the images of the game
+void writeSyntheticImages(std::vector<std::string>* files)
+{
+    std::vector<unsigned char> pixels(SYNTHETIC_SIZE * SYNTHETIC_SIZE * 4);
+    srand(1);
+    for (int y = 0; y < SYNTHETIC_SIZE; ++y)
+    {
+        for (int x = 0; x < SYNTHETIC_SIZE; ++x)
+        {
+            unsigned char* pixel = &pixels[(y * SYNTHETIC_SIZE + x) * 4];
+            pixel[0] = static_cast<unsigned char>(x + rand() % 8);
+            pixel[1] = static_cast<unsigned char>(y + rand() % 8);
+            pixel[2] = static_cast<unsigned char>(x + y);
+            pixel[3] = static_cast<unsigned char>(255 - (x ^ y));
+        }
+    }
+
+    Image image;
+    image.initWithRawData(pixels.data(), pixels.size(), SYNTHETIC_SIZE, SYNTHETIC_SIZE, 8);
+
+    const std::string directory = FileUtils::getInstance()->getWritablePath();
+    const std::pair<const char*, bool> syntheticImages[] = {
+        { "image_decode_benchmark_rgba.png", false },
+        { "image_decode_benchmark_rgb.png", true },
+        { "image_decode_benchmark.jpg", true },
+    };
+    for (const auto& syntheticImage : syntheticImages)
+    {
+        std::string path = directory + syntheticImage.first;
+        if (image.saveToFile(path, syntheticImage.second))
+            files->push_back(path);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int runs = argc > 1 ? atoi(argv[1]) : 10;
+    if (runs < 1)
+        runs = 1;
+
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; ++i)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths.push_back("Resources/res");
+
+    auto fileUtils = FileUtils::getInstance();
+    std::vector<std::string> files;
+    for (const auto& path : paths)
+    {
+        if (fileUtils->isDirectoryExist(path))
+        {
+            std::vector<std::string> directoryFiles;
+            fileUtils->listFilesRecursively(path, &directoryFiles);
+            for (const auto& file : directoryFiles)
+            {
+                if (isDecodedImage(file))
+                    files.push_back(file);
+            }
+        }
+        else
+        {
+            files.push_back(path);
+        }
+    }
+    if (argc <= 2)
+        writeSyntheticImages(&files);
+
+    printf("best of %d runs\n\n", runs);
+    printf("%-40s %14s %12s %12s %8s\n", "image", "previous (ms)", "image (ms)", "buffer (ms)", "speedup");
+
+    bool allSame = true;
+    Result total = { 0, 0, 0, true };
+    for (const auto& path : files)
+    {
+        Data file = fileUtils->getDataFromFile(path);
+        Result result;
+        if (file.isNull() || !benchmark(file, runs, &result))
+        {
+            printf("%-40s skipped, not a PNG or JPEG image\n", path.c_str());
+            continue;
+        }
+
+        allSame = allSame && result.same;
+        total.previousTime += result.previousTime;
+        total.currentTime += result.currentTime;
+        total.bufferTime += result.bufferTime;
+
+        std::string name = path.size() > 40 ? "..." + path.substr(path.size() - 37) : path;
+        printf("%-40s %14.3f %12.3f %12.3f %7.2fx%s\n", name.c_str(), result.previousTime, result.currentTime, result.bufferTime,
+               result.previousTime / result.bufferTime, result.same ? "" : "  DIFFERENT PIXELS");
+    }
+    printf("%-40s %14.3f %12.3f %12.3f %7.2fx\n", "total", total.previousTime, total.currentTime, total.bufferTime,
+           total.previousTime / total.bufferTime);
+
+    printf("\n%s\n", allSame ? "All the decoders give the same pixels." : "Some decoders give other pixels!");
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the lookups, searches and reorders of the children of a node with 10000 children.
+// See README.md to build it.
+
+#include "cocos2d.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMilliseconds(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+Node* createParent(int count)
+{
+    auto parent = Node::create();
+    for (int i = 0; i < count; ++i)
+        parent->addChild(Node::create(), rand() % 100, "child" + std::to_string(i));
+    parent->sortAllChildren();
+    return parent;
+}
+
+// looks up every child by its name, returns the time of a lookup in microseconds
+double timeGetChildByName(Node* parent, const std::vector<std::string>& names)
+{
+    int found = 0;
+    auto start = Clock::now();
+    for (const auto& name : names)
+    {
+        if (parent->getChildByName(name))
+            ++found;
+    }
+    double time = elapsedMilliseconds(start) * 1000 / names.size();
+    if (found != (int)names.size())
+        printf("Only %d of the %d children were found!\n", found, (int)names.size());
+    return time;
+}
+
+// returns the time of a search in microseconds
+double timeEnumerateChildren(Node* parent, const std::string& name, int searches)
+{
+    int matches = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < searches; ++i)
+    {
+        parent->enumerateChildren(name, [&matches](Node*) {
+            ++matches;
+            return false;
+        });
+    }
+    return elapsedMilliseconds(start) * 1000 / searches;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 10000;
+    if (count < 2)
+        count = 2;
+
+    srand(1);
+    auto parent = createParent(count);
+    parent->retain();
+
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i)
+        names.push_back("child" + std::to_string(rand() % count));
+
+    printf("%d children\n", count);
+
+    double scan = timeGetChildByName(parent, names);
+    auto start = Clock::now();
+    parent->setChildNameIndexEnabled(true);
+    double indexing = elapsedMilliseconds(start);
+    double indexed = timeGetChildByName(parent, names);
+    printf("getChildByName:              %10.3f us without the index, %.3f us with it, %.3f ms to build the index\n",
+           scan, indexed, indexing);
+
+    const int searches = 100;
+    std::string middle = "child" + std::to_string(count / 2);
+    printf("enumerateChildren(name):     %10.3f us\n", timeEnumerateChildren(parent, middle, searches));
+    printf("enumerateChildren(//name):   %10.3f us\n", timeEnumerateChildren(parent, "//" + middle, searches));
+    printf("enumerateChildren(regex):    %10.3f us\n", timeEnumerateChildren(parent, "child[0-9]*7", searches));
+
+    // one child changing its z order per frame, as a sprite moving in depth
+    const int reorders = 1000;
+    auto& children = parent->getChildren();
+    start = Clock::now();
+    for (int i = 0; i < reorders; ++i)
+    {
+        children.at(rand() % count)->setLocalZOrder(rand() % 100);
+        parent->sortAllChildren();
+    }
+    printf("reorder one child and sort:  %10.3f us\n", elapsedMilliseconds(start) * 1000 / reorders);
+
+    // every child changing its z order
+    start = Clock::now();
+    for (auto child : children)
+        child->setLocalZOrder(rand() % 100);
+    parent->sortAllChildren();
+    printf("reorder all and sort:        %10.3f ms\n", elapsedMilliseconds(start));
+
+    start = Clock::now();
+    parent->removeAllChildren();
+    printf("removeAllChildren:           %10.3f ms\n", elapsedMilliseconds(start));
+
+    parent->release();
+    return 0;
+}
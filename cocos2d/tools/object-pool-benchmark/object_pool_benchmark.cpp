@@ -0,0 +1,138 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the construction and teardown of scenes of many nodes and actions, with or without the ObjectPool.
+// See README.md to build it.
+
+#include "cocos2d.h"
+#include "base/CCObjectPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace {
+
+const int WARM_UP_SCENES = 5;
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMilliseconds(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// a scene of layers of sprites, each sprite running a few actions, as a level being loaded
+Scene* createScene(int nodeCount)
+{
+    auto scene = Scene::create();
+    const int spritesPerLayer = 100;
+    Node* layer = nullptr;
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (i % spritesPerLayer == 0)
+        {
+            layer = Node::create();
+            scene->addChild(layer);
+            continue;
+        }
+
+        auto sprite = Sprite::create();
+        sprite->setPosition(Vec2(i % 960, i % 640));
+        sprite->runAction(RepeatForever::create(Sequence::create(
+            MoveBy::create(1, Vec2(10, 0)),
+            RotateBy::create(1, 90),
+            FadeOut::create(0.5f),
+            FadeIn::create(0.5f),
+            nullptr)));
+        layer->addChild(sprite);
+    }
+    return scene;
+}
+
+double median(std::vector<double>& times)
+{
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int nodeCount = argc > 1 ? atoi(argv[1]) : 10000;
+    int sceneCount = argc > 2 ? atoi(argv[2]) : 50;
+    if (nodeCount < 1)
+        nodeCount = 1;
+    if (sceneCount < 1)
+        sceneCount = 1;
+
+    // the sprites need a GL context for their shaders and their default texture
+    auto director = Director::getInstance();
+    auto glview = GLViewImpl::createWithRect("object-pool-benchmark", Rect(0, 0, 960, 640));
+    director->setOpenGLView(glview);
+    director->setDisplayStats(false);
+
+    auto autoreleasePool = PoolManager::getInstance()->getCurrentPool();
+    std::vector<double> constructionTimes;
+    std::vector<double> teardownTimes;
+    for (int i = 0; i < WARM_UP_SCENES + sceneCount; ++i)
+    {
+        auto start = Clock::now();
+        auto scene = createScene(nodeCount);
+        scene->retain();
+        autoreleasePool->clear();
+        double construction = elapsedMilliseconds(start);
+
+        // what the Director does when the scene is replaced
+        start = Clock::now();
+        scene->cleanup();
+        scene->release();
+        double teardown = elapsedMilliseconds(start);
+
+        if (i >= WARM_UP_SCENES)
+        {
+            constructionTimes.push_back(construction);
+            teardownTimes.push_back(teardown);
+        }
+    }
+
+    printf("object pool: %s\n", CC_ENABLE_OBJECT_POOL ? "enabled" : "disabled");
+    printf("%d scenes of %d nodes, each sprite running 6 actions, after %d warm-up scenes, median times\n",
+           sceneCount, nodeCount, WARM_UP_SCENES);
+    printf("construction: %10.3f ms\n", median(constructionTimes));
+    printf("teardown:     %10.3f ms\n", median(teardownTimes));
+#if CC_ENABLE_OBJECT_POOL
+    printf("\n%s", ObjectPool::getInfo().c_str());
+#endif
+
+    director->end();
+    director->mainLoop();
+    return 0;
+}
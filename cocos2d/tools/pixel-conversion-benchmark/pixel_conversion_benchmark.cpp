@@ -0,0 +1,156 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Checks the vector kernels of PixelConversion against the scalar ones and times them.
+// See README.md to build it.
+
+#include "renderer/ccPixelConversion.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace {
+
+const int WIDTH = 2048;
+const int HEIGHT = 2048;
+const int PIXEL_COUNT = WIDTH * HEIGHT;
+
+struct Conversion
+{
+    const char* name;
+    int inBytesPerPixel;
+    int outBytesPerPixel;
+    void (*convert)(const unsigned char* data, ssize_t pixelCount, unsigned char* outData);
+};
+
+void premultiply(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    memcpy(outData, data, pixelCount * 4);
+    PixelConversion::premultiplyAlpha(outData, pixelCount);
+}
+
+const Conversion CONVERSIONS[] = {
+    { "RGBA8888 -> RGB565", 4, 2, PixelConversion::convertRGBA8888ToRGB565 },
+    { "RGBA8888 -> RGBA4444", 4, 2, PixelConversion::convertRGBA8888ToRGBA4444 },
+    { "RGBA8888 -> RGB5A1", 4, 2, PixelConversion::convertRGBA8888ToRGB5A1 },
+    { "RGBA8888 -> A8", 4, 1, PixelConversion::convertRGBA8888ToA8 },
+    { "RGBA8888 -> RGB888", 4, 3, PixelConversion::convertRGBA8888ToRGB888 },
+    { "RGB888 -> RGBA8888", 3, 4, PixelConversion::convertRGB888ToRGBA8888 },
+    // includes a copy of the pixels, the same for all the instruction sets
+    { "premultiply alpha", 4, 4, premultiply },
+};
+
+const char* getName(PixelConversion::InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case PixelConversion::InstructionSet::SSE2: return "SSE2";
+        case PixelConversion::InstructionSet::AVX2: return "AVX2";
+        case PixelConversion::InstructionSet::NEON: return "NEON";
+        default: return "scalar";
+    }
+}
+
+// the best time of the runs, in milliseconds
+double timeConversion(const Conversion& conversion, const std::vector<unsigned char>& in, std::vector<unsigned char>& out, int runs)
+{
+    double best = 1e9;
+    for (int run = 0; run < runs; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        conversion.convert(in.data(), PIXEL_COUNT, out.data());
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int runs = argc > 1 ? atoi(argv[1]) : 20;
+    if (runs < 1)
+        runs = 1;
+
+    // random pixels, with an odd count of pixels left over by the vector kernels in the last run
+    std::vector<unsigned char> in(PIXEL_COUNT * 4 + 4);
+    srand(1);
+    for (auto& byte : in)
+        byte = static_cast<unsigned char>(rand());
+
+    const PixelConversion::InstructionSet instructionSets[] = {
+        PixelConversion::InstructionSet::SSE2,
+        PixelConversion::InstructionSet::AVX2,
+        PixelConversion::InstructionSet::NEON,
+    };
+
+    printf("%d x %d pixels, best of %d runs\n\n", WIDTH, HEIGHT, runs);
+    printf("%-22s %12s %12s %9s %8s\n", "conversion", "kernels", "scalar (ms)", "ms", "speedup");
+
+    bool allSame = true;
+    for (const auto& conversion : CONVERSIONS)
+    {
+        std::vector<unsigned char> expected(PIXEL_COUNT * conversion.outBytesPerPixel);
+        PixelConversion::setInstructionSet(PixelConversion::InstructionSet::SCALAR);
+        double scalarTime = timeConversion(conversion, in, expected, runs);
+
+        for (auto instructionSet : instructionSets)
+        {
+            PixelConversion::setInstructionSet(instructionSet);
+            // not supported by the CPU or not compiled in
+            if (PixelConversion::getInstructionSet() != instructionSet)
+                continue;
+
+            std::vector<unsigned char> out(expected.size());
+            double time = timeConversion(conversion, in, out, runs);
+
+            // all the pixel counts, so that the pixels left by the vector kernels are checked too
+            bool same = out == expected;
+            for (int count = 1; same && count <= 67; ++count)
+            {
+                std::vector<unsigned char> small(count * conversion.outBytesPerPixel), smallExpected(small.size());
+                conversion.convert(in.data(), count, small.data());
+                PixelConversion::setInstructionSet(PixelConversion::InstructionSet::SCALAR);
+                conversion.convert(in.data(), count, smallExpected.data());
+                PixelConversion::setInstructionSet(instructionSet);
+                same = small == smallExpected;
+            }
+            allSame = allSame && same;
+
+            printf("%-22s %12s %12.2f %9.2f %7.1fx%s\n", conversion.name, getName(instructionSet), scalarTime, time,
+                   scalarTime / time, same ? "" : "  DIFFERENT FROM SCALAR");
+        }
+    }
+
+    printf("\n%s\n", allSame ? "All the kernels give the scalar results." : "Some kernels don't give the scalar results!");
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Counts the heap allocations of the frames of a scene using the 2D draw paths, once they reached their steady state.
+// See README.md to build it.
+
+#include "cocos2d.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace cocos2d;
+
+namespace {
+
+const int WARM_UP_FRAMES = 120;
+const int SPRITE_COUNT = 1000;
+const float FRAME_TIME = 1.0f / 60;
+
+std::atomic<bool> s_counting(false);
+std::atomic<long> s_allocations(0);
+
+void* countedAllocate(size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed))
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+// moves, rotates and fades the nodes every frame, so that their transforms and commands are updated
+class AnimatedScene : public Scene
+{
+public:
+    static AnimatedScene* create()
+    {
+        AnimatedScene* ret = new (std::nothrow) AnimatedScene();
+        if (ret && ret->init())
+        {
+            ret->autorelease();
+            return ret;
+        }
+        CC_SAFE_DELETE(ret);
+        return nullptr;
+    }
+
+    virtual bool init() override
+    {
+        if (!Scene::init())
+            return false;
+
+        auto size = Director::getInstance()->getWinSize();
+
+        addChild(LayerColor::create(Color4B(40, 40, 80, 255)));
+
+        // a small texture shared by all the sprites, so that they are batched
+        const int textureSize = 32;
+        std::vector<unsigned char> pixels(textureSize * textureSize * 4, 255);
+        auto texture = new (std::nothrow) Texture2D();
+        texture->initWithData(pixels.data(), pixels.size(), Texture2D::PixelFormat::RGBA8888, textureSize, textureSize, Size(textureSize, textureSize));
+        texture->autorelease();
+
+        for (int i = 0; i < SPRITE_COUNT; ++i)
+        {
+            auto sprite = Sprite::createWithTexture(texture);
+            sprite->setPosition(Vec2(rand() % (int)size.width, rand() % (int)size.height));
+            addChild(sprite);
+            _sprites.push_back(sprite);
+        }
+
+        auto drawNode = DrawNode::create();
+        drawNode->drawSolidRect(Vec2(10, 10), Vec2(110, 110), Color4F::RED);
+        drawNode->drawCircle(Vec2(200, 60), 50, 0, 32, false, Color4F::GREEN);
+        drawNode->drawLine(Vec2(0, 0), Vec2(size.width, size.height), Color4F::WHITE);
+        drawNode->drawPoint(Vec2(300, 60), 4, Color4F::BLUE);
+        addChild(drawNode);
+
+        auto label = Label::createWithTTF("Steady state", "fonts/arial.ttf", 32);
+        label->setPosition(Vec2(size.width / 2, size.height - 40));
+        label->enableOutline(Color4B::BLACK, 2);
+        addChild(label);
+
+        auto stencil = DrawNode::create();
+        stencil->drawSolidCircle(Vec2::ZERO, 80, 0, 32, Color4F::WHITE);
+        auto clipper = ClippingNode::create(stencil);
+        clipper->setPosition(Vec2(size.width / 2, size.height / 2));
+        clipper->addChild(LayerColor::create(Color4B(200, 100, 0, 255), 400, 400));
+        addChild(clipper);
+
+        _progress = ProgressTimer::create(Sprite::createWithTexture(texture));
+        _progress->setType(ProgressTimer::Type::RADIAL);
+        _progress->setScale(4);
+        _progress->setPosition(Vec2(size.width - 100, 100));
+        addChild(_progress);
+
+        _streak = MotionStreak::create(0.5f, 3, 16, Color3B::YELLOW, texture);
+        addChild(_streak);
+
+        _renderTextureSprite = Sprite::createWithTexture(texture);
+        _renderTextureSprite->setPosition(Vec2(64, 64));
+        _renderTextureSprite->retain();
+        _renderTexture = RenderTexture::create(128, 128);
+        _renderTexture->setPosition(Vec2(size.width - 100, size.height - 100));
+        addChild(_renderTexture);
+
+        scheduleUpdate();
+        return true;
+    }
+
+    virtual ~AnimatedScene()
+    {
+        CC_SAFE_RELEASE(_renderTextureSprite);
+    }
+
+    virtual void update(float dt) override
+    {
+        _time += dt;
+
+        for (auto sprite : _sprites)
+        {
+            sprite->setRotation(sprite->getRotation() + 1);
+        }
+
+        _progress->setPercentage(fmodf(_time * 50, 100));
+        _streak->setPosition(Vec2(300 + 200 * cosf(_time), 300 + 200 * sinf(_time)));
+
+        _renderTexture->beginWithClear(0, 0, 0, 0);
+        _renderTextureSprite->setRotation(_time * 90);
+        _renderTextureSprite->visit();
+        _renderTexture->end();
+    }
+
+private:
+    std::vector<Sprite*> _sprites;
+    ProgressTimer* _progress = nullptr;
+    MotionStreak* _streak = nullptr;
+    RenderTexture* _renderTexture = nullptr;
+    Sprite* _renderTextureSprite = nullptr;
+    float _time = 0;
+};
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    void* address = countedAllocate(size);
+    if (address == nullptr)
+        throw std::bad_alloc();
+    return address;
+}
+
+void* operator new[](size_t size)
+{
+    void* address = countedAllocate(size);
+    if (address == nullptr)
+        throw std::bad_alloc();
+    return address;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void operator delete(void* address) noexcept { std::free(address); }
+void operator delete[](void* address) noexcept { std::free(address); }
+void operator delete(void* address, const std::nothrow_t&) noexcept { std::free(address); }
+void operator delete[](void* address, const std::nothrow_t&) noexcept { std::free(address); }
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 300;
+    if (frames < 1)
+        frames = 1;
+    if (argc > 2)
+        FileUtils::getInstance()->addSearchPath(argv[2]);
+    else
+        FileUtils::getInstance()->addSearchPath("Resources");
+
+    auto director = Director::getInstance();
+    auto glview = GLViewImpl::createWithRect("render-allocation-check", Rect(0, 0, 960, 640));
+    director->setOpenGLView(glview);
+    director->setDisplayStats(false);
+
+    srand(1);
+    director->runWithScene(AnimatedScene::create());
+
+    // the caches, pools and vectors reach their high-water mark
+    for (int i = 0; i < WARM_UP_FRAMES; ++i)
+        director->mainLoop(FRAME_TIME);
+
+    s_allocations = 0;
+    s_counting = true;
+    for (int i = 0; i < frames; ++i)
+        director->mainLoop(FRAME_TIME);
+    s_counting = false;
+
+    long allocations = s_allocations;
+    printf("%d frames after %d warm-up frames: %ld allocations, %.2f per frame\n",
+           frames, WARM_UP_FRAMES, allocations, (double)allocations / frames);
+
+    director->end();
+    director->mainLoop();
+
+    printf("%s\n", allocations == 0 ? "The steady state frames don't allocate." : "The steady state frames allocate!");
+    return allocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the Scheduler driving 50000 timers at mixed intervals, delays and repeats, and per-frame updates.
+// See README.md to build it.
+
+#include "cocos2d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace {
+
+const float FRAME_TIME = 1.0f / 60;
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMilliseconds(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// a target of the per-frame updates
+struct UpdateTarget
+{
+    void update(float dt) { ++calls; }
+    long calls = 0;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 50000;
+    int frames = argc > 2 ? atoi(argv[2]) : 600;
+    if (count < 1)
+        count = 1;
+    if (frames < 1)
+        frames = 1;
+
+    auto scheduler = new (std::nothrow) Scheduler();
+    long calls = 0;
+
+    // the timers are keyed by target, one target per ten timers like nodes scheduling several callbacks
+    std::vector<char> targets(count / 10 + 1);
+    std::vector<std::string> keys(count);
+    for (int i = 0; i < count; ++i)
+        keys[i] = "timer" + std::to_string(i);
+
+    srand(1);
+    auto start = Clock::now();
+    for (int i = 0; i < count; ++i)
+    {
+        void* target = &targets[i / 10];
+        auto callback = [&calls](float) { ++calls; };
+        switch (i % 4)
+        {
+        case 0:
+            // repeating every 0.1 to 2 seconds
+            scheduler->schedule(callback, target, 0.1f + (rand() % 20) * 0.1f, false, keys[i]);
+            break;
+        case 1:
+            // repeating after a delay of up to 5 seconds
+            scheduler->schedule(callback, target, 0.5f, CC_REPEAT_FOREVER, (rand() % 50) * 0.1f, false, keys[i]);
+            break;
+        case 2:
+            // firing once after up to 10 seconds
+            scheduler->schedule(callback, target, 0, 0, (rand() % 100) * 0.1f, false, keys[i]);
+            break;
+        default:
+            // repeating a few times at a short interval
+            scheduler->schedule(callback, target, 0.05f, rand() % 10, 0, false, keys[i]);
+            break;
+        }
+    }
+    double scheduleTime = elapsedMilliseconds(start);
+
+    std::vector<double> times;
+    times.reserve(frames);
+    for (int i = 0; i < frames; ++i)
+    {
+        auto frameStart = Clock::now();
+        scheduler->update(FRAME_TIME);
+        times.push_back(elapsedMilliseconds(frameStart));
+    }
+
+    std::vector<double> sorted(times);
+    std::sort(sorted.begin(), sorted.end());
+    double average = 0;
+    for (auto time : times)
+        average += time;
+    average /= times.size();
+
+    printf("%d timers, %d frames of %.4f s\n", count, frames, FRAME_TIME);
+    printf("schedule:   %10.3f ms\n", scheduleTime);
+    printf("update:     %10.3f ms per frame on average, %.3f median, %.3f worst, %ld callbacks\n",
+           average, sorted[sorted.size() / 2], sorted.back(), calls);
+
+    start = Clock::now();
+    scheduler->unscheduleAll();
+    printf("unschedule: %10.3f ms\n", elapsedMilliseconds(start));
+
+    // per-frame updates, scheduled and unscheduled one by one as nodes entering and leaving a scene do
+    std::vector<UpdateTarget> updateTargets(count);
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        scheduler->scheduleUpdate(&updateTargets[i], rand() % 10 - 5, false);
+    double scheduleUpdateTime = elapsedMilliseconds(start);
+
+    start = Clock::now();
+    for (int i = 0; i < frames; ++i)
+        scheduler->update(FRAME_TIME);
+    double updateTime = elapsedMilliseconds(start) / frames;
+
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+        scheduler->unscheduleUpdate(&updateTargets[i]);
+    double unscheduleUpdateTime = elapsedMilliseconds(start);
+
+    printf("\n%d per-frame updates\n", count);
+    printf("schedule:   %10.3f ms\n", scheduleUpdateTime);
+    printf("update:     %10.3f ms per frame on average\n", updateTime);
+    printf("unschedule: %10.3f ms\n", unscheduleUpdateTime);
+
+    delete scheduler;
+    return 0;
+}
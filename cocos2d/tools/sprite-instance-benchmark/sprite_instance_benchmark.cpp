@@ -0,0 +1,242 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the CPU side of the frames drawing 50000 moving sprites, as Sprite nodes and with a SpriteInstanceBatch.
+// See README.md to build it.
+
+#include "cocos2d.h"
+#include "2d/CCSpriteInstanceBatch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace {
+
+const int WARM_UP_FRAMES = 60;
+const float FRAME_TIME = 1.0f / 60;
+
+enum class Mode
+{
+    SPRITES,
+    BATCH_FALLBACK,
+    BATCH_INSTANCED
+};
+
+const char* modeName(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::SPRITES: return "sprites";
+    case Mode::BATCH_FALLBACK: return "batch (quads)";
+    default: return "batch (instanced)";
+    }
+}
+
+Texture2D* createTexture()
+{
+    const int textureSize = 16;
+    std::vector<unsigned char> pixels(textureSize * textureSize * 4, 255);
+    auto texture = new (std::nothrow) Texture2D();
+    texture->initWithData(pixels.data(), pixels.size(), Texture2D::PixelFormat::RGBA8888, textureSize, textureSize, Size(textureSize, textureSize));
+    texture->autorelease();
+    return texture;
+}
+
+// moves and rotates every sprite every frame, as a particle-like scene would
+class SpritesScene : public Scene
+{
+public:
+    static SpritesScene* create(Mode mode, int count)
+    {
+        SpritesScene* ret = new (std::nothrow) SpritesScene();
+        if (ret && ret->init(mode, count))
+        {
+            ret->autorelease();
+            return ret;
+        }
+        CC_SAFE_DELETE(ret);
+        return nullptr;
+    }
+
+    bool init(Mode mode, int count)
+    {
+        if (!Scene::init())
+            return false;
+
+        _size = Director::getInstance()->getWinSize();
+        auto texture = createTexture();
+        Rect textureRect(0, 0, texture->getContentSize().width, texture->getContentSize().height);
+
+        _positions.resize(count);
+        _velocities.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            _positions[i] = Vec2(rand() % (int)_size.width, rand() % (int)_size.height);
+            _velocities[i] = Vec2(rand() % 200 - 100, rand() % 200 - 100);
+        }
+
+        if (mode == Mode::SPRITES)
+        {
+            _sprites.reserve(count);
+            for (int i = 0; i < count; ++i)
+            {
+                auto sprite = Sprite::createWithTexture(texture);
+                sprite->setPosition(_positions[i]);
+                addChild(sprite);
+                _sprites.push_back(sprite);
+            }
+        }
+        else
+        {
+            _batch = SpriteInstanceBatch::createWithTexture(texture, count);
+            _batch->setInstancingEnabled(mode == Mode::BATCH_INSTANCED);
+            _ids.reserve(count);
+            for (int i = 0; i < count; ++i)
+                _ids.push_back(_batch->addInstance(textureRect, _positions[i]));
+            addChild(_batch);
+        }
+
+        scheduleUpdate();
+        return true;
+    }
+
+    virtual void update(float dt) override
+    {
+        _rotation += dt * 90;
+        for (size_t i = 0; i < _positions.size(); ++i)
+        {
+            Vec2& position = _positions[i];
+            position += _velocities[i] * dt;
+            if (position.x < 0 || position.x > _size.width)
+                _velocities[i].x = -_velocities[i].x;
+            if (position.y < 0 || position.y > _size.height)
+                _velocities[i].y = -_velocities[i].y;
+
+            if (_batch)
+            {
+                _batch->setInstancePosition(_ids[i], position);
+                _batch->setInstanceRotation(_ids[i], _rotation);
+            }
+            else
+            {
+                _sprites[i]->setPosition(position);
+                _sprites[i]->setRotation(_rotation);
+            }
+        }
+    }
+
+    bool isDrawingInstanced() const { return _batch && _batch->isDrawingInstanced(); }
+
+private:
+    Size _size;
+    std::vector<Vec2> _positions;
+    std::vector<Vec2> _velocities;
+    std::vector<Sprite*> _sprites;
+    SpriteInstanceBatch* _batch = nullptr;
+    std::vector<int> _ids;
+    float _rotation = 0;
+};
+
+struct Result
+{
+    double average;
+    double median;
+    double best;
+};
+
+Result run(Mode mode, int count, int frames)
+{
+    auto director = Director::getInstance();
+    auto scene = SpritesScene::create(mode, count);
+    if (director->getRunningScene())
+        director->replaceScene(scene);
+    else
+        director->runWithScene(scene);
+
+    for (int i = 0; i < WARM_UP_FRAMES; ++i)
+        director->mainLoop(FRAME_TIME);
+
+    if (mode == Mode::BATCH_INSTANCED && !scene->isDrawingInstanced())
+        printf("The GPU doesn't support instancing, the instanced batch draws quads.\n");
+
+    std::vector<double> times;
+    times.reserve(frames);
+    for (int i = 0; i < frames; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        director->mainLoop(FRAME_TIME);
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    Result result;
+    result.average = 0;
+    for (auto time : times)
+        result.average += time;
+    result.average /= times.size();
+    result.median = times[times.size() / 2];
+    result.best = times.front();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 50000;
+    int frames = argc > 2 ? atoi(argv[2]) : 300;
+    if (count < 1)
+        count = 1;
+    if (frames < 1)
+        frames = 1;
+
+    auto director = Director::getInstance();
+    auto glview = GLViewImpl::createWithRect("sprite-instance-benchmark", Rect(0, 0, 960, 640));
+    director->setOpenGLView(glview);
+    director->setDisplayStats(false);
+    // the frames aren't paced by the display, so mainLoop() takes the time of the frame only
+    glfwSwapInterval(0);
+
+    printf("%d sprites, %d frames after %d warm-up frames, in ms per frame\n", count, frames, WARM_UP_FRAMES);
+    printf("%-20s %10s %10s %10s\n", "mode", "average", "median", "best");
+
+    const Mode modes[] = { Mode::SPRITES, Mode::BATCH_FALLBACK, Mode::BATCH_INSTANCED };
+    for (auto mode : modes)
+    {
+        srand(1);
+        auto result = run(mode, count, frames);
+        printf("%-20s %10.3f %10.3f %10.3f\n", modeName(mode), result.average, result.median, result.best);
+    }
+
+    director->end();
+    director->mainLoop();
+    return 0;
+}
@@ -0,0 +1,169 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the startup of a process until its first frame, loading the images of the game, with the decoded image
+// cache of TextureCache disabled, empty (cold) and filled by a previous launch (warm).
+// See README.md to build it.
+
+#include "cocos2d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+using namespace cocos2d;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// initialized before main(), the closest to the start of the process
+const Clock::time_point s_processStart = Clock::now();
+
+const char* RESULT_FORMAT = "time to first frame: %lf ms";
+
+bool isImage(const std::string& path)
+{
+    std::string extension = FileUtils::getInstance()->getFileExtension(path);
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".webp";
+}
+
+// a sprite for every image of the game, loaded when the scene is created like the first scene of a game does
+Scene* createFirstScene(const std::string& directory)
+{
+    auto scene = Scene::create();
+    auto size = Director::getInstance()->getWinSize();
+
+    std::vector<std::string> files;
+    FileUtils::getInstance()->listFilesRecursively(directory, &files);
+    for (const auto& file : files)
+    {
+        if (!isImage(file))
+            continue;
+        auto sprite = Sprite::create(file);
+        if (sprite)
+        {
+            sprite->setPosition(Vec2(rand() % (int)size.width, rand() % (int)size.height));
+            scene->addChild(sprite);
+        }
+    }
+    return scene;
+}
+
+// one launch, in the current process
+int launch(const std::string& mode, const std::string& directory)
+{
+    auto director = Director::getInstance();
+    auto glview = GLViewImpl::createWithRect("startup-benchmark", Rect(0, 0, 960, 640));
+    director->setOpenGLView(glview);
+    director->setDisplayStats(false);
+
+    auto textureCache = director->getTextureCache();
+    if (mode != "none")
+    {
+        textureCache->setDecodedImageCacheEnabled(true);
+        if (mode == "cold")
+            textureCache->removeDecodedImageCache();
+    }
+
+    srand(1);
+    director->runWithScene(createFirstScene(directory));
+    director->mainLoop();
+
+    double time = std::chrono::duration<double, std::milli>(Clock::now() - s_processStart).count();
+    printf(RESULT_FORMAT, time);
+    printf("\n");
+
+    director->end();
+    director->mainLoop();
+    return 0;
+}
+
+// runs a launch in a new process, so that nothing is kept in memory from the previous one
+bool runLaunch(const std::string& program, const std::string& mode, const std::string& directory, double* time)
+{
+    std::string command = "\"" + program + "\" " + mode + " \"" + directory + "\"";
+    FILE* output = popen(command.c_str(), "r");
+    if (output == nullptr)
+        return false;
+
+    bool found = false;
+    char line[256];
+    while (fgets(line, sizeof(line), output))
+    {
+        if (sscanf(line, RESULT_FORMAT, time) == 1)
+            found = true;
+    }
+    return pclose(output) == 0 && found;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string first = argc > 1 ? argv[1] : "";
+    std::string directory = argc > 2 ? argv[2] : "Resources/res";
+
+    if (first == "none" || first == "cold" || first == "warm")
+        return launch(first, directory);
+
+    int runs = argc > 1 ? atoi(argv[1]) : 5;
+    if (runs < 1)
+        runs = 1;
+
+    const char* modes[] = { "none", "cold", "warm" };
+    std::vector<double> times[3];
+    for (int i = 0; i < runs; ++i)
+    {
+        // the cold launch fills the cache of the warm one
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            double time = 0;
+            if (!runLaunch(argv[0], modes[mode], directory, &time))
+            {
+                printf("The %s launch failed.\n", modes[mode]);
+                return 1;
+            }
+            times[mode].push_back(time);
+        }
+    }
+
+    printf("time to the first frame loading the images of %s, median of %d launches\n\n", directory.c_str(), runs);
+    printf("%-6s %12s\n", "cache", "time (ms)");
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        std::sort(times[mode].begin(), times[mode].end());
+        printf("%-6s %12.3f\n", modes[mode], times[mode][times[mode].size() / 2]);
+    }
+    return 0;
+}
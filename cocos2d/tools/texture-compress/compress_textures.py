@@ -0,0 +1,233 @@
+#!/usr/bin/python
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Transcode images to GPU compressed textures for TextureCache::addCompressedTextureManifest.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Transcode the images of a resource directory to ASTC, ETC2 and S3TC (BC1/BC3)
+textures, and write the manifest read by TextureCache::addCompressedTextureManifest.
+
+The encoders are external tools:
+ - astc: astcenc (https://github.com/ARM-software/astc-encoder), writes .astc files
+ - etc2: EtcTool (https://github.com/google/etc2comp), writes PKM 2.0 files
+ - s3tc: nvcompress (https://github.com/castano/nvidia-texture-tools), writes .dds files
+'''
+
+import os
+import plistlib
+import struct
+import subprocess
+import sys
+
+from argparse import ArgumentParser
+from multiprocessing.pool import ThreadPool
+
+SOURCE_EXTENSIONS = ('.png', '.jpg', '.jpeg')
+FORMATS = ('astc', 'etc2', 's3tc')
+MANIFEST_FORMAT = 1
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+PNG_COLOR_TYPE_GRAY_ALPHA = 4
+PNG_COLOR_TYPE_RGBA = 6
+JPEG_SIGNATURE = b'\xff\xd8'
+
+ASTC_MAGIC = b'\x13\xab\xa1\x5c'
+ASTC_BLOCK_SIZES = ('4x4', '6x6', '8x8')
+ETC2_PKM_MAGIC = b'PKM 20'
+DDS_MAGIC = b'DDS '
+
+ASTC_QUALITIES = {'fast': '-fast', 'medium': '-medium', 'thorough': '-thorough'}
+ETC2_EFFORTS = {'fast': '20', 'medium': '60', 'thorough': '100'}
+S3TC_QUALITIES = {'fast': '-fast', 'medium': '-production', 'thorough': '-highest'}
+
+
+def read_image_info(path):
+    '''Returns (width, height, has_alpha) of a png or jpeg file.'''
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if data.startswith(PNG_SIGNATURE):
+        width, height, _, color_type = struct.unpack('>IIBB', data[16:26])
+        has_alpha = color_type in (PNG_COLOR_TYPE_GRAY_ALPHA, PNG_COLOR_TYPE_RGBA)
+        # palette and opaque images may have a transparent color
+        offset = len(PNG_SIGNATURE)
+        while not has_alpha and offset + 8 <= len(data):
+            length, chunk_type = struct.unpack('>I4s', data[offset:offset + 8])
+            if chunk_type == b'tRNS':
+                has_alpha = True
+            elif chunk_type == b'IDAT':
+                break
+            offset += length + 12
+        return width, height, has_alpha
+
+    if data.startswith(JPEG_SIGNATURE):
+        offset = len(JPEG_SIGNATURE)
+        while offset + 9 <= len(data):
+            marker = bytearray(data[offset + 1:offset + 2])[0]
+            length = struct.unpack('>H', data[offset + 2:offset + 4])[0]
+            # the start of frame segments hold the size, 0xc4, 0xc8 and 0xcc are other segments
+            if 0xc0 <= marker <= 0xcf and marker not in (0xc4, 0xc8, 0xcc):
+                height, width = struct.unpack('>HH', data[offset + 5:offset + 9])
+                return width, height, False
+            offset += length + 2
+
+    raise ValueError('unsupported image: %s' % path)
+
+
+def variant_path(name, fmt):
+    base = os.path.splitext(name)[0]
+    if fmt == 'astc':
+        return base + '.astc'
+    if fmt == 'etc2':
+        return base + '.pkm'
+    return base + '.dds'
+
+
+def encoder_command(args, fmt, src, dst, has_alpha):
+    if fmt == 'astc':
+        return [args.astcenc, '-cl', src, dst, args.astc_block, ASTC_QUALITIES[args.quality]]
+    if fmt == 'etc2':
+        return [args.etctool, src, '-format', 'RGBA8' if has_alpha else 'RGB8',
+                '-effort', ETC2_EFFORTS[args.quality], '-output', dst]
+    return [args.nvcompress, '-nomips', '-bc3' if has_alpha else '-bc1',
+            S3TC_QUALITIES[args.quality], src, dst]
+
+
+def check_output(fmt, path):
+    '''The engine only reads the 2D, single level files of these containers.'''
+    with open(path, 'rb') as f:
+        header = f.read(16)
+
+    if fmt == 'astc':
+        return header.startswith(ASTC_MAGIC) and bytearray(header)[6] == 1
+    if fmt == 'etc2':
+        return header.startswith(ETC2_PKM_MAGIC)
+    return header.startswith(DDS_MAGIC)
+
+
+def compress(args, job):
+    name, src, width, height, has_alpha = job
+    variants = {}
+    for fmt in args.formats:
+        relative = variant_path(name, fmt)
+        dst = os.path.join(args.dst_dir, relative)
+
+        # skip the variants newer than their image
+        if args.force or not os.path.isfile(dst) or os.path.getmtime(dst) < os.path.getmtime(src):
+            directory = os.path.dirname(dst)
+            if directory and not os.path.isdir(directory):
+                try:
+                    os.makedirs(directory)
+                except OSError:
+                    if not os.path.isdir(directory):
+                        raise
+
+            command = encoder_command(args, fmt, src, dst, has_alpha)
+            with open(os.devnull, 'w') as devnull:
+                code = subprocess.call(command, stdout=devnull, stderr=subprocess.STDOUT)
+            if code != 0 or not os.path.isfile(dst):
+                return name, None, 'failed to run: %s' % ' '.join(command)
+
+        if not check_output(fmt, dst):
+            return name, None, 'unexpected %s file: %s' % (fmt, dst)
+
+        variants[fmt] = relative.replace(os.sep, '/')
+
+    return name, (width * height * 4, variants), None
+
+
+def find_images(src_dir):
+    for root, dirs, files in os.walk(src_dir):
+        dirs.sort()
+        for filename in sorted(files):
+            lower = filename.lower()
+            # the 9-patch borders are parsed from the pixels
+            if not lower.endswith(SOURCE_EXTENSIONS) or lower.endswith('.9.png'):
+                continue
+            path = os.path.join(root, filename)
+            yield os.path.relpath(path, src_dir).replace(os.sep, '/'), path
+
+
+def write_manifest(path, textures):
+    manifest = {
+        'metadata': {'format': MANIFEST_FORMAT},
+        'textures': textures,
+    }
+    if hasattr(plistlib, 'dump'):
+        with open(path, 'wb') as f:
+            plistlib.dump(manifest, f)
+    else:
+        plistlib.writePlist(manifest, path)
+
+
+def main():
+    parser = ArgumentParser(description='Transcode images to GPU compressed textures.')
+    parser.add_argument('src_dir', help='the resource directory, the manifest lists its images by their path relative to it')
+    parser.add_argument('dst_dir', help='the directory of the compressed textures and of the manifest')
+    parser.add_argument('--formats', default=','.join(FORMATS),
+                        help='comma separated formats to write, among %s' % ', '.join(FORMATS))
+    parser.add_argument('--astc-block', default='6x6', choices=ASTC_BLOCK_SIZES,
+                        help='ASTC block size, 4x4 is 8 bits per pixel, 6x6 3.56 and 8x8 2')
+    parser.add_argument('--quality', default='medium', choices=sorted(ASTC_QUALITIES.keys()))
+    parser.add_argument('--manifest', default='textures.plist', help='manifest file name in dst_dir')
+    parser.add_argument('--jobs', type=int, default=0, help='images compressed in parallel, one per core by default')
+    parser.add_argument('--force', action='store_true', help='compress the images again even if they did not change')
+    parser.add_argument('--astcenc', default='astcenc', help='path of astcenc')
+    parser.add_argument('--etctool', default='EtcTool', help='path of EtcTool')
+    parser.add_argument('--nvcompress', default='nvcompress', help='path of nvcompress')
+    args = parser.parse_args()
+
+    args.formats = [fmt.strip() for fmt in args.formats.split(',') if fmt.strip()]
+    for fmt in args.formats:
+        if fmt not in FORMATS:
+            parser.error('unknown format: %s' % fmt)
+
+    if not os.path.isdir(args.src_dir):
+        parser.error('%s is not a directory' % args.src_dir)
+
+    jobs = []
+    for name, path in find_images(args.src_dir):
+        try:
+            width, height, has_alpha = read_image_info(path)
+        except (ValueError, struct.error) as e:
+            print('skipped %s: %s' % (name, e))
+            continue
+        jobs.append((name, path, width, height, has_alpha))
+
+    pool = ThreadPool(args.jobs if args.jobs > 0 else None)
+    results = pool.map(lambda job: compress(args, job), jobs)
+    pool.close()
+
+    textures = {}
+    errors = 0
+    uncompressed_size = 0
+    compressed_sizes = dict((fmt, 0) for fmt in args.formats)
+    for name, result, error in results:
+        if error:
+            print('error: %s: %s' % (name, error))
+            errors += 1
+            continue
+
+        size, variants = result
+        textures[name] = variants
+        uncompressed_size += size
+        for fmt, relative in variants.items():
+            compressed_sizes[fmt] += os.path.getsize(os.path.join(args.dst_dir, relative))
+
+    if not os.path.isdir(args.dst_dir):
+        os.makedirs(args.dst_dir)
+    write_manifest(os.path.join(args.dst_dir, args.manifest), textures)
+
+    print('%d images, %.1f MB as RGBA8888' % (len(textures), uncompressed_size / 1048576.0))
+    for fmt in args.formats:
+        if compressed_sizes[fmt]:
+            print('  %s: %.1f MB, %.1fx smaller' % (fmt, compressed_sizes[fmt] / 1048576.0,
+                                                    float(uncompressed_size) / compressed_sizes[fmt]))
+
+    return 1 if errors else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,153 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+// Times the preload of the images of the game with TextureCache::addImageAsync(), against the number of decoders.
+// See README.md to build it.
+
+#include "cocos2d.h"
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cocos2d;
+
+namespace {
+
+const float FRAME_TIME = 1.0f / 60;
+
+typedef std::chrono::steady_clock Clock;
+
+bool isImage(const std::string& path)
+{
+    std::string extension = FileUtils::getInstance()->getFileExtension(path);
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".webp";
+}
+
+std::vector<std::string> listImages(const std::vector<std::string>& paths)
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::vector<std::string> files;
+    for (const auto& path : paths)
+    {
+        if (fileUtils->isDirectoryExist(path))
+        {
+            std::vector<std::string> directoryFiles;
+            fileUtils->listFilesRecursively(path, &directoryFiles);
+            for (const auto& file : directoryFiles)
+            {
+                if (isImage(file))
+                    files.push_back(file);
+            }
+        }
+        else
+        {
+            files.push_back(path);
+        }
+    }
+    return files;
+}
+
+// loads all the images, returns the milliseconds until the last callback
+double preload(const std::vector<std::string>& files)
+{
+    auto director = Director::getInstance();
+    auto textureCache = director->getTextureCache();
+    textureCache->removeAllTextures();
+
+    size_t loaded = 0;
+    auto start = Clock::now();
+    for (const auto& file : files)
+        textureCache->addImageAsync(file, [&loaded](Texture2D*) { ++loaded; });
+    while (loaded < files.size())
+        director->mainLoop(FRAME_TIME);
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int runs = argc > 1 ? atoi(argv[1]) : 5;
+    if (runs < 1)
+        runs = 1;
+
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; ++i)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths.push_back("Resources/res");
+
+    auto director = Director::getInstance();
+    auto glview = GLViewImpl::createWithRect("texture-preload-benchmark", Rect(0, 0, 960, 640));
+    director->setOpenGLView(glview);
+    director->setDisplayStats(false);
+    // the frames aren't paced by the display, the callbacks run as soon as the textures are created
+    glfwSwapInterval(0);
+    director->runWithScene(Scene::create());
+
+    auto files = listImages(paths);
+    if (files.empty())
+    {
+        printf("No image found.\n");
+        return 1;
+    }
+
+    auto textureCache = director->getTextureCache();
+    // all the decoded images of a frame are uploaded, the time measured is the one of the decoders
+    textureCache->setAsyncUploadBudget(0);
+
+    int workers = JobSystem::getInstance()->getWorkerCount();
+    printf("%d images, %u cores, %d JobSystem workers, median of %d runs\n\n",
+           (int)files.size(), std::thread::hardware_concurrency(), workers, runs);
+    printf("%8s %12s %8s\n", "decoders", "time (ms)", "speedup");
+
+    // the first load reads the files into the cache of the system
+    preload(files);
+
+    double single = 0;
+    for (int decoders = 1; decoders <= std::max(workers, 1); ++decoders)
+    {
+        textureCache->setAsyncDecoderCount(decoders);
+        std::vector<double> times;
+        for (int i = 0; i < runs; ++i)
+            times.push_back(preload(files));
+        std::sort(times.begin(), times.end());
+        double time = times[times.size() / 2];
+        if (decoders == 1)
+            single = time;
+        printf("%8d %12.3f %7.2fx\n", decoders, time, single / time);
+    }
+
+    textureCache->removeAllTextures();
+    director->end();
+    director->mainLoop();
+    return 0;
+}